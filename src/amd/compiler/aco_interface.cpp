@@ -26,6 +26,7 @@
 #include "vulkan/radv_shader.h"
 #include "c11/threads.h"
 #include "util/debug.h"
+#include "util/os_time.h"
 
 #include <iostream>
 #include <sstream>
@@ -51,13 +52,57 @@ static void init()
    debug_flags |= aco::DEBUG_VALIDATE;
    #endif
 }
+
+/* Adds the time spent until the end of the enclosing scope to the pass. */
+class pass_timer {
+public:
+   pass_timer(aco_compile_stats *stats, aco_pass pass)
+      : stats(stats), pass(pass), start(stats ? os_time_get_nano() : 0) {}
+
+   ~pass_timer()
+   {
+      if (stats)
+         stats->pass_time_ns[pass] += os_time_get_nano() - start;
+   }
+
+private:
+   aco_compile_stats *stats;
+   aco_pass pass;
+   int64_t start;
+};
+}
+
+const char *aco_pass_name(enum aco_pass pass)
+{
+   /* Must be in the same order as enum aco_pass. */
+   static const char *names[] = {
+      "isel",
+      "lower_bool_phis",
+      "dominance",
+      "value_numbering",
+      "optimize",
+      "exec_mask",
+      "live_vars",
+      "spill",
+      "schedule",
+      "register_allocation",
+      "ssa_elimination",
+      "lower_to_hw",
+      "wait_states",
+      "assembly",
+   };
+   static_assert(sizeof(names) / sizeof(names[0]) == ACO_NUM_PASSES,
+                 "missing aco_pass name");
+   assert(pass < ACO_NUM_PASSES);
+   return names[pass];
 }
 
 void aco_compile_shader(unsigned shader_count,
                         struct nir_shader *const *shaders,
                         struct radv_shader_binary **binary,
                         struct radv_shader_info *info,
-                        struct radv_nir_compiler_options *options)
+                        struct radv_nir_compiler_options *options,
+                        struct aco_compile_stats *stats)
 {
    call_once(&aco::init_once_flag, aco::init);
 
@@ -65,7 +110,10 @@ void aco_compile_shader(unsigned shader_count,
    std::unique_ptr<aco::Program> program{new aco::Program};
 
    /* Instruction Selection */
-   aco::select_program(program.get(), shader_count, shaders, &config, info, options);
+   {
+      aco::pass_timer t(stats, ACO_PASS_ISEL);
+      aco::select_program(program.get(), shader_count, shaders, &config, info, options);
+   }
    if (options->dump_preoptir) {
       std::cerr << "After Instruction Selection:\n";
       aco_print_program(program.get(), stderr);
@@ -73,27 +121,52 @@ void aco_compile_shader(unsigned shader_count,
    aco::validate(program.get(), stderr);
 
    /* Boolean phi lowering */
-   aco::lower_bool_phis(program.get());
+   {
+      aco::pass_timer t(stats, ACO_PASS_LOWER_BOOL_PHIS);
+      aco::lower_bool_phis(program.get());
+   }
    //std::cerr << "After Boolean Phi Lowering:\n";
    //aco_print_program(program.get(), stderr);
 
-   aco::dominator_tree(program.get());
+   {
+      aco::pass_timer t(stats, ACO_PASS_DOMINANCE);
+      aco::dominator_tree(program.get());
+   }
 
    /* Optimization */
-   aco::value_numbering(program.get());
-   aco::optimize(program.get());
+   {
+      aco::pass_timer t(stats, ACO_PASS_VALUE_NUMBERING);
+      aco::value_numbering(program.get());
+   }
+   {
+      aco::pass_timer t(stats, ACO_PASS_OPTIMIZE);
+      aco::optimize(program.get());
+   }
    aco::validate(program.get(), stderr);
 
-   aco::setup_reduce_temp(program.get());
-   aco::insert_exec_mask(program.get());
+   {
+      aco::pass_timer t(stats, ACO_PASS_EXEC_MASK);
+      aco::setup_reduce_temp(program.get());
+      aco::insert_exec_mask(program.get());
+   }
    aco::validate(program.get(), stderr);
 
-   aco::live live_vars = aco::live_var_analysis(program.get(), options);
-   aco::spill(program.get(), live_vars, options);
+   aco::live live_vars;
+   {
+      aco::pass_timer t(stats, ACO_PASS_LIVE_VARS);
+      live_vars = aco::live_var_analysis(program.get(), options);
+   }
+   {
+      aco::pass_timer t(stats, ACO_PASS_SPILL);
+      aco::spill(program.get(), live_vars, options);
+   }
 
    //std::cerr << "Before Schedule:\n";
    //aco_print_program(program.get(), stderr);
-   aco::schedule_program(program.get(), live_vars);
+   {
+      aco::pass_timer t(stats, ACO_PASS_SCHEDULE);
+      aco::schedule_program(program.get(), live_vars);
+   }
 
    std::string llvm_ir;
    if (options->record_ir) {
@@ -111,7 +184,10 @@ void aco_compile_shader(unsigned shader_count,
    }
 
    /* Register Allocation */
-   aco::register_allocation(program.get(), live_vars.live_out);
+   {
+      aco::pass_timer t(stats, ACO_PASS_RA);
+      aco::register_allocation(program.get(), live_vars.live_out);
+   }
    if (options->dump_shader) {
       std::cerr << "After RA:\n";
       aco_print_program(program.get(), stderr);
@@ -123,22 +199,42 @@ void aco_compile_shader(unsigned shader_count,
       abort();
    }
 
-   aco::ssa_elimination(program.get());
+   {
+      aco::pass_timer t(stats, ACO_PASS_SSA_ELIMINATION);
+      aco::ssa_elimination(program.get());
+   }
    /* Lower to HW Instructions */
-   aco::lower_to_hw_instr(program.get());
+   {
+      aco::pass_timer t(stats, ACO_PASS_LOWER_TO_HW);
+      aco::lower_to_hw_instr(program.get());
+   }
    //std::cerr << "After Eliminate Pseudo Instr:\n";
    //aco_print_program(program.get(), stderr);
 
    /* Insert Waitcnt */
-   aco::insert_wait_states(program.get());
-   aco::insert_NOPs(program.get());
+   {
+      aco::pass_timer t(stats, ACO_PASS_WAIT_STATES);
+      aco::insert_wait_states(program.get());
+      aco::insert_NOPs(program.get());
+   }
 
    //std::cerr << "After Insert-Waitcnt:\n";
    //aco_print_program(program.get(), stderr);
 
    /* Assembly */
    std::vector<uint32_t> code;
-   unsigned exec_size = aco::emit_program(program.get(), code);
+   unsigned exec_size;
+   {
+      aco::pass_timer t(stats, ACO_PASS_ASSEMBLY);
+      exec_size = aco::emit_program(program.get(), code);
+   }
+
+   if (stats) {
+      for (aco::Block& block : program->blocks)
+         stats->num_instructions += block.instructions.size();
+      stats->code_size += code.size() * sizeof(uint32_t);
+      stats->exec_size += exec_size;
+   }
 
    bool get_disasm = options->dump_shader || options->record_ir;
 
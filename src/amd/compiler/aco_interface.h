@@ -32,11 +32,46 @@ extern "C" {
 
 struct ac_shader_config;
 
+/* Backend passes timed by aco_compile_shader(), in execution order. */
+enum aco_pass {
+   ACO_PASS_ISEL,
+   ACO_PASS_LOWER_BOOL_PHIS,
+   ACO_PASS_DOMINANCE,
+   ACO_PASS_VALUE_NUMBERING,
+   ACO_PASS_OPTIMIZE,
+   ACO_PASS_EXEC_MASK,
+   ACO_PASS_LIVE_VARS,
+   ACO_PASS_SPILL,
+   ACO_PASS_SCHEDULE,
+   ACO_PASS_RA,
+   ACO_PASS_SSA_ELIMINATION,
+   ACO_PASS_LOWER_TO_HW,
+   ACO_PASS_WAIT_STATES,
+   ACO_PASS_ASSEMBLY,
+   ACO_NUM_PASSES,
+};
+
+struct aco_compile_stats {
+   /* CPU time spent in each pass; validation and IR dumps are excluded. */
+   uint64_t pass_time_ns[ACO_NUM_PASSES];
+   /* Hardware instructions in the final program. */
+   unsigned num_instructions;
+   /* Size of the binary in bytes, and of its executable part. */
+   unsigned code_size;
+   unsigned exec_size;
+};
+
+const char *aco_pass_name(enum aco_pass pass);
+
+/* If stats is not NULL, the time spent in each pass and the size of the
+ * generated code are added to it.
+ */
 void aco_compile_shader(unsigned shader_count,
                         struct nir_shader *const *shaders,
                         struct radv_shader_binary** binary,
                         struct radv_shader_info *info,
-                        struct radv_nir_compiler_options *options);
+                        struct radv_nir_compiler_options *options,
+                        struct aco_compile_stats *stats);
 
 #ifdef __cplusplus
 }
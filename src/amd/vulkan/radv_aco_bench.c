@@ -0,0 +1,651 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/** @file radv_aco_bench.c
+ *
+ * Offline compile-time benchmark for ACO.
+ *
+ * Every SPIR-V compute (.comp.spv) and fragment (.frag.spv) shader found in
+ * the files and directories given on the command line is compiled for the
+ * chosen GPU family without opening a device: the shader goes through the
+ * same radv NIR lowering as at pipeline creation and then through
+ * aco_compile_shader(), which reports the time spent in each backend pass.
+ * Shaders are compiled in parallel, one thread per CPU by default.
+ *
+ * The pipeline layout is synthesized from the descriptor variables declared
+ * by the shader, fragment outputs are exported as 32-bit RGBA and no other
+ * pipeline state is known, so the code matches what radv generates for the
+ * simplest pipeline using the shader.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "radv_private.h"
+#include "radv_shader.h"
+#include "aco_interface.h"
+#include "ac_llvm_util.h"
+#include "sid.h"
+
+#include "compiler/glsl_types.h"
+#include "compiler/spirv/nir_spirv.h"
+#include "util/compile_bench.h"
+#include "util/os_time.h"
+#include "util/u_dynarray.h"
+
+struct bench_shader {
+	char *path;
+	gl_shader_stage stage;
+	struct radv_shader_module *module;
+	VkDescriptorSetLayout set_layouts[MAX_SETS];
+	unsigned num_set_layouts;
+	struct radv_pipeline_layout *layout;
+
+	bool failed;
+
+	/* Summed over all iterations. */
+	uint64_t nir_time_ns;
+	struct aco_compile_stats stats;
+	/* From the last iteration. */
+	struct ac_shader_config config;
+};
+
+static struct {
+	const char *family;
+} opts = {
+	.family = "vega10",
+};
+
+static struct compile_bench bench;
+
+static struct radv_instance bench_instance;
+static struct radv_physical_device bench_physical_device;
+static struct radv_device bench_device;
+
+static void *
+bench_alloc(void *data, size_t size, size_t align,
+	    VkSystemAllocationScope scope)
+{
+	return malloc(size);
+}
+
+static void *
+bench_realloc(void *data, void *mem, size_t size, size_t align,
+	      VkSystemAllocationScope scope)
+{
+	return realloc(mem, size);
+}
+
+static void
+bench_free(void *data, void *mem)
+{
+	free(mem);
+}
+
+static const VkAllocationCallbacks bench_allocator = {
+	.pfnAllocation = bench_alloc,
+	.pfnReallocation = bench_realloc,
+	.pfnFree = bench_free,
+};
+
+/* Sets up just enough of a device for the shader compiler, following
+ * radv_physical_device_init() and RADV_FORCE_FAMILY.
+ */
+static bool
+init_device(const char *family)
+{
+	struct radeon_info *info = &bench_physical_device.rad_info;
+	unsigned i;
+
+	for (i = CHIP_TAHITI; i < CHIP_LAST; i++) {
+		if (!strcmp(family, ac_get_llvm_processor_name(i)))
+			break;
+	}
+	if (i == CHIP_LAST) {
+		fprintf(stderr, "Unknown family: %s\n", family);
+		return false;
+	}
+
+	info->family = i;
+	if (i >= CHIP_NAVI10)
+		info->chip_class = GFX10;
+	else if (i >= CHIP_VEGA10)
+		info->chip_class = GFX9;
+	else if (i >= CHIP_TONGA)
+		info->chip_class = GFX8;
+	else if (i >= CHIP_BONAIRE)
+		info->chip_class = GFX7;
+	else
+		info->chip_class = GFX6;
+
+	if (info->chip_class < GFX8 || info->chip_class > GFX9) {
+		fprintf(stderr, "ACO doesn't support %s\n", family);
+		return false;
+	}
+
+	info->address32_hi = 0xffff8000u;
+
+	bench_physical_device.instance = &bench_instance;
+	bench_physical_device.use_aco = true;
+	bench_physical_device.ps_wave_size = 64;
+	bench_physical_device.cs_wave_size = 64;
+	bench_physical_device.ge_wave_size = 64;
+
+	bench_instance.alloc = bench_allocator;
+
+	bench_device.alloc = bench_allocator;
+	bench_device.instance = &bench_instance;
+	bench_device.physical_device = &bench_physical_device;
+
+	return true;
+}
+
+static VkDescriptorType
+descriptor_type(const nir_variable *var)
+{
+	const struct glsl_type *type = glsl_without_array(var->type);
+
+	if (var->data.mode == nir_var_mem_ubo)
+		return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	if (var->data.mode == nir_var_mem_ssbo)
+		return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+
+	if (glsl_type_is_image(type)) {
+		switch (glsl_get_sampler_dim(type)) {
+		case GLSL_SAMPLER_DIM_BUF:
+			return VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER;
+		case GLSL_SAMPLER_DIM_SUBPASS:
+		case GLSL_SAMPLER_DIM_SUBPASS_MS:
+			return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+		default:
+			return VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		}
+	}
+
+	if (glsl_type_is_sampler(type)) {
+		if (glsl_get_sampler_dim(type) == GLSL_SAMPLER_DIM_BUF)
+			return VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+		/* Has room for both an image and a sampler, so it works for
+		 * separate textures and samplers too.
+		 */
+		return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	}
+
+	return VK_DESCRIPTOR_TYPE_MAX_ENUM;
+}
+
+/* Builds a pipeline layout with a binding for every descriptor the shader
+ * declares, visible to all stages, plus the maximum push constant range.
+ */
+static bool
+create_pipeline_layout(struct bench_shader *shader, const nir_shader *nir)
+{
+	VkDevice device = radv_device_to_handle(&bench_device);
+	struct util_dynarray bindings[MAX_SETS];
+	unsigned num_sets = 0;
+	VkPipelineLayout layout = VK_NULL_HANDLE;
+
+	for (unsigned s = 0; s < MAX_SETS; s++)
+		util_dynarray_init(&bindings[s], NULL);
+
+	nir_foreach_variable(var, &nir->uniforms) {
+		VkDescriptorType type = descriptor_type(var);
+		unsigned set = var->data.descriptor_set;
+		bool found = false;
+
+		if (type == VK_DESCRIPTOR_TYPE_MAX_ENUM || set >= MAX_SETS)
+			continue;
+
+		util_dynarray_foreach(&bindings[set], VkDescriptorSetLayoutBinding, b) {
+			if (b->binding == var->data.binding)
+				found = true;
+		}
+		if (found)
+			continue;
+
+		unsigned count = 1;
+		if (glsl_type_is_array(var->type))
+			count = MAX2(glsl_get_aoa_size(var->type), 1);
+
+		VkDescriptorSetLayoutBinding binding = {
+			.binding = var->data.binding,
+			.descriptorType = type,
+			.descriptorCount = count,
+			.stageFlags = VK_SHADER_STAGE_ALL,
+		};
+		util_dynarray_append(&bindings[set], VkDescriptorSetLayoutBinding,
+				     binding);
+		num_sets = MAX2(num_sets, set + 1);
+	}
+
+	for (unsigned s = 0; s < num_sets; s++) {
+		VkDescriptorSetLayoutCreateInfo set_info = {
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+			.bindingCount = util_dynarray_num_elements(&bindings[s],
+								   VkDescriptorSetLayoutBinding),
+			.pBindings = bindings[s].data,
+		};
+		if (radv_CreateDescriptorSetLayout(device, &set_info, NULL,
+						   &shader->set_layouts[s]) != VK_SUCCESS)
+			goto fail;
+		shader->num_set_layouts++;
+	}
+
+	VkPushConstantRange push_range = {
+		.stageFlags = VK_SHADER_STAGE_ALL,
+		.offset = 0,
+		.size = MAX_PUSH_CONSTANTS_SIZE,
+	};
+	VkPipelineLayoutCreateInfo layout_info = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+		.setLayoutCount = num_sets,
+		.pSetLayouts = shader->set_layouts,
+		.pushConstantRangeCount = 1,
+		.pPushConstantRanges = &push_range,
+	};
+	radv_CreatePipelineLayout(device, &layout_info, NULL, &layout);
+	shader->layout = radv_pipeline_layout_from_handle(layout);
+
+fail:
+	for (unsigned s = 0; s < MAX_SETS; s++)
+		util_dynarray_fini(&bindings[s]);
+
+	return shader->layout != NULL;
+}
+
+static void
+destroy_pipeline_layout(struct bench_shader *shader)
+{
+	VkDevice device = radv_device_to_handle(&bench_device);
+
+	/* The pipeline layout points at the set layouts, so free it first. */
+	if (shader->layout)
+		radv_DestroyPipelineLayout(device,
+					   radv_pipeline_layout_to_handle(shader->layout),
+					   NULL);
+	for (unsigned s = 0; s < shader->num_set_layouts; s++)
+		radv_DestroyDescriptorSetLayout(device, shader->set_layouts[s], NULL);
+}
+
+static struct radv_shader_module *
+load_module(const char *path)
+{
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "Failed to open %s\n", path);
+		return NULL;
+	}
+
+	off_t len = lseek(fd, 0, SEEK_END);
+	if (len <= 0 || len % 4 != 0) {
+		fprintf(stderr, "%s: file length isn't a multiple of the word size\n",
+			path);
+		close(fd);
+		return NULL;
+	}
+
+	struct radv_shader_module *module = calloc(1, sizeof(*module) + len);
+	if (!module) {
+		close(fd);
+		return NULL;
+	}
+
+	if (pread(fd, module->data, len, 0) != len) {
+		fprintf(stderr, "%s: failed to read: %s\n", path, strerror(errno));
+		free(module);
+		close(fd);
+		return NULL;
+	}
+	close(fd);
+
+	module->size = len;
+	_mesa_sha1_compute(module->data, module->size, module->sha1);
+	return module;
+}
+
+/* Runs spirv_to_nir() once, untimed, to find the descriptors the shader
+ * uses before the real compile, which needs the layout.
+ */
+static bool
+prepare_shader(struct bench_shader *shader)
+{
+	static const nir_shader_compiler_options nir_options = { 0 };
+	/* The capabilities radv enables with ACO. */
+	const struct spirv_to_nir_options spirv_options = {
+		.lower_ubo_ssbo_access_to_offsets = true,
+		.caps = {
+			.amd_gcn_shader = true,
+			.amd_trinary_minmax = true,
+			.demote_to_helper_invocation = true,
+			.derivative_group = true,
+			.descriptor_array_dynamic_indexing = true,
+			.descriptor_array_non_uniform_indexing = true,
+			.descriptor_indexing = true,
+			.device_group = true,
+			.draw_parameters = true,
+			.float64 = true,
+			.image_read_without_format = true,
+			.image_write_without_format = true,
+			.int64 = true,
+			.int64_atomics = true,
+			.multiview = true,
+			.physical_storage_buffer_address = true,
+			.post_depth_coverage = true,
+			.runtime_descriptor_array = true,
+			.stencil_export = true,
+			.storage_image_ms = true,
+			.subgroup_arithmetic = true,
+			.subgroup_ballot = true,
+			.subgroup_basic = true,
+			.subgroup_quad = true,
+			.subgroup_shuffle = true,
+			.subgroup_vote = true,
+			.variable_pointers = true,
+		},
+		.ubo_addr_format = nir_address_format_32bit_index_offset,
+		.ssbo_addr_format = nir_address_format_32bit_index_offset,
+		.phys_ssbo_addr_format = nir_address_format_64bit_global,
+		.push_const_addr_format = nir_address_format_logical,
+		.shared_addr_format = nir_address_format_32bit_offset,
+		.frag_coord_is_sysval = true,
+	};
+
+	shader->module = load_module(shader->path);
+	if (!shader->module)
+		return false;
+
+	nir_shader *nir = spirv_to_nir((const uint32_t *)shader->module->data,
+				       shader->module->size / 4, NULL, 0,
+				       shader->stage, "main",
+				       &spirv_options, &nir_options);
+	if (!nir) {
+		fprintf(stderr, "%s: spirv_to_nir failed\n", shader->path);
+		return false;
+	}
+
+	bool ok = create_pipeline_layout(shader, nir);
+	ralloc_free(nir);
+
+	if (!ok) {
+		fprintf(stderr, "%s: failed to create the pipeline layout\n",
+			shader->path);
+		return false;
+	}
+	return true;
+}
+
+static void
+compile_shader(struct bench_shader *shader)
+{
+	struct radv_device *device = &bench_device;
+	uint64_t start = os_time_get_nano();
+
+	nir_shader *nir = radv_shader_compile_to_nir(device, shader->module,
+						     "main", shader->stage,
+						     NULL, 0, shader->layout,
+						     true);
+
+	NIR_PASS_V(nir, nir_lower_non_uniform_access,
+		   nir_lower_non_uniform_ubo_access |
+		   nir_lower_non_uniform_ssbo_access |
+		   nir_lower_non_uniform_texture_access |
+		   nir_lower_non_uniform_image_access);
+
+	struct radv_shader_variant_key key = {0};
+	if (shader->stage == MESA_SHADER_FRAGMENT) {
+		uint64_t written = nir->info.outputs_written >> FRAG_RESULT_DATA0;
+
+		for (unsigned i = 0; i < MAX_RTS; i++) {
+			if (written & (1ull << i))
+				key.fs.col_format |= V_028714_SPI_SHADER_32_ABGR << (4 * i);
+		}
+		radv_lower_fs_io(nir);
+	}
+
+	struct radv_shader_info info;
+	radv_nir_shader_info_init(&info);
+	radv_nir_shader_info_pass(nir, shader->layout, &key, &info);
+
+	struct radv_nir_compiler_options options = {
+		.layout = shader->layout,
+		.key = key,
+		.supports_spill = true,
+		.family = device->physical_device->rad_info.family,
+		.chip_class = device->physical_device->rad_info.chip_class,
+		.address32_hi = device->physical_device->rad_info.address32_hi,
+		.wave_size = shader->stage == MESA_SHADER_COMPUTE ?
+			     device->physical_device->cs_wave_size :
+			     device->physical_device->ps_wave_size,
+	};
+
+	shader->nir_time_ns += os_time_get_nano() - start;
+
+	struct radv_shader_binary *binary = NULL;
+	aco_compile_shader(1, &nir, &binary, &info, &options, &shader->stats);
+
+	shader->config = ((struct radv_shader_binary_legacy *)binary)->config;
+	free(binary);
+	ralloc_free(nir);
+}
+
+static void
+compile_shader_job(void *job)
+{
+	struct bench_shader *shader = job;
+
+	if (shader->failed)
+		return;
+
+	for (unsigned i = 0; i < bench.iterations; i++)
+		compile_shader(shader);
+}
+
+static uint64_t
+total_time_ns(const struct bench_shader *shader)
+{
+	uint64_t total = shader->nir_time_ns;
+
+	for (unsigned p = 0; p < ACO_NUM_PASSES; p++)
+		total += shader->stats.pass_time_ns[p];
+	return total;
+}
+
+static void
+print_shader(const struct bench_shader *shader)
+{
+	const struct ac_shader_config *conf = &shader->config;
+	const struct aco_compile_stats *stats = &shader->stats;
+	double ms = total_time_ns(shader) / 1000000.0 / bench.iterations;
+
+	if (bench.csv) {
+		printf("%s,%s,%.3f,%u,%u,%u,%u,%u,%u\n", shader->path,
+		       _mesa_shader_stage_to_abbrev(shader->stage), ms,
+		       stats->num_instructions / bench.iterations,
+		       stats->code_size / bench.iterations,
+		       conf->num_sgprs, conf->num_vgprs,
+		       conf->spilled_sgprs, conf->spilled_vgprs);
+	} else {
+		printf("%-48s %4s %10.3f %8u %8u %6u %6u %6u %6u\n", shader->path,
+		       _mesa_shader_stage_to_abbrev(shader->stage), ms,
+		       stats->num_instructions / bench.iterations,
+		       stats->code_size / bench.iterations,
+		       conf->num_sgprs, conf->num_vgprs,
+		       conf->spilled_sgprs, conf->spilled_vgprs);
+	}
+}
+
+static void
+print_pass_stats(const struct bench_shader *shaders, unsigned count,
+		 uint64_t wall_ns)
+{
+	uint64_t pass_ns[ACO_NUM_PASSES] = {0};
+	uint64_t nir_ns = 0, total_ns = 0;
+	uint64_t instrs = 0, code_size = 0;
+	unsigned compiled = 0;
+
+	for (unsigned i = 0; i < count; i++) {
+		if (shaders[i].failed)
+			continue;
+
+		nir_ns += shaders[i].nir_time_ns;
+		for (unsigned p = 0; p < ACO_NUM_PASSES; p++)
+			pass_ns[p] += shaders[i].stats.pass_time_ns[p];
+		total_ns += total_time_ns(&shaders[i]);
+		instrs += shaders[i].stats.num_instructions;
+		code_size += shaders[i].stats.code_size;
+		compiled++;
+	}
+
+	if (!total_ns)
+		return;
+
+	if (bench.csv)
+		printf("\npass,total_ms\n");
+	else
+		printf("\n%-24s %12s %6s\n", "pass", "total ms", "%");
+
+	for (int p = -1; p < ACO_NUM_PASSES; p++) {
+		const char *name = p < 0 ? "nir" : aco_pass_name(p);
+		uint64_t ns = p < 0 ? nir_ns : pass_ns[p];
+		double ms = ns / 1000000.0 / bench.iterations;
+
+		if (bench.csv)
+			printf("%s,%.3f\n", name, ms);
+		else
+			printf("%-24s %12.3f %6.2f\n", name, ms, 100.0 * ns / total_ns);
+	}
+
+	if (!bench.csv) {
+		printf("\n%u shaders, %" PRIu64 " instructions, %" PRIu64 " bytes\n",
+		       compiled, instrs / bench.iterations,
+		       code_size / bench.iterations);
+		printf("CPU time %.3f ms, wall time %.3f ms on %u threads\n",
+		       total_ns / 1000000.0 / bench.iterations,
+		       wall_ns / 1000000.0 / bench.iterations, bench.threads);
+	}
+}
+
+static bool
+stage_from_path(const char *path, gl_shader_stage *stage)
+{
+	size_t len = strlen(path);
+
+	if (len > 9 && strcmp(path + len - 9, ".comp.spv") == 0) {
+		*stage = MESA_SHADER_COMPUTE;
+		return true;
+	}
+	if (len > 9 && strcmp(path + len - 9, ".frag.spv") == 0) {
+		*stage = MESA_SHADER_FRAGMENT;
+		return true;
+	}
+	return false;
+}
+
+static bool
+is_shader(const char *path)
+{
+	gl_shader_stage stage;
+
+	return stage_from_path(path, &stage);
+}
+
+static const struct compile_bench_option bench_opts[] = {
+	{ "family", "name", "GPU to compile for, e.g. polaris10 (vega10)", NULL,
+	  &opts.family },
+	{ NULL }
+};
+
+int
+main(int argc, char **argv)
+{
+	int status;
+
+	bench.description = "Compiles .comp.spv and .frag.spv shaders with ACO.";
+	bench.is_shader = is_shader;
+	bench.options = bench_opts;
+	bench.threaded = true;
+	if (!compile_bench_init(&bench, argc, argv, &status))
+		return status;
+
+	if (!init_device(opts.family))
+		return EXIT_FAILURE;
+
+	unsigned count = bench.num_paths;
+
+	glsl_type_singleton_init_or_ref();
+
+	struct bench_shader *shaders = calloc(MAX2(count, 1), sizeof(*shaders));
+	unsigned failed = 0;
+	for (unsigned i = 0; i < count; i++) {
+		struct bench_shader *shader = &shaders[i];
+
+		shader->path = bench.paths[i];
+		stage_from_path(shader->path, &shader->stage);
+
+		if (!prepare_shader(shader)) {
+			shader->failed = true;
+			failed++;
+		}
+	}
+
+	uint64_t wall_ns = compile_bench_run(&bench, shaders, count,
+					     sizeof(*shaders),
+					     compile_shader_job);
+
+	if (bench.verbose) {
+		if (bench.csv)
+			printf("shader,stage,ms,instructions,code_size,sgprs,vgprs,"
+			       "spilled_sgprs,spilled_vgprs\n");
+		else
+			printf("%-48s %4s %10s %8s %8s %6s %6s %6s %6s\n", "shader",
+			       "", "ms", "instrs", "bytes", "sgprs", "vgprs",
+			       "sspill", "vspill");
+
+		for (unsigned i = 0; i < count; i++) {
+			if (!shaders[i].failed)
+				print_shader(&shaders[i]);
+		}
+	}
+
+	print_pass_stats(shaders, count, wall_ns);
+
+	if (failed)
+		fprintf(stderr, "%u shaders failed to compile\n", failed);
+
+	for (unsigned i = 0; i < count; i++) {
+		struct bench_shader *shader = &shaders[i];
+
+		destroy_pipeline_layout(shader);
+		free(shader->module);
+	}
+	free(shaders);
+	compile_bench_fini(&bench);
+	glsl_type_singleton_decref();
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
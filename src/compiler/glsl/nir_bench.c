@@ -0,0 +1,743 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/** @file nir_bench.c
+ *
+ * Offline compile-time benchmark for NIR.
+ *
+ * Every GLSL (.vert, .tesc, .tese, .geom, .frag, .comp) and SPIR-V
+ * (.vert.spv, .frag.spv, ...) shader found in the files and directories given
+ * on the command line is translated with glsl_to_nir() or spirv_to_nir() and
+ * then run through a driver-like pipeline of NIR passes.  The time spent in
+ * each NIR_PASS() is recorded through nir_set_pass_profiler() and, with
+ * --memory, so is the heap growth, so that compile-time regressions can be
+ * compared across commits.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "main/mtypes.h"
+#include "compiler/glsl_types.h"
+#include "compiler/nir/nir.h"
+#include "compiler/spirv/nir_spirv.h"
+#include "compiler/glsl/builtin_functions.h"
+#include "compiler/glsl/gl_nir.h"
+#include "compiler/glsl/glsl_to_nir.h"
+#include "compiler/glsl/standalone.h"
+#include "util/compile_bench.h"
+#include "util/hash_table.h"
+#include "util/os_time.h"
+#include "util/ralloc.h"
+#include "util/u_dynarray.h"
+
+#define MAX_PASS_DEPTH 32
+
+struct pass_stats {
+   const char *name;
+   unsigned calls;
+   unsigned progress;
+   int64_t time_ns;
+   /* Net heap growth across the pass, only with --memory. */
+   int64_t heap_growth;
+   /* Largest heap size right after the pass, only with --memory.  The heap
+    * isn't sampled during the pass, so this isn't its high-water mark.
+    */
+   size_t heap_after;
+};
+
+struct pass_frame {
+   int64_t start_ns;
+   size_t start_heap;
+};
+
+struct bench_state {
+   /* Pass name -> struct pass_stats, accumulated over all shaders. */
+   struct hash_table *passes;
+
+   struct pass_frame stack[MAX_PASS_DEPTH];
+   unsigned depth;
+
+   bool track_memory;
+   size_t shader_heap_after;
+};
+
+static struct bench_state profile;
+
+static struct {
+   const char *glsl_version;
+   int scalar;
+   int track_memory;
+   const char *pipeline;
+} opts = {
+   .glsl_version = "450",
+   .pipeline = "default",
+};
+
+static struct compile_bench bench;
+
+static size_t
+heap_in_use(void)
+{
+#if defined(__GLIBC__) && \
+    (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+   struct mallinfo2 mi = mallinfo2();
+   return mi.uordblks + mi.hblkhd;
+#elif defined(__GLIBC__)
+   struct mallinfo mi = mallinfo();
+   return (unsigned) mi.uordblks + (unsigned) mi.hblkhd;
+#else
+   return 0;
+#endif
+}
+
+static struct pass_stats *
+get_pass_stats(const char *name)
+{
+   struct hash_entry *entry = _mesa_hash_table_search(profile.passes, name);
+   if (entry)
+      return entry->data;
+
+   struct pass_stats *stats = rzalloc(profile.passes, struct pass_stats);
+   stats->name = ralloc_strdup(stats, name);
+   _mesa_hash_table_insert(profile.passes, stats->name, stats);
+   return stats;
+}
+
+static void
+profile_begin(const char *name)
+{
+   assert(profile.depth < MAX_PASS_DEPTH);
+   struct pass_frame *frame = &profile.stack[profile.depth++];
+
+   frame->start_heap = profile.track_memory ? heap_in_use() : 0;
+   frame->start_ns = os_time_get_nano();
+}
+
+static void
+profile_end(const char *name, bool progress)
+{
+   int64_t end_ns = os_time_get_nano();
+
+   assert(profile.depth > 0);
+   struct pass_frame *frame = &profile.stack[--profile.depth];
+   struct pass_stats *stats = get_pass_stats(name);
+
+   stats->calls++;
+   stats->progress += progress;
+   stats->time_ns += end_ns - frame->start_ns;
+
+   if (profile.track_memory) {
+      size_t heap = heap_in_use();
+      stats->heap_growth += (int64_t) heap - (int64_t) frame->start_heap;
+      stats->heap_after = MAX2(stats->heap_after, heap);
+      profile.shader_heap_after = MAX2(profile.shader_heap_after, heap);
+   }
+}
+
+static void
+nir_begin_pass_cb(void *data, const nir_shader *shader, const char *pass)
+{
+   profile_begin(pass);
+}
+
+static void
+nir_end_pass_cb(void *data, const nir_shader *shader, const char *pass,
+                bool progress)
+{
+   profile_end(pass, progress);
+}
+
+static const nir_pass_profiler bench_profiler = {
+   .begin_pass = nir_begin_pass_cb,
+   .end_pass = nir_end_pass_cb,
+};
+
+/* Wrap each pass of the pipeline in NIR_PASS() so that the profiler sees the
+ * real pass name.
+ */
+#define BENCH_PASS(pass, ...)                                        \
+static bool                                                          \
+bench_##pass(nir_shader *nir)                                        \
+{                                                                    \
+   bool progress = false;                                            \
+   NIR_PASS(progress, nir, pass, ##__VA_ARGS__);                     \
+   return progress;                                                  \
+}
+
+BENCH_PASS(nir_split_var_copies)
+BENCH_PASS(nir_lower_var_copies)
+BENCH_PASS(nir_lower_global_vars_to_local)
+BENCH_PASS(nir_lower_vars_to_ssa)
+BENCH_PASS(nir_remove_dead_variables,
+           nir_var_function_temp | nir_var_shader_temp | nir_var_mem_shared)
+BENCH_PASS(nir_opt_copy_prop_vars)
+BENCH_PASS(nir_opt_dead_write_vars)
+BENCH_PASS(nir_lower_alu_to_scalar, NULL, NULL)
+BENCH_PASS(nir_lower_phis_to_scalar)
+BENCH_PASS(nir_lower_alu)
+BENCH_PASS(nir_lower_pack)
+BENCH_PASS(nir_copy_prop)
+BENCH_PASS(nir_opt_remove_phis)
+BENCH_PASS(nir_opt_dce)
+BENCH_PASS(nir_opt_trivial_continues)
+BENCH_PASS(nir_opt_if, false)
+BENCH_PASS(nir_opt_dead_cf)
+BENCH_PASS(nir_opt_cse)
+BENCH_PASS(nir_opt_peephole_select, 8, true, true)
+BENCH_PASS(nir_opt_algebraic)
+BENCH_PASS(nir_opt_algebraic_late)
+BENCH_PASS(nir_opt_constant_folding)
+BENCH_PASS(gl_nir_opt_access)
+BENCH_PASS(nir_opt_undef)
+BENCH_PASS(nir_opt_conditional_discard)
+BENCH_PASS(nir_opt_loop_unroll, 0)
+BENCH_PASS(nir_opt_gcm, false)
+BENCH_PASS(nir_opt_move, nir_move_const_undef | nir_move_load_ubo |
+                         nir_move_load_input | nir_move_comparisons)
+BENCH_PASS(nir_lower_int64, ~0)
+BENCH_PASS(nir_lower_idiv)
+BENCH_PASS(nir_lower_bool_to_int32)
+BENCH_PASS(nir_lower_locals_to_regs)
+BENCH_PASS(nir_convert_from_ssa, true)
+
+/* The optimization loop most drivers run, modelled on st_nir_opts(). */
+static bool
+bench_optimize(nir_shader *nir)
+{
+   bool any_progress = false;
+   bool progress;
+
+   do {
+      progress = false;
+
+      bench_nir_lower_vars_to_ssa(nir);
+      progress |= bench_nir_remove_dead_variables(nir);
+      progress |= bench_nir_opt_copy_prop_vars(nir);
+      progress |= bench_nir_opt_dead_write_vars(nir);
+
+      if (opts.scalar) {
+         bench_nir_lower_alu_to_scalar(nir);
+         bench_nir_lower_phis_to_scalar(nir);
+      }
+
+      bench_nir_lower_alu(nir);
+      bench_nir_lower_pack(nir);
+      progress |= bench_nir_copy_prop(nir);
+      progress |= bench_nir_opt_remove_phis(nir);
+      progress |= bench_nir_opt_dce(nir);
+      if (bench_nir_opt_trivial_continues(nir)) {
+         progress = true;
+         bench_nir_copy_prop(nir);
+         bench_nir_opt_dce(nir);
+      }
+      progress |= bench_nir_opt_if(nir);
+      progress |= bench_nir_opt_dead_cf(nir);
+      progress |= bench_nir_opt_cse(nir);
+      progress |= bench_nir_opt_peephole_select(nir);
+      progress |= bench_nir_opt_algebraic(nir);
+      progress |= bench_nir_opt_constant_folding(nir);
+      progress |= bench_gl_nir_opt_access(nir);
+      progress |= bench_nir_opt_undef(nir);
+      progress |= bench_nir_opt_conditional_discard(nir);
+      if (nir->options->max_unroll_iterations)
+         progress |= bench_nir_opt_loop_unroll(nir);
+
+      any_progress |= progress;
+   } while (progress);
+
+   return any_progress;
+}
+
+struct bench_step {
+   const char *name;
+   bool (*run)(nir_shader *nir);
+};
+
+#define STEP(pass) { #pass, bench_##pass }
+
+static const struct bench_step bench_steps[] = {
+   STEP(optimize),
+   STEP(nir_split_var_copies),
+   STEP(nir_lower_var_copies),
+   STEP(nir_lower_global_vars_to_local),
+   STEP(nir_lower_vars_to_ssa),
+   STEP(nir_remove_dead_variables),
+   STEP(nir_opt_copy_prop_vars),
+   STEP(nir_opt_dead_write_vars),
+   STEP(nir_lower_alu_to_scalar),
+   STEP(nir_lower_phis_to_scalar),
+   STEP(nir_lower_alu),
+   STEP(nir_lower_pack),
+   STEP(nir_copy_prop),
+   STEP(nir_opt_remove_phis),
+   STEP(nir_opt_dce),
+   STEP(nir_opt_trivial_continues),
+   STEP(nir_opt_if),
+   STEP(nir_opt_dead_cf),
+   STEP(nir_opt_cse),
+   STEP(nir_opt_peephole_select),
+   STEP(nir_opt_algebraic),
+   STEP(nir_opt_algebraic_late),
+   STEP(nir_opt_constant_folding),
+   STEP(gl_nir_opt_access),
+   STEP(nir_opt_undef),
+   STEP(nir_opt_conditional_discard),
+   STEP(nir_opt_loop_unroll),
+   STEP(nir_opt_gcm),
+   STEP(nir_opt_move),
+   STEP(nir_lower_int64),
+   STEP(nir_lower_idiv),
+   STEP(nir_lower_bool_to_int32),
+   STEP(nir_lower_locals_to_regs),
+   STEP(nir_convert_from_ssa),
+};
+
+static const char default_pipeline[] =
+   "nir_split_var_copies,nir_lower_var_copies,nir_lower_global_vars_to_local,"
+   "optimize,nir_opt_algebraic_late,nir_copy_prop,nir_opt_dce,nir_opt_cse,"
+   "nir_opt_move,nir_lower_locals_to_regs,nir_convert_from_ssa";
+
+/* Parses a comma separated list of step names into \steps. */
+static bool
+parse_pipeline(const char *pipeline, struct util_dynarray *steps)
+{
+   if (strcmp(pipeline, "default") == 0)
+      pipeline = default_pipeline;
+
+   while (*pipeline) {
+      size_t len = strcspn(pipeline, ",");
+      const struct bench_step *step = NULL;
+
+      for (unsigned i = 0; i < ARRAY_SIZE(bench_steps); i++) {
+         if (strlen(bench_steps[i].name) == len &&
+             strncmp(bench_steps[i].name, pipeline, len) == 0) {
+            step = &bench_steps[i];
+            break;
+         }
+      }
+
+      if (!step) {
+         fprintf(stderr, "Unknown pipeline step `%.*s'\n", (int) len,
+                 pipeline);
+         return false;
+      }
+
+      util_dynarray_append(steps, const struct bench_step *, step);
+      pipeline += len;
+      if (*pipeline == ',')
+         pipeline++;
+   }
+
+   return true;
+}
+
+static const nir_shader_compiler_options bench_nir_options = {
+   .lower_fdiv = true,
+   .lower_flrp32 = true,
+   .lower_fmod = true,
+   .lower_fpow = true,
+   .lower_fsat = true,
+   .lower_sub = true,
+   .lower_scmp = true,
+   .lower_ldexp = true,
+   .lower_pack_snorm_2x16 = true,
+   .lower_all_io_to_temps = true,
+   .vertex_id_zero_based = true,
+   .max_unroll_iterations = 32,
+};
+
+static bool
+stage_from_extension(const char *ext, gl_shader_stage *stage)
+{
+   static const struct {
+      const char *ext;
+      gl_shader_stage stage;
+   } exts[] = {
+      { ".vert", MESA_SHADER_VERTEX },
+      { ".tesc", MESA_SHADER_TESS_CTRL },
+      { ".tese", MESA_SHADER_TESS_EVAL },
+      { ".geom", MESA_SHADER_GEOMETRY },
+      { ".frag", MESA_SHADER_FRAGMENT },
+      { ".comp", MESA_SHADER_COMPUTE },
+   };
+
+   for (unsigned i = 0; i < ARRAY_SIZE(exts); i++) {
+      if (strncmp(ext, exts[i].ext, 5) == 0) {
+         *stage = exts[i].stage;
+         return true;
+      }
+   }
+
+   return false;
+}
+
+/* Works out the stage and whether \path is SPIR-V from its name. */
+static bool
+classify_shader(const char *path, gl_shader_stage *stage, bool *is_spirv)
+{
+   size_t len = strlen(path);
+
+   *is_spirv = len > 4 && strcmp(path + len - 4, ".spv") == 0;
+   if (*is_spirv)
+      len -= 4;
+
+   return len > 5 && stage_from_extension(path + len - 5, stage);
+}
+
+static nir_shader *
+spirv_file_to_nir(const char *path, gl_shader_stage stage)
+{
+   int fd = open(path, O_RDONLY);
+   if (fd < 0) {
+      fprintf(stderr, "Failed to open %s\n", path);
+      return NULL;
+   }
+
+   off_t len = lseek(fd, 0, SEEK_END);
+   if (len <= 0 || len % 4 != 0) {
+      fprintf(stderr, "%s: file length isn't a multiple of the word size\n",
+              path);
+      close(fd);
+      return NULL;
+   }
+
+   const uint32_t *words = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+   if (words == MAP_FAILED) {
+      fprintf(stderr, "%s: failed to mmap: %s\n", path, strerror(errno));
+      return NULL;
+   }
+
+   const struct spirv_to_nir_options spirv_options = {
+      .caps = {
+         .draw_parameters = true,
+         .float64 = true,
+         .geometry_streams = true,
+         .image_ms_array = true,
+         .image_read_without_format = true,
+         .image_write_without_format = true,
+         .int16 = true,
+         .int64 = true,
+         .min_lod = true,
+         .multiview = true,
+         .storage_16bit = true,
+         .storage_8bit = true,
+         .storage_image_ms = true,
+         .subgroup_arithmetic = true,
+         .subgroup_ballot = true,
+         .subgroup_basic = true,
+         .subgroup_quad = true,
+         .subgroup_shuffle = true,
+         .subgroup_vote = true,
+         .tessellation = true,
+         .transform_feedback = true,
+         .variable_pointers = true,
+      },
+      .ubo_addr_format = nir_address_format_32bit_index_offset,
+      .ssbo_addr_format = nir_address_format_32bit_index_offset,
+      .phys_ssbo_addr_format = nir_address_format_64bit_global,
+      .push_const_addr_format = nir_address_format_logical,
+      .shared_addr_format = nir_address_format_32bit_offset,
+   };
+
+   profile_begin("spirv_to_nir");
+   nir_shader *nir = spirv_to_nir(words, len / 4, NULL, 0, stage, "main",
+                                  &spirv_options, &bench_nir_options);
+   profile_end("spirv_to_nir", true);
+   munmap((void *) words, len);
+
+   if (!nir)
+      return NULL;
+
+   /* Reduce the module to its entrypoint like the Vulkan drivers do. */
+   NIR_PASS_V(nir, nir_lower_constant_initializers, nir_var_function_temp);
+   NIR_PASS_V(nir, nir_lower_returns);
+   NIR_PASS_V(nir, nir_inline_functions);
+   NIR_PASS_V(nir, nir_opt_deref);
+
+   foreach_list_typed_safe(nir_function, func, node, &nir->functions) {
+      if (!func->is_entrypoint)
+         exec_node_remove(&func->node);
+   }
+
+   NIR_PASS_V(nir, nir_lower_constant_initializers, ~0);
+
+   return nir;
+}
+
+static nir_shader *
+glsl_file_to_nir(const char *path, gl_shader_stage stage,
+                 struct gl_shader_program **prog_out)
+{
+   static struct gl_context ctx;
+   const struct standalone_options standalone_options = {
+      .glsl_version = strtol(opts.glsl_version, NULL, 10),
+      .just_log = true,
+   };
+   char *files[] = { (char *) path };
+
+   profile_begin("glsl_compile");
+   struct gl_shader_program *prog =
+      standalone_compile_shader(&standalone_options, 1, files, &ctx);
+   profile_end("glsl_compile", true);
+
+   if (!prog)
+      return NULL;
+
+   *prog_out = prog;
+   if (!prog->data->LinkStatus || !prog->_LinkedShaders[stage]) {
+      fprintf(stderr, "%s: failed to compile\n", path);
+      return NULL;
+   }
+
+   profile_begin("glsl_to_nir");
+   nir_shader *nir = glsl_to_nir(&ctx, prog, stage, &bench_nir_options);
+   profile_end("glsl_to_nir", true);
+
+   return nir;
+}
+
+static unsigned
+count_instrs(nir_shader *nir)
+{
+   unsigned count = 0;
+
+   nir_foreach_function(func, nir) {
+      if (!func->impl)
+         continue;
+
+      nir_foreach_block(block, func->impl) {
+         nir_foreach_instr(instr, block)
+            count++;
+      }
+   }
+
+   return count;
+}
+
+static bool
+bench_shader(const char *path, const struct util_dynarray *steps)
+{
+   gl_shader_stage stage;
+   bool is_spirv;
+   bool ok = true;
+
+   if (!classify_shader(path, &stage, &is_spirv))
+      return true;
+
+   int64_t total_ns = 0;
+   unsigned instrs = 0;
+   profile.shader_heap_after = 0;
+
+   for (unsigned i = 0; i < bench.iterations && ok; i++) {
+      struct gl_shader_program *prog = NULL;
+      int64_t start_ns = os_time_get_nano();
+
+      nir_shader *nir = is_spirv ? spirv_file_to_nir(path, stage) :
+                                   glsl_file_to_nir(path, stage, &prog);
+      if (nir) {
+         util_dynarray_foreach(steps, const struct bench_step *, step)
+            (*step)->run(nir);
+
+         total_ns += os_time_get_nano() - start_ns;
+         instrs = count_instrs(nir);
+         ralloc_free(nir);
+      } else {
+         ok = false;
+      }
+
+      if (prog)
+         standalone_compiler_cleanup(prog);
+   }
+
+   if (!ok) {
+      fprintf(stderr, "%s: skipped\n", path);
+      return false;
+   }
+
+   if (bench.verbose || !bench.csv) {
+      printf("%-60s %-5s %10.3f ms %7u instrs", path,
+             _mesa_shader_stage_to_abbrev(stage),
+             total_ns / 1000000.0 / bench.iterations, instrs);
+      if (profile.track_memory)
+         printf(" %9zu KB max after a pass", profile.shader_heap_after / 1024);
+      printf("\n");
+   }
+
+   return true;
+}
+
+static int
+compare_pass_time(const void *a, const void *b)
+{
+   const struct pass_stats *pa = *(const struct pass_stats **) a;
+   const struct pass_stats *pb = *(const struct pass_stats **) b;
+
+   if (pa->time_ns != pb->time_ns)
+      return pa->time_ns < pb->time_ns ? 1 : -1;
+   return strcmp(pa->name, pb->name);
+}
+
+static void
+print_pass_stats(void)
+{
+   unsigned count = profile.passes->entries;
+   struct pass_stats **sorted = malloc(count * sizeof(*sorted));
+   unsigned i = 0;
+   int64_t total_ns = 0;
+
+   hash_table_foreach(profile.passes, entry) {
+      sorted[i++] = entry->data;
+   }
+   qsort(sorted, count, sizeof(*sorted), compare_pass_time);
+
+   /* Nested passes are accounted to their caller too, so only the
+    * per-shader totals above are exact; this is good enough to rank passes.
+    */
+   for (i = 0; i < count; i++)
+      total_ns += sorted[i]->time_ns;
+
+   if (bench.csv) {
+      printf("pass,calls,progress,total_ms,mean_us,heap_growth_kb,"
+             "heap_after_kb\n");
+   } else {
+      printf("\n%-40s %8s %8s %12s %10s %6s", "pass", "calls", "progress",
+             "total ms", "mean us", "%");
+      if (profile.track_memory)
+         printf(" %12s %12s", "growth KB", "after KB");
+      printf("\n");
+   }
+
+   for (i = 0; i < count; i++) {
+      const struct pass_stats *s = sorted[i];
+      double total_ms = s->time_ns / 1000000.0 / bench.iterations;
+      double mean_us = s->time_ns / 1000.0 / s->calls;
+
+      if (bench.csv) {
+         printf("%s,%u,%u,%.3f,%.3f,%" PRId64 ",%zu\n", s->name,
+                s->calls / bench.iterations, s->progress / bench.iterations,
+                total_ms, mean_us, s->heap_growth / 1024 / bench.iterations,
+                s->heap_after / 1024);
+      } else {
+         printf("%-40s %8u %8u %12.3f %10.3f %6.2f", s->name,
+                s->calls / bench.iterations, s->progress / bench.iterations,
+                total_ms, mean_us, 100.0 * s->time_ns / total_ns);
+         if (profile.track_memory)
+            printf(" %12" PRId64 " %12zu", s->heap_growth / 1024 /
+                   bench.iterations, s->heap_after / 1024);
+         printf("\n");
+      }
+   }
+
+   free(sorted);
+}
+
+static bool
+is_shader(const char *path)
+{
+   gl_shader_stage stage;
+   bool is_spirv;
+
+   return classify_shader(path, &stage, &is_spirv);
+}
+
+static const struct compile_bench_option bench_opts[] = {
+   { "glsl-version", "ver", "GLSL version to compile with (450)", NULL,
+     &opts.glsl_version },
+   { "pipeline", "steps", "comma separated NIR passes to run, or \"default\"",
+     NULL, &opts.pipeline },
+   { "scalar", NULL, "scalarize ALU in the optimize step", &opts.scalar },
+   { "memory", NULL, "record heap growth per pass", &opts.track_memory },
+   { NULL }
+};
+
+static void
+print_steps(void)
+{
+   printf("\nPipeline steps:\n");
+   for (unsigned i = 0; i < ARRAY_SIZE(bench_steps); i++)
+      printf("    %s\n", bench_steps[i].name);
+}
+
+static struct util_dynarray steps;
+static unsigned failed;
+
+static void
+bench_shader_job(void *job)
+{
+   if (!bench_shader(*(const char **) job, &steps))
+      failed++;
+}
+
+int
+main(int argc, char **argv)
+{
+   int status;
+
+   bench.is_shader = is_shader;
+   bench.options = bench_opts;
+   bench.print_help = print_steps;
+   if (!compile_bench_init(&bench, argc, argv, &status))
+      return status;
+
+   util_dynarray_init(&steps, NULL);
+   if (!parse_pipeline(opts.pipeline, &steps))
+      return EXIT_FAILURE;
+
+   /* Keep the type and builtin singletons alive across shaders, otherwise
+    * every compile pays for rebuilding the builtin function library.
+    */
+   glsl_type_singleton_init_or_ref();
+   _mesa_glsl_builtin_functions_init_or_ref();
+
+   profile.passes = _mesa_hash_table_create(NULL, _mesa_key_hash_string,
+                                            _mesa_key_string_equal);
+   profile.track_memory = opts.track_memory;
+   nir_set_pass_profiler(&bench_profiler);
+
+   /* The profiler state is global, so shaders are compiled one at a time. */
+   compile_bench_run(&bench, bench.paths, bench.num_paths, sizeof(char *),
+                     bench_shader_job);
+
+   nir_set_pass_profiler(NULL);
+   print_pass_stats();
+
+   if (failed)
+      fprintf(stderr, "%u shaders failed to compile\n", failed);
+
+   ralloc_free(profile.passes);
+   compile_bench_fini(&bench);
+   util_dynarray_fini(&steps);
+   _mesa_glsl_builtin_functions_decref();
+   glsl_type_singleton_decref();
+
+   return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -493,6 +493,54 @@ test_put_key_and_get_key(void)
 
    disk_cache_destroy(cache);
 }
+
+static void
+test_prefetch(const char *codec)
+{
+   struct disk_cache *cache;
+   char blob[] = "This is a blob of thirty-seven bytes";
+   char string[] = "While this string has thirty-four";
+   char missing[] = "Never put in the cache";
+   cache_key keys[3];
+   char *result;
+   size_t size;
+
+   /* Each codec gets its own cache directory, so that the items are really
+    * written and read with it.
+    */
+   setenv("MESA_GLSL_CACHE_COMPRESSION", codec, 1);
+   cache = disk_cache_create("test", codec, 0);
+   unsetenv("MESA_GLSL_CACHE_COMPRESSION");
+
+   disk_cache_compute_key(cache, blob, sizeof(blob), keys[0]);
+   disk_cache_compute_key(cache, string, sizeof(string), keys[1]);
+   disk_cache_compute_key(cache, missing, sizeof(missing), keys[2]);
+
+   disk_cache_put(cache, keys[0], blob, sizeof(blob), NULL);
+   disk_cache_put(cache, keys[1], string, sizeof(string), NULL);
+   wait_until_file_written(cache, keys[0]);
+   wait_until_file_written(cache, keys[1]);
+
+   disk_cache_prefetch(cache, (const cache_key *) keys, 3);
+
+   result = disk_cache_get(cache, keys[1], &size);
+   expect_equal_str(result, string, "disk_cache_get of prefetched item (pointer)");
+   expect_equal(size, sizeof(string), "disk_cache_get of prefetched item (size)");
+   free(result);
+
+   result = disk_cache_get(cache, keys[2], &size);
+   expect_null(result, "disk_cache_get of prefetched missing item (pointer)");
+   expect_equal(size, 0, "disk_cache_get of prefetched missing item (size)");
+
+   /* A claimed item is loaded from disk again on the next get. */
+   result = disk_cache_get(cache, keys[1], &size);
+   expect_equal_str(result, string, "disk_cache_get after prefetched get (pointer)");
+   expect_equal(size, sizeof(string), "disk_cache_get after prefetched get (size)");
+   free(result);
+
+   /* keys[0] is never claimed and must be released by disk_cache_destroy. */
+   disk_cache_destroy(cache);
+}
 #endif /* ENABLE_SHADER_CACHE */
 
 int
@@ -507,6 +555,11 @@ main(void)
 
    test_put_key_and_get_key();
 
+   test_prefetch("zlib");
+#ifdef HAVE_ZSTD
+   test_prefetch("zstd");
+#endif
+
    err = rmrf_local(CACHE_TEST_TMP);
    expect_equal(err, 0, "Removing " CACHE_TEST_TMP " again");
 #endif /* ENABLE_SHADER_CACHE */
@@ -36,6 +36,14 @@
 
 #include "main/menums.h" /* BITFIELD64_MASK */
 
+const nir_pass_profiler *nir_active_pass_profiler = NULL;
+
+void
+nir_set_pass_profiler(const nir_pass_profiler *profiler)
+{
+   nir_active_pass_profiler = profiler;
+}
+
 nir_shader *
 nir_shader_create(void *mem_ctx,
                   gl_shader_stage stage,
@@ -3359,6 +3359,39 @@ static inline bool should_serialize_deserialize_nir(void) { return false; }
 static inline bool should_print_nir(void) { return false; }
 #endif /* NDEBUG */
 
+/** Callbacks run around every NIR_PASS()/NIR_PASS_V(), for compile-time
+ * profiling tools. Passes invoked directly rather than through the macros are
+ * not reported.
+ */
+typedef struct nir_pass_profiler {
+   void (*begin_pass)(void *data, const nir_shader *shader, const char *pass);
+   void (*end_pass)(void *data, const nir_shader *shader, const char *pass,
+                    bool progress);
+   void *data;
+} nir_pass_profiler;
+
+extern const nir_pass_profiler *nir_active_pass_profiler;
+
+/** Installs \profiler for all shaders in the process, NULL removes it. */
+void nir_set_pass_profiler(const nir_pass_profiler *profiler);
+
+static inline void
+nir_profile_begin_pass(const nir_shader *shader, const char *pass)
+{
+   const nir_pass_profiler *profiler = nir_active_pass_profiler;
+   if (unlikely(profiler))
+      profiler->begin_pass(profiler->data, shader, pass);
+}
+
+static inline void
+nir_profile_end_pass(const nir_shader *shader, const char *pass,
+                     bool progress)
+{
+   const nir_pass_profiler *profiler = nir_active_pass_profiler;
+   if (unlikely(profiler))
+      profiler->end_pass(profiler->data, shader, pass, progress);
+}
+
 #define _PASS(pass, nir, do_pass) do {                               \
    if (should_skip_nir(#pass)) {                                     \
       printf("skipping %s\n", #pass);                                \
@@ -3379,7 +3412,10 @@ static inline bool should_print_nir(void) { return false; }
    nir_metadata_set_validation_flag(nir);                            \
    if (should_print_nir())                                           \
       printf("%s\n", #pass);                                         \
-   if (pass(nir, ##__VA_ARGS__)) {                                   \
+   nir_profile_begin_pass(nir, #pass);                               \
+   bool _pass_progress = pass(nir, ##__VA_ARGS__);                   \
+   nir_profile_end_pass(nir, #pass, _pass_progress);                 \
+   if (_pass_progress) {                                             \
       progress = true;                                               \
       if (should_print_nir())                                        \
          nir_print_shader(nir, stdout);                              \
@@ -3390,7 +3426,9 @@ static inline bool should_print_nir(void) { return false; }
 #define NIR_PASS_V(nir, pass, ...) _PASS(pass, nir,                  \
    if (should_print_nir())                                           \
       printf("%s\n", #pass);                                         \
+   nir_profile_begin_pass(nir, #pass);                               \
    pass(nir, ##__VA_ARGS__);                                         \
+   nir_profile_end_pass(nir, #pass, false);                          \
    if (should_print_nir())                                           \
       nir_print_shader(nir, stdout);                                 \
 )
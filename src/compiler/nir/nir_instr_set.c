@@ -198,7 +198,7 @@ hash_load_const(uint32_t hash, const nir_load_const_instr *instr)
       }
    } else {
       unsigned size = instr->def.num_components * sizeof(*instr->value);
-      hash = _mesa_fnv32_1a_accumulate_block(hash, instr->value, size);
+      hash = _mesa_hash_data_with_seed(instr->value, size, hash);
    }
 
    return hash;
@@ -246,9 +246,9 @@ hash_intrinsic(uint32_t hash, const nir_intrinsic_instr *instr)
       hash = HASH(hash, instr->dest.ssa.bit_size);
    }
 
-   hash = _mesa_fnv32_1a_accumulate_block(hash, instr->const_index,
-                                          info->num_indices
-                                             * sizeof(instr->const_index[0]));
+   hash = _mesa_hash_data_with_seed(instr->const_index,
+                                    info->num_indices
+                                       * sizeof(instr->const_index[0]), hash);
    return hash;
 }
 
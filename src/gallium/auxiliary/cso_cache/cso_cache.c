@@ -29,6 +29,7 @@
  */
 
 #include "util/u_debug.h"
+#include "util/hash_table.h"
 
 #include "util/u_memory.h"
 
@@ -44,40 +45,9 @@ struct cso_cache {
    void                 *sanitize_data;
 };
 
-#if 1
-static unsigned hash_key(const void *key, unsigned key_size)
-{
-   unsigned *ikey = (unsigned *)key;
-   unsigned hash = 0, i;
-
-   assert(key_size % 4 == 0);
-
-   /* I'm sure this can be improved on:
-    */
-   for (i = 0; i < key_size/4; i++)
-      hash ^= ikey[i];
-
-   return hash;
-}
-#else
-static unsigned hash_key(const unsigned char *p, int n)
-{
-   unsigned h = 0;
-   unsigned g;
-
-   while (n--) {
-      h = (h << 4) + *p++;
-      if ((g = (h & 0xf0000000)) != 0)
-         h ^= g >> 23;
-      h &= ~g;
-   }
-   return h;
-}
-#endif
-
 unsigned cso_construct_key(void *item, int item_size)
 {
-   return hash_key((item), item_size);
+   return _mesa_hash_data(item, item_size);
 }
 
 static inline struct cso_hash *_cso_hash_for_type(struct cso_cache *sc, enum cso_cache_type type)
@@ -118,6 +118,7 @@ lp_sampler_static_texture_state(struct lp_static_texture_state *state,
    state->pot_height        = util_is_power_of_two_or_zero(texture->height0);
    state->pot_depth         = util_is_power_of_two_or_zero(texture->depth0);
    state->level_zero_only   = !view->u.tex.last_level;
+   state->tiled             = !!(texture->flags & LP_RESOURCE_FLAG_TILED);
 
    /*
     * the layer / element / level parameters are all either dynamic
@@ -234,6 +235,34 @@ lp_sampler_static_sampler_state(struct lp_static_sampler_state *state,
 }
 
 
+/**
+ * Return the size of a mipmap level from the level_sizes array, as a
+ * vector of four int32 { width, height, depth, unused }.
+ * \param level  integer mipmap level (scalar)
+ */
+static LLVMValueRef
+lp_build_get_level_size(struct lp_build_sample_context *bld,
+                        LLVMValueRef level)
+{
+   LLVMBuilderRef builder = bld->gallivm->builder;
+   LLVMTypeRef vec_type =
+      LLVMVectorType(LLVMInt32TypeInContext(bld->gallivm->context), 4);
+   LLVMValueRef indexes[2], size_ptr, size;
+
+   assert(bld->level_sizes_array);
+
+   indexes[0] = lp_build_const_int32(bld->gallivm, 0);
+   indexes[1] = level;
+   size_ptr = LLVMBuildGEP(builder, bld->level_sizes_array, indexes, 2, "");
+   size_ptr = LLVMBuildBitCast(builder, size_ptr,
+                               LLVMPointerType(vec_type, 0), "");
+   size = LLVMBuildLoad(builder, size_ptr, "level_size");
+   /* the array is only int32 aligned */
+   LLVMSetAlignment(size, 4);
+   return size;
+}
+
+
 /**
  * Generate code to compute coordinate gradient (rho).
  * \param derivs  partial derivatives of (s, t, r, q) with respect to X and Y
@@ -283,8 +312,13 @@ lp_build_rho(struct lp_build_sample_context *bld,
 
    first_level = bld->dynamic_state->first_level(bld->dynamic_state, bld->gallivm,
                                                  bld->context_ptr, texture_unit);
-   first_level_vec = lp_build_broadcast_scalar(int_size_bld, first_level);
-   int_size = lp_build_minify(int_size_bld, bld->int_size, first_level_vec, TRUE);
+   if (bld->level_sizes_array) {
+      int_size = lp_build_get_level_size(bld, first_level);
+   }
+   else {
+      first_level_vec = lp_build_broadcast_scalar(int_size_bld, first_level);
+      int_size = lp_build_minify(int_size_bld, bld->int_size, first_level_vec, TRUE);
+   }
    float_size = lp_build_int_to_float(float_size_bld, int_size);
 
    if (cube_rho) {
@@ -1262,11 +1296,17 @@ lp_build_mipmap_level_sizes(struct lp_build_sample_context *bld,
    LLVMValueRef ilevel_vec;
 
    /*
-    * Compute width, height, depth at mipmap level 'ilevel'
+    * Compute width, height, depth at mipmap level 'ilevel', or just load
+    * them when the driver has them precomputed (never for 1D textures).
     */
    if (bld->num_mips == 1) {
-      ilevel_vec = lp_build_broadcast_scalar(&bld->int_size_bld, ilevel);
-      *out_size = lp_build_minify(&bld->int_size_bld, bld->int_size, ilevel_vec, TRUE);
+      if (bld->level_sizes_array) {
+         *out_size = lp_build_get_level_size(bld, ilevel);
+      }
+      else {
+         ilevel_vec = lp_build_broadcast_scalar(&bld->int_size_bld, ilevel);
+         *out_size = lp_build_minify(&bld->int_size_bld, bld->int_size, ilevel_vec, TRUE);
+      }
    }
    else {
       LLVMValueRef int_size_vec;
@@ -1305,6 +1345,13 @@ lp_build_mipmap_level_sizes(struct lp_build_sample_context *bld,
             LLVMValueRef ileveli;
             LLVMValueRef indexi = lp_build_const_int32(bld->gallivm, i);
 
+            if (bld->level_sizes_array) {
+               ileveli = LLVMBuildExtractElement(bld->gallivm->builder,
+                                                 ilevel, indexi, "");
+               tmp[i] = lp_build_get_level_size(bld, ileveli);
+               continue;
+            }
+
             ileveli = lp_build_extract_broadcast(bld->gallivm,
                                                  bld->leveli_bld.type,
                                                  bld4.type,
@@ -1343,6 +1390,14 @@ lp_build_mipmap_level_sizes(struct lp_build_sample_context *bld,
             LLVMValueRef ilevel1;
             for (i = 0; i < bld->num_mips; i++) {
                LLVMValueRef indexi = lp_build_const_int32(bld->gallivm, i);
+
+               if (bld->level_sizes_array) {
+                  ilevel1 = LLVMBuildExtractElement(bld->gallivm->builder,
+                                                    ilevel, indexi, "");
+                  tmp[i] = lp_build_get_level_size(bld, ilevel1);
+                  continue;
+               }
+
                ilevel1 = lp_build_extract_broadcast(bld->gallivm, bld->int_coord_type,
                                                     bld->int_size_in_bld.type, ilevel, indexi);
                tmp[i] = bld->int_size;
@@ -2058,6 +2113,37 @@ lp_build_sample_partial_offset(struct lp_build_context *bld,
 }
 
 
+/**
+ * Compute the partial offset of a texel along the x or y axis of a tiled
+ * texture (see LP_TEX_TILE_SIZE).
+ *
+ * @param coord         coordinate in texels
+ * @param stride        number of bytes between successive tiles along the
+ *                      axis, divided by LP_TEX_TILE_SIZE
+ * @param texel_stride  number of bytes between successive texels along the
+ *                      axis within a tile
+ * @param out_offset    resulting relative offset of the texel in bytes
+ */
+void
+lp_build_sample_partial_offset_tiled(struct lp_build_context *bld,
+                                     LLVMValueRef coord,
+                                     LLVMValueRef stride,
+                                     LLVMValueRef texel_stride,
+                                     LLVMValueRef *out_offset)
+{
+   LLVMBuilderRef builder = bld->gallivm->builder;
+   LLVMValueRef tile_mask = lp_build_const_int_vec(bld->gallivm, bld->type,
+                                                   LP_TEX_TILE_SIZE - 1);
+   LLVMValueRef tile_coord, subcoord;
+
+   subcoord = LLVMBuildAnd(builder, coord, tile_mask, "");
+   tile_coord = LLVMBuildAnd(builder, coord, LLVMBuildNot(builder, tile_mask, ""), "");
+
+   *out_offset = lp_build_add(bld, lp_build_mul(bld, tile_coord, stride),
+                              lp_build_mul(bld, subcoord, texel_stride));
+}
+
+
 /**
  * Compute the offset of a pixel block.
  *
@@ -2073,6 +2159,7 @@ lp_build_sample_offset(struct lp_build_context *bld,
                        LLVMValueRef z,
                        LLVMValueRef y_stride,
                        LLVMValueRef z_stride,
+                       boolean tiled,
                        LLVMValueRef *out_offset,
                        LLVMValueRef *out_i,
                        LLVMValueRef *out_j)
@@ -2083,6 +2170,32 @@ lp_build_sample_offset(struct lp_build_context *bld,
    x_stride = lp_build_const_vec(bld->gallivm, bld->type,
                                  format_desc->block.bits/8);
 
+   if (tiled) {
+      /* Tiled textures always have 1x1 pixel blocks and two dimensions */
+      LLVMValueRef tile_row_stride =
+         lp_build_const_vec(bld->gallivm, bld->type,
+                            LP_TEX_TILE_SIZE * format_desc->block.bits/8);
+      LLVMValueRef y_offset;
+
+      assert(format_desc->block.width == 1 && format_desc->block.height == 1);
+      assert(y && y_stride);
+
+      lp_build_sample_partial_offset_tiled(bld, x, tile_row_stride, x_stride,
+                                           &offset);
+      lp_build_sample_partial_offset_tiled(bld, y, y_stride, tile_row_stride,
+                                           &y_offset);
+      offset = lp_build_add(bld, offset, y_offset);
+      *out_i = bld->zero;
+      *out_j = bld->zero;
+
+      if (z && z_stride) {
+         offset = lp_build_add(bld, offset, lp_build_mul(bld, z, z_stride));
+      }
+
+      *out_offset = offset;
+      return;
+   }
+
    lp_build_sample_partial_offset(bld,
                                   format_desc->block.width,
                                   x, x_stride,
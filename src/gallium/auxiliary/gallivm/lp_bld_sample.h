@@ -36,6 +36,7 @@
 #define LP_BLD_SAMPLE_H
 
 
+#include "pipe/p_defines.h"
 #include "pipe/p_format.h"
 #include "util/u_debug.h"
 #include "gallivm/lp_bld.h"
@@ -55,6 +56,19 @@ struct lp_type;
 struct lp_build_context;
 
 
+/**
+ * Tiled textures are stored in LP_TEX_TILE_SIZE x LP_TEX_TILE_SIZE texel
+ * tiles, each held contiguously with its rows one after the other.  Tiles
+ * are laid out in rows, each taking the same space as LP_TEX_TILE_SIZE rows
+ * of a linear image, so row and image strides keep their usual meaning.
+ * Drivers mark such textures with LP_RESOURCE_FLAG_TILED.
+ */
+#define LP_TEX_TILE_SIZE 4
+#define LP_TEX_TILE_SIZE_LOG2 2
+
+#define LP_RESOURCE_FLAG_TILED PIPE_RESOURCE_FLAG_DRV_PRIV
+
+
 /**
  * Helper struct holding all derivatives needed for sampling
  */
@@ -165,6 +179,7 @@ struct lp_static_texture_state
    unsigned pot_height:1;
    unsigned pot_depth:1;
    unsigned level_zero_only:1;
+   unsigned tiled:1;         /**< stored in LP_TEX_TILE_SIZE tiles? */
 };
 
 
@@ -276,6 +291,18 @@ struct lp_sampler_dynamic_state
                   LLVMValueRef context_ptr,
                   unsigned texture_unit);
 
+   /**
+    * Obtain pointer to array of mipmap level sizes, each { width, height,
+    * depth, unused } as four int32, already minified.
+    *
+    * It's optional: sizes are minified in the generated code if it's NULL.
+    */
+   LLVMValueRef
+   (*level_sizes)(const struct lp_sampler_dynamic_state *state,
+                  struct gallivm_state *gallivm,
+                  LLVMValueRef context_ptr,
+                  unsigned texture_unit);
+
    /* These are callbacks for sampler state */
 
    /** Obtain texture min lod (returns float) */
@@ -409,6 +436,7 @@ struct lp_build_sample_context
    LLVMValueRef img_stride_array;
    LLVMValueRef base_ptr;
    LLVMValueRef mip_offsets;
+   LLVMValueRef level_sizes_array;  /**< NULL for 1D textures */
    LLVMValueRef cache;
 
    /** Integer vector with texture width, height, depth */
@@ -615,6 +643,14 @@ lp_build_sample_partial_offset(struct lp_build_context *bld,
                                LLVMValueRef *out_i);
 
 
+void
+lp_build_sample_partial_offset_tiled(struct lp_build_context *bld,
+                                     LLVMValueRef coord,
+                                     LLVMValueRef stride,
+                                     LLVMValueRef texel_stride,
+                                     LLVMValueRef *out_offset);
+
+
 void
 lp_build_sample_offset(struct lp_build_context *bld,
                        const struct util_format_description *format_desc,
@@ -623,6 +659,7 @@ lp_build_sample_offset(struct lp_build_context *bld,
                        LLVMValueRef z,
                        LLVMValueRef y_stride,
                        LLVMValueRef z_stride,
+                       boolean tiled,
                        LLVMValueRef *out_offset,
                        LLVMValueRef *out_i,
                        LLVMValueRef *out_j);
@@ -141,6 +141,7 @@ lp_build_sample_texel_soa(struct lp_build_sample_context *bld,
    lp_build_sample_offset(&bld->int_coord_bld,
                           bld->format_desc,
                           x, y, z, y_stride, z_stride,
+                          bld->static_texture_state->tiled,
                           &offset, &i, &j);
    if (mipoffsets) {
       offset = lp_build_add(&bld->int_coord_bld, offset, mipoffsets);
@@ -2680,6 +2681,7 @@ lp_build_fetch_texel(struct lp_build_sample_context *bld,
    lp_build_sample_offset(int_coord_bld,
                           bld->format_desc,
                           x, y, z, row_stride_vec, img_stride_vec,
+                          bld->static_texture_state->tiled,
                           &offset, &i, &j);
 
    if (bld->static_texture_state->target != PIPE_BUFFER) {
@@ -3029,6 +3031,12 @@ lp_build_sample_soa_code(struct gallivm_state *gallivm,
                                                 context_ptr, texture_index);
    /* Note that mip_offsets is an array[level] of offsets to texture images */
 
+   if (dynamic_state->level_sizes && dims >= 2) {
+      bld.level_sizes_array = dynamic_state->level_sizes(dynamic_state, gallivm,
+                                                         context_ptr,
+                                                         texture_index);
+   }
+
    if (dynamic_state->cache_ptr && thread_data_ptr) {
       bld.cache = dynamic_state->cache_ptr(dynamic_state, gallivm,
                                            thread_data_ptr, texture_index);
@@ -3225,6 +3233,7 @@ lp_build_sample_soa_code(struct gallivm_state *gallivm,
          bld4.dims = bld.dims;
          bld4.row_stride_array = bld.row_stride_array;
          bld4.img_stride_array = bld.img_stride_array;
+         bld4.level_sizes_array = bld.level_sizes_array;
          bld4.base_ptr = bld.base_ptr;
          bld4.mip_offsets = bld.mip_offsets;
          bld4.int_size = bld.int_size;
@@ -4082,6 +4091,7 @@ lp_build_img_op_soa(const struct lp_static_texture_state *static_texture_state,
    lp_build_sample_offset(&int_coord_bld,
                           format_desc,
                           x, y, z, row_stride_vec, img_stride_vec,
+                          FALSE,
                           &offset, &i, &j);
 
    if (params->img_op == LP_IMG_LOAD) {
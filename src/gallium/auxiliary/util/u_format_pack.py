@@ -619,6 +619,60 @@ def generate_pack_kernel(format, src_channel, src_native_type):
         print_channels(format, pack_into_struct)
 
 
+def is_rgba8_unorm(format):
+    '''Whether the format has four 8-bit unorm or padding channels, which the
+    util/format_rgba8_sse2.h row converters handle.'''
+
+    if format.layout != PLAIN or format.colorspace != RGB:
+        return False
+    if len(format.le_channels) != 4:
+        return False
+    for channel in format.le_channels:
+        if channel.size != 8 or channel.shift % 8 != 0:
+            return False
+        if channel.type != VOID and (channel.type != UNSIGNED or not channel.norm or channel.pure):
+            return False
+    return True
+
+
+def rgba8_unpack_swizzles(format):
+    '''Source byte of each RGBA channel for the row converters.'''
+
+    swizzles = []
+    for swizzle in format.le_swizzles:
+        if swizzle < 4:
+            swizzles.append(format.le_channels[swizzle].shift // 8)
+        elif swizzle == SWIZZLE_1:
+            swizzles.append(SWIZZLE_1)
+        else:
+            swizzles.append(SWIZZLE_0)
+    return swizzles
+
+
+def rgba8_pack_swizzles(format):
+    '''RGBA channel of each format byte for the row converters.'''
+
+    inv_swizzle = inv_swizzles(format.le_swizzles)
+    swizzles = [SWIZZLE_0]*4
+    for i in range(4):
+        channel = format.le_channels[i]
+        if channel.type != VOID and inv_swizzle[i] is not None:
+            swizzles[channel.shift // 8] = inv_swizzle[i]
+    return swizzles
+
+
+def generate_rgba8_row(format, function, dst, src, swizzles, extra_args = ''):
+    '''Convert what the SSE2 row converters can of a row, leaving the
+    remaining pixels to the per-pixel loop.'''
+
+    print('      x = 0;')
+    print('#ifdef __SSE2__')
+    print('      x = %s(%s, %s, width, %s%s);' % (function, dst, src, ', '.join([str(s) for s in swizzles]), extra_args))
+    print('      src += 4 * x;')
+    print('      dst += 4 * x;')
+    print('#endif')
+
+
 def generate_format_unpack(format, dst_channel, dst_native_type, dst_suffix):
     '''Generate the function to unpack pixels from a particular format'''
 
@@ -633,7 +687,15 @@ def generate_format_unpack(format, dst_channel, dst_native_type, dst_suffix):
         print('   for(y = 0; y < height; y += %u) {' % (format.block_height,))
         print('      %s *dst = dst_row;' % (dst_native_type))
         print('      const uint8_t *src = src_row;')
-        print('      for(x = 0; x < width; x += %u) {' % (format.block_width,))
+        if is_rgba8_unorm(format) and dst_suffix in ('rgba_8unorm', 'rgba_float'):
+            if dst_suffix == 'rgba_8unorm':
+                function = 'util_format_rgba8_swizzle_row_sse2'
+            else:
+                function = 'util_format_rgba8_to_float_row_sse2'
+            generate_rgba8_row(format, function, 'dst', 'src', rgba8_unpack_swizzles(format))
+            print('      for(; x < width; x += %u) {' % (format.block_width,))
+        else:
+            print('      for(x = 0; x < width; x += %u) {' % (format.block_width,))
         
         generate_unpack_kernel(format, dst_channel, dst_native_type)
     
@@ -662,7 +724,14 @@ def generate_format_pack(format, src_channel, src_native_type, src_suffix):
         print('   for(y = 0; y < height; y += %u) {' % (format.block_height,))
         print('      const %s *src = src_row;' % (src_native_type))
         print('      uint8_t *dst = dst_row;')
-        print('      for(x = 0; x < width; x += %u) {' % (format.block_width,))
+        if is_rgba8_unorm(format) and src_suffix in ('rgba_8unorm', 'rgba_float'):
+            if src_suffix == 'rgba_8unorm':
+                generate_rgba8_row(format, 'util_format_rgba8_swizzle_row_sse2', 'dst', 'src', rgba8_pack_swizzles(format))
+            else:
+                generate_rgba8_row(format, 'util_format_rgba8_from_float_row_sse2', 'dst', 'src', rgba8_pack_swizzles(format), ', false')
+            print('      for(; x < width; x += %u) {' % (format.block_width,))
+        else:
+            print('      for(x = 0; x < width; x += %u) {' % (format.block_width,))
     
         generate_pack_kernel(format, src_channel, src_native_type)
             
@@ -705,6 +774,7 @@ def generate(formats):
     print('#include "u_format.h"')
     print('#include "u_format_other.h"')
     print('#include "util/format_srgb.h"')
+    print('#include "util/format_rgba8_sse2.h"')
     print('#include "u_format_yuv.h"')
     print('#include "u_format_zs.h"')
     print()
@@ -39,6 +39,7 @@
 #include "util/u_atomic.h"
 #include "util/u_box.h"
 #include "util/u_math.h"
+#include "util/streaming-load-memcpy.h"
 
 
 #ifdef __cplusplus
@@ -458,7 +459,8 @@ pipe_buffer_read(struct pipe_context *pipe,
    if (!map)
       return;
 
-   memcpy(data, map, size);
+   /* The mapping may be uncached */
+   util_streaming_load_memcpy(data, map, size);
    pipe_buffer_unmap(pipe, src_transfer);
 }
 
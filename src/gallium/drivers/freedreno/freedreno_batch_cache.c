@@ -98,10 +98,9 @@ static uint32_t
 key_hash(const void *_key)
 {
 	const struct key *key = _key;
-	uint32_t hash = _mesa_fnv32_1a_offset_bias;
-	hash = _mesa_fnv32_1a_accumulate_block(hash, key, offsetof(struct key, surf[0]));
-	hash = _mesa_fnv32_1a_accumulate_block(hash, key->surf, sizeof(key->surf[0]) * key->num_surfs);
-	return hash;
+	uint32_t hash = _mesa_hash_data(key, offsetof(struct key, surf[0]));
+	return _mesa_hash_data_with_seed(key->surf,
+			sizeof(key->surf[0]) * key->num_surfs, hash);
 }
 
 static bool
@@ -35,9 +35,7 @@ static uint32_t
 key_hash(const void *_key)
 {
 	const struct ir3_cache_key *key = _key;
-	uint32_t hash = _mesa_fnv32_1a_offset_bias;
-	hash = _mesa_fnv32_1a_accumulate_block(hash, key, sizeof(*key));
-	return hash;
+	return _mesa_hash_data(key, sizeof(*key));
 }
 
 static bool
@@ -59,6 +59,9 @@ create_jit_texture_type(struct gallivm_state *gallivm)
    elem_types[LP_JIT_TEXTURE_IMG_STRIDE] =
    elem_types[LP_JIT_TEXTURE_MIP_OFFSETS] =
       LLVMArrayType(LLVMInt32TypeInContext(lc), LP_MAX_TEXTURE_LEVELS);
+   elem_types[LP_JIT_TEXTURE_LEVEL_SIZES] =
+      LLVMPointerType(LLVMArrayType(LLVMArrayType(LLVMInt32TypeInContext(lc), 4),
+                                    LP_MAX_TEXTURE_LEVELS), 0);
 
    texture_type = LLVMStructTypeInContext(lc, elem_types,
                                           ARRAY_SIZE(elem_types), 0);
@@ -90,6 +93,9 @@ create_jit_texture_type(struct gallivm_state *gallivm)
    LP_CHECK_MEMBER_OFFSET(struct lp_jit_texture, mip_offsets,
                           gallivm->target, texture_type,
                           LP_JIT_TEXTURE_MIP_OFFSETS);
+   LP_CHECK_MEMBER_OFFSET(struct lp_jit_texture, level_sizes,
+                          gallivm->target, texture_type,
+                          LP_JIT_TEXTURE_LEVEL_SIZES);
    LP_CHECK_STRUCT_SIZE(struct lp_jit_texture,
                         gallivm->target, texture_type);
    return texture_type;
@@ -60,6 +60,8 @@ struct lp_jit_texture
    uint32_t first_level;
    uint32_t last_level;
    uint32_t mip_offsets[LP_MAX_TEXTURE_LEVELS];
+   /* width, height, depth of each level, the resource's own table */
+   uint32_t (*level_sizes)[4];
 };
 
 
@@ -99,6 +101,7 @@ enum {
    LP_JIT_TEXTURE_FIRST_LEVEL,
    LP_JIT_TEXTURE_LAST_LEVEL,
    LP_JIT_TEXTURE_MIP_OFFSETS,
+   LP_JIT_TEXTURE_LEVEL_SIZES,
    LP_JIT_TEXTURE_NUM_FIELDS  /* number of fields above */
 };
 
@@ -34,3 +34,9 @@
 PIPE_ALIGN_VAR(LP_MIN_VECTOR_ALIGN)
 uint8_t lp_dummy_tile[TILE_SIZE * TILE_SIZE * 4];
 
+/* The level sizes of textures sampled from the dummy tile (LP_PERF=texmem).
+ */
+uint32_t lp_dummy_level_sizes[LP_MAX_TEXTURE_LEVELS][4] = {
+   { TILE_SIZE/8, TILE_SIZE/8, 1, 0 }
+};
+
@@ -37,4 +37,6 @@
 extern PIPE_ALIGN_VAR(LP_MIN_VECTOR_ALIGN)
 uint8_t lp_dummy_tile[TILE_SIZE * TILE_SIZE * 4];
 
+extern uint32_t lp_dummy_level_sizes[LP_MAX_TEXTURE_LEVELS][4];
+
 #endif /* LP_MEMORY_H */
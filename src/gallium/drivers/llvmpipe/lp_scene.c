@@ -522,6 +522,10 @@ void lp_scene_begin_binning(struct lp_scene *scene,
    assert(scene->tiles_x <= TILES_X);
    assert(scene->tiles_y <= TILES_Y);
 
+   scene->damage.x0 = scene->tiles_x;
+   scene->damage.y0 = scene->tiles_y;
+   scene->damage.x1 = scene->damage.y1 = -1;
+
    /*
     * Determine how many layers the fb has (used for clamping layer value).
     * OpenGL (but not d3d10) permits different amount of layers per rt, however
@@ -550,6 +554,25 @@ void lp_scene_begin_binning(struct lp_scene *scene,
 
 void lp_scene_end_binning( struct lp_scene *scene )
 {
+   const struct pipe_framebuffer_state *fb = &scene->fb;
+   unsigned i;
+
+   /* Record what the scene draws in the display targets, for presenting */
+   if (scene->damage.x0 <= scene->damage.x1) {
+      struct u_rect rect;
+
+      rect.x0 = scene->damage.x0 * TILE_SIZE;
+      rect.y0 = scene->damage.y0 * TILE_SIZE;
+      rect.x1 = MIN2((scene->damage.x1 + 1) * TILE_SIZE, fb->width) - 1;
+      rect.y1 = MIN2((scene->damage.y1 + 1) * TILE_SIZE, fb->height) - 1;
+
+      for (i = 0; i < fb->nr_cbufs; i++) {
+         if (fb->cbufs[i])
+            llvmpipe_resource_add_damage(llvmpipe_resource(fb->cbufs[i]->texture),
+                                         &rect);
+      }
+   }
+
    if (LP_DEBUG & DEBUG_SCENE) {
       debug_printf("rasterize scene:\n");
       debug_printf("  scene_size: %u\n",
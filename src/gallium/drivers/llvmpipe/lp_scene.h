@@ -36,6 +36,7 @@
 #define LP_SCENE_H
 
 #include "os/os_thread.h"
+#include "util/u_rect.h"
 #include "lp_rast.h"
 #include "lp_debug.h"
 
@@ -172,6 +173,9 @@ struct lp_scene {
     */
    unsigned tiles_x, tiles_y;
 
+   /** Bins with commands that may write to the framebuffer, in tiles */
+   struct u_rect damage;
+
    int curr_x, curr_y;  /**< for iterating over bins */
    mtx_t mutex;
 
@@ -322,7 +326,20 @@ lp_scene_bin_command( struct lp_scene *scene,
       tail->arg[i] = arg;
       tail->count++;
    }
-   
+
+   switch (cmd & LP_RAST_OP_MASK) {
+   case LP_RAST_OP_SET_STATE:
+   case LP_RAST_OP_BEGIN_QUERY:
+   case LP_RAST_OP_END_QUERY:
+      break;
+   default:
+      scene->damage.x0 = MIN2(scene->damage.x0, (int) x);
+      scene->damage.x1 = MAX2(scene->damage.x1, (int) x);
+      scene->damage.y0 = MIN2(scene->damage.y0, (int) y);
+      scene->damage.y1 = MAX2(scene->damage.y1, (int) y);
+      break;
+   }
+
    return TRUE;
 }
 
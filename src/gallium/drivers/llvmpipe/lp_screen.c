@@ -26,6 +26,7 @@
  **************************************************************************/
 
 
+#include "util/u_box.h"
 #include "util/u_memory.h"
 #include "util/u_math.h"
 #include "util/u_cpu_detect.h"
@@ -38,6 +39,7 @@
 #include "draw/draw_context.h"
 #include "gallivm/lp_bld_type.h"
 
+#include "util/mesa-sha1.h"
 #include "util/os_misc.h"
 #include "util/os_time.h"
 #include "lp_texture.h"
@@ -84,6 +86,7 @@ static const struct debug_named_value lp_perf_flags[] = {
    { "no_blend",       PERF_NO_BLEND, NULL },
    { "no_depth",       PERF_NO_DEPTH, NULL },
    { "no_alphatest",   PERF_NO_ALPHATEST, NULL },
+   { "tiled_tex",      PERF_TILED_TEX, NULL },
    DEBUG_NAMED_VALUE_END
 };
 
@@ -105,6 +108,33 @@ llvmpipe_get_name(struct pipe_screen *screen)
 }
 
 
+/**
+ * Memory objects are plain files mapped in the host's address space, so any
+ * llvmpipe on the same machine can share them, but the resource layouts
+ * may change between versions.
+ */
+static void
+llvmpipe_get_driver_uuid(struct pipe_screen *screen, char *uuid)
+{
+   static const char id[] = "llvmpipe " PACKAGE_VERSION;
+   unsigned char sha1[20];
+
+   _mesa_sha1_compute(id, strlen(id), sha1);
+   memcpy(uuid, sha1, PIPE_UUID_SIZE);
+}
+
+
+static void
+llvmpipe_get_device_uuid(struct pipe_screen *screen, char *uuid)
+{
+   static const char id[] = "llvmpipe";
+   unsigned char sha1[20];
+
+   _mesa_sha1_compute(id, strlen(id), sha1);
+   memcpy(uuid, sha1, PIPE_UUID_SIZE);
+}
+
+
 static int
 llvmpipe_get_param(struct pipe_screen *screen, enum pipe_cap param)
 {
@@ -318,8 +348,15 @@ llvmpipe_get_param(struct pipe_screen *screen, enum pipe_cap param)
       return 32;
    case PIPE_CAP_SHADER_BUFFER_OFFSET_ALIGNMENT:
       return 1;
-   case PIPE_CAP_MULTISAMPLE_Z_RESOLVE:
    case PIPE_CAP_RESOURCE_FROM_USER_MEMORY:
+      return 1;
+   case PIPE_CAP_MEMOBJ:
+#if defined(PIPE_OS_UNIX)
+      return 1;
+#else
+      return 0;
+#endif
+   case PIPE_CAP_MULTISAMPLE_Z_RESOLVE:
    case PIPE_CAP_DEVICE_RESET_STATUS_QUERY:
    case PIPE_CAP_MAX_SHADER_PATCH_VARYINGS:
    case PIPE_CAP_DEPTH_BOUNDS_TEST:
@@ -364,7 +401,6 @@ llvmpipe_get_param(struct pipe_screen *screen, enum pipe_cap param)
    case PIPE_CAP_POST_DEPTH_COVERAGE:
    case PIPE_CAP_BINDLESS_TEXTURE:
    case PIPE_CAP_NIR_SAMPLERS_AS_DEREF:
-   case PIPE_CAP_MEMOBJ:
    case PIPE_CAP_LOAD_CONSTBUF:
    case PIPE_CAP_TGSI_ANY_REG_AS_ADDRESS:
    case PIPE_CAP_TILE_RASTER_ORDER:
@@ -638,10 +674,41 @@ llvmpipe_flush_frontbuffer(struct pipe_screen *_screen,
    struct llvmpipe_screen *screen = llvmpipe_screen(_screen);
    struct sw_winsys *winsys = screen->winsys;
    struct llvmpipe_resource *texture = llvmpipe_resource(resource);
+   struct u_rect rect = texture->damage;
+   struct pipe_box box;
 
    assert(texture->dt);
-   if (texture->dt)
-      winsys->displaytarget_display(winsys, texture->dt, context_private, sub_box);
+   if (!texture->dt)
+      return;
+
+   /* Sub-box presents (glXCopySubBufferMESA) copy exactly what they ask for,
+    * and leave the damage to the next full present.
+    */
+   if (sub_box) {
+      winsys->displaytarget_display(winsys, texture->dt, context_private,
+                                    sub_box);
+      return;
+   }
+
+   llvmpipe_resource_clear_damage(texture);
+
+   /* Present the whole image when nothing is known to have been drawn (the
+    * contents may have been changed in ways the damage doesn't track), or
+    * when everything was, letting the winsys do it its own way.  Otherwise
+    * only present what was drawn since the last time.
+    */
+   if (rect.x1 < rect.x0 || rect.y1 < rect.y0 ||
+       (rect.x0 <= 0 && rect.y0 <= 0 &&
+        rect.x1 >= (int) resource->width0 - 1 &&
+        rect.y1 >= (int) resource->height0 - 1)) {
+      winsys->displaytarget_display(winsys, texture->dt, context_private,
+                                    NULL);
+      return;
+   }
+
+   u_box_2d(rect.x0, rect.y0, rect.x1 - rect.x0 + 1, rect.y1 - rect.y0 + 1,
+            &box);
+   winsys->displaytarget_display(winsys, texture->dt, context_private, &box);
 }
 
 static void
@@ -750,6 +817,8 @@ llvmpipe_create_screen(struct sw_winsys *winsys)
    screen->base.get_shader_param = llvmpipe_get_shader_param;
    screen->base.get_compute_param = llvmpipe_get_compute_param;
    screen->base.get_paramf = llvmpipe_get_paramf;
+   screen->base.get_driver_uuid = llvmpipe_get_driver_uuid;
+   screen->base.get_device_uuid = llvmpipe_get_device_uuid;
    screen->base.is_format_supported = llvmpipe_is_format_supported;
 
    screen->base.context_create = llvmpipe_create_context;
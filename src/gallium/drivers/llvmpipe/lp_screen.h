@@ -55,6 +55,12 @@ struct llvmpipe_screen
     */
    unsigned timestamp;
 
+   /* Increments whenever a tiled texture is made linear, which changes the
+    * shaders sampling it.  Any context can untile a shared texture, so it's
+    * only accessed with p_atomic_inc() and p_atomic_read().
+    */
+   unsigned tiling_timestamp;
+
    struct lp_rasterizer *rast;
    mtx_t rast_mutex;
 
@@ -910,6 +910,8 @@ lp_setup_set_fragment_sampler_views(struct lp_setup_context *setup,
           */
          pipe_resource_reference(&setup->fs.current_tex[i], res);
 
+         jit_tex->level_sizes = lp_tex->level_sizes;
+
          if (!lp_tex->dt) {
             /* regular texture - setup array of mipmap level offsets */
             int j;
@@ -930,6 +932,7 @@ lp_setup_set_fragment_sampler_views(struct lp_setup_context *setup,
             if (LP_PERF & PERF_TEX_MEM) {
                /* use dummy tile memory */
                jit_tex->base = lp_dummy_tile;
+               jit_tex->level_sizes = lp_dummy_level_sizes;
                jit_tex->width = TILE_SIZE/8;
                jit_tex->height = TILE_SIZE/8;
                jit_tex->depth = 1;
@@ -773,6 +773,8 @@ lp_csctx_set_sampler_views(struct lp_cs_context *csctx,
           */
          pipe_resource_reference(&csctx->cs.current_tex[i], res);
 
+         jit_tex->level_sizes = lp_tex->level_sizes;
+
          if (!lp_tex->dt) {
             /* regular texture - csctx array of mipmap level offsets */
             int j;
@@ -792,6 +794,7 @@ lp_csctx_set_sampler_views(struct lp_cs_context *csctx,
             if (LP_PERF & PERF_TEX_MEM) {
                /* use dummy tile memory */
                jit_tex->base = lp_dummy_tile;
+               jit_tex->level_sizes = lp_dummy_level_sizes;
                jit_tex->width = TILE_SIZE/8;
                jit_tex->height = TILE_SIZE/8;
                jit_tex->depth = 1;
@@ -1079,7 +1082,21 @@ update_csctx_ssbo(struct llvmpipe_context *llvmpipe)
 static void
 llvmpipe_cs_update_derived(struct llvmpipe_context *llvmpipe)
 {
-   if (llvmpipe->cs_dirty & (LP_CSNEW_CS))
+   struct llvmpipe_screen *screen = llvmpipe_screen(llvmpipe->pipe.screen);
+   unsigned tiling_timestamp;
+
+   /* Check for textures made linear, see llvmpipe_update_derived() */
+   tiling_timestamp = p_atomic_read(&screen->tiling_timestamp);
+   if (llvmpipe->cs_tiling_timestamp != tiling_timestamp) {
+      llvmpipe->cs_tiling_timestamp = tiling_timestamp;
+      llvmpipe->cs_dirty |= LP_CSNEW_SAMPLER_VIEW;
+   }
+
+   /* The variant key has the sampler, texture and image state too */
+   if (llvmpipe->cs_dirty & (LP_CSNEW_CS |
+                             LP_CSNEW_SAMPLER |
+                             LP_CSNEW_SAMPLER_VIEW |
+                             LP_CSNEW_IMAGES))
       llvmpipe_update_cs(llvmpipe);
 
    if (llvmpipe->cs_dirty & LP_CSNEW_CONSTANTS) {
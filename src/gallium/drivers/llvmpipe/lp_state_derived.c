@@ -183,6 +183,7 @@ compute_vertex_info(struct llvmpipe_context *llvmpipe)
 void llvmpipe_update_derived( struct llvmpipe_context *llvmpipe )
 {
    struct llvmpipe_screen *lp_screen = llvmpipe_screen(llvmpipe->pipe.screen);
+   unsigned tiling_timestamp;
 
    /* Check for updated textures.
     */
@@ -191,6 +192,21 @@ void llvmpipe_update_derived( struct llvmpipe_context *llvmpipe )
       llvmpipe->dirty |= LP_NEW_SAMPLER_VIEW;
    }
 
+   /* Check for textures made linear, which the shaders sampling them must be
+    * rebuilt for.  Setting the same views again has draw look at them.
+    */
+   tiling_timestamp = p_atomic_read(&lp_screen->tiling_timestamp);
+   if (llvmpipe->tiling_timestamp != tiling_timestamp) {
+      llvmpipe->tiling_timestamp = tiling_timestamp;
+      llvmpipe->dirty |= LP_NEW_SAMPLER_VIEW;
+      draw_set_sampler_views(llvmpipe->draw, PIPE_SHADER_VERTEX,
+                             llvmpipe->sampler_views[PIPE_SHADER_VERTEX],
+                             llvmpipe->num_sampler_views[PIPE_SHADER_VERTEX]);
+      draw_set_sampler_views(llvmpipe->draw, PIPE_SHADER_GEOMETRY,
+                             llvmpipe->sampler_views[PIPE_SHADER_GEOMETRY],
+                             llvmpipe->num_sampler_views[PIPE_SHADER_GEOMETRY]);
+   }
+
    /* This needs LP_NEW_RASTERIZER because of draw_prepare_shader_outputs(). */
    if (llvmpipe->dirty & (LP_NEW_RASTERIZER |
                           LP_NEW_FS |
@@ -3223,6 +3223,10 @@ llvmpipe_set_shader_images(struct pipe_context *pipe,
    for (i = start_slot, idx = 0; i < start_slot + count; i++, idx++) {
       const struct pipe_image_view *image = images ? &images[idx] : NULL;
 
+      /* Image loads and stores only deal with linear images */
+      if (image && image->resource)
+         llvmpipe_resource_untile(image->resource);
+
       util_copy_image_view(&llvmpipe->images[shader][i], image);
    }
 
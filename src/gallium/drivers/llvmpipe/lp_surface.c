@@ -131,6 +131,10 @@ llvmpipe_create_surface(struct pipe_context *pipe,
 {
    struct pipe_surface *ps;
 
+   /* Rendering only deals with linear images */
+   if (!llvmpipe_resource_untile(pt))
+      return NULL;
+
    if (!(pt->bind & (PIPE_BIND_DEPTH_STENCIL | PIPE_BIND_RENDER_TARGET))) {
       debug_printf("Illegal surface creation without bind flag\n");
       if (util_format_is_depth_or_stencil(surf_tmpl->format)) {
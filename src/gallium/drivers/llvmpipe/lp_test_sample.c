@@ -0,0 +1,762 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file
+ * Unit tests and benchmark for sampling tiled textures.
+ *
+ * Each test samples the same texture stored linear and in LP_TEX_TILE_SIZE
+ * tiles (see LP_RESOURCE_FLAG_TILED), and the results must be the same bit
+ * for bit.  Both layouts are then timed walking the texture column-wise, one
+ * 2x2 quad per pixel pair, as a rotated quad would.  The tiled layout only
+ * wins once the texture rows are far enough apart to miss the caches and
+ * TLB, which is why it's opt-in.
+ */
+
+
+#include <string.h>
+
+#include "util/u_memory.h"
+#include "util/u_math.h"
+#include "util/u_format.h"
+
+#include "gallivm/lp_bld_init.h"
+#include "gallivm/lp_bld_type.h"
+#include "gallivm/lp_bld_const.h"
+#include "gallivm/lp_bld_debug.h"
+#include "gallivm/lp_bld_sample.h"
+#include "lp_limits.h"
+#include "lp_test.h"
+
+
+#define NUM_RANDOM_VECS 256
+
+/* Texel columns walked by the benchmark, which keeps the coordinates of
+ * large textures small.
+ */
+#define WALK_MAX_WIDTH 128
+
+
+typedef void (*sample_ptr_t)(const void *coords, const void *lod,
+                             void *texels);
+
+
+struct sample_test_case
+{
+   enum pipe_format format;
+   enum pipe_texture_target target;
+   unsigned width;
+   unsigned height;
+   unsigned layers;
+   boolean mipmaps;
+   unsigned img_filter;
+   unsigned mip_filter;
+   enum lp_sampler_op_type op;
+};
+
+
+static const struct sample_test_case test_cases[] =
+{
+   /* AoS filtering, power of two and not */
+   { PIPE_FORMAT_B8G8R8A8_UNORM, PIPE_TEXTURE_2D, 256, 256, 1, TRUE,
+     PIPE_TEX_FILTER_LINEAR, PIPE_TEX_MIPFILTER_LINEAR, LP_SAMPLER_OP_TEXTURE },
+   { PIPE_FORMAT_B8G8R8A8_UNORM, PIPE_TEXTURE_2D, 509, 257, 1, TRUE,
+     PIPE_TEX_FILTER_LINEAR, PIPE_TEX_MIPFILTER_NEAREST, LP_SAMPLER_OP_TEXTURE },
+   { PIPE_FORMAT_B8G8R8A8_UNORM, PIPE_TEXTURE_2D, 509, 257, 1, FALSE,
+     PIPE_TEX_FILTER_NEAREST, PIPE_TEX_MIPFILTER_NONE, LP_SAMPLER_OP_TEXTURE },
+   { PIPE_FORMAT_R8_UNORM, PIPE_TEXTURE_2D_ARRAY, 77, 45, 3, TRUE,
+     PIPE_TEX_FILTER_LINEAR, PIPE_TEX_MIPFILTER_LINEAR, LP_SAMPLER_OP_TEXTURE },
+   /* SoA filtering */
+   { PIPE_FORMAT_R32G32B32A32_FLOAT, PIPE_TEXTURE_2D, 509, 257, 1, TRUE,
+     PIPE_TEX_FILTER_LINEAR, PIPE_TEX_MIPFILTER_LINEAR, LP_SAMPLER_OP_TEXTURE },
+   { PIPE_FORMAT_R32G32B32A32_FLOAT, PIPE_TEXTURE_2D_ARRAY, 77, 45, 3, TRUE,
+     PIPE_TEX_FILTER_NEAREST, PIPE_TEX_MIPFILTER_NEAREST, LP_SAMPLER_OP_TEXTURE },
+   { PIPE_FORMAT_R16G16B16A16_UNORM, PIPE_TEXTURE_2D, 509, 257, 1, TRUE,
+     PIPE_TEX_FILTER_LINEAR, PIPE_TEX_MIPFILTER_LINEAR, LP_SAMPLER_OP_TEXTURE },
+   { PIPE_FORMAT_R32_FLOAT, PIPE_TEXTURE_2D, 509, 257, 1, FALSE,
+     PIPE_TEX_FILTER_LINEAR, PIPE_TEX_MIPFILTER_NONE, LP_SAMPLER_OP_TEXTURE },
+   /* Large enough that walking down the columns of the linear layout misses
+    * the caches and TLB on every row
+    */
+   { PIPE_FORMAT_B8G8R8A8_UNORM, PIPE_TEXTURE_2D, 4096, 4096, 1, FALSE,
+     PIPE_TEX_FILTER_LINEAR, PIPE_TEX_MIPFILTER_NONE, LP_SAMPLER_OP_TEXTURE },
+   { PIPE_FORMAT_B8G8R8A8_UNORM, PIPE_TEXTURE_2D, 4096, 4096, 1, FALSE,
+     PIPE_TEX_FILTER_NEAREST, PIPE_TEX_MIPFILTER_NONE, LP_SAMPLER_OP_TEXTURE },
+   { PIPE_FORMAT_R32G32B32A32_FLOAT, PIPE_TEXTURE_2D, 2048, 2048, 1, FALSE,
+     PIPE_TEX_FILTER_LINEAR, PIPE_TEX_MIPFILTER_NONE, LP_SAMPLER_OP_TEXTURE },
+   /* Texel fetches */
+   { PIPE_FORMAT_B8G8R8A8_UNORM, PIPE_TEXTURE_2D, 509, 257, 1, TRUE,
+     PIPE_TEX_FILTER_NEAREST, PIPE_TEX_MIPFILTER_NONE, LP_SAMPLER_OP_FETCH },
+   { PIPE_FORMAT_R32G32B32A32_FLOAT, PIPE_TEXTURE_2D_ARRAY, 77, 45, 3, TRUE,
+     PIPE_TEX_FILTER_NEAREST, PIPE_TEX_MIPFILTER_NONE, LP_SAMPLER_OP_FETCH },
+};
+
+
+/**
+ * A texture laid out the way llvmpipe_texture_layout() does, held twice:
+ * linear in data[0] and tiled in data[1].  The texture unit picks which.
+ */
+struct sample_test_texture
+{
+   struct lp_sampler_dynamic_state base;
+
+   unsigned width;
+   unsigned height;
+   unsigned layers;
+   unsigned last_level;
+   uint32_t row_stride[LP_MAX_TEXTURE_LEVELS];
+   uint32_t img_stride[LP_MAX_TEXTURE_LEVELS];
+   uint32_t mip_offsets[LP_MAX_TEXTURE_LEVELS];
+   float border_color[4];
+   unsigned size;
+   ubyte *data[2];
+};
+
+
+static LLVMValueRef
+const_array_ptr(struct gallivm_state *gallivm, LLVMTypeRef elem_type,
+                unsigned length, const void *ptr)
+{
+   LLVMTypeRef type = LLVMPointerType(LLVMArrayType(elem_type, length), 0);
+
+   return LLVMBuildBitCast(gallivm->builder,
+                           lp_build_const_int_pointer(gallivm, ptr), type, "");
+}
+
+
+static LLVMValueRef
+test_texture_width(const struct lp_sampler_dynamic_state *state,
+                   struct gallivm_state *gallivm,
+                   LLVMValueRef context_ptr, unsigned unit)
+{
+   const struct sample_test_texture *tex =
+      (const struct sample_test_texture *) state;
+   return lp_build_const_int32(gallivm, tex->width);
+}
+
+
+static LLVMValueRef
+test_texture_height(const struct lp_sampler_dynamic_state *state,
+                    struct gallivm_state *gallivm,
+                    LLVMValueRef context_ptr, unsigned unit)
+{
+   const struct sample_test_texture *tex =
+      (const struct sample_test_texture *) state;
+   return lp_build_const_int32(gallivm, tex->height);
+}
+
+
+static LLVMValueRef
+test_texture_depth(const struct lp_sampler_dynamic_state *state,
+                   struct gallivm_state *gallivm,
+                   LLVMValueRef context_ptr, unsigned unit)
+{
+   const struct sample_test_texture *tex =
+      (const struct sample_test_texture *) state;
+   return lp_build_const_int32(gallivm, tex->layers);
+}
+
+
+static LLVMValueRef
+test_texture_first_level(const struct lp_sampler_dynamic_state *state,
+                         struct gallivm_state *gallivm,
+                         LLVMValueRef context_ptr, unsigned unit)
+{
+   return lp_build_const_int32(gallivm, 0);
+}
+
+
+static LLVMValueRef
+test_texture_last_level(const struct lp_sampler_dynamic_state *state,
+                        struct gallivm_state *gallivm,
+                        LLVMValueRef context_ptr, unsigned unit)
+{
+   const struct sample_test_texture *tex =
+      (const struct sample_test_texture *) state;
+   return lp_build_const_int32(gallivm, tex->last_level);
+}
+
+
+static LLVMValueRef
+test_texture_row_stride(const struct lp_sampler_dynamic_state *state,
+                        struct gallivm_state *gallivm,
+                        LLVMValueRef context_ptr, unsigned unit)
+{
+   const struct sample_test_texture *tex =
+      (const struct sample_test_texture *) state;
+   return const_array_ptr(gallivm, LLVMInt32TypeInContext(gallivm->context),
+                          LP_MAX_TEXTURE_LEVELS, tex->row_stride);
+}
+
+
+static LLVMValueRef
+test_texture_img_stride(const struct lp_sampler_dynamic_state *state,
+                        struct gallivm_state *gallivm,
+                        LLVMValueRef context_ptr, unsigned unit)
+{
+   const struct sample_test_texture *tex =
+      (const struct sample_test_texture *) state;
+   return const_array_ptr(gallivm, LLVMInt32TypeInContext(gallivm->context),
+                          LP_MAX_TEXTURE_LEVELS, tex->img_stride);
+}
+
+
+static LLVMValueRef
+test_texture_base_ptr(const struct lp_sampler_dynamic_state *state,
+                      struct gallivm_state *gallivm,
+                      LLVMValueRef context_ptr, unsigned unit)
+{
+   const struct sample_test_texture *tex =
+      (const struct sample_test_texture *) state;
+   return LLVMBuildBitCast(gallivm->builder,
+                           lp_build_const_int_pointer(gallivm, tex->data[unit]),
+                           LLVMPointerType(LLVMInt8TypeInContext(gallivm->context),
+                                           0), "");
+}
+
+
+static LLVMValueRef
+test_texture_mip_offsets(const struct lp_sampler_dynamic_state *state,
+                         struct gallivm_state *gallivm,
+                         LLVMValueRef context_ptr, unsigned unit)
+{
+   const struct sample_test_texture *tex =
+      (const struct sample_test_texture *) state;
+   return const_array_ptr(gallivm, LLVMInt32TypeInContext(gallivm->context),
+                          LP_MAX_TEXTURE_LEVELS, tex->mip_offsets);
+}
+
+
+static LLVMValueRef
+test_sampler_zero(const struct lp_sampler_dynamic_state *state,
+                  struct gallivm_state *gallivm,
+                  LLVMValueRef context_ptr, unsigned unit)
+{
+   return lp_build_const_float(gallivm, 0.0f);
+}
+
+
+static LLVMValueRef
+test_sampler_max_lod(const struct lp_sampler_dynamic_state *state,
+                     struct gallivm_state *gallivm,
+                     LLVMValueRef context_ptr, unsigned unit)
+{
+   return lp_build_const_float(gallivm, 1000.0f);
+}
+
+
+static LLVMValueRef
+test_sampler_border_color(const struct lp_sampler_dynamic_state *state,
+                          struct gallivm_state *gallivm,
+                          LLVMValueRef context_ptr, unsigned unit)
+{
+   const struct sample_test_texture *tex =
+      (const struct sample_test_texture *) state;
+   return const_array_ptr(gallivm, LLVMFloatTypeInContext(gallivm->context),
+                          4, tex->border_color);
+}
+
+
+/**
+ * Byte offset of texel (x, y) of an image in tiles.
+ */
+static unsigned
+tiled_offset(unsigned x, unsigned y, unsigned row_stride, unsigned bpp)
+{
+   const unsigned mask = LP_TEX_TILE_SIZE - 1;
+
+   return (y & ~mask) * row_stride +
+          (x & ~mask) * LP_TEX_TILE_SIZE * bpp +
+          (y & mask) * LP_TEX_TILE_SIZE * bpp +
+          (x & mask) * bpp;
+}
+
+
+static boolean
+init_test_texture(struct sample_test_texture *tex,
+                  const struct sample_test_case *test)
+{
+   const struct util_format_description *desc =
+      util_format_description(test->format);
+   const unsigned bpp = util_format_get_blocksize(test->format);
+   unsigned level, layer, x, y, i;
+
+   memset(tex, 0, sizeof *tex);
+
+   tex->base.width = test_texture_width;
+   tex->base.height = test_texture_height;
+   tex->base.depth = test_texture_depth;
+   tex->base.first_level = test_texture_first_level;
+   tex->base.last_level = test_texture_last_level;
+   tex->base.row_stride = test_texture_row_stride;
+   tex->base.img_stride = test_texture_img_stride;
+   tex->base.base_ptr = test_texture_base_ptr;
+   tex->base.mip_offsets = test_texture_mip_offsets;
+   tex->base.min_lod = test_sampler_zero;
+   tex->base.max_lod = test_sampler_max_lod;
+   tex->base.lod_bias = test_sampler_zero;
+   tex->base.border_color = test_sampler_border_color;
+
+   tex->width = test->width;
+   tex->height = test->height;
+   tex->layers = test->layers;
+   tex->last_level = test->mipmaps ?
+                     util_logbase2(MAX2(test->width, test->height)) : 0;
+
+   for (level = 0; level <= tex->last_level; level++) {
+      const unsigned width = align(u_minify(test->width, level),
+                                   LP_TEX_TILE_SIZE);
+      const unsigned height = align(u_minify(test->height, level),
+                                    LP_TEX_TILE_SIZE);
+
+      tex->row_stride[level] = align(width * bpp, 16);
+      tex->img_stride[level] = tex->row_stride[level] * height;
+      tex->mip_offsets[level] = tex->size;
+      tex->size += align(tex->img_stride[level] * test->layers, 64);
+   }
+
+   tex->data[0] = align_malloc(tex->size, 64);
+   tex->data[1] = align_malloc(tex->size, 64);
+   if (!tex->data[0] || !tex->data[1])
+      return FALSE;
+
+   if (desc->channel[0].type == UTIL_FORMAT_TYPE_FLOAT) {
+      float *f = (float *) tex->data[0];
+      for (i = 0; i < tex->size / 4; i++)
+         f[i] = random_float();
+   }
+   else {
+      for (i = 0; i < tex->size; i++)
+         tex->data[0][i] = rand();
+   }
+
+   /* The padding isn't sampled, only the texels need to be tiled */
+   memset(tex->data[1], 0, tex->size);
+   for (level = 0; level <= tex->last_level; level++) {
+      const unsigned width = u_minify(test->width, level);
+      const unsigned height = u_minify(test->height, level);
+      const unsigned row_stride = tex->row_stride[level];
+
+      for (layer = 0; layer < test->layers; layer++) {
+         const unsigned offset = tex->mip_offsets[level] +
+                                 layer * tex->img_stride[level];
+         const ubyte *src = tex->data[0] + offset;
+         ubyte *dst = tex->data[1] + offset;
+
+         for (y = 0; y < height; y++) {
+            for (x = 0; x < width; x++) {
+               memcpy(dst + tiled_offset(x, y, row_stride, bpp),
+                      src + y * row_stride + x * bpp, bpp);
+            }
+         }
+      }
+   }
+
+   return TRUE;
+}
+
+
+static void
+free_test_texture(struct sample_test_texture *tex)
+{
+   align_free(tex->data[0]);
+   align_free(tex->data[1]);
+}
+
+
+/**
+ * Build a function sampling texture unit \p unit, that is the linear or the
+ * tiled copy of the texture, at one vector of coordinates (s, t, layer) and
+ * explicit lods, and storing the four channels.
+ */
+static LLVMValueRef
+add_sample_test(struct gallivm_state *gallivm,
+                const struct sample_test_case *test,
+                struct sample_test_texture *tex,
+                unsigned unit,
+                struct lp_type type)
+{
+   LLVMModuleRef module = gallivm->module;
+   LLVMContextRef context = gallivm->context;
+   LLVMBuilderRef builder = gallivm->builder;
+   const struct lp_type coord_type =
+      test->op == LP_SAMPLER_OP_FETCH ? lp_int_type(type) : type;
+   LLVMTypeRef coord_vec_type = lp_build_vec_type(gallivm, coord_type);
+   LLVMTypeRef vec_type = lp_build_vec_type(gallivm, type);
+   struct lp_static_texture_state texture_state;
+   struct lp_static_sampler_state sampler_state;
+   struct lp_sampler_params params;
+   LLVMTypeRef args[3];
+   LLVMValueRef func, coords_ptr, lod_ptr, texels_ptr;
+   LLVMValueRef coords[5], offsets[3], texels[4];
+   LLVMBasicBlockRef block;
+   unsigned i;
+
+   memset(&texture_state, 0, sizeof texture_state);
+   texture_state.format = test->format;
+   texture_state.swizzle_r = PIPE_SWIZZLE_X;
+   texture_state.swizzle_g = PIPE_SWIZZLE_Y;
+   texture_state.swizzle_b = PIPE_SWIZZLE_Z;
+   texture_state.swizzle_a = PIPE_SWIZZLE_W;
+   texture_state.target = test->target;
+   texture_state.pot_width = util_is_power_of_two_or_zero(test->width);
+   texture_state.pot_height = util_is_power_of_two_or_zero(test->height);
+   texture_state.pot_depth = 1;
+   texture_state.tiled = unit;
+
+   memset(&sampler_state, 0, sizeof sampler_state);
+   sampler_state.wrap_s = PIPE_TEX_WRAP_REPEAT;
+   sampler_state.wrap_t = PIPE_TEX_WRAP_CLAMP_TO_EDGE;
+   sampler_state.wrap_r = PIPE_TEX_WRAP_CLAMP_TO_EDGE;
+   sampler_state.min_img_filter = test->img_filter;
+   sampler_state.mag_img_filter = test->img_filter;
+   sampler_state.min_mip_filter = test->mip_filter;
+   sampler_state.normalized_coords = 1;
+
+   args[0] = LLVMPointerType(coord_vec_type, 0);
+   args[1] = LLVMPointerType(coord_vec_type, 0);
+   args[2] = LLVMPointerType(vec_type, 0);
+
+   func = LLVMAddFunction(module, unit ? "sample_tiled" : "sample_linear",
+                          LLVMFunctionType(LLVMVoidTypeInContext(context),
+                                           args, ARRAY_SIZE(args), 0));
+   LLVMSetFunctionCallConv(func, LLVMCCallConv);
+   coords_ptr = LLVMGetParam(func, 0);
+   lod_ptr = LLVMGetParam(func, 1);
+   texels_ptr = LLVMGetParam(func, 2);
+
+   block = LLVMAppendBasicBlockInContext(context, func, "entry");
+   LLVMPositionBuilderAtEnd(builder, block);
+
+   memset(coords, 0, sizeof coords);
+   memset(offsets, 0, sizeof offsets);
+   for (i = 0; i < 3; i++) {
+      LLVMValueRef index = lp_build_const_int32(gallivm, i);
+      coords[i] = LLVMBuildLoad(builder,
+                                LLVMBuildGEP(builder, coords_ptr, &index, 1, ""),
+                                "");
+   }
+
+   memset(&params, 0, sizeof params);
+   params.type = type;
+   params.texture_index = unit;
+   params.sampler_index = 0;
+   params.sample_key = (test->op << LP_SAMPLER_OP_TYPE_SHIFT) |
+                       (LP_SAMPLER_LOD_EXPLICIT << LP_SAMPLER_LOD_CONTROL_SHIFT) |
+                       (LP_SAMPLER_LOD_PER_ELEMENT << LP_SAMPLER_LOD_PROPERTY_SHIFT);
+   params.context_ptr =
+      LLVMConstNull(LLVMPointerType(LLVMInt8TypeInContext(context), 0));
+   params.coords = coords;
+   params.offsets = offsets;
+   params.lod = LLVMBuildLoad(builder, lod_ptr, "");
+   params.texel = texels;
+
+   lp_build_sample_soa(&texture_state, &sampler_state, &tex->base,
+                       gallivm, &params);
+
+   for (i = 0; i < 4; i++) {
+      LLVMValueRef index = lp_build_const_int32(gallivm, i);
+      LLVMBuildStore(builder, texels[i],
+                     LLVMBuildGEP(builder, texels_ptr, &index, 1, ""));
+   }
+
+   LLVMBuildRetVoid(builder);
+
+   gallivm_verify_function(gallivm, func);
+
+   return func;
+}
+
+
+/**
+ * Random coordinates (and lods) covering every level and layer, and a bit
+ * outside the texture to go through the wrap modes.
+ */
+static void
+random_coords(const struct sample_test_case *test,
+              const struct sample_test_texture *tex,
+              unsigned length, void *coords, void *lod)
+{
+   unsigned i;
+
+   for (i = 0; i < length; i++) {
+      if (test->op == LP_SAMPLER_OP_FETCH) {
+         int32_t *c = (int32_t *) coords;
+         int32_t *l = (int32_t *) lod;
+         unsigned level = rand() % (tex->last_level + 1);
+
+         c[0 * length + i] = rand() % u_minify(tex->width, level);
+         c[1 * length + i] = rand() % u_minify(tex->height, level);
+         c[2 * length + i] = rand() % tex->layers;
+         l[i] = level;
+      }
+      else {
+         float *c = (float *) coords;
+         float *l = (float *) lod;
+
+         c[0 * length + i] = random_float() * 2.0f - 0.5f;
+         c[1 * length + i] = random_float() * 2.0f - 0.5f;
+         c[2 * length + i] = random_float() * tex->layers - 0.5f;
+         l[i] = random_float() * (tex->last_level + 2) - 1.0f;
+      }
+   }
+}
+
+
+/**
+ * Coordinates of the first level, in 2x2 quads walking the first
+ * WALK_MAX_WIDTH columns of the texture one column after the other.  Returns
+ * the number of vectors.
+ */
+static unsigned
+walk_coords(const struct sample_test_case *test,
+            const struct sample_test_texture *tex,
+            unsigned length, void *coords, void *lod)
+{
+   const unsigned quads_per_vec = length / 4;
+   const unsigned num_x = MIN2(tex->width, WALK_MAX_WIDTH) / 2;
+   const unsigned num_y = tex->height / (2 * quads_per_vec);
+   unsigned qx, qy, i, n = 0;
+
+   for (qx = 0; qx < num_x; qx++) {
+      for (qy = 0; qy < num_y; qy++) {
+         for (i = 0; i < length; i++) {
+            const unsigned quad = i / 4;
+            const unsigned x = qx * 2 + (i & 1);
+            const unsigned y = (qy * quads_per_vec + quad) * 2 + ((i >> 1) & 1);
+            const unsigned index = n * 3 * length + i;
+
+            if (test->op == LP_SAMPLER_OP_FETCH) {
+               int32_t *c = (int32_t *) coords;
+               c[index + 0 * length] = x;
+               c[index + 1 * length] = y;
+               c[index + 2 * length] = 0;
+               ((int32_t *) lod)[n * length + i] = 0;
+            }
+            else {
+               float *c = (float *) coords;
+               c[index + 0 * length] = (x + 0.5f) / tex->width;
+               c[index + 1 * length] = (y + 0.5f) / tex->height;
+               c[index + 2 * length] = 0.0f;
+               ((float *) lod)[n * length + i] = 0.0f;
+            }
+         }
+         n++;
+      }
+   }
+
+   return n;
+}
+
+
+static double
+time_walk(sample_ptr_t sample, const ubyte *coords, const ubyte *lod,
+          unsigned num_vecs, unsigned vec_size, void *texels)
+{
+   int64_t best = INT64_MAX;
+   unsigned i, n;
+
+   for (i = 0; i < LP_TEST_NUM_SAMPLES; i++) {
+      int64_t start_counter = rdtsc();
+
+      for (n = 0; n < num_vecs; n++)
+         sample(coords + n * 3 * vec_size, lod + n * vec_size, texels);
+
+      best = MIN2(best, (int64_t) rdtsc() - start_counter);
+   }
+
+   return (double) best;
+}
+
+
+void
+write_tsv_header(FILE *fp)
+{
+   fprintf(fp,
+           "result\t"
+           "cycles_per_texel_linear\t"
+           "cycles_per_texel_tiled\t"
+           "format\t"
+           "target\t"
+           "size\t"
+           "img_filter\t"
+           "mip_filter\t"
+           "op\n");
+
+   fflush(fp);
+}
+
+
+static void
+write_tsv_row(FILE *fp,
+              const struct sample_test_case *test,
+              double cycles_linear,
+              double cycles_tiled,
+              boolean success)
+{
+   fprintf(fp, "%s\t", success ? "pass" : "fail");
+
+   fprintf(fp, "%.2f\t%.2f\t", cycles_linear, cycles_tiled);
+
+   fprintf(fp, "%s\t%s\t%ux%ux%u\t%s\t%s\t%s\n",
+           util_format_name(test->format),
+           util_str_tex_target(test->target, TRUE),
+           test->width, test->height, test->layers,
+           util_str_tex_filter(test->img_filter, TRUE),
+           util_str_tex_mipfilter(test->mip_filter, TRUE),
+           test->op == LP_SAMPLER_OP_FETCH ? "fetch" : "texture");
+
+   fflush(fp);
+}
+
+
+static boolean
+test_one(unsigned verbose, FILE *fp, const struct sample_test_case *test)
+{
+   struct lp_type type = lp_type_float_vec(32, lp_native_vector_width);
+   const unsigned vec_size = type.length * 4;
+   struct sample_test_texture tex;
+   LLVMContextRef context;
+   struct gallivm_state *gallivm;
+   LLVMValueRef func[2];
+   sample_ptr_t sample[2];
+   ubyte *coords, *lod, *texels[2];
+   unsigned num_vecs, i;
+   double cycles[2];
+   boolean success = TRUE;
+
+   if (verbose >= 1) {
+      fprintf(stdout, "%s %s %ux%ux%u %s %s %s\n",
+              util_format_name(test->format),
+              util_str_tex_target(test->target, TRUE),
+              test->width, test->height, test->layers,
+              util_str_tex_filter(test->img_filter, TRUE),
+              util_str_tex_mipfilter(test->mip_filter, TRUE),
+              test->op == LP_SAMPLER_OP_FETCH ? "fetch" : "texture");
+   }
+
+   if (!init_test_texture(&tex, test)) {
+      free_test_texture(&tex);
+      return FALSE;
+   }
+
+   context = LLVMContextCreate();
+   gallivm = gallivm_create("test_module", context);
+
+   for (i = 0; i < 2; i++)
+      func[i] = add_sample_test(gallivm, test, &tex, i, type);
+
+   gallivm_compile_module(gallivm);
+
+   for (i = 0; i < 2; i++)
+      sample[i] = (sample_ptr_t) gallivm_jit_function(gallivm, func[i]);
+
+   gallivm_free_ir(gallivm);
+
+   /* Enough for the random vectors and for walking the first level */
+   num_vecs = MAX2(NUM_RANDOM_VECS,
+                   MIN2(test->width, WALK_MAX_WIDTH) * test->height /
+                   type.length + 1);
+   coords = align_malloc(num_vecs * 3 * vec_size, 64);
+   lod = align_malloc(num_vecs * vec_size, 64);
+   texels[0] = align_malloc(4 * vec_size, 64);
+   texels[1] = align_malloc(4 * vec_size, 64);
+
+   for (i = 0; i < NUM_RANDOM_VECS; i++) {
+      random_coords(test, &tex, type.length, coords, lod);
+
+      sample[0](coords, lod, texels[0]);
+      sample[1](coords, lod, texels[1]);
+
+      if (memcmp(texels[0], texels[1], 4 * vec_size) != 0) {
+         success = FALSE;
+
+         fprintf(stderr, "MISMATCH: %s\n", util_format_name(test->format));
+         if (verbose >= 1) {
+            unsigned chan;
+            fprintf(stderr, "  linear:");
+            for (chan = 0; chan < 4; chan++)
+               dump_vec(stderr, type, texels[0] + chan * vec_size);
+            fprintf(stderr, "\n  tiled: ");
+            for (chan = 0; chan < 4; chan++)
+               dump_vec(stderr, type, texels[1] + chan * vec_size);
+            fprintf(stderr, "\n");
+         }
+         break;
+      }
+   }
+
+   num_vecs = walk_coords(test, &tex, type.length, coords, lod);
+   for (i = 0; i < 2; i++) {
+      cycles[i] = time_walk(sample[i], coords, lod, num_vecs, vec_size,
+                            texels[i]);
+      cycles[i] /= num_vecs * type.length;
+   }
+
+   if (fp)
+      write_tsv_row(fp, test, cycles[0], cycles[1], success);
+
+   align_free(coords);
+   align_free(lod);
+   align_free(texels[0]);
+   align_free(texels[1]);
+
+   gallivm_destroy(gallivm);
+   LLVMContextDispose(context);
+
+   free_test_texture(&tex);
+
+   return success;
+}
+
+
+boolean
+test_all(unsigned verbose, FILE *fp)
+{
+   boolean success = TRUE;
+   unsigned i;
+
+   for (i = 0; i < ARRAY_SIZE(test_cases); i++) {
+      if (!test_one(verbose, fp, &test_cases[i]))
+         success = FALSE;
+   }
+
+   return success;
+}
+
+
+boolean
+test_some(unsigned verbose, FILE *fp,
+          unsigned long n)
+{
+   return test_all(verbose, fp);
+}
+
+
+boolean
+test_single(unsigned verbose, FILE *fp)
+{
+   printf("no test_single()");
+   return TRUE;
+}
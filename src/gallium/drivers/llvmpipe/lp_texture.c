@@ -35,6 +35,8 @@
 #include "pipe/p_context.h"
 #include "pipe/p_defines.h"
 
+#include "os/os_mman.h"
+#include "util/anon_file.h"
 #include "util/u_inlines.h"
 #include "util/u_cpu_detect.h"
 #include "util/u_format.h"
@@ -44,6 +46,7 @@
 #include "util/u_transfer.h"
 
 #include "lp_context.h"
+#include "lp_debug.h"
 #include "lp_flush.h"
 #include "lp_screen.h"
 #include "lp_texture.h"
@@ -51,8 +54,15 @@
 #include "lp_state.h"
 #include "lp_rast.h"
 
+#include "gallivm/lp_bld_sample.h"
 #include "state_tracker/sw_winsys.h"
 
+#if defined(PIPE_OS_UNIX)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 
 #ifdef DEBUG
 static struct llvmpipe_resource resource_list;
@@ -60,6 +70,249 @@ static struct llvmpipe_resource resource_list;
 static unsigned id_counter = 0;
 
 
+/**
+ * A memory object imported from an fd.  Resources created from it map the
+ * part of the file they use themselves, so the memory object can be
+ * destroyed before them.
+ */
+struct llvmpipe_memory_object
+{
+   struct pipe_memory_object b;
+   int fd;
+   uint64_t size;
+};
+
+
+#if defined(PIPE_OS_UNIX)
+/**
+ * Map \p size bytes of \p fd at \p offset, which needn't be page aligned.
+ * The mapping is owned by the resource and unmapped when it's destroyed.
+ * \return the address of the data at \p offset, or NULL on failure.
+ */
+static void *
+llvmpipe_resource_map_fd(struct llvmpipe_resource *lpr, int fd,
+                         uint64_t offset, uint64_t size)
+{
+   const uint64_t page_size = sysconf(_SC_PAGESIZE);
+   const uint64_t map_offset = offset - offset % page_size;
+   void *map;
+
+   lpr->mmap_size = offset - map_offset + size;
+   map = os_mmap(NULL, lpr->mmap_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                 fd, map_offset);
+   if (map == MAP_FAILED)
+      return NULL;
+
+   lpr->mmap_ptr = map;
+   return (ubyte *) map + (offset - map_offset);
+}
+
+
+/**
+ * Allocate the storage of a shareable resource in an anonymous file (a
+ * memfd on Linux), so that it can be exported with resource_get_handle.
+ * The file is zero-filled to begin with.
+ */
+static void *
+llvmpipe_resource_alloc_fd(struct llvmpipe_resource *lpr, uint64_t size)
+{
+   void *data;
+
+   lpr->fd = os_create_anonymous_file(size, "llvmpipe");
+   if (lpr->fd < 0)
+      return NULL;
+
+   data = llvmpipe_resource_map_fd(lpr, lpr->fd, 0, size);
+   if (!data) {
+      close(lpr->fd);
+      lpr->fd = -1;
+   }
+
+   return data;
+}
+#endif
+
+
+/**
+ * Whether to store a texture in tiles (see LP_TEX_TILE_SIZE), which keeps
+ * the texels of bilinear footprints and of small minified areas in the same
+ * cache lines.  Only sampling deals with tiles, so textures start tiled but
+ * are made linear for good when they're first rendered to or bound as a
+ * shader image (see llvmpipe_resource_untile()).  It's only done when asked
+ * for with LP_PERF=tiled_tex.  The layout computed by
+ * llvmpipe_texture_layout() is padded to whole 4x4 blocks anyway, so it's
+ * the same for tiled textures.
+ */
+static boolean
+llvmpipe_texture_can_tile(const struct pipe_resource *pt)
+{
+   const struct util_format_description *desc =
+      util_format_description(pt->format);
+
+   if (!(LP_PERF & PERF_TILED_TEX))
+      return FALSE;
+
+   if (pt->nr_samples > 1 ||
+       desc->block.width != 1 ||
+       desc->block.height != 1)
+      return FALSE;
+
+   switch (pt->target) {
+   case PIPE_TEXTURE_2D:
+   case PIPE_TEXTURE_RECT:
+   case PIPE_TEXTURE_2D_ARRAY:
+   case PIPE_TEXTURE_CUBE:
+   case PIPE_TEXTURE_CUBE_ARRAY:
+   case PIPE_TEXTURE_3D:
+      return TRUE;
+   default:
+      return FALSE;
+   }
+}
+
+
+/**
+ * Copy LP_TEX_TILE_SIZE texels, which the compiler turns into a few vector
+ * moves for the common texel sizes.
+ */
+static inline void
+llvmpipe_copy_tile_row(ubyte *dst, const ubyte *src, unsigned bpp)
+{
+   switch (bpp) {
+   case 1:
+      memcpy(dst, src, LP_TEX_TILE_SIZE * 1);
+      break;
+   case 2:
+      memcpy(dst, src, LP_TEX_TILE_SIZE * 2);
+      break;
+   case 4:
+      memcpy(dst, src, LP_TEX_TILE_SIZE * 4);
+      break;
+   case 8:
+      memcpy(dst, src, LP_TEX_TILE_SIZE * 8);
+      break;
+   case 16:
+      memcpy(dst, src, LP_TEX_TILE_SIZE * 16);
+      break;
+   default:
+      memcpy(dst, src, LP_TEX_TILE_SIZE * bpp);
+      break;
+   }
+}
+
+
+/**
+ * Copy a box of texels between a tiled image (starting at the box's first
+ * layer) and a linear one holding just the box.
+ */
+static void
+llvmpipe_tiled_copy_box(ubyte *tiled, unsigned row_stride, unsigned img_stride,
+                        ubyte *linear, unsigned stride, unsigned layer_stride,
+                        unsigned bpp, const struct pipe_box *box,
+                        boolean to_tiled)
+{
+   const unsigned tile_row_size = LP_TEX_TILE_SIZE * bpp;
+   const unsigned tile_mask = LP_TEX_TILE_SIZE - 1;
+   const unsigned x_end = box->x + box->width;
+   int y, z;
+
+   for (z = 0; z < box->depth; z++) {
+      for (y = 0; y < box->height; y++) {
+         const unsigned ty = box->y + y;
+         ubyte *tiled_row = tiled + z * img_stride +
+                            (ty & ~tile_mask) * row_stride +
+                            (ty & tile_mask) * tile_row_size;
+         ubyte *linear_row = linear + z * layer_stride + y * stride;
+         unsigned x = box->x;
+
+         while (x < x_end) {
+            const unsigned n = MIN2(LP_TEX_TILE_SIZE - (x & tile_mask),
+                                    x_end - x);
+            ubyte *t = tiled_row + (x & ~tile_mask) * tile_row_size +
+                       (x & tile_mask) * bpp;
+            ubyte *l = linear_row + (x - box->x) * bpp;
+
+            if (n == LP_TEX_TILE_SIZE) {
+               if (to_tiled)
+                  llvmpipe_copy_tile_row(t, l, bpp);
+               else
+                  llvmpipe_copy_tile_row(l, t, bpp);
+            }
+            else {
+               if (to_tiled)
+                  memcpy(t, l, n * bpp);
+               else
+                  memcpy(l, t, n * bpp);
+            }
+
+            x += n;
+         }
+      }
+   }
+}
+
+
+/**
+ * Make a tiled texture linear, which it stays from then on.  This has to
+ * happen before it's rendered to or bound as a shader image, as only the
+ * sampling code knows about tiles.  The texture is untiled into new storage,
+ * because scenes that any context has already queued still sample the tiles
+ * with shaders built for them.  The tiles are kept until the texture is
+ * destroyed.  Every context rebuilds its shaders sampling the texture at its
+ * next draw or dispatch, see tiling_timestamp.
+ */
+boolean
+llvmpipe_resource_untile(struct pipe_resource *pt)
+{
+   struct llvmpipe_resource *lpr = llvmpipe_resource(pt);
+   struct llvmpipe_screen *screen = llvmpipe_screen(pt->screen);
+   const unsigned bpp = util_format_get_blocksize(pt->format);
+   unsigned level;
+   ubyte *linear;
+
+   if (!(pt->flags & LP_RESOURCE_FLAG_TILED))
+      return TRUE;
+
+   /* Only malloc'ed textures are tiled, see llvmpipe_texture_can_tile() */
+   assert(!lpr->dt && !lpr->mmap_ptr && !lpr->userBuffer);
+
+   linear = align_malloc(lpr->total_alloc_size,
+                         MAX2(64, util_cpu_caps.cacheline));
+   if (!linear)
+      return FALSE;
+
+   for (level = 0; level <= pt->last_level; level++) {
+      const unsigned row_stride = lpr->row_stride[level];
+      const unsigned tile_row_size = LP_TEX_TILE_SIZE * row_stride;
+      const unsigned num_slices = pt->target == PIPE_TEXTURE_3D ?
+                                  u_minify(pt->depth0, level) : pt->array_size;
+      const unsigned num_tile_rows =
+         lpr->img_stride[level] / tile_row_size * num_slices;
+      ubyte *tiles = (ubyte *) lpr->tex_data + lpr->mip_offsets[level];
+      ubyte *rows = linear + lpr->mip_offsets[level];
+      struct pipe_box box;
+      unsigned i;
+
+      /* A row of tiles takes the same bytes as the rows of texels it holds */
+      u_box_2d(0, 0, align(u_minify(pt->width0, level), LP_TEX_TILE_SIZE),
+               LP_TEX_TILE_SIZE, &box);
+
+      for (i = 0; i < num_tile_rows; i++) {
+         llvmpipe_tiled_copy_box(tiles + i * tile_row_size, row_stride, 0,
+                                 rows + i * tile_row_size, row_stride, 0,
+                                 bpp, &box, FALSE);
+      }
+   }
+
+   lpr->tiled_data = lpr->tex_data;
+   lpr->tex_data = linear;
+   pt->flags &= ~LP_RESOURCE_FLAG_TILED;
+   p_atomic_inc(&screen->tiling_timestamp);
+
+   return TRUE;
+}
+
+
 /**
  * Conventional allocation path for non-display textures:
  * Compute strides and allocate data (unless asked not to).
@@ -166,6 +419,8 @@ llvmpipe_texture_layout(struct llvmpipe_screen *screen,
       depth = u_minify(depth, 1);
    }
 
+   lpr->total_alloc_size = total_size;
+
    if (allocate) {
       lpr->tex_data = align_malloc(total_size, mip_align);
       if (!lpr->tex_data) {
@@ -183,6 +438,24 @@ fail:
 }
 
 
+/**
+ * Fill in the size of every mipmap level, which the sampling code loads
+ * instead of minifying the base size.  All levels are filled, as texel
+ * fetches use level 0 for out of range levels, whatever the view.
+ */
+static void
+llvmpipe_resource_fill_level_sizes(struct llvmpipe_resource *lpr)
+{
+   unsigned level;
+
+   for (level = 0; level < LP_MAX_TEXTURE_LEVELS; level++) {
+      lpr->level_sizes[level][0] = u_minify(lpr->base.width0, level);
+      lpr->level_sizes[level][1] = u_minify(lpr->base.height0, level);
+      lpr->level_sizes[level][2] = u_minify(lpr->base.depth0, level);
+      lpr->level_sizes[level][3] = 0;
+   }
+}
+
 /**
  * Check the size of the texture specified by 'res'.
  * \return TRUE if OK, FALSE if too large.
@@ -222,6 +495,8 @@ llvmpipe_displaytarget_layout(struct llvmpipe_screen *screen,
    if (lpr->dt == NULL)
       return FALSE;
 
+   llvmpipe_resource_damage_all(lpr);
+
    if (!map_front_private) {
       void *map = winsys->displaytarget_map(winsys, lpr->dt,
                                             PIPE_TRANSFER_WRITE);
@@ -262,6 +537,10 @@ llvmpipe_resource_create_front(struct pipe_screen *_screen,
       }
       else {
          /* texture map */
+         lpr->base.flags &= ~LP_RESOURCE_FLAG_TILED;
+         if (llvmpipe_texture_can_tile(&lpr->base))
+            lpr->base.flags |= LP_RESOURCE_FLAG_TILED;
+
          if (!llvmpipe_texture_layout(screen, lpr, true))
             goto fail;
       }
@@ -278,7 +557,14 @@ llvmpipe_resource_create_front(struct pipe_screen *_screen,
        * read/write always LP_RASTER_BLOCK_SIZE pixels, but the element
        * offset doesn't need to be aligned to LP_RASTER_BLOCK_SIZE.
        */
-      lpr->data = align_malloc(bytes + (LP_RASTER_BLOCK_SIZE - 1) * 4 * sizeof(float), 64);
+      const uint size = bytes + (LP_RASTER_BLOCK_SIZE - 1) * 4 * sizeof(float);
+
+#if defined(PIPE_OS_UNIX)
+      if (templat->bind & PIPE_BIND_SHARED)
+         lpr->data = llvmpipe_resource_alloc_fd(lpr, size);
+      else
+#endif
+         lpr->data = align_malloc(size, 64);
 
       /*
        * buffers don't really have stride but it's probably safer
@@ -291,6 +577,7 @@ llvmpipe_resource_create_front(struct pipe_screen *_screen,
       memset(lpr->data, 0, bytes);
    }
 
+   llvmpipe_resource_fill_level_sizes(lpr);
    lpr->id = id_counter++;
 
 #ifdef DEBUG
@@ -325,12 +612,21 @@ llvmpipe_resource_destroy(struct pipe_screen *pscreen,
       struct sw_winsys *winsys = screen->winsys;
       winsys->displaytarget_destroy(winsys, lpr->dt);
    }
+#if defined(PIPE_OS_UNIX)
+   else if (lpr->mmap_ptr) {
+      /* shareable or imported storage */
+      os_munmap(lpr->mmap_ptr, lpr->mmap_size);
+      if (lpr->fd >= 0)
+         close(lpr->fd);
+   }
+#endif
    else if (llvmpipe_resource_is_texture(pt)) {
       /* free linear image data */
-      if (lpr->tex_data) {
+      if (lpr->tex_data && !lpr->userBuffer) {
          align_free(lpr->tex_data);
          lpr->tex_data = NULL;
       }
+      align_free(lpr->tiled_data);
    }
    else if (!lpr->userBuffer) {
       assert(lpr->data);
@@ -471,6 +767,9 @@ llvmpipe_resource_from_handle(struct pipe_screen *screen,
       goto no_dt;
    }
 
+   llvmpipe_resource_damage_all(lpr);
+
+   llvmpipe_resource_fill_level_sizes(lpr);
    lpr->id = id_counter++;
 
 #ifdef DEBUG
@@ -486,6 +785,98 @@ no_lpr:
 }
 
 
+/**
+ * Wrap application memory holding a buffer, or a single 2D image with rows
+ * packed without padding.
+ *
+ * We render 4x4 blocks at a time and the generated code relies on rows
+ * starting on 16 byte boundaries, so images we render to must be made of
+ * whole blocks.  Buffers can't have the padding we normally allocate past
+ * their end for rendering, so they can't be render targets.  NULL is
+ * returned for anything else, and the caller is expected to fall back to an
+ * ordinary resource.
+ */
+static struct pipe_resource *
+llvmpipe_resource_from_user_memory(struct pipe_screen *screen,
+                                   const struct pipe_resource *templat,
+                                   void *user_memory)
+{
+   struct llvmpipe_resource *lpr;
+   unsigned row_stride;
+
+   if (templat->target == PIPE_BUFFER) {
+      if ((uintptr_t) user_memory % 16 != 0 ||
+          (templat->bind & PIPE_BIND_RENDER_TARGET))
+         return NULL;
+
+      lpr = CALLOC_STRUCT(llvmpipe_resource);
+      if (!lpr)
+         return NULL;
+
+      lpr->base = *templat;
+      pipe_reference_init(&lpr->base.reference, 1);
+      lpr->base.screen = screen;
+
+      lpr->row_stride[0] = templat->width0;
+      lpr->data = user_memory;
+      lpr->userBuffer = TRUE;
+      llvmpipe_resource_fill_level_sizes(lpr);
+      lpr->id = id_counter++;
+
+#ifdef DEBUG
+      insert_at_tail(&resource_list, lpr);
+#endif
+
+      return &lpr->base;
+   }
+
+   if ((templat->target != PIPE_TEXTURE_2D &&
+        templat->target != PIPE_TEXTURE_RECT) ||
+       templat->last_level != 0 ||
+       templat->depth0 != 1 ||
+       templat->array_size != 1 ||
+       templat->nr_samples > 1 ||
+       util_format_is_compressed(templat->format))
+      return NULL;
+
+   row_stride = util_format_get_stride(templat->format, templat->width0);
+
+   if ((uintptr_t) user_memory % 16 != 0 || row_stride % 16 != 0)
+      return NULL;
+
+   if ((templat->bind & (PIPE_BIND_RENDER_TARGET | PIPE_BIND_DEPTH_STENCIL)) &&
+       (templat->width0 % LP_RASTER_BLOCK_SIZE != 0 ||
+        templat->height0 % LP_RASTER_BLOCK_SIZE != 0))
+      return NULL;
+
+   if ((uint64_t) row_stride * templat->height0 > LP_MAX_TEXTURE_SIZE)
+      return NULL;
+
+   lpr = CALLOC_STRUCT(llvmpipe_resource);
+   if (!lpr)
+      return NULL;
+
+   lpr->base = *templat;
+   pipe_reference_init(&lpr->base.reference, 1);
+   lpr->base.screen = screen;
+
+   lpr->row_stride[0] = row_stride;
+   lpr->img_stride[0] = row_stride * templat->height0;
+   lpr->mip_offsets[0] = 0;
+   lpr->tex_data = user_memory;
+   lpr->userBuffer = TRUE;
+
+   llvmpipe_resource_fill_level_sizes(lpr);
+   lpr->id = id_counter++;
+
+#ifdef DEBUG
+   insert_at_tail(&resource_list, lpr);
+#endif
+
+   return &lpr->base;
+}
+
+
 static bool
 llvmpipe_resource_get_handle(struct pipe_screen *screen,
                              struct pipe_context *ctx,
@@ -496,12 +887,137 @@ llvmpipe_resource_get_handle(struct pipe_screen *screen,
    struct sw_winsys *winsys = llvmpipe_screen(screen)->winsys;
    struct llvmpipe_resource *lpr = llvmpipe_resource(pt);
 
-   assert(lpr->dt);
-   if (!lpr->dt)
-      return false;
+   if (lpr->dt)
+      return winsys->displaytarget_get_handle(winsys, lpr->dt, whandle);
+
+#if defined(PIPE_OS_UNIX)
+   /* storage allocated in an anonymous file */
+   if (lpr->mmap_ptr && lpr->fd >= 0 &&
+       whandle->type == WINSYS_HANDLE_TYPE_FD) {
+      whandle->handle = fcntl(lpr->fd, F_DUPFD_CLOEXEC, 0);
+      whandle->stride = lpr->row_stride[0];
+      whandle->offset = 0;
+      return (int) whandle->handle >= 0;
+   }
+#endif
+
+   return false;
+}
+
+
+#if defined(PIPE_OS_UNIX)
+static struct pipe_memory_object *
+llvmpipe_memobj_create_from_handle(struct pipe_screen *screen,
+                                   struct winsys_handle *whandle,
+                                   bool dedicated)
+{
+   struct llvmpipe_memory_object *memobj;
+   struct stat st;
+
+   if (whandle->type != WINSYS_HANDLE_TYPE_FD ||
+       fstat(whandle->handle, &st) != 0)
+      return NULL;
+
+   memobj = CALLOC_STRUCT(llvmpipe_memory_object);
+   if (!memobj)
+      return NULL;
+
+   /* The caller keeps ownership of the fd it passed */
+   memobj->fd = fcntl(whandle->handle, F_DUPFD_CLOEXEC, 0);
+   if (memobj->fd < 0) {
+      FREE(memobj);
+      return NULL;
+   }
+
+   memobj->b.dedicated = dedicated;
+   memobj->size = st.st_size;
+
+   return &memobj->b;
+}
+
+
+static void
+llvmpipe_memobj_destroy(struct pipe_screen *screen,
+                        struct pipe_memory_object *_memobj)
+{
+   struct llvmpipe_memory_object *memobj =
+      (struct llvmpipe_memory_object *) _memobj;
+
+   close(memobj->fd);
+   FREE(memobj);
+}
+
+
+/**
+ * Create a resource using the memory at \p offset of a memory object,
+ * which must hold it in the same layout as llvmpipe_texture_layout() would
+ * give it.  Buffers don't get the padding past their end needed to render
+ * to them.
+ */
+static struct pipe_resource *
+llvmpipe_resource_from_memobj(struct pipe_screen *screen,
+                              const struct pipe_resource *templat,
+                              struct pipe_memory_object *_memobj,
+                              uint64_t offset)
+{
+   struct llvmpipe_memory_object *memobj =
+      (struct llvmpipe_memory_object *) _memobj;
+   struct llvmpipe_resource *lpr;
+   uint64_t size;
+   void *data;
+
+   if (offset % 16 != 0)
+      return NULL;
+
+   if (templat->target == PIPE_BUFFER &&
+       (templat->bind & PIPE_BIND_RENDER_TARGET))
+      return NULL;
+
+   lpr = CALLOC_STRUCT(llvmpipe_resource);
+   if (!lpr)
+      return NULL;
+
+   lpr->base = *templat;
+   pipe_reference_init(&lpr->base.reference, 1);
+   lpr->base.screen = screen;
+   lpr->fd = -1;
 
-   return winsys->displaytarget_get_handle(winsys, lpr->dt, whandle);
+   if (llvmpipe_resource_is_texture(&lpr->base)) {
+      if (!llvmpipe_texture_layout(llvmpipe_screen(screen), lpr, false))
+         goto fail;
+      size = lpr->total_alloc_size;
+   }
+   else {
+      lpr->row_stride[0] = templat->width0;
+      size = templat->width0;
+   }
+
+   if (offset + size > memobj->size)
+      goto fail;
+
+   data = llvmpipe_resource_map_fd(lpr, memobj->fd, offset, size);
+   if (!data)
+      goto fail;
+
+   if (llvmpipe_resource_is_texture(&lpr->base))
+      lpr->tex_data = data;
+   else
+      lpr->data = data;
+
+   llvmpipe_resource_fill_level_sizes(lpr);
+   lpr->id = id_counter++;
+
+#ifdef DEBUG
+   insert_at_tail(&resource_list, lpr);
+#endif
+
+   return &lpr->base;
+
+ fail:
+   FREE(lpr);
+   return NULL;
 }
+#endif
 
 
 static void *
@@ -546,6 +1062,21 @@ llvmpipe_transfer_map( struct pipe_context *pipe,
       }
    }
 
+   /* Tiled textures are only mapped through a linear copy */
+   if ((resource->flags & LP_RESOURCE_FLAG_TILED) &&
+       (usage & PIPE_TRANSFER_MAP_DIRECTLY))
+      return NULL;
+
+   if ((usage & PIPE_TRANSFER_WRITE) && lpr->dt) {
+      struct u_rect rect;
+
+      rect.x0 = box->x;
+      rect.y0 = box->y;
+      rect.x1 = box->x + box->width - 1;
+      rect.y1 = box->y + box->height - 1;
+      llvmpipe_resource_add_damage(lpr, &rect);
+   }
+
    /* Check if we're mapping a current constant buffer */
    if ((usage & PIPE_TRANSFER_WRITE) &&
        (resource->bind & PIPE_BIND_CONSTANT_BUFFER)) {
@@ -611,6 +1142,32 @@ llvmpipe_transfer_map( struct pipe_context *pipe,
       screen->timestamp++;
    }
 
+   if (resource->flags & LP_RESOURCE_FLAG_TILED) {
+      const unsigned bpp = util_format_get_blocksize(format);
+
+      pt->stride = align(box->width * bpp, 16);
+      pt->layer_stride = pt->stride * box->height;
+
+      lpt->staging = align_malloc(pt->layer_stride * box->depth, 64);
+      if (!lpt->staging) {
+         llvmpipe_resource_unmap(resource, level, box->z);
+         pipe_resource_reference(&pt->resource, NULL);
+         FREE(lpt);
+         *transfer = NULL;
+         return NULL;
+      }
+
+      if (!(usage & (PIPE_TRANSFER_DISCARD_RANGE |
+                     PIPE_TRANSFER_DISCARD_WHOLE_RESOURCE))) {
+         llvmpipe_tiled_copy_box(map, lpr->row_stride[level],
+                                 lpr->img_stride[level],
+                                 lpt->staging, pt->stride, pt->layer_stride,
+                                 bpp, box, FALSE);
+      }
+
+      return lpt->staging;
+   }
+
    map +=
       box->y / util_format_get_blockheight(format) * pt->stride +
       box->x / util_format_get_blockwidth(format) * util_format_get_blocksize(format);
@@ -623,16 +1180,36 @@ static void
 llvmpipe_transfer_unmap(struct pipe_context *pipe,
                         struct pipe_transfer *transfer)
 {
+   struct llvmpipe_transfer *lpt = llvmpipe_transfer(transfer);
+
    assert(transfer->resource);
 
+   /* Put the linear copy of a tiled texture back in place */
+   if (lpt->staging) {
+      if (transfer->usage & PIPE_TRANSFER_WRITE) {
+         struct llvmpipe_resource *lpr = llvmpipe_resource(transfer->resource);
+         ubyte *map = llvmpipe_resource_map(transfer->resource,
+                                            transfer->level,
+                                            transfer->box.z,
+                                            LP_TEX_USAGE_READ_WRITE);
+
+         llvmpipe_tiled_copy_box(map, lpr->row_stride[transfer->level],
+                                 lpr->img_stride[transfer->level],
+                                 lpt->staging, transfer->stride,
+                                 transfer->layer_stride,
+                                 util_format_get_blocksize(lpr->base.format),
+                                 &transfer->box, TRUE);
+         llvmpipe_resource_unmap(transfer->resource,
+                                 transfer->level,
+                                 transfer->box.z);
+      }
+      align_free(lpt->staging);
+   }
+
    llvmpipe_resource_unmap(transfer->resource,
                            transfer->level,
                            transfer->box.z);
 
-   /* Effectively do the texture_update work here - if texture images
-    * needed post-processing to put them into hardware layout, this is
-    * where it would happen.  For llvmpipe, nothing to do.
-    */
    assert (transfer->resource);
    pipe_resource_reference(&transfer->resource, NULL);
    FREE(transfer);
@@ -817,6 +1394,12 @@ llvmpipe_init_screen_resource_funcs(struct pipe_screen *screen)
 /*   screen->resource_create_front = llvmpipe_resource_create_front; */
    screen->resource_destroy = llvmpipe_resource_destroy;
    screen->resource_from_handle = llvmpipe_resource_from_handle;
+   screen->resource_from_user_memory = llvmpipe_resource_from_user_memory;
+#if defined(PIPE_OS_UNIX)
+   screen->memobj_create_from_handle = llvmpipe_memobj_create_from_handle;
+   screen->memobj_destroy = llvmpipe_memobj_destroy;
+   screen->resource_from_memobj = llvmpipe_resource_from_memobj;
+#endif
    screen->resource_get_handle = llvmpipe_resource_get_handle;
    screen->can_create_resource = llvmpipe_can_create_resource;
 }
@@ -29,8 +29,10 @@
 #define LP_TEXTURE_H
 
 
+#include <limits.h>
 #include "pipe/p_state.h"
 #include "util/u_debug.h"
+#include "util/u_rect.h"
 #include "lp_limits.h"
 
 
@@ -66,6 +68,8 @@ struct llvmpipe_resource
    unsigned img_stride[LP_MAX_TEXTURE_LEVELS];
    /** Offset to start of mipmap level, in bytes */
    unsigned mip_offsets[LP_MAX_TEXTURE_LEVELS];
+   /** Width, height, depth of each mipmap level, and a zero */
+   uint32_t level_sizes[LP_MAX_TEXTURE_LEVELS][4];
    /** allocated total size (for non-display target texture resources only) */
    unsigned total_alloc_size;
 
@@ -80,12 +84,33 @@ struct llvmpipe_resource
     */
    void *tex_data;
 
+   /**
+    * The tiled storage tex_data had before llvmpipe_resource_untile(), which
+    * scenes queued before may still be sampling.
+    */
+   void *tiled_data;
+
    /**
     * Data for non-texture resources.
     */
    void *data;
 
-   boolean userBuffer;  /** Is this a user-space buffer? */
+   /**
+    * Part of a display target changed since it was last presented, in
+    * pixels, inclusive.  Empty when x1 < x0.
+    */
+   struct u_rect damage;
+
+   /**
+    * Mapping of a file backing tex_data or data, for resources that can be
+    * exported as an fd or were created from a memory object.  fd is the
+    * file if we own it, or -1.  Only valid when mmap_ptr is set.
+    */
+   void *mmap_ptr;
+   size_t mmap_size;
+   int fd;
+
+   boolean userBuffer;  /** Is the memory owned by the application? */
    unsigned timestamp;
 
    unsigned id;  /**< temporary, for debugging */
@@ -102,6 +127,9 @@ struct llvmpipe_transfer
    struct pipe_transfer base;
 
    unsigned long offset;
+
+   /** Linear copy of the box, for tiled textures */
+   void *staging;
 };
 
 
@@ -120,6 +148,33 @@ llvmpipe_resource_const(const struct pipe_resource *pt)
 }
 
 
+static inline void
+llvmpipe_resource_clear_damage(struct llvmpipe_resource *lpr)
+{
+   lpr->damage.x0 = lpr->damage.y0 = INT_MAX;
+   lpr->damage.x1 = lpr->damage.y1 = -1;
+}
+
+
+static inline void
+llvmpipe_resource_damage_all(struct llvmpipe_resource *lpr)
+{
+   lpr->damage.x0 = 0;
+   lpr->damage.y0 = 0;
+   lpr->damage.x1 = lpr->base.width0 - 1;
+   lpr->damage.y1 = lpr->base.height0 - 1;
+}
+
+
+static inline void
+llvmpipe_resource_add_damage(struct llvmpipe_resource *lpr,
+                             const struct u_rect *rect)
+{
+   if (lpr->dt)
+      u_rect_union(&lpr->damage, &lpr->damage, rect);
+}
+
+
 static inline struct llvmpipe_transfer *
 llvmpipe_transfer(struct pipe_transfer *pt)
 {
@@ -236,4 +291,7 @@ llvmpipe_is_resource_referenced( struct pipe_context *pipe,
 unsigned
 llvmpipe_get_format_alignment(enum pipe_format format);
 
+boolean
+llvmpipe_resource_untile(struct pipe_resource *pt);
+
 #endif /* LP_TEXTURE_H */
@@ -250,6 +250,41 @@ softpipe_resource_from_handle(struct pipe_screen *screen,
 }
 
 
+/**
+ * Wrap application memory laid out like softpipe_resource_layout() would,
+ * i.e. with tightly packed rows, images and levels.
+ */
+static struct pipe_resource *
+softpipe_resource_from_user_memory(struct pipe_screen *screen,
+                                   const struct pipe_resource *templat,
+                                   void *user_memory)
+{
+   struct softpipe_resource *spr = CALLOC_STRUCT(softpipe_resource);
+   if (!spr)
+      return NULL;
+
+   spr->base = *templat;
+   pipe_reference_init(&spr->base.reference, 1);
+   spr->base.screen = screen;
+
+   spr->pot = (util_is_power_of_two_or_zero(templat->width0) &&
+               util_is_power_of_two_or_zero(templat->height0) &&
+               util_is_power_of_two_or_zero(templat->depth0));
+
+   if (!softpipe_resource_layout(screen, spr, FALSE))
+      goto fail;
+
+   spr->data = user_memory;
+   spr->userBuffer = TRUE;
+
+   return &spr->base;
+
+ fail:
+   FREE(spr);
+   return NULL;
+}
+
+
 static bool
 softpipe_resource_get_handle(struct pipe_screen *screen,
                              struct pipe_context *ctx,
@@ -532,6 +567,7 @@ softpipe_init_screen_texture_funcs(struct pipe_screen *screen)
    screen->resource_create_front = softpipe_resource_create_front;
    screen->resource_destroy = softpipe_resource_destroy;
    screen->resource_from_handle = softpipe_resource_from_handle;
+   screen->resource_from_user_memory = softpipe_resource_from_user_memory;
    screen->resource_get_handle = softpipe_resource_get_handle;
    screen->can_create_resource = softpipe_can_create_resource;
 }
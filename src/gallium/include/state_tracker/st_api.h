@@ -311,6 +311,13 @@ struct st_framebuffer_iface
     */
    const struct st_visual *visual;
 
+   /**
+    * Whether the rows of the attachments are stored bottom to top, in the
+    * order of GL window coordinates, rather than top to bottom like window
+    * systems do.  Checked again whenever the stamp changes.
+    */
+   bool bottom_up;
+
    /**
     * Flush the front buffer.
     *
@@ -31,16 +31,14 @@
  * Otherwise we use softpipe.  The GALLIUM_DRIVER environment variable
  * may be set to "softpipe" or "llvmpipe" to override.
  *
- * With softpipe we could render directly into the user's buffer by using a
- * display target resource.  However, softpipe doesn't support "upside-down"
- * rendering which would be needed for the OSMESA_Y_UP=TRUE case.
- *
- * With llvmpipe we could only render directly into the user's buffer when its
- * width and height is a multiple of the tile size (64 pixels).
- *
- * Because of these constraints we always render into ordinary resources then
- * copy the results to the user's buffer in the flush_front() function which
- * is called when the app calls glFlush/Finish.
+ * When the driver can wrap the user's buffer in a resource (see
+ * pipe_screen::resource_from_user_memory) we render directly into it.  The
+ * OSMESA_Y_UP=TRUE case doesn't need a flip: the framebuffer is set up to
+ * store its rows bottom to top, like user FBOs.  The driver may still refuse
+ * the buffer (llvmpipe only renders into images made of whole 4x4 blocks)
+ * and OSMESA_ROW_LENGTH padding isn't supported there, so otherwise we render
+ * into ordinary resources then copy the results to the user's buffer in the
+ * flush_front() function which is called when the app calls glFlush/Finish.
  *
  * In general, the OSMesa interface is pretty ugly and not a good match
  * for Gallium.  But we're interested in doing the best we can to preserve
@@ -89,6 +87,9 @@ struct osmesa_buffer
 
    void *map;
 
+   /** The user's buffer that the color texture wraps, or NULL */
+   void *color_map;
+
    struct osmesa_buffer *next;  /**< next in linked list */
 };
 
@@ -322,8 +323,10 @@ osmesa_st_framebuffer_flush_front(struct st_context_iface *stctx,
    OSMesaContext osmesa = OSMesaGetCurrentContext();
    struct osmesa_buffer *osbuffer = stfbi_to_osbuffer(stfbi);
    struct pipe_context *pipe = stctx->pipe;
+   struct pipe_screen *screen = pipe->screen;
    struct pipe_resource *res = osbuffer->textures[statt];
    struct pipe_transfer *transfer = NULL;
+   struct pipe_fence_handle *fence = NULL;
    struct pipe_box box;
    void *map;
    ubyte *src, *dst;
@@ -352,6 +355,16 @@ osmesa_st_framebuffer_flush_front(struct st_context_iface *stctx,
       pp_run(osmesa->pp, res, res, zsbuf);
    }
 
+   if (osbuffer->color_map) {
+      /* We rendered into the user's buffer, just wait for the rendering */
+      pipe->flush(pipe, &fence, 0);
+      if (fence) {
+         screen->fence_finish(screen, NULL, fence, PIPE_TIMEOUT_INFINITE);
+         screen->fence_reference(screen, &fence, NULL);
+      }
+      return true;
+   }
+
    u_box_2d(0, 0, res->width0, res->height0, &box);
 
    map = pipe->transfer_map(pipe, res, 0, PIPE_TRANSFER_READ, &box,
@@ -369,12 +382,7 @@ osmesa_st_framebuffer_flush_front(struct st_context_iface *stctx,
       dst_stride = bpp * osbuffer->width;
    bytes = bpp * res->width0;
 
-   if (osmesa->y_up) {
-      /* need to flip image upside down */
-      dst = dst + (res->height0 - 1) * dst_stride;
-      dst_stride = -dst_stride;
-   }
-
+   /* Rows are already in the order of OSMESA_Y_UP, see bottom_up */
    for (y = 0; y < res->height0; y++) {
       memcpy(dst, src, bytes);
       dst += dst_stride;
@@ -387,6 +395,41 @@ osmesa_st_framebuffer_flush_front(struct st_context_iface *stctx,
 }
 
 
+/**
+ * (Re)create the color texture if needed, wrapping the user's buffer when
+ * the driver allows it.
+ */
+static void
+validate_color_texture(OSMesaContext osmesa, struct osmesa_buffer *osbuffer,
+                       const struct pipe_resource *templat)
+{
+   struct pipe_screen *screen = get_st_manager()->screen;
+   struct pipe_resource **res = &osbuffer->textures[ST_ATTACHMENT_FRONT_LEFT];
+   const bool packed_rows = !osmesa->user_row_length ||
+      osmesa->user_row_length == osbuffer->width;
+   void *color_map =
+      screen->resource_from_user_memory && packed_rows ? osbuffer->map : NULL;
+
+   if (*res && (*res)->format == templat->format &&
+       (*res)->width0 == templat->width0 &&
+       (*res)->height0 == templat->height0 &&
+       osbuffer->color_map == color_map)
+      return;
+
+   pipe_resource_reference(res, NULL);
+   osbuffer->color_map = NULL;
+
+   if (color_map) {
+      *res = screen->resource_from_user_memory(screen, templat, color_map);
+      if (*res)
+         osbuffer->color_map = color_map;
+   }
+
+   if (!*res)
+      *res = screen->resource_create(screen, templat);
+}
+
+
 /**
  * Called by the st manager to validate the framebuffer (allocate
  * its resources).
@@ -398,6 +441,7 @@ osmesa_st_framebuffer_validate(struct st_context_iface *stctx,
                                unsigned count,
                                struct pipe_resource **out)
 {
+   OSMesaContext osmesa = (OSMesaContext) stctx->st_manager_private;
    struct pipe_screen *screen = get_st_manager()->screen;
    enum st_attachment_type i;
    struct osmesa_buffer *osbuffer = stfbi_to_osbuffer(stfbi);
@@ -443,9 +487,24 @@ osmesa_st_framebuffer_validate(struct st_context_iface *stctx,
 
       templat.format = format;
       templat.bind = bind;
-      pipe_resource_reference(&out[i], NULL);
-      out[i] = osbuffer->textures[statts[i]] =
-         screen->resource_create(screen, &templat);
+
+      if (statts[i] == ST_ATTACHMENT_FRONT_LEFT) {
+         validate_color_texture(osmesa, osbuffer, &templat);
+      }
+      else {
+         struct pipe_resource *res = osbuffer->textures[statts[i]];
+
+         /* Keep the contents of buffers that are still suitable */
+         if (!res || res->format != format ||
+             res->width0 != templat.width0 ||
+             res->height0 != templat.height0) {
+            pipe_resource_reference(&osbuffer->textures[statts[i]], NULL);
+            osbuffer->textures[statts[i]] =
+               screen->resource_create(screen, &templat);
+         }
+      }
+
+      pipe_resource_reference(&out[i], osbuffer->textures[statts[i]]);
    }
 
    return true;
@@ -531,6 +590,9 @@ osmesa_destroy_buffer(struct osmesa_buffer *osbuffer)
     */
    stapi->destroy_drawable(stapi, osbuffer->stfb);
 
+   for (unsigned i = 0; i < ARRAY_SIZE(osbuffer->textures); i++)
+      pipe_resource_reference(&osbuffer->textures[i], NULL);
+
    FREE(osbuffer->stfb);
    FREE(osbuffer);
 }
@@ -798,7 +860,12 @@ OSMesaMakeCurrent(OSMesaContext osmesa, void *buffer, GLenum type,
 
    osbuffer->width = width;
    osbuffer->height = height;
-   osbuffer->map = buffer;
+
+   if (osbuffer->map != buffer || osbuffer->stfb->bottom_up != osmesa->y_up) {
+      osbuffer->map = buffer;
+      osbuffer->stfb->bottom_up = osmesa->y_up;
+      p_atomic_inc(&osbuffer->stfb->stamp);
+   }
 
    /* XXX unused for now */
    (void) osmesa_destroy_buffer;
@@ -862,6 +929,12 @@ OSMesaPixelStore(GLint pname, GLint value)
       fprintf(stderr, "Invalid pname in OSMesaPixelStore()\n");
       return;
    }
+
+   /* Both change how we render into the user's buffer */
+   if (osmesa->current_buffer) {
+      osmesa->current_buffer->stfb->bottom_up = osmesa->y_up;
+      p_atomic_inc(&osmesa->current_buffer->stfb->stamp);
+   }
 }
 
 
@@ -28,8 +28,10 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <float.h>
 
+#include "util/os_time.h"
 #include "util/u_half.h"
 #include "util/u_format.h"
 #include "util/u_format_tests.h"
@@ -709,6 +711,79 @@ test_format_norm_flags(const struct util_format_description *format_desc)
    return success;
 }
 
+/* Odd, so that the row converters leave some pixels to the scalar code */
+#define ROW_WIDTH 37
+
+/**
+ * Check that converting a whole row gives the same results as converting
+ * each pixel on its own.  This covers the SIMD row converters some formats
+ * use.
+ */
+static boolean
+test_format_rows(const struct util_format_description *format_desc)
+{
+   const unsigned bytes = format_desc->block.bits / 8;
+   uint8_t packed[ROW_WIDTH * UTIL_FORMAT_MAX_PACKED_BYTES];
+   uint8_t packed_pixel[UTIL_FORMAT_MAX_PACKED_BYTES];
+   float unpacked_float[ROW_WIDTH][4], pixel_float[4];
+   uint8_t unpacked_8unorm[ROW_WIDTH][4], pixel_8unorm[4];
+   boolean success = TRUE;
+   unsigned x, i;
+
+   if (format_desc->layout != UTIL_FORMAT_LAYOUT_PLAIN ||
+       format_desc->block.bits % 8 != 0 || !format_desc->unpack_rgba_float)
+      return TRUE;
+
+   for (i = 0; i < sizeof(packed); i++)
+      packed[i] = rand();
+
+   format_desc->unpack_rgba_float(&unpacked_float[0][0], 0, packed, 0,
+                                  ROW_WIDTH, 1);
+   format_desc->unpack_rgba_8unorm(&unpacked_8unorm[0][0], 0, packed, 0,
+                                   ROW_WIDTH, 1);
+   for (x = 0; x < ROW_WIDTH; x++) {
+      format_desc->unpack_rgba_float(pixel_float, 0, packed + x * bytes, 0,
+                                     1, 1);
+      format_desc->unpack_rgba_8unorm(pixel_8unorm, 0, packed + x * bytes, 0,
+                                      1, 1);
+      if (memcmp(pixel_float, unpacked_float[x], sizeof(pixel_float)) ||
+          memcmp(pixel_8unorm, unpacked_8unorm[x], sizeof(pixel_8unorm)))
+         success = FALSE;
+   }
+
+   /* Include values out of [0, 1], and some halfway between unorm8 values */
+   for (x = 0; x < ROW_WIDTH; x++) {
+      for (i = 0; i < 4; i++) {
+         unpacked_float[x][i] = (rand() % 1024 - 256) / 510.0f;
+         unpacked_8unorm[x][i] = rand();
+      }
+   }
+
+   format_desc->pack_rgba_float(packed, 0, &unpacked_float[0][0], 0,
+                                ROW_WIDTH, 1);
+   for (x = 0; x < ROW_WIDTH; x++) {
+      format_desc->pack_rgba_float(packed_pixel, 0, unpacked_float[x], 0,
+                                   1, 1);
+      if (memcmp(packed_pixel, packed + x * bytes, bytes))
+         success = FALSE;
+   }
+
+   format_desc->pack_rgba_8unorm(packed, 0, &unpacked_8unorm[0][0], 0,
+                                 ROW_WIDTH, 1);
+   for (x = 0; x < ROW_WIDTH; x++) {
+      format_desc->pack_rgba_8unorm(packed_pixel, 0, unpacked_8unorm[x], 0,
+                                    1, 1);
+      if (memcmp(packed_pixel, packed + x * bytes, bytes))
+         success = FALSE;
+   }
+
+   if (!success)
+      printf("FAILED: %s rows differ from single pixels\n",
+             format_desc->short_name);
+
+   return success;
+}
+
 typedef boolean
 (*test_func_t)(const struct util_format_description *format_desc,
                const struct util_format_test_case *test);
@@ -800,6 +875,7 @@ test_all(void)
       TEST_ONE_FUNC(pack_s_8uint);
 
       TEST_FORMAT_METADATA(norm_flags);
+      TEST_FORMAT_METADATA(rows);
 
 #     undef TEST_ONE_FUNC
 #     undef TEST_ONE_FORMAT
@@ -809,10 +885,84 @@ test_all(void)
 }
 
 
+#define BENCH_WIDTH 1024
+#define BENCH_HEIGHT 256
+
+/**
+ * Print the throughput of the pack and unpack functions of every plain
+ * format, in megapixels per second.
+ */
+static void
+benchmark_all(void)
+{
+   const unsigned pixels = BENCH_WIDTH * BENCH_HEIGHT;
+   uint8_t *packed = calloc(pixels, UTIL_FORMAT_MAX_PACKED_BYTES);
+   float *unpacked_float = calloc(pixels, 4 * sizeof(float));
+   uint8_t *unpacked_8unorm = calloc(pixels, 4);
+   enum pipe_format format;
+
+   if (!packed || !unpacked_float || !unpacked_8unorm)
+      goto out;
+
+   printf("%-32s %12s %12s %12s %12s\n", "format",
+          "unpack f32", "pack f32", "unpack 8", "pack 8");
+
+   for (format = 1; format < PIPE_FORMAT_COUNT; ++format) {
+      const struct util_format_description *desc;
+      double mpix[4];
+
+      desc = util_format_description(format);
+      if (!desc || desc->layout != UTIL_FORMAT_LAYOUT_PLAIN ||
+          desc->block.bits % 8 != 0 || !desc->unpack_rgba_float)
+         continue;
+
+      const unsigned stride = BENCH_WIDTH * desc->block.bits / 8;
+
+      for (unsigned i = 0; i < 4; i++) {
+         int64_t start = os_time_get_nano();
+
+         switch (i) {
+         case 0:
+            desc->unpack_rgba_float(unpacked_float, BENCH_WIDTH * 16,
+                                    packed, stride, BENCH_WIDTH, BENCH_HEIGHT);
+            break;
+         case 1:
+            desc->pack_rgba_float(packed, stride, unpacked_float,
+                                  BENCH_WIDTH * 16, BENCH_WIDTH, BENCH_HEIGHT);
+            break;
+         case 2:
+            desc->unpack_rgba_8unorm(unpacked_8unorm, BENCH_WIDTH * 4,
+                                     packed, stride, BENCH_WIDTH, BENCH_HEIGHT);
+            break;
+         case 3:
+            desc->pack_rgba_8unorm(packed, stride, unpacked_8unorm,
+                                   BENCH_WIDTH * 4, BENCH_WIDTH, BENCH_HEIGHT);
+            break;
+         }
+
+         mpix[i] = pixels / ((os_time_get_nano() - start) / 1000.0);
+      }
+
+      printf("%-32s %12.1f %12.1f %12.1f %12.1f\n", desc->short_name,
+             mpix[0], mpix[1], mpix[2], mpix[3]);
+   }
+
+out:
+   free(packed);
+   free(unpacked_float);
+   free(unpacked_8unorm);
+}
+
+
 int main(int argc, char **argv)
 {
    boolean success;
 
+   if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+      benchmark_all();
+      return 0;
+   }
+
    success = test_all();
 
    return success ? 0 : 1;
@@ -268,3 +268,20 @@ brw_prog_key_size(gl_shader_stage stage)
    assert((int)stage >= 0 && stage < ARRAY_SIZE(stage_sizes));
    return stage_sizes[stage];
 }
+
+const char *
+brw_compile_phase_name(enum brw_compile_phase phase)
+{
+   static const char *names[] = {
+      [BRW_PHASE_NIR] = "nir",
+      [BRW_PHASE_NIR_TO_BACKEND] = "nir_to_backend",
+      [BRW_PHASE_OPTIMIZE] = "optimize",
+      [BRW_PHASE_SCHEDULE] = "schedule",
+      [BRW_PHASE_REG_ALLOC] = "reg_alloc",
+      [BRW_PHASE_GENERATE] = "generate",
+      [BRW_PHASE_COMPACT] = "compact",
+   };
+   STATIC_ASSERT(ARRAY_SIZE(names) == BRW_NUM_COMPILE_PHASES);
+   assert((int)phase >= 0 && phase < ARRAY_SIZE(names));
+   return names[phase];
+}
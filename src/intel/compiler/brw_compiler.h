@@ -28,6 +28,7 @@
 #include "dev/gen_device_info.h"
 #include "main/macros.h"
 #include "main/mtypes.h"
+#include "util/os_time.h"
 #include "util/ralloc.h"
 
 #ifdef __cplusplus
@@ -38,6 +39,23 @@ struct ra_regs;
 struct nir_shader;
 struct brw_program;
 
+/**
+ * Phases of a backend compile reported through
+ * brw_compiler::shader_phase_time.
+ */
+enum brw_compile_phase {
+   BRW_PHASE_NIR,             /**< NIR lowering done by brw_compile_*() */
+   BRW_PHASE_NIR_TO_BACKEND,  /**< fs_visitor::emit_nir_code() */
+   BRW_PHASE_OPTIMIZE,        /**< fs_visitor::optimize() */
+   BRW_PHASE_SCHEDULE,        /**< pre- and post-RA scheduling */
+   BRW_PHASE_REG_ALLOC,       /**< fs_visitor::assign_regs() */
+   BRW_PHASE_GENERATE,        /**< EU emission, without compaction */
+   BRW_PHASE_COMPACT,         /**< brw_compact_instructions() */
+   BRW_NUM_COMPILE_PHASES,
+};
+
+const char *brw_compile_phase_name(enum brw_compile_phase phase);
+
 struct brw_compiler {
    const struct gen_device_info *devinfo;
 
@@ -92,6 +110,15 @@ struct brw_compiler {
    void (*shader_debug_log)(void *, const char *str, ...) PRINTFLIKE(2, 3);
    void (*shader_perf_log)(void *, const char *str, ...) PRINTFLIKE(2, 3);
 
+   /**
+    * Optional.  Called with the log_data given to brw_compile_*() and the
+    * CPU time spent in a compile phase, for profiling the compiler itself.
+    * dispatch_width is 0 for work shared by all dispatch widths and for the
+    * vec4 backend.
+    */
+   void (*shader_phase_time)(void *log_data, enum brw_compile_phase phase,
+                             unsigned dispatch_width, uint64_t ns);
+
    bool scalar_stage[MESA_SHADER_STAGES];
    bool use_tcs_8_patch;
    struct gl_shader_compiler_options glsl_compiler_options[MESA_SHADER_STAGES];
@@ -1258,6 +1285,23 @@ struct brw_compile_stats {
 struct brw_compiler *
 brw_compiler_create(void *mem_ctx, const struct gen_device_info *devinfo);
 
+static inline int64_t
+brw_phase_begin(const struct brw_compiler *compiler)
+{
+   return compiler->shader_phase_time ? os_time_get_nano() : 0;
+}
+
+static inline void
+brw_phase_end(const struct brw_compiler *compiler, void *log_data,
+              enum brw_compile_phase phase, unsigned dispatch_width,
+              int64_t start)
+{
+   if (compiler->shader_phase_time) {
+      compiler->shader_phase_time(log_data, phase, dispatch_width,
+                                  os_time_get_nano() - start);
+   }
+}
+
 /**
  * Returns a compiler configuration for use with disk shader cache
  *
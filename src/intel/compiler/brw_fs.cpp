@@ -7166,6 +7166,8 @@ fs_visitor::calculate_register_pressure()
 void
 fs_visitor::optimize()
 {
+   int64_t start = brw_phase_begin(compiler);
+
    /* Start by validating the shader we currently have. */
    validate();
 
@@ -7326,6 +7328,9 @@ fs_visitor::optimize()
    lower_uniform_pull_constant_loads();
 
    validate();
+
+   brw_phase_end(compiler, log_data, BRW_PHASE_OPTIMIZE, dispatch_width,
+                 start);
 }
 
 /**
@@ -8165,6 +8170,7 @@ brw_compile_fs(const struct brw_compiler *compiler, void *log_data,
 
    unsigned max_subgroup_size = unlikely(INTEL_DEBUG & DEBUG_DO32) ? 32 : 16;
 
+   int64_t nir_start = brw_phase_begin(compiler);
    brw_nir_apply_key(shader, compiler, &key->base, max_subgroup_size, true);
    brw_nir_lower_fs_inputs(shader, devinfo, key);
    brw_nir_lower_fs_outputs(shader);
@@ -8176,6 +8182,7 @@ brw_compile_fs(const struct brw_compiler *compiler, void *log_data,
       NIR_PASS_V(shader, demote_sample_qualifiers);
    NIR_PASS_V(shader, move_interpolation_to_top);
    brw_postprocess_nir(shader, compiler, true);
+   brw_phase_end(compiler, log_data, BRW_PHASE_NIR, 0, nir_start);
 
    /* key->alpha_test_func means simulating alpha testing via discards,
     * so the shader definitely kills pixels.
@@ -8420,11 +8427,14 @@ cs_set_simd_size(struct brw_cs_prog_data *cs_prog_data, unsigned size)
 
 static nir_shader *
 compile_cs_to_nir(const struct brw_compiler *compiler,
+                  void *log_data,
                   void *mem_ctx,
                   const struct brw_cs_prog_key *key,
                   const nir_shader *src_shader,
                   unsigned dispatch_width)
 {
+   int64_t start = brw_phase_begin(compiler);
+
    nir_shader *shader = nir_shader_clone(mem_ctx, src_shader);
    brw_nir_apply_key(shader, compiler, &key->base, dispatch_width, true);
 
@@ -8436,6 +8446,8 @@ compile_cs_to_nir(const struct brw_compiler *compiler,
 
    brw_postprocess_nir(shader, compiler, true);
 
+   brw_phase_end(compiler, log_data, BRW_PHASE_NIR, dispatch_width, start);
+
    return shader;
 }
 
@@ -8489,7 +8501,7 @@ brw_compile_cs(const struct brw_compiler *compiler, void *log_data,
    /* Now the main event: Visit the shader IR and generate our CS IR for it.
     */
    if (!fail_msg && min_dispatch_width <= 8 && max_dispatch_width >= 8) {
-      nir_shader *nir8 = compile_cs_to_nir(compiler, mem_ctx, key,
+      nir_shader *nir8 = compile_cs_to_nir(compiler, log_data, mem_ctx, key,
                                            src_shader, 8);
       v8 = new fs_visitor(compiler, log_data, mem_ctx, &key->base,
                           &prog_data->base,
@@ -8509,7 +8521,7 @@ brw_compile_cs(const struct brw_compiler *compiler, void *log_data,
    if (likely(!(INTEL_DEBUG & DEBUG_NO16)) &&
        !fail_msg && min_dispatch_width <= 16 && max_dispatch_width >= 16) {
       /* Try a SIMD16 compile */
-      nir_shader *nir16 = compile_cs_to_nir(compiler, mem_ctx, key,
+      nir_shader *nir16 = compile_cs_to_nir(compiler, log_data, mem_ctx, key,
                                             src_shader, 16);
       v16 = new fs_visitor(compiler, log_data, mem_ctx, &key->base,
                            &prog_data->base,
@@ -8542,7 +8554,7 @@ brw_compile_cs(const struct brw_compiler *compiler, void *log_data,
    if (!fail_msg && (min_dispatch_width > 16 || (INTEL_DEBUG & DEBUG_DO32)) &&
        max_dispatch_width >= 32) {
       /* Try a SIMD32 compile */
-      nir_shader *nir32 = compile_cs_to_nir(compiler, mem_ctx, key,
+      nir_shader *nir32 = compile_cs_to_nir(compiler, log_data, mem_ctx, key,
                                             src_shader, 32);
       v32 = new fs_visitor(compiler, log_data, mem_ctx, &key->base,
                            &prog_data->base,
@@ -1645,6 +1645,8 @@ int
 fs_generator::generate_code(const cfg_t *cfg, int dispatch_width,
                             struct brw_compile_stats *stats)
 {
+   int64_t generate_start = brw_phase_begin(compiler);
+
    /* align to 64 byte boundary. */
    while (p->next_insn_offset % 64)
       brw_NOP(p);
@@ -2287,10 +2289,17 @@ fs_generator::generate_code(const cfg_t *cfg, int dispatch_width,
                                 p->next_insn_offset,
                                 disasm_info);
 
+   int64_t compact_start = brw_phase_begin(compiler);
+   brw_phase_end(compiler, log_data, BRW_PHASE_GENERATE, dispatch_width,
+                 generate_start);
+
    int before_size = p->next_insn_offset - start_offset;
    brw_compact_instructions(p, start_offset, disasm_info);
    int after_size = p->next_insn_offset - start_offset;
 
+   brw_phase_end(compiler, log_data, BRW_PHASE_COMPACT, dispatch_width,
+                 compact_start);
+
    if (unlikely(debug_flag)) {
       unsigned char sha1[21];
       char sha1buf[41];
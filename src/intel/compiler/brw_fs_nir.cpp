@@ -34,6 +34,8 @@ using namespace brw;
 void
 fs_visitor::emit_nir_code()
 {
+   int64_t start = brw_phase_begin(compiler);
+
    emit_shader_float_controls_execution_mode();
 
    /* emit the arrays used for inputs and outputs - load/store intrinsics will
@@ -44,6 +46,9 @@ fs_visitor::emit_nir_code()
    nir_emit_system_values();
 
    nir_emit_impl(nir_shader_get_entrypoint((nir_shader *)nir));
+
+   brw_phase_end(compiler, log_data, BRW_PHASE_NIR_TO_BACKEND,
+                 dispatch_width, start);
 }
 
 void
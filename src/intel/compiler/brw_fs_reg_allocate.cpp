@@ -1217,8 +1217,14 @@ fs_reg_alloc::assign_regs(bool allow_spilling, bool spill_all)
 bool
 fs_visitor::assign_regs(bool allow_spilling, bool spill_all)
 {
+   int64_t start = brw_phase_begin(compiler);
+
    fs_reg_alloc alloc(this);
    bool success = alloc.assign_regs(allow_spilling, spill_all);
+
+   brw_phase_end(compiler, log_data, BRW_PHASE_REG_ALLOC, dispatch_width,
+                 start);
+
    if (!success && allow_spilling) {
       fail("no register to spill:\n");
       dump_instructions(NULL);
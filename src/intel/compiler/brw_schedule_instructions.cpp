@@ -1824,6 +1824,8 @@ instruction_scheduler::run(cfg_t *cfg)
 void
 fs_visitor::schedule_instructions(instruction_scheduler_mode mode)
 {
+   int64_t start = brw_phase_begin(compiler);
+
    if (mode != SCHEDULE_POST)
       calculate_live_intervals();
 
@@ -1838,6 +1840,9 @@ fs_visitor::schedule_instructions(instruction_scheduler_mode mode)
    sched.run(cfg);
 
    invalidate_live_intervals();
+
+   brw_phase_end(compiler, log_data, BRW_PHASE_SCHEDULE, dispatch_width,
+                 start);
 }
 
 void
@@ -2846,6 +2846,7 @@ brw_compile_vs(const struct brw_compiler *compiler, void *log_data,
                char **error_str)
 {
    const bool is_scalar = compiler->scalar_stage[MESA_SHADER_VERTEX];
+   int64_t nir_start = brw_phase_begin(compiler);
    brw_nir_apply_key(shader, compiler, &key->base, 8, is_scalar);
 
    const unsigned *assembly = NULL;
@@ -2871,6 +2872,7 @@ brw_compile_vs(const struct brw_compiler *compiler, void *log_data,
    brw_nir_lower_vs_inputs(shader, key->gl_attrib_wa_flags);
    brw_nir_lower_vue_outputs(shader);
    brw_postprocess_nir(shader, compiler, is_scalar);
+   brw_phase_end(compiler, log_data, BRW_PHASE_NIR, 0, nir_start);
 
    prog_data->base.clip_distance_mask =
       ((1 << shader->info.clip_distance_array_size) - 1);
@@ -0,0 +1,922 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Offline compile-time benchmark for the Intel backend compiler.
+ *
+ * Compiles the SPIR-V vertex (.vert.spv), fragment (.frag.spv) and compute
+ * (.comp.spv) shaders found in the given files and directories for any
+ * platform known to gen_device_info, without a device.  The NIR is prepared
+ * the way anv prepares it, except that descriptors are assigned binding
+ * table entries in declaration order instead of through a pipeline layout.
+ *
+ * Every SIMD variant of a compute shader is compiled as its own job, so all
+ * of them run concurrently on the thread pool; the fragment shader widths
+ * depend on each other and are compiled by a single job.  The time spent in
+ * each backend phase is collected through brw_compiler::shader_phase_time.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "compiler/brw_compiler.h"
+#include "compiler/brw_nir.h"
+#include "compiler/glsl_types.h"
+#include "compiler/nir/nir_builder.h"
+#include "compiler/spirv/nir_spirv.h"
+#include "dev/gen_debug.h"
+#include "dev/gen_device_info.h"
+#include "util/compile_bench.h"
+#include "util/os_time.h"
+#include "util/u_dynarray.h"
+#include "util/u_math.h"
+
+#define PUSH_CONSTANTS_SIZE 128
+#define MAX_BINDINGS 256
+
+/* Index into the per-width timing arrays: shared work, SIMD8, 16 and 32. */
+#define NUM_WIDTH_SLOTS 4
+
+struct bench_binding {
+   unsigned set;
+   unsigned binding;
+   unsigned surface;
+   unsigned sampler;
+};
+
+struct bench_shader {
+   char *path;
+   gl_shader_stage stage;
+   void *mem_ctx;
+   nir_shader *nir;
+   bool failed;
+
+   uint64_t frontend_ns;
+};
+
+struct bench_job {
+   struct bench_shader *shader;
+   /* Required SIMD width for compute shaders, 0 to let the compiler pick. */
+   unsigned simd;
+
+   bool failed;
+   /* A compute width that the shader can't be compiled for, while another
+    * width succeeded.
+    */
+   bool skipped;
+   char *error;
+   uint64_t total_ns;
+   uint64_t phase_ns[BRW_NUM_COMPILE_PHASES][NUM_WIDTH_SLOTS];
+   unsigned program_size;
+   unsigned num_stats;
+   struct brw_compile_stats stats[3];
+};
+
+static struct {
+   const char *platform;
+   int simd32;
+} opts = {
+   .platform = "skl",
+};
+
+static struct compile_bench bench;
+
+static struct gen_device_info devinfo;
+static struct brw_compiler *compiler;
+
+static void
+bench_debug_log(void *data, const char *fmt, ...)
+{
+}
+
+static void
+bench_phase_time(void *log_data, enum brw_compile_phase phase,
+                 unsigned dispatch_width, uint64_t ns)
+{
+   struct bench_job *job = log_data;
+   unsigned slot = dispatch_width ? util_logbase2(dispatch_width) - 2 : 0;
+
+   assert(slot < NUM_WIDTH_SLOTS);
+   job->phase_ns[phase][slot] += ns;
+}
+
+static const struct bench_binding *
+find_binding(const struct util_dynarray *bindings, unsigned set,
+             unsigned binding)
+{
+   util_dynarray_foreach(bindings, struct bench_binding, b) {
+      if (b->set == set && b->binding == binding)
+         return b;
+   }
+   return NULL;
+}
+
+/* Gives every descriptor the shader declares its own binding table entries,
+ * after the render targets, and every sampler its own sampler state.
+ */
+static void
+assign_bindings(nir_shader *nir, unsigned first_surface,
+                struct util_dynarray *bindings)
+{
+   unsigned surface = first_surface, sampler = 0;
+
+   nir_foreach_variable(var, &nir->uniforms) {
+      if (var->data.mode != nir_var_uniform &&
+          var->data.mode != nir_var_mem_ubo &&
+          var->data.mode != nir_var_mem_ssbo)
+         continue;
+
+      if (find_binding(bindings, var->data.descriptor_set, var->data.binding))
+         continue;
+
+      unsigned count = glsl_type_is_array(var->type) ?
+                       MAX2(glsl_get_aoa_size(var->type), 1) : 1;
+
+      struct bench_binding b = {
+         .set = var->data.descriptor_set,
+         .binding = var->data.binding,
+         .surface = surface,
+         .sampler = sampler,
+      };
+      util_dynarray_append(bindings, struct bench_binding, b);
+
+      surface += count;
+      if (glsl_type_is_sampler(glsl_without_array(var->type)))
+         sampler += count;
+   }
+}
+
+static nir_ssa_def *
+deref_index(nir_builder *b, nir_deref_instr *deref, unsigned base)
+{
+   if (deref->deref_type != nir_deref_type_array)
+      return nir_imm_int(b, base);
+
+   return nir_iadd_imm(b, nir_ssa_for_src(b, deref->arr.index, 1), base);
+}
+
+static void
+lower_tex_deref(nir_builder *b, nir_tex_instr *tex, nir_tex_src_type type,
+                const struct util_dynarray *bindings)
+{
+   int idx = nir_tex_instr_src_index(tex, type);
+   if (idx < 0)
+      return;
+
+   bool is_texture = type == nir_tex_src_texture_deref;
+   nir_deref_instr *deref = nir_src_as_deref(tex->src[idx].src);
+   nir_variable *var = nir_deref_instr_get_variable(deref);
+   const struct bench_binding *binding =
+      find_binding(bindings, var->data.descriptor_set, var->data.binding);
+   unsigned base = is_texture ? binding->surface : binding->sampler;
+
+   if (deref->deref_type == nir_deref_type_array &&
+       !nir_src_is_const(deref->arr.index)) {
+      nir_instr_rewrite_src(&tex->instr, &tex->src[idx].src,
+                            deref->arr.index);
+      tex->src[idx].src_type = is_texture ? nir_tex_src_texture_offset :
+                                            nir_tex_src_sampler_offset;
+   } else {
+      if (deref->deref_type == nir_deref_type_array)
+         base += nir_src_as_uint(deref->arr.index);
+      nir_tex_instr_remove_src(tex, idx);
+   }
+
+   if (is_texture)
+      tex->texture_index = base;
+   else
+      tex->sampler_index = base;
+}
+
+static bool
+is_image_deref_intrinsic(nir_intrinsic_op op)
+{
+   switch (op) {
+   case nir_intrinsic_image_deref_load:
+   case nir_intrinsic_image_deref_store:
+   case nir_intrinsic_image_deref_atomic_add:
+   case nir_intrinsic_image_deref_atomic_imin:
+   case nir_intrinsic_image_deref_atomic_umin:
+   case nir_intrinsic_image_deref_atomic_imax:
+   case nir_intrinsic_image_deref_atomic_umax:
+   case nir_intrinsic_image_deref_atomic_and:
+   case nir_intrinsic_image_deref_atomic_or:
+   case nir_intrinsic_image_deref_atomic_xor:
+   case nir_intrinsic_image_deref_atomic_exchange:
+   case nir_intrinsic_image_deref_atomic_comp_swap:
+   case nir_intrinsic_image_deref_atomic_fadd:
+   case nir_intrinsic_image_deref_size:
+   case nir_intrinsic_image_deref_samples:
+   case nir_intrinsic_image_deref_load_raw_intel:
+   case nir_intrinsic_image_deref_store_raw_intel:
+      return true;
+   default:
+      return false;
+   }
+}
+
+/* Stands in for anv_nir_apply_pipeline_layout(): resource indices, texture
+ * and image derefs become binding table indices.  Image parameters, which
+ * only exist before gen9, read as zero.
+ */
+static void
+apply_bindings(nir_shader *nir, const struct util_dynarray *bindings)
+{
+   nir_function_impl *impl = nir_shader_get_entrypoint(nir);
+   nir_builder b;
+   nir_builder_init(&b, impl);
+
+   nir_foreach_block(block, impl) {
+      nir_foreach_instr_safe(instr, block) {
+         b.cursor = nir_before_instr(instr);
+
+         if (instr->type == nir_instr_type_tex) {
+            nir_tex_instr *tex = nir_instr_as_tex(instr);
+            lower_tex_deref(&b, tex, nir_tex_src_texture_deref, bindings);
+            lower_tex_deref(&b, tex, nir_tex_src_sampler_deref, bindings);
+            continue;
+         }
+
+         if (instr->type != nir_instr_type_intrinsic)
+            continue;
+
+         nir_intrinsic_instr *intrin = nir_instr_as_intrinsic(instr);
+         if (intrin->intrinsic == nir_intrinsic_vulkan_resource_index) {
+            const struct bench_binding *binding =
+               find_binding(bindings, nir_intrinsic_desc_set(intrin),
+                            nir_intrinsic_binding(intrin));
+            nir_ssa_def *index =
+               nir_iadd_imm(&b, nir_ssa_for_src(&b, intrin->src[0], 1),
+                            binding->surface);
+            nir_ssa_def_rewrite_uses(&intrin->dest.ssa, nir_src_for_ssa(index));
+            nir_instr_remove(instr);
+         } else if (intrin->intrinsic ==
+                    nir_intrinsic_image_deref_load_param_intel) {
+            nir_ssa_def *zero =
+               nir_imm_zero(&b, intrin->dest.ssa.num_components, 32);
+            nir_ssa_def_rewrite_uses(&intrin->dest.ssa, nir_src_for_ssa(zero));
+            nir_instr_remove(instr);
+         } else if (is_image_deref_intrinsic(intrin->intrinsic)) {
+            nir_deref_instr *deref = nir_src_as_deref(intrin->src[0]);
+            nir_variable *var = nir_deref_instr_get_variable(deref);
+            const struct bench_binding *binding =
+               find_binding(bindings, var->data.descriptor_set,
+                            var->data.binding);
+            brw_nir_rewrite_image_intrinsic(intrin,
+                                            deref_index(&b, deref,
+                                                        binding->surface));
+         }
+      }
+   }
+
+   nir_metadata_preserve(impl, nir_metadata_block_index |
+                               nir_metadata_dominance);
+   NIR_PASS_V(nir, nir_opt_dce);
+}
+
+static void
+lower_push_constants(nir_shader *nir)
+{
+   nir_foreach_function(function, nir) {
+      if (!function->impl)
+         continue;
+
+      nir_foreach_block(block, function->impl) {
+         nir_foreach_instr(instr, block) {
+            if (instr->type != nir_instr_type_intrinsic)
+               continue;
+
+            nir_intrinsic_instr *intrin = nir_instr_as_intrinsic(instr);
+            if (intrin->intrinsic == nir_intrinsic_load_push_constant)
+               intrin->intrinsic = nir_intrinsic_load_uniform;
+         }
+      }
+   }
+}
+
+static void
+shared_type_info(const struct glsl_type *type, unsigned *size, unsigned *align)
+{
+   assert(glsl_type_is_vector_or_scalar(type));
+
+   uint32_t comp_size = glsl_type_is_boolean(type)
+      ? 4 : glsl_get_bit_size(type) / 8;
+   unsigned length = glsl_get_vector_elements(type);
+   *size = comp_size * length;
+   *align = comp_size * (length == 3 ? 4 : length);
+}
+
+/* Number of render targets written by a fragment shader, at least one. */
+static unsigned
+num_render_targets(const nir_shader *nir)
+{
+   unsigned rts = 1;
+
+   nir_foreach_variable(var, &nir->outputs) {
+      if (var->data.location < FRAG_RESULT_DATA0)
+         continue;
+
+      unsigned len = glsl_type_is_array(var->type) ?
+                     glsl_get_length(var->type) : 1;
+      rts = MAX2(rts, var->data.location - FRAG_RESULT_DATA0 + len);
+   }
+
+   return MIN2(rts, BRW_MAX_DRAW_BUFFERS);
+}
+
+static uint32_t *
+read_spirv(const char *path, size_t *word_count)
+{
+   FILE *f = fopen(path, "rb");
+   if (!f)
+      return NULL;
+
+   struct stat st;
+   uint32_t *words = NULL;
+   if (fstat(fileno(f), &st) == 0 && st.st_size > 0 && st.st_size % 4 == 0) {
+      words = malloc(st.st_size);
+      if (words && fread(words, st.st_size, 1, f) != 1) {
+         free(words);
+         words = NULL;
+      }
+   }
+   fclose(f);
+
+   *word_count = words ? st.st_size / 4 : 0;
+   return words;
+}
+
+/* spirv_to_nir() and the NIR lowering anv does before brw_compile_*(). */
+static nir_shader *
+spirv_file_to_nir(struct bench_shader *shader)
+{
+   size_t word_count;
+   uint32_t *spirv = read_spirv(shader->path, &word_count);
+   if (!spirv) {
+      fprintf(stderr, "%s: failed to read SPIR-V\n", shader->path);
+      return NULL;
+   }
+
+   const struct spirv_to_nir_options spirv_options = {
+      .frag_coord_is_sysval = true,
+      .lower_ubo_ssbo_access_to_offsets = true,
+      .caps = {
+         .demote_to_helper_invocation = true,
+         .derivative_group = true,
+         .descriptor_array_dynamic_indexing = true,
+         .descriptor_array_non_uniform_indexing = true,
+         .descriptor_indexing = true,
+         .device_group = true,
+         .draw_parameters = true,
+         .float16 = devinfo.gen >= 8,
+         .float64 = devinfo.gen >= 8,
+         .geometry_streams = true,
+         .image_write_without_format = true,
+         .int8 = devinfo.gen >= 8,
+         .int16 = devinfo.gen >= 8,
+         .int64 = devinfo.gen >= 8,
+         .min_lod = true,
+         .multiview = true,
+         .post_depth_coverage = devinfo.gen >= 9,
+         .runtime_descriptor_array = true,
+         .float_controls = devinfo.gen >= 8,
+         .shader_viewport_index_layer = true,
+         .stencil_export = devinfo.gen >= 9,
+         .storage_8bit = devinfo.gen >= 8,
+         .storage_16bit = devinfo.gen >= 8,
+         .subgroup_arithmetic = true,
+         .subgroup_basic = true,
+         .subgroup_ballot = true,
+         .subgroup_quad = true,
+         .subgroup_shuffle = true,
+         .subgroup_vote = true,
+         .tessellation = true,
+         .variable_pointers = true,
+      },
+      .ubo_addr_format = nir_address_format_32bit_index_offset,
+      .ssbo_addr_format = nir_address_format_32bit_index_offset,
+      .phys_ssbo_addr_format = nir_address_format_64bit_global,
+      .push_const_addr_format = nir_address_format_logical,
+      .shared_addr_format = nir_address_format_32bit_offset,
+   };
+   const nir_shader_compiler_options *nir_options =
+      compiler->glsl_compiler_options[shader->stage].NirOptions;
+
+   nir_shader *nir = spirv_to_nir(spirv, word_count,
+                                  NULL, 0, shader->stage, "main",
+                                  &spirv_options, nir_options);
+   free(spirv);
+   if (!nir) {
+      fprintf(stderr, "%s: spirv_to_nir failed\n", shader->path);
+      return NULL;
+   }
+   ralloc_steal(shader->mem_ctx, nir);
+
+   NIR_PASS_V(nir, nir_lower_constant_initializers, nir_var_function_temp);
+   NIR_PASS_V(nir, nir_lower_returns);
+   NIR_PASS_V(nir, nir_inline_functions);
+   NIR_PASS_V(nir, nir_opt_deref);
+
+   foreach_list_typed_safe(nir_function, func, node, &nir->functions) {
+      if (!func->is_entrypoint)
+         exec_node_remove(&func->node);
+   }
+   assert(exec_list_length(&nir->functions) == 1);
+
+   NIR_PASS_V(nir, nir_lower_constant_initializers, ~0);
+   NIR_PASS_V(nir, nir_split_var_copies);
+   NIR_PASS_V(nir, nir_split_per_member_structs);
+   NIR_PASS_V(nir, nir_remove_dead_variables,
+              nir_var_shader_in | nir_var_shader_out | nir_var_system_value);
+   NIR_PASS_V(nir, nir_propagate_invariant);
+   NIR_PASS_V(nir, nir_lower_io_to_temporaries,
+              nir_shader_get_entrypoint(nir), true, false);
+   NIR_PASS_V(nir, nir_lower_frexp);
+
+   nir->info.separate_shader = true;
+
+   brw_preprocess_nir(compiler, nir, NULL);
+
+   if (nir->info.stage == MESA_SHADER_FRAGMENT) {
+      NIR_PASS_V(nir, nir_lower_wpos_center, false);
+      NIR_PASS_V(nir, nir_lower_input_attachments, true);
+   }
+
+   lower_push_constants(nir);
+   nir_shader_gather_info(nir, nir_shader_get_entrypoint(nir));
+
+   NIR_PASS_V(nir, brw_nir_lower_image_load_store, &devinfo);
+   NIR_PASS_V(nir, nir_lower_explicit_io, nir_var_mem_global,
+              nir_address_format_64bit_global);
+
+   struct util_dynarray bindings;
+   util_dynarray_init(&bindings, NULL);
+   assign_bindings(nir, nir->info.stage == MESA_SHADER_FRAGMENT ?
+                   num_render_targets(nir) : 0, &bindings);
+   apply_bindings(nir, &bindings);
+   util_dynarray_fini(&bindings);
+
+   NIR_PASS_V(nir, nir_opt_constant_folding);
+   NIR_PASS_V(nir, nir_lower_non_uniform_access,
+              nir_lower_non_uniform_texture_access |
+              nir_lower_non_uniform_image_access);
+
+   if (nir->info.stage == MESA_SHADER_COMPUTE) {
+      NIR_PASS_V(nir, nir_lower_vars_to_explicit_types,
+                 nir_var_mem_shared, shared_type_info);
+      NIR_PASS_V(nir, nir_lower_explicit_io,
+                 nir_var_mem_shared, nir_address_format_32bit_offset);
+   }
+
+   return nir;
+}
+
+static void
+prepare_shader_job(void *data)
+{
+   struct bench_shader *shader = data;
+   uint64_t start = os_time_get_nano();
+
+   shader->nir = spirv_file_to_nir(shader);
+   shader->failed = shader->nir == NULL;
+
+   shader->frontend_ns = os_time_get_nano() - start;
+}
+
+/* Every push constant is a param; like anv, we always push all of them. */
+static void
+setup_params(void *mem_ctx, nir_shader *nir,
+             struct brw_stage_prog_data *prog_data)
+{
+   if (nir->num_uniforms == 0)
+      return;
+
+   nir->num_uniforms = PUSH_CONSTANTS_SIZE;
+   prog_data->nr_params = PUSH_CONSTANTS_SIZE / sizeof(uint32_t);
+   prog_data->param = ralloc_array(mem_ctx, uint32_t, prog_data->nr_params);
+   for (unsigned i = 0; i < prog_data->nr_params; i++)
+      prog_data->param[i] = i * sizeof(uint32_t);
+}
+
+static void
+setup_base_key(struct brw_base_prog_key *key)
+{
+   key->subgroup_size_type = BRW_SUBGROUP_SIZE_API_CONSTANT;
+   key->tex.compressed_multisample_layout_mask = ~0;
+   if (devinfo.gen >= 9)
+      key->tex.msaa_16 = ~0;
+   for (unsigned i = 0; i < MAX_SAMPLERS; i++)
+      key->tex.swizzles[i] = SWIZZLE_XYZW;
+}
+
+static bool
+compile_vs(struct bench_job *job, void *mem_ctx, nir_shader *nir)
+{
+   struct brw_vs_prog_key key;
+   struct brw_vs_prog_data prog_data;
+
+   memset(&key, 0, sizeof(key));
+   memset(&prog_data, 0, sizeof(prog_data));
+   setup_base_key(&key.base);
+   setup_params(mem_ctx, nir, &prog_data.base.base);
+
+   brw_nir_analyze_ubo_ranges(compiler, nir, &key, prog_data.base.base.ubo_ranges);
+   brw_compute_vue_map(&devinfo, &prog_data.base.vue_map,
+                       nir->info.outputs_written, nir->info.separate_shader);
+
+   const unsigned *code = brw_compile_vs(compiler, job, mem_ctx, &key,
+                                         &prog_data, nir, -1, job->stats,
+                                         &job->error);
+   job->num_stats = 1;
+   job->program_size = prog_data.base.base.program_size;
+   return code != NULL;
+}
+
+static bool
+compile_fs(struct bench_job *job, void *mem_ctx, nir_shader *nir)
+{
+   struct brw_wm_prog_key key;
+   struct brw_wm_prog_data prog_data;
+
+   memset(&key, 0, sizeof(key));
+   memset(&prog_data, 0, sizeof(prog_data));
+   setup_base_key(&key.base);
+   key.nr_color_regions = num_render_targets(nir);
+   key.color_outputs_valid = (1 << key.nr_color_regions) - 1;
+   key.input_slots_valid = nir->info.inputs_read | VARYING_BIT_POS;
+   setup_params(mem_ctx, nir, &prog_data.base);
+
+   brw_nir_analyze_ubo_ranges(compiler, nir, NULL, prog_data.base.ubo_ranges);
+
+   const unsigned *code = brw_compile_fs(compiler, job, mem_ctx, &key,
+                                         &prog_data, nir, -1, -1, -1, true,
+                                         false, NULL, job->stats,
+                                         &job->error);
+   job->num_stats = prog_data.dispatch_8 + prog_data.dispatch_16 +
+                    prog_data.dispatch_32;
+   job->program_size = prog_data.base.program_size;
+   return code != NULL;
+}
+
+static bool
+compile_cs(struct bench_job *job, void *mem_ctx, const nir_shader *nir)
+{
+   struct brw_cs_prog_key key;
+   struct brw_cs_prog_data prog_data;
+
+   memset(&key, 0, sizeof(key));
+   memset(&prog_data, 0, sizeof(prog_data));
+   setup_base_key(&key.base);
+   if (job->simd) {
+      /* The enum values match the subgroup size they require. */
+      key.base.subgroup_size_type = job->simd;
+   }
+
+   /* The source shader is shared by the jobs of all widths, so the params
+    * go on a private copy.
+    */
+   nir_shader *clone = nir_shader_clone(mem_ctx, nir);
+   setup_params(mem_ctx, clone, &prog_data.base);
+
+   const unsigned *code = brw_compile_cs(compiler, job, mem_ctx, &key,
+                                         &prog_data, clone, -1, job->stats,
+                                         &job->error);
+   job->num_stats = 1;
+   job->program_size = prog_data.base.program_size;
+   return code != NULL;
+}
+
+static void
+compile_job(void *data)
+{
+   struct bench_job *job = data;
+   const struct bench_shader *shader = job->shader;
+
+   for (unsigned i = 0; i < bench.iterations && !job->failed; i++) {
+      void *mem_ctx = ralloc_context(NULL);
+      uint64_t start = os_time_get_nano();
+      bool ok;
+
+      if (shader->stage == MESA_SHADER_COMPUTE) {
+         ok = compile_cs(job, mem_ctx, shader->nir);
+      } else {
+         /* brw_compile_vs/fs modify the shader. */
+         nir_shader *nir = nir_shader_clone(mem_ctx, shader->nir);
+
+         if (shader->stage == MESA_SHADER_VERTEX)
+            ok = compile_vs(job, mem_ctx, nir);
+         else
+            ok = compile_fs(job, mem_ctx, nir);
+      }
+
+      job->total_ns += os_time_get_nano() - start;
+
+      if (!ok) {
+         job->failed = true;
+         job->error = strdup(job->error ? job->error : "unknown error");
+      } else {
+         job->error = NULL;
+      }
+      ralloc_free(mem_ctx);
+   }
+}
+
+static uint64_t
+job_phase_total(const struct bench_job *job)
+{
+   uint64_t total = 0;
+
+   for (unsigned p = 0; p < BRW_NUM_COMPILE_PHASES; p++) {
+      for (unsigned w = 0; w < NUM_WIDTH_SLOTS; w++)
+         total += job->phase_ns[p][w];
+   }
+   return total;
+}
+
+static void
+print_job(const struct bench_job *job)
+{
+   const char *variant = job->simd == 8 ? "simd8" :
+                         job->simd == 16 ? "simd16" :
+                         job->simd == 32 ? "simd32" : "all";
+   double ms = job->total_ns / 1000000.0 / bench.iterations;
+
+   if (job->failed) {
+      const char *status = job->skipped ? "skipped" : "failed";
+
+      if (bench.csv) {
+         printf("%s,%s,%s,%s\n", job->shader->path,
+                _mesa_shader_stage_to_abbrev(job->shader->stage), variant,
+                status);
+      } else {
+         printf("%-48s %4s %7s  %s: %s\n", job->shader->path,
+                _mesa_shader_stage_to_abbrev(job->shader->stage), variant,
+                status, job->error);
+      }
+      return;
+   }
+
+   for (unsigned i = 0; i < job->num_stats; i++) {
+      const struct brw_compile_stats *s = &job->stats[i];
+
+      printf(bench.csv ? "%s,%s,%s,%u,%.3f,%u,%u,%u,%u,%u\n" :
+                        "%-48s %4s %7s %4u %10.3f %8u %8u %6u %6u %8u\n",
+             job->shader->path, _mesa_shader_stage_to_abbrev(job->shader->stage),
+             variant, s->dispatch_width, ms, s->instructions, s->cycles,
+             s->spills, s->fills, job->program_size);
+   }
+}
+
+static void
+print_phase_stats(const struct bench_shader *shaders, unsigned num_shaders,
+                  const struct bench_job *jobs, unsigned num_jobs,
+                  uint64_t wall_ns)
+{
+   static const char *slot_names[NUM_WIDTH_SLOTS] = {
+      "shared", "simd8", "simd16", "simd32",
+   };
+   uint64_t phase_ns[BRW_NUM_COMPILE_PHASES][NUM_WIDTH_SLOTS] = {{0}};
+   uint64_t frontend_ns = 0, backend_ns = 0, other_ns = 0;
+   unsigned compiled = 0, failed = 0, skipped = 0;
+
+   for (unsigned i = 0; i < num_shaders; i++) {
+      frontend_ns += shaders[i].frontend_ns;
+      failed += shaders[i].failed;
+   }
+
+   for (unsigned j = 0; j < num_jobs; j++) {
+      if (jobs[j].failed) {
+         if (jobs[j].skipped)
+            skipped++;
+         else
+            failed++;
+         continue;
+      }
+
+      for (unsigned p = 0; p < BRW_NUM_COMPILE_PHASES; p++) {
+         for (unsigned w = 0; w < NUM_WIDTH_SLOTS; w++)
+            phase_ns[p][w] += jobs[j].phase_ns[p][w];
+      }
+      backend_ns += jobs[j].total_ns;
+      other_ns += jobs[j].total_ns - job_phase_total(&jobs[j]);
+      compiled++;
+   }
+
+   double div = 1000000.0 * bench.iterations;
+
+   if (bench.csv) {
+      printf("\nphase,shared_ms,simd8_ms,simd16_ms,simd32_ms\n");
+   } else {
+      printf("\n%-16s", "phase (ms)");
+      for (unsigned w = 0; w < NUM_WIDTH_SLOTS; w++)
+         printf(" %10s", slot_names[w]);
+      printf(" %10s\n", "total");
+   }
+
+   for (unsigned p = 0; p < BRW_NUM_COMPILE_PHASES; p++) {
+      uint64_t total = 0;
+
+      printf(bench.csv ? "%s" : "%-16s", brw_compile_phase_name(p));
+      for (unsigned w = 0; w < NUM_WIDTH_SLOTS; w++) {
+         printf(bench.csv ? ",%.3f" : " %10.3f", phase_ns[p][w] / div);
+         total += phase_ns[p][w];
+      }
+      if (!bench.csv)
+         printf(" %10.3f", total / div);
+      printf("\n");
+   }
+
+   if (bench.csv)
+      return;
+
+   printf("%-16s %54.3f\n", "other", other_ns / div);
+   printf("\nspirv_to_nir and anv-like lowering: %.3f ms (once per shader)\n",
+          frontend_ns / 1000000.0);
+   printf("%u compiles, %u failed, %u skipped; backend CPU time %.3f ms, "
+          "wall time %.3f ms on %u threads\n",
+          compiled, failed, skipped, backend_ns / div, wall_ns / div,
+          bench.threads);
+}
+
+static bool
+stage_from_path(const char *path, gl_shader_stage *stage)
+{
+   static const struct {
+      const char *ext;
+      gl_shader_stage stage;
+   } exts[] = {
+      { ".vert.spv", MESA_SHADER_VERTEX },
+      { ".frag.spv", MESA_SHADER_FRAGMENT },
+      { ".comp.spv", MESA_SHADER_COMPUTE },
+   };
+   size_t len = strlen(path);
+
+   for (unsigned i = 0; i < ARRAY_SIZE(exts); i++) {
+      size_t ext_len = strlen(exts[i].ext);
+      if (len > ext_len && strcmp(path + len - ext_len, exts[i].ext) == 0) {
+         *stage = exts[i].stage;
+         return true;
+      }
+   }
+
+   return false;
+}
+
+static bool
+is_shader(const char *path)
+{
+   gl_shader_stage stage;
+
+   return stage_from_path(path, &stage);
+}
+
+static const struct compile_bench_option bench_opts[] = {
+   { "platform", "name", "platform to compile for, e.g. icl, or a PCI id "
+     "(skl)", NULL, &opts.platform },
+   { "simd32", NULL, "also compile SIMD32 fragment shaders", &opts.simd32 },
+   { NULL }
+};
+
+int
+main(int argc, char **argv)
+{
+   int status;
+
+   bench.description =
+      "Compiles .vert.spv, .frag.spv and .comp.spv shaders with the Intel\n"
+      "backend compiler and reports the time spent in each phase.";
+   bench.is_shader = is_shader;
+   bench.options = bench_opts;
+   bench.threaded = true;
+   if (!compile_bench_init(&bench, argc, argv, &status))
+      return status;
+
+   int pci_id = gen_device_name_to_pci_device_id(opts.platform);
+   if (pci_id < 0)
+      pci_id = strtol(opts.platform, NULL, 0);
+   if (!gen_get_device_info_from_pci_id(pci_id, &devinfo)) {
+      fprintf(stderr, "Unknown platform: %s\n", opts.platform);
+      return EXIT_FAILURE;
+   }
+
+   /* The fragment shader widths are chosen inside brw_compile_fs(). */
+   if (opts.simd32)
+      INTEL_DEBUG |= DEBUG_DO32;
+
+   void *mem_ctx = ralloc_context(NULL);
+   compiler = brw_compiler_create(mem_ctx, &devinfo);
+   compiler->shader_debug_log = bench_debug_log;
+   compiler->shader_perf_log = bench_debug_log;
+   compiler->shader_phase_time = bench_phase_time;
+   compiler->supports_pull_constants = false;
+   compiler->constant_buffer_0_is_relative = devinfo.gen < 8;
+   compiler->supports_shader_constants = true;
+
+   unsigned num_shaders = bench.num_paths;
+
+   glsl_type_singleton_init_or_ref();
+
+   /* Translate every shader to NIR first, so that the backend jobs of a
+    * shader can share its NIR.
+    */
+   struct bench_shader *shaders = rzalloc_array(mem_ctx, struct bench_shader,
+                                                MAX2(num_shaders, 1));
+   for (unsigned i = 0; i < num_shaders; i++) {
+      shaders[i].path = bench.paths[i];
+      shaders[i].mem_ctx = ralloc_context(mem_ctx);
+      stage_from_path(shaders[i].path, &shaders[i].stage);
+   }
+   compile_bench_run(&bench, shaders, num_shaders, sizeof(*shaders),
+                     prepare_shader_job);
+
+   struct util_dynarray jobs;
+   util_dynarray_init(&jobs, mem_ctx);
+   for (unsigned i = 0; i < num_shaders; i++) {
+      if (shaders[i].failed)
+         continue;
+
+      struct bench_job job = { .shader = &shaders[i] };
+      if (shaders[i].stage == MESA_SHADER_COMPUTE) {
+         for (unsigned simd = 8; simd <= 32; simd *= 2) {
+            job.simd = simd;
+            util_dynarray_append(&jobs, struct bench_job, job);
+         }
+      } else {
+         util_dynarray_append(&jobs, struct bench_job, job);
+      }
+   }
+
+   unsigned num_jobs = util_dynarray_num_elements(&jobs, struct bench_job);
+   uint64_t wall_ns = compile_bench_run(&bench, jobs.data, num_jobs,
+                                        sizeof(struct bench_job),
+                                        compile_job);
+
+   /* A compute width that the workgroup size rules out isn't an error as
+    * long as another width compiled.  The widths of a shader are adjacent.
+    */
+   struct bench_job *all_jobs = jobs.data;
+   for (unsigned j = 0; j < num_jobs; j++) {
+      if (!all_jobs[j].simd || !all_jobs[j].failed)
+         continue;
+
+      for (unsigned k = 0; k < num_jobs; k++) {
+         if (all_jobs[k].shader == all_jobs[j].shader && !all_jobs[k].failed)
+            all_jobs[j].skipped = true;
+      }
+   }
+
+   unsigned failed = 0;
+   for (unsigned i = 0; i < num_shaders; i++)
+      failed += shaders[i].failed;
+   for (unsigned j = 0; j < num_jobs; j++)
+      failed += all_jobs[j].failed && !all_jobs[j].skipped;
+
+   if (bench.verbose) {
+      if (bench.csv) {
+         printf("shader,stage,variant,simd,ms,instructions,cycles,spills,"
+                "fills,bytes\n");
+      } else {
+         printf("%-48s %4s %7s %4s %10s %8s %8s %6s %6s %8s\n", "shader", "",
+                "variant", "simd", "ms", "instrs", "cycles", "spills",
+                "fills", "bytes");
+      }
+      util_dynarray_foreach(&jobs, struct bench_job, job)
+         print_job(job);
+   }
+
+   print_phase_stats(shaders, num_shaders, all_jobs, num_jobs, wall_ns);
+
+   if (failed)
+      fprintf(stderr, "%u shaders failed to compile\n", failed);
+
+   util_dynarray_foreach(&jobs, struct bench_job, job)
+      free(job->error);
+   compile_bench_fini(&bench);
+   ralloc_free(mem_ctx);
+   glsl_type_singleton_decref();
+
+   return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -91,6 +91,10 @@ class PrintCode(gl_XML.gl_print_base):
         out('debug_print_sync_fallback("{0}");'.format(func.name))
         self.print_sync_call(func)
 
+    def print_call_after(self, func):
+        if func.marshal_call_after:
+            out('{0};'.format(func.marshal_call_after))
+
     def print_sync_body(self, func):
         out('/* {0}: marshalled synchronously */'.format(func.name))
         out('static {0} GLAPIENTRY'.format(func.return_type))
@@ -98,9 +102,12 @@ class PrintCode(gl_XML.gl_print_base):
         out('{')
         with indent():
             out('GET_CURRENT_CONTEXT(ctx);')
-            out('_mesa_glthread_finish(ctx);')
+            out('_mesa_glthread_finish_before(ctx, "{0}");'.format(func.name))
             out('debug_print_sync("{0}");'.format(func.name))
             self.print_sync_call(func)
+            if func.marshal_call_after:
+                assert func.return_type == 'void'
+                out('{0};'.format(func.marshal_call_after))
         out('}')
         out('')
         out('')
@@ -132,6 +139,20 @@ class PrintCode(gl_XML.gl_print_base):
                     out('variable_data += {0};'.format(
                         p.size_string(False)))
 
+        if func.marshal_user_arrays:
+            out('cmd->user_arrays_size = user_arrays_size;')
+            out('if (user_arrays_size)')
+            with indent():
+                out('_mesa_glthread_upload_user_arrays(&user_arrays, '
+                    'cmd + 1);')
+
+        if func.marshal_user_indices:
+            out('cmd->user_indices = user_indices;')
+            out('if (user_indices)')
+            with indent():
+                out('memcpy((char *) (cmd + 1) + user_arrays_size, indices, '
+                    'indices_size);')
+
         if not func.fixed_params and not func.variable_params:
             out('(void) cmd;\n')
         out('_mesa_post_marshal_hook(ctx);')
@@ -153,6 +174,14 @@ class PrintCode(gl_XML.gl_print_base):
                     out('bool {0}_null; /* If set, no data follows '
                         'for "{0}" */'.format(p.name))
 
+            if func.marshal_user_arrays:
+                out('GLuint user_arrays_size; /* If nonzero, copies of the '
+                    'client arrays follow */')
+
+            if func.marshal_user_indices:
+                out('bool user_indices; /* If set, the indices follow and '
+                    '"indices" is ignored */')
+
             for p in func.variable_params:
                 if p.count_scale != 1:
                     out(('/* Next {0} bytes are '
@@ -206,7 +235,26 @@ class PrintCode(gl_XML.gl_print_base):
                     else:
                         out('variable_data += {0};'.format(p.size_string(False)))
 
+            if func.marshal_user_arrays:
+                out('const GLubyte *saved_pointers[VERT_ATTRIB_MAX];')
+                out('if (cmd->user_arrays_size)')
+                with indent():
+                    out('_mesa_glthread_bind_user_arrays(ctx, cmd + 1, '
+                        'saved_pointers);')
+
+            if func.marshal_user_indices:
+                out('if (cmd->user_indices)')
+                with indent():
+                    out('indices = (const GLvoid *) ((const char *) (cmd + 1) '
+                        '+ cmd->user_arrays_size);')
+
             self.print_sync_call(func)
+
+            if func.marshal_user_arrays:
+                out('if (cmd->user_arrays_size)')
+                with indent():
+                    out('_mesa_glthread_unbind_user_arrays(ctx, cmd + 1, '
+                        'saved_pointers);')
         out('}')
 
     def validate_count_or_fallback(self, func):
@@ -238,6 +286,32 @@ class PrintCode(gl_XML.gl_print_base):
                 if p.img_null_flag:
                     size = '({0} ? {1} : 0)'.format(p.name, size)
                 size_terms.append(size)
+            if func.marshal_user_indices:
+                # Indices in client memory are copied into the command, so
+                # that the draw doesn't have to be executed synchronously.
+                out('const bool user_indices = '
+                    '_mesa_glthread_is_non_vbo_draw_elements(ctx);')
+                out('const int indices_size = user_indices ? '
+                    '_mesa_glthread_user_indices_size(type, count) : 0;')
+                size_terms.append('MAX2(indices_size, 0)')
+            if func.marshal_user_arrays:
+                # So are the parts of the vertex arrays in client memory that
+                # the draw reads.
+                params = dict((p.name, p) for p in func.parameters)
+                def param_or(name, default):
+                    return name if name in params else default
+                out('struct glthread_user_arrays user_arrays;')
+                out('const int user_arrays_size = '
+                    '_mesa_glthread_prepare_user_arrays(ctx, &user_arrays, '
+                    '{0}, count, {1}, {2}, {3}, {4}, {5});'.format(
+                        param_or('first', '0'),
+                        'type' if func.marshal_user_indices else '0',
+                        'user_indices ? indices : NULL'
+                        if func.marshal_user_indices else 'NULL',
+                        param_or('basevertex', '0'),
+                        param_or('primcount', '1'),
+                        param_or('baseinstance', '0')))
+                size_terms.append('MAX2(user_arrays_size, 0)')
             out('size_t cmd_size = {0};'.format(' + '.join(size_terms)))
             out('{0} *cmd;'.format(struct))
 
@@ -245,10 +319,36 @@ class PrintCode(gl_XML.gl_print_base):
 
             need_fallback_sync = self.validate_count_or_fallback(func)
 
+            if func.marshal_user_indices:
+                # Leave invalid counts and types to the error checking in
+                # Mesa core.
+                out('if (unlikely(indices_size < 0)) {')
+                with indent():
+                    out('goto fallback_to_sync;')
+                out('}')
+                need_fallback_sync = True
+
+            if func.marshal_user_arrays:
+                # The arrays are too large to be copied, or the range of
+                # vertices isn't known.
+                out('if (unlikely(user_arrays_size < 0)) {')
+                with indent():
+                    out('goto fallback_to_sync;')
+                out('}')
+                need_fallback_sync = True
+            elif func.marshal == 'draw':
+                # Other draws reading vertices from client memory are
+                # executed synchronously.
+                out('if (unlikely(_mesa_glthread_has_user_arrays(ctx))) {')
+                with indent():
+                    out('goto fallback_to_sync;')
+                out('}')
+                need_fallback_sync = True
+
             if func.marshal_fail:
                 out('if ({0}) {{'.format(func.marshal_fail))
                 with indent():
-                    out('_mesa_glthread_finish(ctx);')
+                    out('_mesa_glthread_finish_before(ctx, "{0}");'.format(func.name))
                     out('_mesa_glthread_restore_dispatch(ctx, __func__);')
                     self.print_sync_dispatch(func)
                     out('return;')
@@ -257,6 +357,7 @@ class PrintCode(gl_XML.gl_print_base):
             out('if (cmd_size <= MARSHAL_MAX_CMD_SIZE) {')
             with indent():
                 self.print_async_dispatch(func)
+                self.print_call_after(func)
                 out('return;')
             out('}')
 
@@ -264,8 +365,9 @@ class PrintCode(gl_XML.gl_print_base):
         if need_fallback_sync:
             out('fallback_to_sync:')
         with indent():
-            out('_mesa_glthread_finish(ctx);')
+            out('_mesa_glthread_finish_before(ctx, "{0}");'.format(func.name))
             self.print_sync_dispatch(func)
+            self.print_call_after(func)
 
         out('}')
 
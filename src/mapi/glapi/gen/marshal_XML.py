@@ -58,6 +58,26 @@ class marshal_function(gl_XML.gl_function):
         # Store the "marshal" attribute, if present.
         self.marshal = element.get('marshal')
         self.marshal_fail = element.get('marshal_fail')
+        self.marshal_call_after = element.get('marshal_call_after')
+
+        # Draws that take a single array of "count" indices of type "type"
+        # can copy the indices into the command when they're in client
+        # memory.
+        params = dict((p.name, p) for p in self.parameters)
+        self.marshal_user_indices = (
+            self.marshal == 'draw' and
+            'indices' in params and 'count' in params and 'type' in params and
+            params['indices'].type_string() == 'const GLvoid *' and
+            not params['count'].is_pointer())
+
+        # Draws of a single range of vertices can copy the vertex arrays in
+        # client memory into the command, because the range is known before
+        # the draw is executed.
+        self.marshal_user_arrays = (
+            self.marshal_user_indices or
+            (self.marshal == 'draw' and
+             'first' in params and 'count' in params and
+             not params['first'].is_pointer()))
 
     def marshal_flavor(self):
         """Find out how this function should be marshalled between
@@ -275,7 +275,7 @@ write_program_data(struct brw_context *brw, struct gl_program *prog,
    /* TODO: Improve perf for non-LLC. It would be best to save it at program
     * generation time when the program is in normal memory accessible with
     * cache to the CPU. Another easier change would be to use
-    * _mesa_streaming_load_memcpy to read from the program mapped memory. */
+    * util_streaming_load_memcpy to read from the program mapped memory. */
    brw_write_blob_program_data(&binary, stage, program_map, prog_data);
 
    unsigned char sha1[20];
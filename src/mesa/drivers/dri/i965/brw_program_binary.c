@@ -263,7 +263,7 @@ serialize_gen_part(struct blob *writer, struct gl_context *ctx,
       /* TODO: Improve perf for non-LLC. It would be best to save it at
        * program generation time when the program is in normal memory
        * accessible with cache to the CPU. Another easier change would be to
-       * use _mesa_streaming_load_memcpy to read from the program mapped
+       * use util_streaming_load_memcpy to read from the program mapped
        * memory.
        */
       blob_write_uint32(writer, GEN_PART);
@@ -45,7 +45,7 @@
  */
 
 #include "main/imports.h"
-#include "main/streaming-load-memcpy.h"
+#include "util/streaming-load-memcpy.h"
 #include "x86/common_x86_asm.h"
 #include "intel_batchbuffer.h"
 #include "brw_state.h"
@@ -226,7 +226,7 @@ brw_cache_new_bo(struct brw_cache *cache, uint32_t new_size)
    if (cache->next_offset != 0) {
 #ifdef USE_SSE41
       if (!cache->bo->cache_coherent && cpu_has_sse4_1)
-         _mesa_streaming_load_memcpy(map, cache->map, cache->next_offset);
+         util_streaming_load_memcpy(map, cache->map, cache->next_offset);
       else
 #endif
          memcpy(map, cache->map, cache->next_offset);
@@ -32,8 +32,8 @@
 #include "main/imports.h"
 #include "main/mtypes.h"
 #include "main/macros.h"
-#include "main/streaming-load-memcpy.h"
 #include "main/bufferobj.h"
+#include "util/streaming-load-memcpy.h"
 #include "x86/common_x86_asm.h"
 
 #include "brw_context.h"
@@ -352,7 +352,7 @@ brw_get_buffer_subdata(struct gl_context *ctx,
        * and use the magic movntd instructions instead.
        */
       map_flags |= MAP_COHERENT;
-      memcpy_fn = (mem_copy_fn) _mesa_streaming_load_memcpy;
+      memcpy_fn = (mem_copy_fn) util_streaming_load_memcpy;
    }
 #endif
 
@@ -44,9 +44,9 @@
 #include "main/glformats.h"
 #include "main/texcompress_etc.h"
 #include "main/teximage.h"
-#include "main/streaming-load-memcpy.h"
 
 #include "util/format_srgb.h"
+#include "util/streaming-load-memcpy.h"
 
 #include "x86/common_x86_asm.h"
 
@@ -3174,7 +3174,7 @@ intel_miptree_map_movntdqa(struct brw_context *brw,
       void *dst_ptr = map->ptr + y * map->stride;
       void *src_ptr = src + y * mt->surf.row_pitch_B;
 
-      _mesa_streaming_load_memcpy(dst_ptr, src_ptr, width_bytes);
+      util_streaming_load_memcpy(dst_ptr, src_ptr, width_bytes);
    }
 
    intel_miptree_unmap_raw(mt);
@@ -48,6 +48,7 @@ string = """/*
 #include "macros.h"
 #include "util/format_rgb9e5.h"
 #include "util/format_r11g11b10f.h"
+#include "util/format_rgba8_sse2.h"
 #include "util/format_srgb.h"
 
 #define UNPACK(SRC, OFFSET, BITS) (((SRC) >> (OFFSET)) & MAX_UINT(BITS))
@@ -352,7 +353,17 @@ _mesa_pack_ubyte_rgba_row(mesa_format format, uint32_t n,
    %endif
 
    case ${f.name}:
+   %if f.is_rgba8_unorm():
+      i = 0;
+#ifdef __SSE2__
+      i = util_format_rgba8_swizzle_row_sse2(d, src[0], n,
+            ${', '.join(str(c) for c in f.rgba8_pack_swizzle())});
+      d += 4 * i;
+#endif
+      for (; i < n; ++i) {
+   %else:
       for (i = 0; i < n; ++i) {
+   %endif
          pack_ubyte_${f.short_name()}(src[i], d);
          d += ${f.block_size() // 8};
       }
@@ -414,7 +425,17 @@ _mesa_pack_float_rgba_row(mesa_format format, uint32_t n,
    %endif
 
    case ${f.name}:
+   %if f.is_rgba8_unorm():
+      i = 0;
+#ifdef __SSE2__
+      i = util_format_rgba8_from_float_row_sse2(d, src[0], n,
+            ${', '.join(str(c) for c in f.rgba8_pack_swizzle())}, true);
+      d += 4 * i;
+#endif
+      for (; i < n; ++i) {
+   %else:
       for (i = 0; i < n; ++i) {
+   %endif
          pack_float_${f.short_name()}(src[i], d);
          d += ${f.block_size() // 8};
       }
@@ -475,6 +475,49 @@ class Format:
             return channel
       return None
 
+   def is_rgba8_unorm(self):
+      """Returns true if this is a 32-bit packed RGB format with four 8-bit
+      unorm or padding channels.
+
+      These are the formats that the row converters in
+      util/format_rgba8_sse2.h handle.
+      """
+      if self.layout != PACKED or self.colorspace != RGB:
+         return False
+      if len(self.channels) != 4 or self.block_size() != 32:
+         return False
+      for c in self.channels:
+         if c.size != 8:
+            return False
+         if c.type != VOID and (c.type != UNSIGNED or not c.norm):
+            return False
+      return True
+
+   def rgba8_unpack_swizzle(self):
+      """Returns the source byte of each RGBA channel, for unpacking an
+      is_rgba8_unorm() format with the row converters.
+      """
+      assert self.is_rgba8_unorm()
+      swizzle = []
+      for s in self.swizzle:
+         if s <= Swizzle.SWIZZLE_W:
+            swizzle.append(self.channels[s].shift // 8)
+         else:
+            swizzle.append(s)
+      return swizzle
+
+   def rgba8_pack_swizzle(self):
+      """Returns the RGBA channel of each byte, for packing an
+      is_rgba8_unorm() format with the row converters.
+      """
+      assert self.is_rgba8_unorm()
+      inverse = self.swizzle.inverse()
+      swizzle = [Swizzle.SWIZZLE_ZERO] * 4
+      for (i, c) in enumerate(self.channels):
+         if c.type != VOID and inverse[i] <= Swizzle.SWIZZLE_W:
+            swizzle[c.shift // 8] = inverse[i]
+      return swizzle
+
    def datatype(self):
       """Returns the datatype corresponding to a format's channel type and size"""
       if self.layout == PACKED:
@@ -48,6 +48,7 @@ string = """/*
 #include "macros.h"
 #include "util/format_rgb9e5.h"
 #include "util/format_r11g11b10f.h"
+#include "util/format_rgba8_sse2.h"
 #include "util/format_srgb.h"
 
 #define UNPACK(SRC, OFFSET, BITS) (((SRC) >> (OFFSET)) & MAX_UINT(BITS))
@@ -319,7 +320,17 @@ _mesa_unpack_rgba_row(mesa_format format, uint32_t n,
       <% continue %>
    %endif
    case ${f.name}:
+   %if f.is_rgba8_unorm():
+      i = 0;
+#ifdef __SSE2__
+      i = util_format_rgba8_to_float_row_sse2(dst[0], s, n,
+            ${', '.join(str(c) for c in f.rgba8_unpack_swizzle())});
+      s += 4 * i;
+#endif
+      for (; i < n; ++i) {
+   %else:
       for (i = 0; i < n; ++i) {
+   %endif
          unpack_float_${f.short_name()}(s, dst[i]);
          s += ${f.block_size() // 8};
       }
@@ -350,7 +361,17 @@ _mesa_unpack_ubyte_rgba_row(mesa_format format, uint32_t n,
    %endif
 
    case ${f.name}:
+   %if f.is_rgba8_unorm():
+      i = 0;
+#ifdef __SSE2__
+      i = util_format_rgba8_swizzle_row_sse2(dst[0], s, n,
+            ${', '.join(str(c) for c in f.rgba8_unpack_swizzle())});
+      s += 4 * i;
+#endif
+      for (; i < n; ++i) {
+   %else:
       for (i = 0; i < n; ++i) {
+   %endif
          unpack_ubyte_${f.short_name()}(s, dst[i]);
          s += ${f.block_size() // 8};
       }
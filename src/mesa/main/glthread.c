@@ -32,28 +32,80 @@
  * thread.
  */
 
+#include <stdio.h>
+#include <stdlib.h>
+
 #include "main/mtypes.h"
 #include "main/glthread.h"
 #include "main/marshal.h"
 #include "main/marshal_generated.h"
+#include "util/debug.h"
+#include "util/hash_table.h"
+#include "util/os_time.h"
 #include "util/u_atomic.h"
 #include "util/u_thread.h"
 
 
+/**
+ * Executes the commands between two ring positions.
+ */
 static void
-glthread_unmarshal_batch(void *job, int thread_index)
+glthread_unmarshal_range(struct gl_context *ctx, uint32_t start, uint32_t end)
 {
-   struct glthread_batch *batch = (struct glthread_batch*)job;
-   struct gl_context *ctx = batch->ctx;
-   size_t pos = 0;
+   struct glthread_state *glthread = ctx->GLThread;
+   uint32_t pos = start;
+
+   while (pos != end) {
+      unsigned offset = pos % MARSHAL_RING_SIZE;
+      const struct marshal_cmd_base *cmd =
+         (const struct marshal_cmd_base *)&glthread->ring[offset];
+
+      if (cmd->cmd_size == 0) {
+         pos += MARSHAL_RING_SIZE - offset;
+         continue;
+      }
+
+      pos += _mesa_unmarshal_dispatch_cmd(ctx, cmd);
+   }
+}
+
+/**
+ * The worker thread job. It executes commands until there are no more, and
+ * then lets the main thread know that it has to be woken up again.
+ */
+static void
+glthread_unmarshal_job(void *job, int thread_index)
+{
+   struct gl_context *ctx = (struct gl_context*)job;
+   struct glthread_state *glthread = ctx->GLThread;
+   struct glthread_counters *counters = &glthread->counters;
+   uint32_t submit = p_atomic_read(&glthread->submit);
+   int64_t start_time = 0;
+
+   if (glthread->print_stats) {
+      start_time = os_time_get_nano();
+      if (counters->worker_idle_since)
+         counters->worker_idle_ns += start_time - counters->worker_idle_since;
+   }
 
    _glapi_set_dispatch(ctx->CurrentServerDispatch);
 
-   while (pos < batch->used)
-      pos += _mesa_unmarshal_dispatch_cmd(ctx, &batch->buffer[pos]);
+   while (true) {
+      uint32_t end = submit & ~1u;
+
+      glthread_unmarshal_range(ctx, glthread->consumed, end);
+      p_atomic_set(&glthread->consumed, end);
+
+      /* Go idle, unless more commands have been submitted meanwhile. */
+      submit = p_atomic_cmpxchg(&glthread->submit, end | 1, end);
+      if (submit == (end | 1))
+         break;
+   }
 
-   assert(pos == batch->used);
-   batch->used = 0;
+   if (glthread->print_stats) {
+      counters->worker_idle_since = os_time_get_nano();
+      counters->worker_busy_ns += counters->worker_idle_since - start_time;
+   }
 }
 
 static void
@@ -73,23 +125,45 @@ _mesa_glthread_init(struct gl_context *ctx)
    if (!glthread)
       return;
 
-   if (!util_queue_init(&glthread->queue, "gl", MARSHAL_MAX_BATCHES - 2,
-                        1, 0)) {
+   glthread->ring = malloc(MARSHAL_RING_SIZE);
+   if (!glthread->ring) {
+      free(glthread);
+      return;
+   }
+
+   /* The queue only holds the wake-ups of the worker thread, and there can
+    * be at most two of them at a time.
+    */
+   if (!util_queue_init(&glthread->queue, "gl", 2, 1, 0)) {
+      free(glthread->ring);
+      free(glthread);
+      return;
+   }
+
+   if (!_mesa_glthread_init_vaos(glthread)) {
+      util_queue_destroy(&glthread->queue);
+      free(glthread->ring);
       free(glthread);
       return;
    }
 
    ctx->MarshalExec = _mesa_create_marshal_table(ctx);
    if (!ctx->MarshalExec) {
+      _mesa_glthread_destroy_vaos(glthread);
       util_queue_destroy(&glthread->queue);
+      free(glthread->ring);
       free(glthread);
       return;
    }
 
-   for (unsigned i = 0; i < MARSHAL_MAX_BATCHES; i++) {
-      glthread->batches[i].ctx = ctx;
-      util_queue_fence_init(&glthread->batches[i].fence);
-   }
+   for (unsigned i = 0; i < ARRAY_SIZE(glthread->fences); i++)
+      util_queue_fence_init(&glthread->fences[i]);
+
+   glthread->limit = MARSHAL_FLUSH_SIZE;
+
+   glthread->print_stats = env_var_as_boolean("MESA_GLTHREAD_STATS", false);
+   if (glthread->print_stats)
+      glthread->counters.syncs = _mesa_pointer_hash_table_create(NULL);
 
    glthread->stats.queue = &glthread->queue;
    ctx->CurrentClientDispatch = ctx->MarshalExec;
@@ -104,6 +178,56 @@ _mesa_glthread_init(struct gl_context *ctx)
    util_queue_fence_destroy(&fence);
 }
 
+static int
+compare_syncs(const void *a, const void *b)
+{
+   const struct hash_entry *ea = *(const struct hash_entry **)a;
+   const struct hash_entry *eb = *(const struct hash_entry **)b;
+   uintptr_t ca = (uintptr_t)ea->data, cb = (uintptr_t)eb->data;
+
+   return ca < cb ? 1 : ca > cb ? -1 : 0;
+}
+
+static void
+glthread_print_stats(struct glthread_state *glthread)
+{
+   struct glthread_counters *counters = &glthread->counters;
+   unsigned flushes = MAX2(counters->num_flushes, 1);
+
+   fprintf(stderr, "glthread: %u flushes, %u of which woke up the worker "
+           "thread\n", counters->num_flushes, counters->num_wakeups);
+   fprintf(stderr, "glthread: %.1f commands and %.1f bytes per flush\n",
+           (double)counters->flushed_cmds / flushes,
+           (double)counters->flushed_bytes / flushes);
+   fprintf(stderr, "glthread: the ring was %.1f%% full on average when "
+           "flushing, %u waits for free space\n",
+           100.0 * counters->ring_used_bytes / flushes / MARSHAL_RING_SIZE,
+           counters->ring_full_waits);
+   fprintf(stderr, "glthread: the worker thread was busy for %.1f ms and "
+           "idle for %.1f ms\n", counters->worker_busy_ns / 1000000.0,
+           counters->worker_idle_ns / 1000000.0);
+
+   unsigned num_funcs = _mesa_hash_table_num_entries(counters->syncs);
+   if (!num_funcs)
+      return;
+
+   struct hash_entry **entries = malloc(num_funcs * sizeof(*entries));
+   if (!entries)
+      return;
+
+   unsigned i = 0;
+   hash_table_foreach(counters->syncs, entry)
+      entries[i++] = entry;
+   qsort(entries, num_funcs, sizeof(*entries), compare_syncs);
+
+   fprintf(stderr, "glthread: synchronizations:\n");
+   for (i = 0; i < num_funcs; i++) {
+      fprintf(stderr, "glthread: %10u %s\n", (unsigned)(uintptr_t)entries[i]->data,
+              (const char *)entries[i]->key);
+   }
+   free(entries);
+}
+
 void
 _mesa_glthread_destroy(struct gl_context *ctx)
 {
@@ -115,9 +239,16 @@ _mesa_glthread_destroy(struct gl_context *ctx)
    _mesa_glthread_finish(ctx);
    util_queue_destroy(&glthread->queue);
 
-   for (unsigned i = 0; i < MARSHAL_MAX_BATCHES; i++)
-      util_queue_fence_destroy(&glthread->batches[i].fence);
+   for (unsigned i = 0; i < ARRAY_SIZE(glthread->fences); i++)
+      util_queue_fence_destroy(&glthread->fences[i]);
+
+   if (glthread->print_stats) {
+      glthread_print_stats(glthread);
+      _mesa_hash_table_destroy(glthread->counters.syncs, NULL);
+   }
 
+   _mesa_glthread_destroy_vaos(glthread);
+   free(glthread->ring);
    free(glthread);
    ctx->GLThread = NULL;
 
@@ -142,6 +273,98 @@ _mesa_glthread_restore_dispatch(struct gl_context *ctx, const char *func)
    }
 }
 
+/**
+ * Waits until the worker thread has executed all flushed commands.
+ */
+static void
+glthread_wait_for_worker(struct glthread_state *glthread)
+{
+   util_queue_fence_wait(&glthread->fences[glthread->last_fence]);
+   glthread->known_consumed = glthread->flushed;
+}
+
+/**
+ * Called by _mesa_glthread_allocate_command() when a command of the given
+ * size doesn't fit before the limit, and regularly to check whether the
+ * recorded commands should be flushed.
+ */
+void
+_mesa_glthread_make_room(struct gl_context *ctx, unsigned size)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+   unsigned offset = glthread->head % MARSHAL_RING_SIZE;
+   unsigned padding = 0;
+
+   assert(size <= MARSHAL_MAX_CMD_SIZE);
+
+   /* Commands are contiguous, so skip the end of the ring if the command
+    * doesn't fit there.
+    */
+   if (offset + size > MARSHAL_RING_SIZE)
+      padding = MARSHAL_RING_SIZE - offset;
+
+   if (glthread->head + padding + size - glthread->known_consumed >
+       MARSHAL_RING_SIZE) {
+      glthread->known_consumed = p_atomic_read(&glthread->consumed);
+
+      if (glthread->head + padding + size - glthread->known_consumed >
+          MARSHAL_RING_SIZE) {
+         _mesa_glthread_flush_batch(ctx);
+         glthread_wait_for_worker(glthread);
+         glthread->counters.ring_full_waits++;
+      }
+   }
+
+   if (padding) {
+      struct marshal_cmd_base *cmd_base =
+         (struct marshal_cmd_base *)&glthread->ring[offset];
+
+      cmd_base->cmd_id = 0;
+      cmd_base->cmd_size = 0;
+      glthread->head += padding;
+   }
+
+   /* Flush often if the worker thread is busy, because that's cheap and
+    * keeps it busy. Otherwise, wait until there is enough work to be worth
+    * waking it up.
+    */
+   if (glthread->head != glthread->flushed) {
+      if (p_atomic_read(&glthread->submit) & 1 ||
+          glthread->head - glthread->flushed >= MARSHAL_FLUSH_SIZE ||
+          glthread->pending_cmds >= MARSHAL_FLUSH_COMMANDS) {
+         _mesa_glthread_flush_batch(ctx);
+      } else {
+         int64_t now = os_time_get_nano();
+
+         if (!glthread->pending_since)
+            glthread->pending_since = now;
+         else if (now - glthread->pending_since >= MARSHAL_FLUSH_NS)
+            _mesa_glthread_flush_batch(ctx);
+      }
+   }
+
+   /* Recording can continue without coming back here up to the end of the
+    * ring, the oldest unexecuted command, or the next flush, but it must
+    * always leave room for the command being recorded.
+    */
+   unsigned room = MIN2(MARSHAL_RING_SIZE - glthread->head % MARSHAL_RING_SIZE,
+                        MARSHAL_RING_SIZE -
+                        (glthread->head - glthread->known_consumed));
+   unsigned until_flush = 0;
+
+   if (glthread->head - glthread->flushed < MARSHAL_FLUSH_SIZE) {
+      until_flush = MARSHAL_FLUSH_SIZE -
+                    (glthread->head - glthread->flushed);
+   }
+
+   assert(room >= size);
+   glthread->limit = glthread->head + MIN2(room, MAX2(until_flush, size));
+}
+
+/**
+ * Hands the recorded commands over to the worker thread, waking it up if
+ * it's idle.
+ */
 void
 _mesa_glthread_flush_batch(struct gl_context *ctx)
 {
@@ -149,37 +372,55 @@ _mesa_glthread_flush_batch(struct gl_context *ctx)
    if (!glthread)
       return;
 
-   struct glthread_batch *next = &glthread->batches[glthread->next];
-   if (!next->used)
+   if (glthread->head == glthread->flushed)
       return;
 
-   /* Debug: execute the batch immediately from this thread.
-    *
-    * Note that glthread_unmarshal_batch() changes the dispatch table so we'll
-    * need to restore it when it returns.
+   unsigned size = glthread->head - glthread->flushed;
+
+   p_atomic_add(&glthread->stats.num_offloaded_items, size);
+
+   if (glthread->print_stats) {
+      struct glthread_counters *counters = &glthread->counters;
+
+      counters->num_flushes++;
+      counters->flushed_cmds += glthread->pending_cmds;
+      counters->flushed_bytes += size;
+      counters->ring_used_bytes +=
+         glthread->head - p_atomic_read(&glthread->consumed);
+   }
+
+   glthread->flushed = glthread->head;
+   glthread->pending_cmds = 0;
+   glthread->pending_since = 0;
+
+   /* Publish the new end of the commands and set the busy bit. If it wasn't
+    * set, the worker thread is idle and has to be woken up.
     */
-   if (false) {
-      glthread_unmarshal_batch(next, 0);
-      _glapi_set_dispatch(ctx->CurrentClientDispatch);
-      return;
+   uint32_t submit = p_atomic_read(&glthread->submit);
+   while (true) {
+      uint32_t old = p_atomic_cmpxchg(&glthread->submit, submit,
+                                      glthread->head | 1);
+      if (old == submit)
+         break;
+      submit = old;
    }
 
-   p_atomic_add(&glthread->stats.num_offloaded_items, next->used);
+   if (!(submit & 1)) {
+      /* The fence of the job before the previous one is signalled, because
+       * the previous job has started, so it can be reused.
+       */
+      glthread->last_fence ^= 1;
+      util_queue_add_job(&glthread->queue, ctx,
+                         &glthread->fences[glthread->last_fence],
+                         glthread_unmarshal_job, NULL, 0);
 
-   util_queue_add_job(&glthread->queue, next, &next->fence,
-                      glthread_unmarshal_batch, NULL, 0);
-   glthread->last = glthread->next;
-   glthread->next = (glthread->next + 1) % MARSHAL_MAX_BATCHES;
+      if (glthread->print_stats)
+         glthread->counters.num_wakeups++;
+   }
 }
 
-/**
- * Waits for all pending batches have been unmarshaled.
- *
- * This can be used by the main thread to synchronize access to the context,
- * since the worker thread will be idle after this.
- */
-void
-_mesa_glthread_finish(struct gl_context *ctx)
+static void
+glthread_finish(struct gl_context *ctx, const char *func)
 {
    struct glthread_state *glthread = ctx->GLThread;
    if (!glthread)
@@ -193,31 +434,79 @@ _mesa_glthread_finish(struct gl_context *ctx)
    if (u_thread_is_self(glthread->queue.threads[0]))
       return;
 
-   struct glthread_batch *last = &glthread->batches[glthread->last];
-   struct glthread_batch *next = &glthread->batches[glthread->next];
    bool synced = false;
 
-   if (!util_queue_fence_is_signalled(&last->fence)) {
-      util_queue_fence_wait(&last->fence);
+   if (p_atomic_read(&glthread->submit) & 1) {
+      /* The worker thread is busy, give it the rest of the commands and wait
+       * for it.
+       */
+      _mesa_glthread_flush_batch(ctx);
+      glthread_wait_for_worker(glthread);
       synced = true;
-   }
+   } else if (glthread->head != glthread->flushed) {
+      /* The worker thread is idle, so execute the rest of the commands in
+       * this thread instead of waking it up.
+       */
+      unsigned size = glthread->head - glthread->flushed;
 
-   if (next->used) {
-      p_atomic_add(&glthread->stats.num_direct_items, next->used);
+      p_atomic_add(&glthread->stats.num_direct_items, size);
 
-      /* Since glthread_unmarshal_batch changes the dispatch to direct,
-       * restore it after it's done.
+      /* Since glthread_unmarshal_range doesn't set the dispatch, but the
+       * commands may change it, restore it after it's done.
        */
       struct _glapi_table *dispatch = _glapi_get_dispatch();
-      glthread_unmarshal_batch(next, 0);
+      _glapi_set_dispatch(ctx->CurrentServerDispatch);
+      glthread_unmarshal_range(ctx, glthread->flushed, glthread->head);
       _glapi_set_dispatch(dispatch);
 
-      /* It's not a sync because we don't enqueue partial batches, but
-       * it would be a sync if we did. So count it anyway.
-       */
+      glthread->flushed = glthread->head;
+      glthread->known_consumed = glthread->head;
+      glthread->pending_cmds = 0;
+      glthread->pending_since = 0;
+      p_atomic_set(&glthread->consumed, glthread->head);
+      p_atomic_set(&glthread->submit, glthread->head);
       synced = true;
    }
 
-   if (synced)
+   /* The last job may still be returning after going idle. */
+   util_queue_fence_wait(&glthread->fences[glthread->last_fence]);
+
+   if (synced) {
       p_atomic_inc(&glthread->stats.num_syncs);
+
+      if (glthread->print_stats) {
+         struct hash_entry *entry;
+
+         if (!func)
+            func = "(internal)";
+
+         entry = _mesa_hash_table_search(glthread->counters.syncs, func);
+         if (entry)
+            entry->data = (void *)((uintptr_t)entry->data + 1);
+         else
+            _mesa_hash_table_insert(glthread->counters.syncs, func, (void *)1);
+      }
+   }
+}
+
+/**
+ * Waits for all pending commands to be executed.
+ *
+ * This can be used by the main thread to synchronize access to the context,
+ * since the worker thread will be idle after this.
+ */
+void
+_mesa_glthread_finish(struct gl_context *ctx)
+{
+   glthread_finish(ctx, NULL);
+}
+
+/**
+ * Same as _mesa_glthread_finish(), but the synchronization is counted for
+ * the given entry point with MESA_GLTHREAD_STATS.
+ */
+void
+_mesa_glthread_finish_before(struct gl_context *ctx, const char *func)
+{
+   glthread_finish(ctx, func);
 }
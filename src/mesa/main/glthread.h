@@ -24,83 +24,307 @@
 #ifndef _GLTHREAD_H
 #define _GLTHREAD_H
 
-/* The size of one batch and the maximum size of one call.
+/* The maximum size of one call.
  *
- * This should be as low as possible, so that:
- * - multiple synchronizations within a frame don't slow us down much
- * - a smaller number of calls per frame can still get decent parallelism
- * - the memory footprint of the queue is low, and with that comes a lower
- *   chance of experiencing CPU cache thrashing
- * but it should be high enough so that u_queue overhead remains negligible.
+ * Calls that need more than this are executed synchronously.
  */
 #define MARSHAL_MAX_CMD_SIZE (8 * 1024)
 
-/* The number of batch slots in memory.
+/* The size of the command ring shared by the main thread and the worker
+ * thread. It must be a power of two.
  *
- * One batch is being executed, one batch is being filled, the rest are
- * waiting batches. There must be at least 1 slot for a waiting batch,
- * so the minimum number of batches is 3.
+ * This is how far ahead of the worker thread the main thread can get. It
+ * should be large enough that the main thread rarely has to wait for free
+ * space, but small enough that the memory footprint of the ring is low and
+ * synchronizations don't have to drain a lot of commands.
  */
-#define MARSHAL_MAX_BATCHES 8
+#define MARSHAL_RING_SIZE (128 * 1024)
+
+/* Commands are handed over to the worker thread (flushed) when one of these
+ * is reached. Flushing while the worker thread is busy is just an atomic
+ * operation, so it's done every MARSHAL_FLUSH_CHECK_INTERVAL commands.
+ * Flushing to an idle worker thread wakes it up, which is expensive, so
+ * commands are batched until there are MARSHAL_FLUSH_SIZE bytes or
+ * MARSHAL_FLUSH_COMMANDS of them, or until the oldest one has been waiting
+ * for MARSHAL_FLUSH_NS.
+ */
+#define MARSHAL_FLUSH_CHECK_INTERVAL 16
+#define MARSHAL_FLUSH_SIZE (8 * 1024)
+#define MARSHAL_FLUSH_COMMANDS 256
+#define MARSHAL_FLUSH_NS (100 * 1000)
 
 #include <inttypes.h>
 #include <stdbool.h>
+#include "GL/gl.h"
+#include "compiler/shader_enums.h"
 #include "util/u_queue.h"
 
-enum marshal_dispatch_cmd_id;
 struct gl_context;
+struct hash_table;
+struct _mesa_HashTable;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A vertex array, as far as the main thread knows it.
+ */
+struct glthread_attrib
+{
+   /** The pointer of the array, an offset if it's in a buffer object. */
+   const GLubyte *pointer;
+
+   /** The size of one element of the array in bytes. */
+   GLubyte element_size;
+
+   /** The vertex buffer binding the array reads from (VERT_ATTRIB_*). */
+   GLubyte binding;
+};
+
+/**
+ * A vertex buffer binding, as far as the main thread knows it.
+ */
+struct glthread_vertex_buffer
+{
+   /** The buffer object name, 0 if the arrays are in client memory. */
+   GLuint buffer;
+
+   /** The effective stride (never 0 for gl*Pointer()) and divisor. */
+   GLsizei stride;
+   GLuint divisor;
+};
 
-/** A single batch of commands queued up for execution. */
-struct glthread_batch
+/**
+ * A vertex array object, as far as the main thread knows it.
+ */
+struct glthread_vao
 {
-   /** Batch fence for waiting for the execution to finish. */
-   struct util_queue_fence fence;
+   GLuint name;
+
+   /**
+    * Set when the vertex array object was changed in a way the main thread
+    * doesn't follow.  Binding it then makes the bound one unknown.
+    */
+   bool stale;
+
+   /** The element array buffer binding of the vertex array object. */
+   GLuint element_buffer;
+
+   /** The enabled arrays, and the arrays in client memory (VERT_BIT_*). */
+   GLbitfield enabled;
+   GLbitfield user_arrays;
+
+   struct glthread_attrib attribs[VERT_ATTRIB_MAX];
+   struct glthread_vertex_buffer vertex_buffers[VERT_ATTRIB_MAX];
+};
 
-   /** The worker thread will access the context with this. */
-   struct gl_context *ctx;
+/**
+ * The copies of the arrays in client memory a draw call reads, see
+ * _mesa_glthread_prepare_user_arrays().
+ */
+struct glthread_user_arrays
+{
+   /** The arrays being copied (VERT_BIT_*). */
+   GLbitfield arrays;
 
-   /** Amount of data used by batch commands, in bytes. */
-   size_t used;
+   /**
+    * For each array being copied, in order: where its first element copied
+    * is in client memory, which element that is, and which copy has it.
+    */
+   struct {
+      const GLubyte *begin;
+      uint32_t start;
+      unsigned copy;
+   } array[VERT_ATTRIB_MAX];
 
-   /** Data contained in the command buffer. */
-   uint8_t buffer[MARSHAL_MAX_CMD_SIZE];
+   /** The ranges of client memory to copy.  Interleaved arrays share one. */
+   unsigned num_copies;
+   struct {
+      const GLubyte *begin;
+      const GLubyte *end;
+   } copies[VERT_ATTRIB_MAX];
+};
+
+/**
+ * Statistics printed when the context is destroyed if MESA_GLTHREAD_STATS
+ * is set.
+ */
+struct glthread_counters
+{
+   /** Number of flushes, and how many of them woke up the worker thread. */
+   unsigned num_flushes;
+   unsigned num_wakeups;
+
+   /** Commands and bytes handed over to the worker thread. */
+   uint64_t flushed_cmds;
+   uint64_t flushed_bytes;
+
+   /** Sum of the number of unexecuted bytes in the ring at each flush. */
+   uint64_t ring_used_bytes;
+
+   /** Number of times the main thread waited for free space in the ring. */
+   unsigned ring_full_waits;
+
+   /** Synchronizations per entry point, as const char * -> uintptr_t. */
+   struct hash_table *syncs;
+
+   /** Only accessed by the worker thread. */
+   int64_t worker_idle_ns;
+   int64_t worker_busy_ns;
+   int64_t worker_idle_since;
 };
 
 struct glthread_state
 {
-   /** Multithreaded queue. */
+   /** Multithreaded queue, used to wake up the worker thread. */
    struct util_queue queue;
 
    /** This is sent to the driver for framebuffer overlay / HUD. */
    struct util_queue_monitoring stats;
 
-   /** The ring of batches in memory. */
-   struct glthread_batch batches[MARSHAL_MAX_BATCHES];
+   /**
+    * The command ring. Positions are byte offsets that only ever increase,
+    * and that are wrapped to the ring size when accessing it.
+    */
+   uint8_t *ring;
 
-   /** Index of the last submitted batch. */
-   unsigned last;
+   /**
+    * The end of the commands the worker thread may execute. Bit 0 is set
+    * while the worker thread is executing commands or is about to.
+    *
+    * Only modified with atomic compare-and-swaps, so that the main thread
+    * knows if it has to wake up the worker thread.
+    */
+   uint32_t submit;
 
-   /** Index of the batch being filled and about to be submitted. */
-   unsigned next;
+   /** Where the worker thread is. Written by the worker thread. */
+   uint32_t consumed;
+
+   /** The fences of the last two worker thread jobs. */
+   struct util_queue_fence fences[2];
+   unsigned last_fence;
+
+   /** Where the next command is recorded (main thread). */
+   uint32_t head;
 
    /**
-    * Tracks on the main thread side whether the current vertex array binding
-    * is in a VBO.
+    * The main thread can record commands up to this position without
+    * looking at the worker thread.
     */
-   bool vertex_array_is_vbo;
+   uint32_t limit;
+
+   /** The position of the last flush (main thread). */
+   uint32_t flushed;
+
+   /** The last known value of "consumed" (main thread). */
+   uint32_t known_consumed;
+
+   /** Commands recorded since the last flush and when it was noticed. */
+   unsigned pending_cmds;
+   int64_t pending_since;
+
+   /** Whether to collect and print statistics. */
+   bool print_stats;
+   struct glthread_counters counters;
 
    /**
-    * Tracks on the main thread side whether the current element array (index
-    * buffer) binding is in a VBO.
+    * The GL_ARRAY_BUFFER binding and the client active texture unit, tracked
+    * on the main thread side because gl*Pointer() makes an array read from
+    * client memory when no array buffer is bound.
     */
-   bool element_array_is_vbo;
+   GLuint array_buffer;
+   GLuint client_active_texture;
+
+   /**
+    * The vertex array objects created through glthread, by name, tracked on
+    * the main thread side because the element array (index buffer) binding
+    * and the vertex arrays belong to the vertex array object.
+    */
+   struct _mesa_HashTable *vaos;
+   struct glthread_vao default_vao;
+
+   /**
+    * The bound vertex array object, or NULL if the main thread doesn't know
+    * it (e.g. after glPopClientAttrib() or binding a name it hasn't seen).
+    */
+   struct glthread_vao *current_vao;
 };
 
 void _mesa_glthread_init(struct gl_context *ctx);
 void _mesa_glthread_destroy(struct gl_context *ctx);
 
 void _mesa_glthread_restore_dispatch(struct gl_context *ctx, const char *func);
+void _mesa_glthread_make_room(struct gl_context *ctx, unsigned size);
 void _mesa_glthread_flush_batch(struct gl_context *ctx);
 void _mesa_glthread_finish(struct gl_context *ctx);
+void _mesa_glthread_finish_before(struct gl_context *ctx, const char *func);
+
+bool _mesa_glthread_init_vaos(struct glthread_state *glthread);
+void _mesa_glthread_destroy_vaos(struct glthread_state *glthread);
+void _mesa_glthread_sync_vao(struct gl_context *ctx);
+
+void _mesa_glthread_BindBuffer(struct gl_context *ctx, GLenum target,
+                               GLuint buffer);
+void _mesa_glthread_DeleteBuffers(struct gl_context *ctx, GLsizei n,
+                                  const GLuint *buffers);
+void _mesa_glthread_GenVertexArrays(struct gl_context *ctx, GLsizei n,
+                                    GLuint *arrays);
+void _mesa_glthread_DeleteVertexArrays(struct gl_context *ctx, GLsizei n,
+                                       const GLuint *arrays);
+void _mesa_glthread_BindVertexArray(struct gl_context *ctx, GLuint array);
+void _mesa_glthread_VertexArrayElementBuffer(struct gl_context *ctx,
+                                             GLuint vaobj, GLuint buffer);
+void _mesa_glthread_PopClientAttrib(struct gl_context *ctx);
+void _mesa_glthread_ClientActiveTexture(struct gl_context *ctx,
+                                       GLenum texture);
+void _mesa_glthread_ClientState(struct gl_context *ctx, GLenum array,
+                                GLuint unit, bool enable);
+void _mesa_glthread_VertexAttribArray(struct gl_context *ctx,
+                                      const GLuint *vaobj, GLuint index,
+                                      bool enable);
+void _mesa_glthread_AttribPointer(struct gl_context *ctx,
+                                  gl_vert_attrib attrib, GLint size,
+                                  GLenum type, GLsizei stride,
+                                  const GLvoid *pointer);
+void _mesa_glthread_VertexAttribPointer(struct gl_context *ctx, GLuint index,
+                                        GLint size, GLenum type,
+                                        GLsizei stride, const GLvoid *pointer);
+void _mesa_glthread_VertexAttribDivisor(struct gl_context *ctx, GLuint index,
+                                        GLuint divisor);
+void _mesa_glthread_VertexAttribFormat(struct gl_context *ctx,
+                                       const GLuint *vaobj,
+                                       GLuint attribindex, GLint size,
+                                       GLenum type);
+void _mesa_glthread_VertexAttribBinding(struct gl_context *ctx,
+                                        const GLuint *vaobj,
+                                        GLuint attribindex,
+                                        GLuint bindingindex);
+void _mesa_glthread_VertexBuffers(struct gl_context *ctx,
+                                  const GLuint *vaobj, GLuint first,
+                                  GLsizei count, const GLuint *buffers,
+                                  const GLsizei *strides);
+void _mesa_glthread_VertexBindingDivisor(struct gl_context *ctx,
+                                         const GLuint *vaobj,
+                                         GLuint bindingindex,
+                                         GLuint divisor);
+
+int _mesa_glthread_prepare_user_arrays(struct gl_context *ctx,
+                                       struct glthread_user_arrays *upload,
+                                       GLint first, GLsizei count,
+                                       GLenum type, const GLvoid *indices,
+                                       GLint basevertex, GLsizei num_instances,
+                                       GLuint baseinstance);
+void _mesa_glthread_upload_user_arrays(const struct glthread_user_arrays *upload,
+                                       void *dst);
+void _mesa_glthread_bind_user_arrays(struct gl_context *ctx, const void *data,
+                                     const GLubyte **saved);
+void _mesa_glthread_unbind_user_arrays(struct gl_context *ctx,
+                                       const void *data,
+                                       const GLubyte *const *saved);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif /* _GLTHREAD_H*/
@@ -0,0 +1,867 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/** @file glthread_varray.c
+ *
+ * Main thread side tracking of the vertex array state that glthread needs to
+ * know about when marshalling draw calls.
+ *
+ * A draw call in a compatibility context reads its indices from client
+ * memory if no element array buffer is bound, and its vertices from client
+ * memory for the enabled arrays that were specified while no array buffer
+ * was bound.  Those have to be copied into the command, so that the draw
+ * doesn't have to be executed synchronously.  The element array buffer
+ * binding and the vertex arrays belong to the vertex array object, so
+ * they're tracked per vertex array object here.
+ *
+ * When the main thread loses track of the bound vertex array object, or of
+ * what it contains, the next draw synchronizes and reads it back from the
+ * context (see _mesa_glthread_sync_vao()).
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "main/bufferobj.h"
+#include "main/glformats.h"
+#include "main/glthread.h"
+#include "main/hash.h"
+#include "main/macros.h"
+#include "main/marshal.h"
+#include "main/mtypes.h"
+#include "util/bitscan.h"
+
+
+/** Resets a vertex array object to the state of a new one. */
+static void
+init_vao(struct glthread_vao *vao, GLuint name)
+{
+   memset(vao, 0, sizeof(*vao));
+   vao->name = name;
+
+   /* No array has a buffer object, and arrays with a NULL pointer are never
+    * copied, so the initial formats don't matter.
+    */
+   vao->user_arrays = VERT_BIT_ALL;
+   for (unsigned i = 0; i < VERT_ATTRIB_MAX; i++)
+      vao->attribs[i].binding = i;
+}
+
+bool
+_mesa_glthread_init_vaos(struct glthread_state *glthread)
+{
+   glthread->vaos = _mesa_NewHashTable();
+   if (!glthread->vaos)
+      return false;
+
+   init_vao(&glthread->default_vao, 0);
+   glthread->current_vao = &glthread->default_vao;
+   return true;
+}
+
+static void
+free_vao(GLuint key, void *data, void *userData)
+{
+   free(data);
+}
+
+void
+_mesa_glthread_destroy_vaos(struct glthread_state *glthread)
+{
+   if (!glthread->vaos)
+      return;
+
+   _mesa_HashDeleteAll(glthread->vaos, free_vao, NULL);
+   _mesa_DeleteHashTable(glthread->vaos);
+   glthread->vaos = NULL;
+   glthread->current_vao = NULL;
+}
+
+static struct glthread_vao *
+lookup_vao(struct glthread_state *glthread, GLuint name)
+{
+   if (name == 0)
+      return &glthread->default_vao;
+
+   return _mesa_HashLookupLocked(glthread->vaos, name);
+}
+
+static struct glthread_vao *
+create_vao(struct glthread_state *glthread, GLuint name)
+{
+   struct glthread_vao *vao = lookup_vao(glthread, name);
+
+   if (!vao) {
+      vao = malloc(sizeof(*vao));
+      if (!vao)
+         return NULL;
+
+      _mesa_HashInsertLocked(glthread->vaos, name, vao);
+   }
+
+   init_vao(vao, name);
+   return vao;
+}
+
+/**
+ * Returns the vertex array object a vertex array call changes, or NULL if the
+ * main thread doesn't know what it contains.  A non-NULL vaobj is the name
+ * passed to a direct state access function.
+ */
+static struct glthread_vao *
+get_vao(struct glthread_state *glthread, const GLuint *vaobj)
+{
+   struct glthread_vao *vao;
+
+   if (vaobj)
+      vao = _mesa_HashLookupLocked(glthread->vaos, *vaobj);
+   else
+      vao = glthread->current_vao;
+
+   return vao && !vao->stale ? vao : NULL;
+}
+
+/**
+ * Makes the main thread forget what a vertex array object contains, after a
+ * change it doesn't follow.  If it's bound, the next draw reads it back.
+ */
+static void
+forget_vao(struct glthread_state *glthread, struct glthread_vao *vao)
+{
+   vao->stale = true;
+   if (glthread->current_vao == vao)
+      glthread->current_vao = NULL;
+}
+
+static void
+forget_vao_cb(GLuint key, void *data, void *userData)
+{
+   forget_vao(userData, data);
+}
+
+/** Recomputes which arrays read from vertex buffer bindings without buffer. */
+static void
+update_user_arrays(struct glthread_vao *vao)
+{
+   vao->user_arrays = 0;
+   for (unsigned i = 0; i < VERT_ATTRIB_MAX; i++) {
+      if (!vao->vertex_buffers[vao->attribs[i].binding].buffer)
+         vao->user_arrays |= VERT_BIT(i);
+   }
+}
+
+/**
+ * Reads the vertex array bindings back from the context when the main thread
+ * doesn't know them.  The caller must have synchronized with the worker
+ * thread.
+ */
+void
+_mesa_glthread_sync_vao(struct gl_context *ctx)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+   struct gl_vertex_array_object *vao = ctx->Array.VAO;
+   struct glthread_vao *current;
+
+   glthread->array_buffer = ctx->Array.ArrayBufferObj ?
+                            ctx->Array.ArrayBufferObj->Name : 0;
+   glthread->client_active_texture = ctx->Array.ActiveTexture;
+
+   current = lookup_vao(glthread, vao->Name);
+   if (!current)
+      current = create_vao(glthread, vao->Name);
+   if (!current)
+      return;
+
+   current->stale = false;
+   current->element_buffer = vao->IndexBufferObj ? vao->IndexBufferObj->Name
+                                                 : 0;
+   current->enabled = vao->Enabled;
+
+   for (unsigned i = 0; i < VERT_ATTRIB_MAX; i++) {
+      const struct gl_array_attributes *array = &vao->VertexAttrib[i];
+      const struct gl_vertex_buffer_binding *binding = &vao->BufferBinding[i];
+
+      current->attribs[i].pointer = array->Ptr;
+      current->attribs[i].element_size = array->Format._ElementSize;
+      current->attribs[i].binding = array->BufferBindingIndex;
+
+      current->vertex_buffers[i].buffer =
+         _mesa_is_bufferobj(binding->BufferObj) ? binding->BufferObj->Name : 0;
+      current->vertex_buffers[i].stride = binding->Stride;
+      current->vertex_buffers[i].divisor = binding->InstanceDivisor;
+   }
+   update_user_arrays(current);
+
+   glthread->current_vao = current;
+}
+
+/** Tracks the current bindings for the vertex array and index array buffers.
+ *
+ * glVertexAttribPointer() and friends make the array read from the buffer
+ * object bound to GL_ARRAY_BUFFER, or from client memory if there's none.
+ *
+ * Note that GL core makes it so that a buffer binding with an invalid handle
+ * in the "buffer" parameter will throw an error, and then a
+ * glVertexAttribPointer() that followsmight not end up pointing at a VBO.
+ * However, in GL core the draw call would throw an error as well, so we don't
+ * really care if our tracking is wrong for this case -- we never need to
+ * marshal user data for draw calls, and the unmarshal will just generate an
+ * error or not as appropriate.
+ *
+ * For compatibility GL, we do need to accurately know whether the draw call
+ * on the unmarshal side will dereference a user pointer or load data from a
+ * VBO per vertex.  That would make it seem like we need to track whether a
+ * "buffer" is valid, so that we can know when an error will be generated
+ * instead of updating the binding.  However, compat GL has the ridiculous
+ * feature that if you pass a bad name, it just gens a buffer object for you,
+ * so we escape without having to know if things are valid or not.
+ */
+void
+_mesa_glthread_BindBuffer(struct gl_context *ctx, GLenum target,
+                          GLuint buffer)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+
+   switch (target) {
+   case GL_ARRAY_BUFFER:
+      glthread->array_buffer = buffer;
+      break;
+   case GL_ELEMENT_ARRAY_BUFFER:
+      if (glthread->current_vao)
+         glthread->current_vao->element_buffer = buffer;
+      break;
+   }
+}
+
+void
+_mesa_glthread_DeleteBuffers(struct gl_context *ctx, GLsizei n,
+                             const GLuint *buffers)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+   struct glthread_vao *vao = glthread->current_vao;
+
+   if (n < 0 || !buffers)
+      return;
+
+   /* Deleting a buffer unbinds it from the context and from the bound vertex
+    * array object only.
+    */
+   for (GLsizei i = 0; i < n; i++) {
+      if (!buffers[i])
+         continue;
+
+      if (buffers[i] == glthread->array_buffer)
+         glthread->array_buffer = 0;
+
+      if (!vao)
+         continue;
+
+      if (buffers[i] == vao->element_buffer)
+         vao->element_buffer = 0;
+
+      /* The arrays reading from it are left with their offset as a client
+       * memory pointer, which only matters to broken applications.
+       */
+      for (unsigned b = 0; b < VERT_ATTRIB_MAX; b++) {
+         if (vao->vertex_buffers[b].buffer == buffers[i]) {
+            forget_vao(glthread, vao);
+            vao = NULL;
+            break;
+         }
+      }
+   }
+}
+
+void
+_mesa_glthread_GenVertexArrays(struct gl_context *ctx, GLsizei n,
+                               GLuint *arrays)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+
+   if (n < 0 || !arrays)
+      return;
+
+   /* This is called after the (synchronous) call filled "arrays". */
+   for (GLsizei i = 0; i < n; i++) {
+      if (arrays[i])
+         create_vao(glthread, arrays[i]);
+   }
+}
+
+void
+_mesa_glthread_DeleteVertexArrays(struct gl_context *ctx, GLsizei n,
+                                  const GLuint *arrays)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+
+   if (n < 0 || !arrays)
+      return;
+
+   for (GLsizei i = 0; i < n; i++) {
+      struct glthread_vao *vao;
+
+      if (!arrays[i])
+         continue;
+
+      vao = _mesa_HashLookupLocked(glthread->vaos, arrays[i]);
+      if (!vao)
+         continue;
+
+      /* Deleting the bound vertex array object binds the default one. */
+      if (glthread->current_vao == vao)
+         glthread->current_vao = glthread->default_vao.stale ?
+                                 NULL : &glthread->default_vao;
+
+      _mesa_HashRemoveLocked(glthread->vaos, arrays[i]);
+      free(vao);
+   }
+}
+
+void
+_mesa_glthread_BindVertexArray(struct gl_context *ctx, GLuint array)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+   struct glthread_vao *vao = lookup_vao(glthread, array);
+
+   /* Binding a name glthread hasn't seen generated either fails, or binds a
+    * vertex array object created before glthread was enabled.  Either way,
+    * the next draw will find out.
+    */
+   glthread->current_vao = vao && !vao->stale ? vao : NULL;
+}
+
+void
+_mesa_glthread_VertexArrayElementBuffer(struct gl_context *ctx, GLuint vaobj,
+                                        GLuint buffer)
+{
+   struct glthread_vao *vao = lookup_vao(ctx->GLThread, vaobj);
+
+   /* An unknown vertex array object can't be the bound one, because that
+    * would have made the bound one unknown as well.
+    */
+   if (vao)
+      vao->element_buffer = buffer;
+}
+
+void
+_mesa_glthread_PopClientAttrib(struct gl_context *ctx)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+
+   /* This may restore any vertex array object binding, and the arrays of
+    * the vertex array object it binds.
+    */
+   _mesa_HashWalkLocked(glthread->vaos, forget_vao_cb, glthread);
+   forget_vao(glthread, &glthread->default_vao);
+   glthread->current_vao = NULL;
+}
+
+void
+_mesa_glthread_ClientActiveTexture(struct gl_context *ctx, GLenum texture)
+{
+   const GLuint unit = texture - GL_TEXTURE0;
+
+   if (unit < MAX_TEXTURE_COORD_UNITS)
+      ctx->GLThread->client_active_texture = unit;
+}
+
+static void
+set_enabled(struct glthread_vao *vao, gl_vert_attrib attrib, bool enable)
+{
+   if (enable)
+      vao->enabled |= VERT_BIT(attrib);
+   else
+      vao->enabled &= ~VERT_BIT(attrib);
+}
+
+/**
+ * Tracks gl{Enable,Disable}ClientState() and the array enables that go
+ * through gl{Enable,Disable}().  unit is the texture coordinate set of
+ * GL_TEXTURE_COORD_ARRAY.
+ */
+void
+_mesa_glthread_ClientState(struct gl_context *ctx, GLenum array, GLuint unit,
+                           bool enable)
+{
+   struct glthread_vao *vao = get_vao(ctx->GLThread, NULL);
+   gl_vert_attrib attrib;
+
+   if (!vao || (ctx->API != API_OPENGL_COMPAT && ctx->API != API_OPENGLES))
+      return;
+
+   switch (array) {
+   case GL_VERTEX_ARRAY:
+      attrib = VERT_ATTRIB_POS;
+      break;
+   case GL_NORMAL_ARRAY:
+      attrib = VERT_ATTRIB_NORMAL;
+      break;
+   case GL_COLOR_ARRAY:
+      attrib = VERT_ATTRIB_COLOR0;
+      break;
+   case GL_SECONDARY_COLOR_ARRAY:
+      attrib = VERT_ATTRIB_COLOR1;
+      break;
+   case GL_FOG_COORDINATE_ARRAY:
+      attrib = VERT_ATTRIB_FOG;
+      break;
+   case GL_INDEX_ARRAY:
+      attrib = VERT_ATTRIB_COLOR_INDEX;
+      break;
+   case GL_EDGE_FLAG_ARRAY:
+      attrib = VERT_ATTRIB_EDGEFLAG;
+      break;
+   case GL_POINT_SIZE_ARRAY_OES:
+      attrib = VERT_ATTRIB_POINT_SIZE;
+      break;
+   case GL_TEXTURE_COORD_ARRAY:
+      if (unit >= MAX_TEXTURE_COORD_UNITS)
+         return;
+      attrib = VERT_ATTRIB_TEX(unit);
+      break;
+   default:
+      return;
+   }
+
+   set_enabled(vao, attrib, enable);
+}
+
+/**
+ * Tracks gl{Enable,Disable}VertexAttribArray() and, with vaobj,
+ * gl{Enable,Disable}VertexArrayAttrib().
+ */
+void
+_mesa_glthread_VertexAttribArray(struct gl_context *ctx, const GLuint *vaobj,
+                                 GLuint index, bool enable)
+{
+   struct glthread_vao *vao = get_vao(ctx->GLThread, vaobj);
+
+   if (vao && index < VERT_ATTRIB_GENERIC_MAX)
+      set_enabled(vao, VERT_ATTRIB_GENERIC(index), enable);
+}
+
+/**
+ * Tracks the gl*Pointer() calls, which make the array read from the array
+ * buffer, or from client memory if none is bound.
+ */
+void
+_mesa_glthread_AttribPointer(struct gl_context *ctx, gl_vert_attrib attrib,
+                             GLint size, GLenum type, GLsizei stride,
+                             const GLvoid *pointer)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+   struct glthread_vao *vao = get_vao(glthread, NULL);
+   int element_size;
+
+   if (!vao)
+      return;
+
+   element_size = size >= 1 && size <= 4 ?
+                  _mesa_bytes_per_vertex_attrib(size, type) :
+                  size == GL_BGRA ? _mesa_bytes_per_vertex_attrib(4, type) : -1;
+   if (element_size <= 0 || stride < 0) {
+      /* Most likely an error, but leave that to Mesa core. */
+      forget_vao(glthread, vao);
+      return;
+   }
+
+   vao->attribs[attrib].pointer = pointer;
+   vao->attribs[attrib].element_size = element_size;
+   vao->attribs[attrib].binding = attrib;
+   vao->vertex_buffers[attrib].buffer = glthread->array_buffer;
+   vao->vertex_buffers[attrib].stride = stride ? stride : element_size;
+   update_user_arrays(vao);
+}
+
+void
+_mesa_glthread_VertexAttribPointer(struct gl_context *ctx, GLuint index,
+                                   GLint size, GLenum type, GLsizei stride,
+                                   const GLvoid *pointer)
+{
+   if (index < VERT_ATTRIB_GENERIC_MAX) {
+      _mesa_glthread_AttribPointer(ctx, VERT_ATTRIB_GENERIC(index), size,
+                                   type, stride, pointer);
+   }
+}
+
+void
+_mesa_glthread_VertexAttribDivisor(struct gl_context *ctx, GLuint index,
+                                   GLuint divisor)
+{
+   struct glthread_vao *vao = get_vao(ctx->GLThread, NULL);
+   gl_vert_attrib attrib;
+
+   if (!vao || index >= VERT_ATTRIB_GENERIC_MAX)
+      return;
+
+   /* This also binds the array to the vertex buffer binding of the same
+    * index, like glVertexAttribPointer() does.
+    */
+   attrib = VERT_ATTRIB_GENERIC(index);
+   vao->attribs[attrib].binding = attrib;
+   vao->vertex_buffers[attrib].divisor = divisor;
+   update_user_arrays(vao);
+}
+
+/*
+ * The GL_ARB_vertex_attrib_binding functions below can't make an array read
+ * from client memory without glBindVertexBuffer(..., 0, ...) or an array
+ * already reading from it, which compatibility applications mixing them with
+ * client memory arrays hardly do.  Those cases make the main thread read the
+ * vertex array object back.
+ */
+
+void
+_mesa_glthread_VertexAttribFormat(struct gl_context *ctx, const GLuint *vaobj,
+                                  GLuint attribindex, GLint size, GLenum type)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+   struct glthread_vao *vao = get_vao(glthread, vaobj);
+
+   if (vao && attribindex < VERT_ATTRIB_GENERIC_MAX &&
+       vao->user_arrays & VERT_BIT_GENERIC(attribindex))
+      forget_vao(glthread, vao);
+}
+
+void
+_mesa_glthread_VertexAttribBinding(struct gl_context *ctx, const GLuint *vaobj,
+                                   GLuint attribindex, GLuint bindingindex)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+   struct glthread_vao *vao = get_vao(glthread, vaobj);
+
+   if (!vao || attribindex >= VERT_ATTRIB_GENERIC_MAX ||
+       bindingindex >= VERT_ATTRIB_GENERIC_MAX)
+      return;
+
+   if (!vao->vertex_buffers[VERT_ATTRIB_GENERIC(bindingindex)].buffer) {
+      forget_vao(glthread, vao);
+      return;
+   }
+
+   vao->attribs[VERT_ATTRIB_GENERIC(attribindex)].binding =
+      VERT_ATTRIB_GENERIC(bindingindex);
+   update_user_arrays(vao);
+}
+
+/**
+ * Tracks glBindVertexBuffer(s)() and glVertexArrayVertexBuffer(s)().  A NULL
+ * buffers unbinds all of them.
+ */
+void
+_mesa_glthread_VertexBuffers(struct gl_context *ctx, const GLuint *vaobj,
+                             GLuint first, GLsizei count,
+                             const GLuint *buffers, const GLsizei *strides)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+   struct glthread_vao *vao = get_vao(glthread, vaobj);
+
+   if (!vao || count < 0 || first >= VERT_ATTRIB_GENERIC_MAX ||
+       count > VERT_ATTRIB_GENERIC_MAX - first)
+      return;
+
+   for (GLsizei i = 0; i < count; i++) {
+      struct glthread_vertex_buffer *vb =
+         &vao->vertex_buffers[VERT_ATTRIB_GENERIC(first + i)];
+
+      if (!buffers || !buffers[i]) {
+         forget_vao(glthread, vao);
+         return;
+      }
+
+      vb->buffer = buffers[i];
+      vb->stride = strides ? strides[i] : 0;
+   }
+   update_user_arrays(vao);
+}
+
+void
+_mesa_glthread_VertexBindingDivisor(struct gl_context *ctx,
+                                    const GLuint *vaobj, GLuint bindingindex,
+                                    GLuint divisor)
+{
+   struct glthread_vao *vao = get_vao(ctx->GLThread, vaobj);
+
+   if (vao && bindingindex < VERT_ATTRIB_GENERIC_MAX)
+      vao->vertex_buffers[VERT_ATTRIB_GENERIC(bindingindex)].divisor = divisor;
+}
+
+/**
+ * The copies of the arrays in client memory in a command start with the
+ * VERT_BIT_* mask of the arrays, followed by one of these for each, followed
+ * by the copied data.
+ */
+struct user_array_record
+{
+   /** Where the first element copied is, from the start of the data. */
+   uint32_t offset;
+
+   /** Which element that is. */
+   uint32_t start;
+};
+
+/** Computes the smallest and largest of count indices. */
+static void
+get_index_range(const void *indices, unsigned index_size, unsigned count,
+                unsigned *min_index, unsigned *max_index)
+{
+   unsigned min = ~0u, max = 0;
+
+   switch (index_size) {
+   case 1:
+      for (unsigned i = 0; i < count; i++) {
+         min = MIN2(min, ((const GLubyte *) indices)[i]);
+         max = MAX2(max, ((const GLubyte *) indices)[i]);
+      }
+      break;
+   case 2:
+      for (unsigned i = 0; i < count; i++) {
+         min = MIN2(min, ((const GLushort *) indices)[i]);
+         max = MAX2(max, ((const GLushort *) indices)[i]);
+      }
+      break;
+   default:
+      for (unsigned i = 0; i < count; i++) {
+         min = MIN2(min, ((const GLuint *) indices)[i]);
+         max = MAX2(max, ((const GLuint *) indices)[i]);
+      }
+      break;
+   }
+
+   *min_index = min;
+   *max_index = max;
+}
+
+/**
+ * Finds out which parts of the enabled arrays in client memory a draw call
+ * reads, so that they can be copied into the command.
+ *
+ * A type of 0 is a non-indexed draw of count vertices from first (an indexed
+ * draw with that type only generates an error).  Otherwise the draw reads
+ * count indices of that type, which must be in client memory (indices) for
+ * the range of vertices to be known.
+ *
+ * Returns the number of bytes _mesa_glthread_upload_user_arrays() writes, 0
+ * if the draw doesn't read client memory, or -1 if the draw has to be
+ * executed synchronously.
+ */
+int
+_mesa_glthread_prepare_user_arrays(struct gl_context *ctx,
+                                   struct glthread_user_arrays *upload,
+                                   GLint first, GLsizei count,
+                                   GLenum type, const GLvoid *indices,
+                                   GLint basevertex, GLsizei num_instances,
+                                   GLuint baseinstance)
+{
+   const struct glthread_vao *vao;
+   GLbitfield arrays;
+   unsigned min_index, max_index, size;
+
+   upload->arrays = 0;
+   upload->num_copies = 0;
+
+   if (ctx->API == API_OPENGL_CORE)
+      return 0;
+
+   vao = _mesa_glthread_get_current_vao(ctx);
+   if (!vao)
+      return -1;
+
+   arrays = vao->enabled & vao->user_arrays;
+   if (!arrays)
+      return 0;
+
+   /* Nothing is drawn, or Mesa core generates an error. */
+   if (count <= 0 || num_instances <= 0)
+      return 0;
+
+   if (type) {
+      const unsigned index_size = type == GL_UNSIGNED_BYTE ? 1 :
+                                  type == GL_UNSIGNED_SHORT ? 2 :
+                                  type == GL_UNSIGNED_INT ? 4 : 0;
+
+      if (!indices || !index_size ||
+          (unsigned) count > MARSHAL_MAX_CMD_SIZE / index_size)
+         return -1;
+
+      /* Primitive restart isn't tracked, so a restart index only makes the
+       * range too large to be copied.
+       */
+      get_index_range(indices, index_size, count, &min_index, &max_index);
+      if ((int64_t) min_index + basevertex < 0 ||
+          (int64_t) max_index + basevertex > UINT32_MAX)
+         return -1;
+      min_index += basevertex;
+      max_index += basevertex;
+   } else {
+      if (first < 0 || (uint64_t) first + count - 1 > UINT32_MAX)
+         return -1;
+      min_index = first;
+      max_index = first + count - 1;
+   }
+
+   size = sizeof(GLbitfield);
+   while (arrays) {
+      const unsigned i = u_bit_scan(&arrays);
+      const struct glthread_attrib *attrib = &vao->attribs[i];
+      const struct glthread_vertex_buffer *vb =
+         &vao->vertex_buffers[attrib->binding];
+      unsigned start = min_index, end = max_index, c, n;
+      const GLubyte *begin;
+      uint64_t bytes;
+
+      /* Mesa core doesn't fetch from a NULL pointer either. */
+      if (!attrib->pointer)
+         continue;
+
+      if (vb->divisor) {
+         start = baseinstance;
+         end = baseinstance + (num_instances - 1) / vb->divisor;
+         if (end < start)
+            return -1;
+      }
+
+      bytes = (uint64_t) (end - start) * vb->stride + attrib->element_size;
+      if (bytes > MARSHAL_MAX_CMD_SIZE)
+         return -1;
+      begin = attrib->pointer + (uintptr_t) start * vb->stride;
+
+      /* Interleaved arrays end up in the same copy. */
+      for (c = 0; c < upload->num_copies; c++) {
+         if (begin <= upload->copies[c].end &&
+             upload->copies[c].begin <= begin + bytes)
+            break;
+      }
+      if (c == upload->num_copies) {
+         upload->copies[c].begin = begin;
+         upload->copies[c].end = begin + bytes;
+         upload->num_copies++;
+      } else {
+         upload->copies[c].begin = MIN2(upload->copies[c].begin, begin);
+         upload->copies[c].end = MAX2(upload->copies[c].end, begin + bytes);
+      }
+
+      n = util_bitcount(upload->arrays);
+      upload->array[n].begin = begin;
+      upload->array[n].start = start;
+      upload->array[n].copy = c;
+      upload->arrays |= VERT_BIT(i);
+
+      /* Checking as we go keeps the copies from overflowing. */
+      if (upload->copies[c].end - upload->copies[c].begin >
+          MARSHAL_MAX_CMD_SIZE)
+         return -1;
+   }
+
+   if (!upload->arrays)
+      return 0;
+
+   size += util_bitcount(upload->arrays) * sizeof(struct user_array_record);
+   for (unsigned c = 0; c < upload->num_copies; c++) {
+      size += ALIGN(upload->copies[c].end - upload->copies[c].begin, 4);
+      if (size > MARSHAL_MAX_CMD_SIZE)
+         return -1;
+   }
+
+   return size;
+}
+
+/**
+ * Writes the copies of the arrays _mesa_glthread_prepare_user_arrays() found
+ * into a command.
+ */
+void
+_mesa_glthread_upload_user_arrays(const struct glthread_user_arrays *upload,
+                                  void *dst)
+{
+   const unsigned num_arrays = util_bitcount(upload->arrays);
+   struct user_array_record *records =
+      (struct user_array_record *) ((GLbitfield *) dst + 1);
+   GLubyte *data = (GLubyte *) (records + num_arrays);
+   uint32_t offsets[VERT_ATTRIB_MAX];
+
+   *(GLbitfield *) dst = upload->arrays;
+
+   for (unsigned c = 0; c < upload->num_copies; c++) {
+      const size_t size = upload->copies[c].end - upload->copies[c].begin;
+
+      offsets[c] = data - (GLubyte *) dst;
+      memcpy(data, upload->copies[c].begin, size);
+      data += ALIGN(size, 4);
+   }
+
+   for (unsigned n = 0; n < num_arrays; n++) {
+      const unsigned c = upload->array[n].copy;
+
+      records[n].offset = offsets[c] +
+         (upload->array[n].begin - upload->copies[c].begin);
+      records[n].start = upload->array[n].start;
+   }
+}
+
+/**
+ * Makes the arrays of the bound vertex array object that were copied into a
+ * command read from the copies, for the draw call of the command.  This is
+ * called by the worker thread, and the previous pointers are saved per
+ * attribute.
+ */
+void
+_mesa_glthread_bind_user_arrays(struct gl_context *ctx, const void *data,
+                                const GLubyte **saved)
+{
+   struct gl_vertex_array_object *vao = ctx->Array.VAO;
+   const GLbitfield arrays = *(const GLbitfield *) data;
+   const struct user_array_record *records =
+      (const struct user_array_record *) ((const GLbitfield *) data + 1);
+   GLbitfield mask = arrays;
+
+   while (mask) {
+      const unsigned i = u_bit_scan(&mask);
+      struct gl_array_attributes *array = &vao->VertexAttrib[i];
+      const GLsizei stride = vao->BufferBinding[array->BufferBindingIndex].Stride;
+
+      saved[i] = array->Ptr;
+      array->Ptr = (const GLubyte *) data + records->offset -
+                   (intptr_t) records->start * stride;
+      records++;
+   }
+
+   vao->NewArrays |= vao->Enabled & arrays;
+}
+
+void
+_mesa_glthread_unbind_user_arrays(struct gl_context *ctx, const void *data,
+                                  const GLubyte *const *saved)
+{
+   struct gl_vertex_array_object *vao = ctx->Array.VAO;
+   const GLbitfield arrays = *(const GLbitfield *) data;
+   GLbitfield mask = arrays;
+
+   while (mask) {
+      const unsigned i = u_bit_scan(&mask);
+
+      vao->VertexAttrib[i].Ptr = saved[i];
+   }
+
+   vao->NewArrays |= vao->Enabled & arrays;
+}
@@ -38,6 +38,43 @@
 #include "glheader.h"
 #include "hash.h"
 #include "util/hash_table.h"
+#include "util/u_atomic.h"
+
+
+/**
+ * The data of the keys below Size, indexed by key, NULL for unused keys.
+ *
+ * Readers may use an array without the mutex, so when it grows, the old one
+ * is only freed with the table.
+ */
+struct _mesa_HashDense {
+   GLuint Size;
+   struct _mesa_HashDense *Prev;   /**< the array this one replaced */
+   void *Data[];
+};
+
+/** Initial size of the dense array, which must cover DELETED_KEY_VALUE. */
+#define DENSE_MIN_SIZE 64
+
+/** Keys from this one on are always stored in the struct hash_table. */
+#define DENSE_MAX_SIZE (64 * 1024)
+
+
+static struct _mesa_HashDense *
+dense_alloc(GLuint size, struct _mesa_HashDense *prev)
+{
+   struct _mesa_HashDense *dense =
+      calloc(1, sizeof(*dense) + size * sizeof(dense->Data[0]));
+
+   if (dense) {
+      dense->Size = size;
+      dense->Prev = prev;
+      if (prev) {
+         memcpy(dense->Data, prev->Data, prev->Size * sizeof(prev->Data[0]));
+      }
+   }
+   return dense;
+}
 
 
 /**
@@ -53,12 +90,16 @@ _mesa_NewHashTable(void)
    if (table) {
       table->ht = _mesa_hash_table_create(NULL, uint_key_hash,
                                           uint_key_compare);
-      if (table->ht == NULL) {
+      table->Dense = dense_alloc(DENSE_MIN_SIZE, NULL);
+      if (table->ht == NULL || table->Dense == NULL) {
+         _mesa_hash_table_destroy(table->ht, NULL);
+         free(table->Dense);
          free(table);
          _mesa_error_no_memory(__func__);
          return NULL;
       }
 
+      STATIC_ASSERT(DELETED_KEY_VALUE < DENSE_MIN_SIZE);
       _mesa_hash_table_set_deleted_key(table->ht, uint_key(DELETED_KEY_VALUE));
       /*
        * Needs to be recursive, since the callback in _mesa_HashWalk()
@@ -88,12 +129,19 @@ _mesa_DeleteHashTable(struct _mesa_HashTable *table)
 {
    assert(table);
 
-   if (_mesa_hash_table_next_entry(table->ht, NULL) != NULL) {
+   if (_mesa_hash_table_next_entry(table->ht, NULL) != NULL ||
+       table->DenseCount) {
       _mesa_problem(NULL, "In _mesa_DeleteHashTable, found non-freed data");
    }
 
    _mesa_hash_table_destroy(table->ht, NULL);
 
+   while (table->Dense) {
+      struct _mesa_HashDense *prev = table->Dense->Prev;
+      free(table->Dense);
+      table->Dense = prev;
+   }
+
    mtx_destroy(&table->Mutex);
    free(table);
 }
@@ -112,9 +160,6 @@ _mesa_HashLookup_unlocked(struct _mesa_HashTable *table, GLuint key)
    assert(table);
    assert(key);
 
-   if (key == DELETED_KEY_VALUE)
-      return table->deleted_key_data;
-
    entry = _mesa_hash_table_search_pre_hashed(table->ht,
                                               uint_hash(key),
                                               uint_key(key));
@@ -136,9 +181,20 @@ _mesa_HashLookup_unlocked(struct _mesa_HashTable *table, GLuint key)
 void *
 _mesa_HashLookup(struct _mesa_HashTable *table, GLuint key)
 {
+   struct _mesa_HashDense *dense = p_atomic_read(&table->Dense);
    void *res;
+
+   /* The dense array is only modified with atomic stores and never freed
+    * while the table is alive, so it doesn't need the mutex.
+    */
+   if (key < dense->Size)
+      return p_atomic_read(&dense->Data[key]);
+
+   /* The dense array may have grown over the key and taken its entry out of
+    * the struct hash_table since it was read, so look at both again.
+    */
    _mesa_HashLockMutex(table);
-   res = _mesa_HashLookup_unlocked(table, key);
+   res = _mesa_HashLookupLocked(table, key);
    _mesa_HashUnlockMutex(table);
    return res;
 }
@@ -158,10 +214,48 @@ _mesa_HashLookup(struct _mesa_HashTable *table, GLuint key)
 void *
 _mesa_HashLookupLocked(struct _mesa_HashTable *table, GLuint key)
 {
+   if (key < table->Dense->Size)
+      return table->Dense->Data[key];
+
    return _mesa_HashLookup_unlocked(table, key);
 }
 
 
+/**
+ * Grows the dense array so that it covers key, and moves the entries it
+ * now covers out of the struct hash_table.
+ */
+static bool
+dense_grow(struct _mesa_HashTable *table, GLuint key)
+{
+   struct _mesa_HashDense *dense;
+   GLuint size = table->Dense->Size;
+
+   while (size <= key)
+      size *= 2;
+
+   dense = dense_alloc(size, table->Dense);
+   if (!dense)
+      return false;
+
+   hash_table_foreach(table->ht, entry) {
+      GLuint entry_key = (uintptr_t)entry->key;
+
+      if (entry_key < size) {
+         if (entry->data) {
+            dense->Data[entry_key] = entry->data;
+            table->DenseCount++;
+         }
+         _mesa_hash_table_remove(table->ht, entry);
+      }
+   }
+
+   /* Publish the array only once it's complete. */
+   p_atomic_set(&table->Dense, dense);
+   return true;
+}
+
+
 static inline void
 _mesa_HashInsert_unlocked(struct _mesa_HashTable *table, GLuint key, void *data)
 {
@@ -174,8 +268,18 @@ _mesa_HashInsert_unlocked(struct _mesa_HashTable *table, GLuint key, void *data)
    if (key > table->MaxKey)
       table->MaxKey = key;
 
-   if (key == DELETED_KEY_VALUE) {
-      table->deleted_key_data = data;
+   /* Names allocated sequentially grow the dense array, other ones go into
+    * the struct hash_table.
+    */
+   if (key >= table->Dense->Size && key < DENSE_MAX_SIZE &&
+       key < 2 * table->Dense->Size)
+      dense_grow(table, key);
+
+   if (key < table->Dense->Size) {
+      struct _mesa_HashDense *dense = table->Dense;
+
+      table->DenseCount += (data != NULL) - (dense->Data[key] != NULL);
+      p_atomic_set(&dense->Data[key], data);
    } else {
       entry = _mesa_hash_table_search_pre_hashed(table->ht, hash, uint_key(key));
       if (entry) {
@@ -244,8 +348,13 @@ _mesa_HashRemove_unlocked(struct _mesa_HashTable *table, GLuint key)
     */
    assert(!table->InDeleteAll);
 
-   if (key == DELETED_KEY_VALUE) {
-      table->deleted_key_data = NULL;
+   if (key < table->Dense->Size) {
+      struct _mesa_HashDense *dense = table->Dense;
+
+      if (dense->Data[key]) {
+         table->DenseCount--;
+         p_atomic_set(&dense->Data[key], NULL);
+      }
    } else {
       entry = _mesa_hash_table_search_pre_hashed(table->ht,
                                                  uint_hash(key),
@@ -283,17 +392,25 @@ _mesa_HashDeleteAll(struct _mesa_HashTable *table,
                     void (*callback)(GLuint key, void *data, void *userData),
                     void *userData)
 {
+   struct _mesa_HashDense *dense;
+
    assert(callback);
    _mesa_HashLockMutex(table);
    table->InDeleteAll = GL_TRUE;
+   dense = table->Dense;
+   for (GLuint key = 0; key < dense->Size; key++) {
+      void *data = dense->Data[key];
+
+      if (data) {
+         callback(key, data, userData);
+         p_atomic_set(&dense->Data[key], NULL);
+      }
+   }
+   table->DenseCount = 0;
    hash_table_foreach(table->ht, entry) {
       callback((uintptr_t)entry->key, entry->data, userData);
       _mesa_hash_table_remove(table->ht, entry);
    }
-   if (table->deleted_key_data) {
-      callback(DELETED_KEY_VALUE, table->deleted_key_data, userData);
-      table->deleted_key_data = NULL;
-   }
    table->InDeleteAll = GL_FALSE;
    _mesa_HashUnlockMutex(table);
 }
@@ -314,11 +431,18 @@ hash_walk_unlocked(const struct _mesa_HashTable *table,
    assert(table);
    assert(callback);
 
+   /* The callback may modify the table, so look at the current dense array
+    * for every key.
+    */
+   for (GLuint key = 0; key < table->Dense->Size; key++) {
+      void *data = table->Dense->Data[key];
+
+      if (data)
+         callback(key, data, userData);
+   }
    hash_table_foreach(table->ht, entry) {
       callback((uintptr_t)entry->key, entry->data, userData);
    }
-   if (table->deleted_key_data)
-      callback(DELETED_KEY_VALUE, table->deleted_key_data, userData);
 }
 
 
@@ -357,8 +481,6 @@ debug_print_entry(GLuint key, void *data, void *userData)
 void
 _mesa_HashPrint(const struct _mesa_HashTable *table)
 {
-   if (table->deleted_key_data)
-      debug_print_entry(DELETED_KEY_VALUE, table->deleted_key_data, NULL);
    _mesa_HashWalk(table, debug_print_entry, NULL);
 }
 
@@ -390,7 +512,7 @@ _mesa_HashFindFreeKeyBlock(struct _mesa_HashTable *table, GLuint numKeys)
       GLuint freeStart = 1;
       GLuint key;
       for (key = 1; key != maxKey; key++) {
-	 if (_mesa_HashLookup_unlocked(table, key)) {
+	 if (_mesa_HashLookupLocked(table, key)) {
 	    /* darn, this key is already in use */
 	    freeCount = 0;
 	    freeStart = key+1;
@@ -415,12 +537,5 @@ _mesa_HashFindFreeKeyBlock(struct _mesa_HashTable *table, GLuint numKeys)
 GLuint
 _mesa_HashNumEntries(const struct _mesa_HashTable *table)
 {
-   GLuint count = 0;
-
-   if (table->deleted_key_data)
-      count++;
-
-   count += _mesa_hash_table_num_entries(table->ht);
-
-   return count;
+   return table->DenseCount + _mesa_hash_table_num_entries(table->ht);
 }
@@ -36,16 +36,19 @@
 #include "imports.h"
 #include "c11/threads.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /**
- * Magic GLuint object name that gets stored outside of the struct hash_table.
+ * Magic GLuint object name that the struct hash_table uses as its deleted key.
  *
  * The hash table needs a particular pointer to be the marker for a key that
  * was deleted from the table, along with NULL for the "never allocated in the
  * table" marker.  Legacy GL allows any GLuint to be used as a GL object name,
- * and we use a 1:1 mapping from GLuints to key pointers, so we need to be
- * able to track a GLuint that happens to match the deleted key outside of
- * struct hash_table.  We tell the hash table to use "1" as the deleted key
- * value, so that we test the deleted-key-in-the-table path as best we can.
+ * and we use a 1:1 mapping from GLuints to key pointers, so this key has to
+ * be stored outside of struct hash_table.  Small keys are always stored in
+ * the dense array (see struct _mesa_HashTable), so this is the case for "1".
  */
 #define DELETED_KEY_VALUE 1
 
@@ -93,16 +96,23 @@ uint_key(GLuint id)
 }
 /** @} */
 
+struct _mesa_HashDense;
+
 /**
  * The hash table data structure.
+ *
+ * Keys below the size of the dense array are stored in it, the others in the
+ * struct hash_table.  Since most names come from glGen*() and are allocated
+ * sequentially from 1, most lookups hit the dense array, which can be read
+ * without taking the mutex.  Every modification is done with the mutex held.
  */
 struct _mesa_HashTable {
    struct hash_table *ht;
+   struct _mesa_HashDense *Dense;        /**< data of keys below Dense->Size */
+   GLuint DenseCount;                    /**< number of entries in Dense */
    GLuint MaxKey;                        /**< highest key inserted so far */
    mtx_t Mutex;                          /**< mutual exclusion lock */
    GLboolean InDeleteAll;                /**< Debug check */
-   /** Value that would be in the table for DELETED_KEY_VALUE. */
-   void *deleted_key_data;
 };
 
 extern struct _mesa_HashTable *_mesa_NewHashTable(void);
@@ -175,5 +185,8 @@ _mesa_HashNumEntries(const struct _mesa_HashTable *table);
 
 extern void _mesa_test_hash_functions(void);
 
+#ifdef __cplusplus
+}
+#endif
 
 #endif
@@ -42,7 +42,10 @@ struct marshal_cmd_base
    uint16_t cmd_id;
 
    /**
-    * Size of command, in multiples of 4 bytes, including cmd_base.
+    * Size of command, in bytes, including cmd_base.
+    *
+    * A size of 0 means that the rest of the ring is unused, and that the
+    * next command is at the start of the ring.
     */
    uint16_t cmd_size;
 };
@@ -53,45 +56,105 @@ _mesa_glthread_allocate_command(struct gl_context *ctx,
                                 size_t size)
 {
    struct glthread_state *glthread = ctx->GLThread;
-   struct glthread_batch *next = &glthread->batches[glthread->next];
    struct marshal_cmd_base *cmd_base;
    const size_t aligned_size = ALIGN(size, 8);
 
-   if (unlikely(next->used + size > MARSHAL_MAX_CMD_SIZE)) {
-      _mesa_glthread_flush_batch(ctx);
-      next = &glthread->batches[glthread->next];
-   }
+   glthread->pending_cmds++;
+   if (unlikely(aligned_size > glthread->limit - glthread->head ||
+                glthread->pending_cmds % MARSHAL_FLUSH_CHECK_INTERVAL == 0))
+      _mesa_glthread_make_room(ctx, aligned_size);
 
-   cmd_base = (struct marshal_cmd_base *)&next->buffer[next->used];
-   next->used += aligned_size;
+   cmd_base = (struct marshal_cmd_base *)
+      &glthread->ring[glthread->head % MARSHAL_RING_SIZE];
+   glthread->head += aligned_size;
    cmd_base->cmd_id = cmd_id;
    cmd_base->cmd_size = aligned_size;
    return cmd_base;
 }
 
 /**
- * Instead of conditionally handling marshaling previously-bound user vertex
- * array data in draw calls (deprecated and removed in GL core), we just
- * disable threading at the point where the user sets a user vertex array.
+ * Returns the bound vertex array object as far as the main thread knows it.
+ * If the main thread doesn't know which one is bound, or what it contains,
+ * this synchronizes with the worker thread to read it back.  NULL is only
+ * returned when running out of memory.
  */
-static inline bool
-_mesa_glthread_is_non_vbo_vertex_attrib_pointer(const struct gl_context *ctx)
+static inline struct glthread_vao *
+_mesa_glthread_get_current_vao(struct gl_context *ctx)
 {
    struct glthread_state *glthread = ctx->GLThread;
 
-   return ctx->API != API_OPENGL_CORE && !glthread->vertex_array_is_vbo;
+   if (unlikely(!glthread->current_vao)) {
+      _mesa_glthread_finish_before(ctx, "Draw with an unknown VAO");
+      _mesa_glthread_sync_vao(ctx);
+   }
+
+   return glthread->current_vao;
 }
 
 /**
- * Instead of conditionally handling marshaling immediate index data in draw
- * calls (deprecated and removed in GL core), we just disable threading.
+ * Whether a draw call would read its indices from client memory (deprecated
+ * and removed in GL core).
+ *
+ * Draws that take a single index array copy the indices into the command,
+ * see _mesa_glthread_user_indices_size().  Draws that take an array of index
+ * arrays just disable threading.
  */
 static inline bool
-_mesa_glthread_is_non_vbo_draw_elements(const struct gl_context *ctx)
+_mesa_glthread_is_non_vbo_draw_elements(struct gl_context *ctx)
 {
-   struct glthread_state *glthread = ctx->GLThread;
+   struct glthread_vao *vao;
+
+   if (ctx->API == API_OPENGL_CORE)
+      return false;
+
+   vao = _mesa_glthread_get_current_vao(ctx);
+   return !vao || vao->element_buffer == 0;
+}
+
+/**
+ * Whether a draw call would read vertices from client memory (deprecated and
+ * removed in GL core).
+ *
+ * Draws of a single range of vertices copy what they read into the command,
+ * see _mesa_glthread_prepare_user_arrays().  The others are executed
+ * synchronously.
+ */
+static inline bool
+_mesa_glthread_has_user_arrays(struct gl_context *ctx)
+{
+   struct glthread_vao *vao;
+
+   if (ctx->API == API_OPENGL_CORE)
+      return false;
 
-   return ctx->API != API_OPENGL_CORE && !glthread->element_array_is_vbo;
+   vao = _mesa_glthread_get_current_vao(ctx);
+   return !vao || (vao->enabled & vao->user_arrays) != 0;
+}
+
+/**
+ * Returns the size of count indices of the given type in client memory, or
+ * -1 if the draw call is going to generate an error instead of reading them
+ * (in which case it should be left to Mesa core).
+ *
+ * If the result fits in a command, the indices are marshalled along with the
+ * draw call, which then reads them from the batch.
+ */
+static inline int
+_mesa_glthread_user_indices_size(GLenum type, GLsizei count)
+{
+   if (count < 0)
+      return -1;
+
+   switch (type) {
+   case GL_UNSIGNED_BYTE:
+      return MIN2(count, MARSHAL_MAX_CMD_SIZE + 1);
+   case GL_UNSIGNED_SHORT:
+      return MIN2(count, MARSHAL_MAX_CMD_SIZE) * 2;
+   case GL_UNSIGNED_INT:
+      return MIN2(count, MARSHAL_MAX_CMD_SIZE) * 4;
+   default:
+      return -1;
+   }
 }
 
 #define DEBUG_MARSHAL_PRINT_CALLS 0
@@ -151,29 +214,6 @@ _mesa_post_marshal_hook(struct gl_context *ctx)
 }
 
 
-/**
- * Checks whether we're on a compat context for code-generated
- * glBindVertexArray().
- *
- * In order to decide whether a draw call uses only VBOs for vertex and index
- * buffers, we track the current vertex and index buffer bindings by
- * glBindBuffer().  However, the index buffer binding is stored in the vertex
- * array as opposed to the context.  If we were to accurately track whether
- * the index buffer was a user pointer ot not, we'd have to track it per
- * vertex array, which would mean synchronizing with the client thread and
- * looking into the hash table to find the actual vertex array object.  That's
- * more tracking than we'd like to do in the main thread, if possible.
- *
- * Instead, just punt for now and disable threading on apps using vertex
- * arrays and compat contexts.  Apps using vertex arrays can probably use a
- * core context.
- */
-static inline bool
-_mesa_glthread_is_compat_bind_vertex_array(const struct gl_context *ctx)
-{
-   return ctx->API != API_OPENGL_CORE;
-}
-
 struct marshal_cmd_Enable;
 struct marshal_cmd_ShaderSource;
 struct marshal_cmd_Flush;
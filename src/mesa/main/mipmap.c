@@ -41,6 +41,11 @@
 #include "util/half_float.h"
 #include "util/format_rgb9e5.h"
 #include "util/format_r11g11b10f.h"
+#include "util/u_parallel_rows.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 
 /**
@@ -163,6 +168,126 @@ bytes_per_pixel(GLenum datatype, GLuint comps)
 /*@}*/
 
 
+#ifdef __SSE2__
+/**
+ * \name SSE2 versions of the do_row() kernels for 4-component pixels
+ *
+ * These only handle the common case of halving the width, and give the same
+ * results as the C code.  They return the number of dest pixels written,
+ * the C code does the remaining ones.
+ */
+/*@{*/
+static GLuint
+do_row_ubyte4_sse2(const GLubyte *rowA, const GLubyte *rowB,
+                   GLuint dstWidth, GLubyte *dst)
+{
+   const __m128i zero = _mm_setzero_si128();
+   GLuint i;
+
+   for (i = 0; i + 4 <= dstWidth; i += 4) {
+      const __m128i a0 = _mm_loadu_si128((const __m128i *) (rowA + i * 8));
+      const __m128i a1 = _mm_loadu_si128((const __m128i *) (rowA + i * 8 + 16));
+      const __m128i b0 = _mm_loadu_si128((const __m128i *) (rowB + i * 8));
+      const __m128i b1 = _mm_loadu_si128((const __m128i *) (rowB + i * 8 + 16));
+
+      /* Vertical sums of source pixels 0-1, 2-3, 4-5 and 6-7 */
+      const __m128i s0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero),
+                                       _mm_unpacklo_epi8(b0, zero));
+      const __m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero),
+                                       _mm_unpackhi_epi8(b0, zero));
+      const __m128i s2 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero),
+                                       _mm_unpacklo_epi8(b1, zero));
+      const __m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero),
+                                       _mm_unpackhi_epi8(b1, zero));
+
+      /* Add up horizontally adjacent pixels */
+      const __m128i d0 = _mm_add_epi16(_mm_unpacklo_epi64(s0, s1),
+                                       _mm_unpackhi_epi64(s0, s1));
+      const __m128i d1 = _mm_add_epi16(_mm_unpacklo_epi64(s2, s3),
+                                       _mm_unpackhi_epi64(s2, s3));
+
+      _mm_storeu_si128((__m128i *) (dst + i * 4),
+                       _mm_packus_epi16(_mm_srli_epi16(d0, 2),
+                                        _mm_srli_epi16(d1, 2)));
+   }
+
+   return i;
+}
+
+static GLuint
+do_row_float4_sse2(const GLfloat *rowA, const GLfloat *rowB,
+                   GLuint dstWidth, GLfloat *dst)
+{
+   const __m128 quarter = _mm_set1_ps(0.25F);
+   GLuint i;
+
+   for (i = 0; i < dstWidth; i++) {
+      const __m128 aj = _mm_loadu_ps(rowA + i * 8);
+      const __m128 ak = _mm_loadu_ps(rowA + i * 8 + 4);
+      const __m128 bj = _mm_loadu_ps(rowB + i * 8);
+      const __m128 bk = _mm_loadu_ps(rowB + i * 8 + 4);
+
+      _mm_storeu_ps(dst + i * 4,
+                    _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(aj, ak), bj),
+                                          bk),
+                               quarter));
+   }
+
+   return i;
+}
+
+/**
+ * Convert four halfs, in the low 16 bits of each lane, the same way as
+ * _mesa_half_to_float().
+ */
+static inline __m128
+half4_to_float4_sse2(__m128i h)
+{
+   const __m128i mag = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x7fff)),
+                                      13);
+   const __m128i sign = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)),
+                                       16);
+   __m128 f = _mm_mul_ps(_mm_castsi128_ps(mag),
+                         _mm_castsi128_ps(_mm_set1_epi32(0xef << 23)));
+   const __m128 infnan = _mm_cmpge_ps(f, _mm_set1_ps(65536.0F));
+
+   f = _mm_or_ps(f, _mm_and_ps(infnan,
+                               _mm_castsi128_ps(_mm_set1_epi32(0xff << 23))));
+   return _mm_or_ps(f, _mm_castsi128_ps(sign));
+}
+
+static GLuint
+do_row_half4_sse2(const GLhalfARB *rowA, const GLhalfARB *rowB,
+                  GLuint dstWidth, GLhalfARB *dst)
+{
+   const __m128i zero = _mm_setzero_si128();
+   const __m128 quarter = _mm_set1_ps(0.25F);
+   GLuint i, comp;
+
+   for (i = 0; i < dstWidth; i++) {
+      const __m128i a = _mm_loadu_si128((const __m128i *) (rowA + i * 8));
+      const __m128i b = _mm_loadu_si128((const __m128i *) (rowB + i * 8));
+      const __m128 aj = half4_to_float4_sse2(_mm_unpacklo_epi16(a, zero));
+      const __m128 ak = half4_to_float4_sse2(_mm_unpackhi_epi16(a, zero));
+      const __m128 bj = half4_to_float4_sse2(_mm_unpacklo_epi16(b, zero));
+      const __m128 bk = half4_to_float4_sse2(_mm_unpackhi_epi16(b, zero));
+      GLfloat avg[4];
+
+      _mm_storeu_ps(avg,
+                    _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(aj, ak), bj),
+                                          bk),
+                               quarter));
+
+      for (comp = 0; comp < 4; comp++)
+         dst[i * 4 + comp] = _mesa_float_to_half(avg[comp]);
+   }
+
+   return i;
+}
+/*@}*/
+#endif
+
+
 /**
  * Average together two rows of a source image to produce a single new
  * row in the dest image.  It's legal for the two source rows to point
@@ -187,11 +312,15 @@ do_row(GLenum datatype, GLuint comps, GLint srcWidth,
    */
 
    if (datatype == GL_UNSIGNED_BYTE && comps == 4) {
-      GLuint i, j, k;
+      GLuint i = 0, j, k;
       const GLubyte(*rowA)[4] = (const GLubyte(*)[4]) srcRowA;
       const GLubyte(*rowB)[4] = (const GLubyte(*)[4]) srcRowB;
       GLubyte(*dst)[4] = (GLubyte(*)[4]) dstRow;
-      for (i = j = 0, k = k0; i < (GLuint) dstWidth;
+#ifdef __SSE2__
+      if (colStride == 2)
+         i = do_row_ubyte4_sse2(srcRowA, srcRowB, dstWidth, dstRow);
+#endif
+      for (j = i * colStride, k = j + k0; i < (GLuint) dstWidth;
            i++, j += colStride, k += colStride) {
          dst[i][0] = (rowA[j][0] + rowA[k][0] + rowB[j][0] + rowB[k][0]) / 4;
          dst[i][1] = (rowA[j][1] + rowA[k][1] + rowB[j][1] + rowB[k][1]) / 4;
@@ -375,11 +504,15 @@ do_row(GLenum datatype, GLuint comps, GLint srcWidth,
    }
 
    else if (datatype == GL_FLOAT && comps == 4) {
-      GLuint i, j, k;
+      GLuint i = 0, j, k;
       const GLfloat(*rowA)[4] = (const GLfloat(*)[4]) srcRowA;
       const GLfloat(*rowB)[4] = (const GLfloat(*)[4]) srcRowB;
       GLfloat(*dst)[4] = (GLfloat(*)[4]) dstRow;
-      for (i = j = 0, k = k0; i < (GLuint) dstWidth;
+#ifdef __SSE2__
+      if (colStride == 2)
+         i = do_row_float4_sse2(srcRowA, srcRowB, dstWidth, dstRow);
+#endif
+      for (j = i * colStride, k = j + k0; i < (GLuint) dstWidth;
            i++, j += colStride, k += colStride) {
          dst[i][0] = (rowA[j][0] + rowA[k][0] +
                       rowB[j][0] + rowB[k][0]) * 0.25F;
@@ -431,11 +564,15 @@ do_row(GLenum datatype, GLuint comps, GLint srcWidth,
    }
 
    else if (datatype == GL_HALF_FLOAT_ARB && comps == 4) {
-      GLuint i, j, k, comp;
+      GLuint i = 0, j, k, comp;
       const GLhalfARB(*rowA)[4] = (const GLhalfARB(*)[4]) srcRowA;
       const GLhalfARB(*rowB)[4] = (const GLhalfARB(*)[4]) srcRowB;
       GLhalfARB(*dst)[4] = (GLhalfARB(*)[4]) dstRow;
-      for (i = j = 0, k = k0; i < (GLuint) dstWidth;
+#ifdef __SSE2__
+      if (colStride == 2)
+         i = do_row_half4_sse2(srcRowA, srcRowB, dstWidth, dstRow);
+#endif
+      for (j = i * colStride, k = j + k0; i < (GLuint) dstWidth;
            i++, j += colStride, k += colStride) {
          for (comp = 0; comp < 4; comp++) {
             GLfloat aj, ak, bj, bk;
@@ -1467,6 +1604,56 @@ make_1d_mipmap(GLenum datatype, GLuint comps, GLint border,
 }
 
 
+/**
+ * 2D images are downsampled in bands of rows on several threads, each band
+ * having at least this many dest texels.
+ */
+#define MIPMAP_BAND_MIN_TEXELS (64 * 1024)
+
+struct mipmap_rows_job {
+   GLenum datatype;
+   GLuint comps;
+   GLint srcWidth;
+   const GLubyte *srcA, *srcB;
+   GLint srcStep;    /**< bytes between the source rows of two dest rows */
+   GLint dstWidth;
+   GLubyte *dst;
+   GLint dstRowStride;
+   GLint rows;
+};
+
+static void
+do_rows(void *data, unsigned start, unsigned end)
+{
+   const struct mipmap_rows_job *job = data;
+   const GLubyte *srcA = job->srcA + (ptrdiff_t) start * job->srcStep;
+   const GLubyte *srcB = job->srcB + (ptrdiff_t) start * job->srcStep;
+   GLubyte *dst = job->dst + (ptrdiff_t) start * job->dstRowStride;
+   unsigned row;
+
+   for (row = start; row < end; row++) {
+      do_row(job->datatype, job->comps, job->srcWidth, srcA, srcB,
+             job->dstWidth, dst);
+      srcA += job->srcStep;
+      srcB += job->srcStep;
+      dst += job->dstRowStride;
+   }
+}
+
+/**
+ * Run do_rows() for a whole image, split across several threads when the
+ * image is large enough.
+ */
+static void
+do_rows_threaded(struct mipmap_rows_job *job)
+{
+   const unsigned min_rows = DIV_ROUND_UP(MIPMAP_BAND_MIN_TEXELS,
+                                          MAX2(job->dstWidth, 1));
+
+   util_parallel_rows(job->rows, min_rows, do_rows, job);
+}
+
+
 static void
 make_2d_mipmap(GLenum datatype, GLuint comps, GLint border,
                GLint srcWidth, GLint srcHeight,
@@ -1481,6 +1668,7 @@ make_2d_mipmap(GLenum datatype, GLuint comps, GLint border,
    const GLubyte *srcA, *srcB;
    GLubyte *dst;
    GLint row, srcRowStep;
+   struct mipmap_rows_job job;
 
    /* Compute src and dst pointers, skipping any border */
    srcA = srcPtr + border * ((srcWidth + 1) * bpt);
@@ -1497,13 +1685,17 @@ make_2d_mipmap(GLenum datatype, GLuint comps, GLint border,
 
    dst = dstPtr + border * ((dstWidth + 1) * bpt);
 
-   for (row = 0; row < dstHeightNB; row++) {
-      do_row(datatype, comps, srcWidthNB, srcA, srcB,
-             dstWidthNB, dst);
-      srcA += srcRowStep * srcRowStride;
-      srcB += srcRowStep * srcRowStride;
-      dst += dstRowStride;
-   }
+   job.datatype = datatype;
+   job.comps = comps;
+   job.srcWidth = srcWidthNB;
+   job.srcA = srcA;
+   job.srcB = srcB;
+   job.srcStep = srcRowStep * srcRowStride;
+   job.dstWidth = dstWidthNB;
+   job.dst = dst;
+   job.dstRowStride = dstRowStride;
+   job.rows = dstHeightNB;
+   do_rows_threaded(&job);
 
    /* This is ugly but probably won't be used much */
    if (border > 0) {
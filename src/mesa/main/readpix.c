@@ -41,6 +41,7 @@
 #include "fbobject.h"
 #include "format_utils.h"
 #include "pixeltransfer.h"
+#include "util/streaming-load-memcpy.h"
 
 
 /**
@@ -243,12 +244,12 @@ readpixels_memcpy(struct gl_context *ctx,
    texelBytes = _mesa_get_format_bytes(rb->Format);
    bytesPerRow = texelBytes * width;
 
-   /* memcpy*/
+   /* memcpy, with streaming loads since the mapping may be uncached */
    if (dstStride == stride && dstStride == bytesPerRow) {
-      memcpy(dst, map, bytesPerRow * height);
+      util_streaming_load_memcpy(dst, map, bytesPerRow * height);
    } else {
       for (j = 0; j < height; j++) {
-         memcpy(dst, map, bytesPerRow);
+         util_streaming_load_memcpy(dst, map, bytesPerRow);
          dst += dstStride;
          map += stride;
       }
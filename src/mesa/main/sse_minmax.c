@@ -26,69 +26,192 @@
  */
 
 #include "main/sse_minmax.h"
+#include "util/macros.h"
 #include <smmintrin.h>
 #include <stdint.h>
 
-void
-_mesa_uint_array_min_max(const unsigned *ui_indices, unsigned *min_index,
-                         unsigned *max_index, const unsigned count)
+/* The helpers below take the index size as a parameter, which is always a
+ * constant, so that array_min_max() can be specialized for each index size
+ * and for primitive restart.
+ */
+
+static inline __m128i
+min_epu(__m128i a, __m128i b, unsigned index_size)
+{
+   switch (index_size) {
+   case 1: return _mm_min_epu8(a, b);
+   case 2: return _mm_min_epu16(a, b);
+   default: return _mm_min_epu32(a, b);
+   }
+}
+
+static inline __m128i
+max_epu(__m128i a, __m128i b, unsigned index_size)
+{
+   switch (index_size) {
+   case 1: return _mm_max_epu8(a, b);
+   case 2: return _mm_max_epu16(a, b);
+   default: return _mm_max_epu32(a, b);
+   }
+}
+
+static inline __m128i
+cmpeq_epi(__m128i a, __m128i b, unsigned index_size)
+{
+   switch (index_size) {
+   case 1: return _mm_cmpeq_epi8(a, b);
+   case 2: return _mm_cmpeq_epi16(a, b);
+   default: return _mm_cmpeq_epi32(a, b);
+   }
+}
+
+static inline __m128i
+set1_epi(unsigned value, unsigned index_size)
+{
+   switch (index_size) {
+   case 1: return _mm_set1_epi8(value);
+   case 2: return _mm_set1_epi16(value);
+   default: return _mm_set1_epi32(value);
+   }
+}
+
+static inline unsigned
+load_index(const void *indices, unsigned i, unsigned index_size)
 {
-   unsigned max_ui = 0;
-   unsigned min_ui = ~0U;
-   unsigned i = 0;
-   unsigned aligned_count = count;
+   switch (index_size) {
+   case 1: return ((const uint8_t *)indices)[i];
+   case 2: return ((const uint16_t *)indices)[i];
+   default: return ((const uint32_t *)indices)[i];
+   }
+}
+
+static ALWAYS_INLINE void
+array_min_max(const void *indices, unsigned index_size, bool restart,
+              unsigned restart_index, unsigned *min_index,
+              unsigned *max_index, unsigned count)
+{
+   const uint8_t *ptr = (const uint8_t *)indices;
+   const unsigned type_max = index_size == 4 ? ~0U :
+                             (1U << (index_size * 8)) - 1;
+   unsigned max = 0;
+   unsigned min = type_max;
 
    /* handle the first few values without SSE until the pointer is aligned */
-   while (((uintptr_t)ui_indices & 15) && aligned_count) {
-      if (*ui_indices > max_ui)
-         max_ui = *ui_indices;
-      if (*ui_indices < min_ui)
-         min_ui = *ui_indices;
-
-      aligned_count--;
-      ui_indices++;
+   while (((uintptr_t)ptr & 15) && count) {
+      unsigned index = load_index(ptr, 0, index_size);
+
+      if (!restart || index != restart_index) {
+         max = MAX2(max, index);
+         min = MIN2(min, index);
+      }
+      ptr += index_size;
+      count--;
    }
 
    /* TODO: The actual threshold for SSE begin useful may be higher than 8.
     * Some careful microbenchmarks and measurement are required to
     * find the actual tipping point.
     */
-   if (aligned_count >= 8) {
-      unsigned max_arr[4] __attribute__ ((aligned (16)));
-      unsigned min_arr[4] __attribute__ ((aligned (16)));
-      unsigned vec_count;
-      __m128i max_ui4 = _mm_setzero_si128();
-      __m128i min_ui4 = _mm_set1_epi32(~0U);
-      __m128i ui_indices4;
-      __m128i *ui_indices_ptr;
-
-      vec_count = aligned_count & ~0x3;
-      ui_indices_ptr = (__m128i *)ui_indices;
-      for (i = 0; i < vec_count / 4; i++) {
-         ui_indices4 = _mm_load_si128(&ui_indices_ptr[i]);
-         max_ui4 = _mm_max_epu32(ui_indices4, max_ui4);
-         min_ui4 = _mm_min_epu32(ui_indices4, min_ui4);
+   const unsigned per_vec = 16 / index_size;
+   if (count >= 2 * per_vec) {
+      uint8_t max_arr[16] __attribute__ ((aligned (16)));
+      uint8_t min_arr[16] __attribute__ ((aligned (16)));
+      const __m128i *vec_ptr = (const __m128i *)ptr;
+      const unsigned vec_count = count / per_vec;
+      const __m128i restart4 = set1_epi(restart_index, index_size);
+      __m128i max4 = _mm_setzero_si128();
+      __m128i min4 = _mm_set1_epi32(~0);
+
+      for (unsigned i = 0; i < vec_count; i++) {
+         __m128i indices4 = _mm_load_si128(&vec_ptr[i]);
+
+         if (restart) {
+            /* Restart indices become the identity of each operation:
+             * all ones for min and zero for max.
+             */
+            __m128i is_restart = cmpeq_epi(indices4, restart4, index_size);
+
+            min4 = min_epu(_mm_or_si128(indices4, is_restart), min4,
+                           index_size);
+            max4 = max_epu(_mm_andnot_si128(is_restart, indices4), max4,
+                           index_size);
+         } else {
+            min4 = min_epu(indices4, min4, index_size);
+            max4 = max_epu(indices4, max4, index_size);
+         }
       }
 
-      _mm_store_si128((__m128i *)max_arr, max_ui4);
-      _mm_store_si128((__m128i *)min_arr, min_ui4);
+      _mm_store_si128((__m128i *)max_arr, max4);
+      _mm_store_si128((__m128i *)min_arr, min4);
 
-      for (i = 0; i < 4; i++) {
-         if (max_arr[i] > max_ui)
-            max_ui = max_arr[i];
-         if (min_arr[i] < min_ui)
-            min_ui = min_arr[i];
+      for (unsigned i = 0; i < per_vec; i++) {
+         max = MAX2(max, load_index(max_arr, i, index_size));
+         min = MIN2(min, load_index(min_arr, i, index_size));
       }
-      i = vec_count;
+
+      ptr += vec_count * 16;
+      count -= vec_count * per_vec;
    }
 
-   for (; i < aligned_count; i++) {
-      if (ui_indices[i] > max_ui)
-         max_ui = ui_indices[i];
-      if (ui_indices[i] < min_ui)
-         min_ui = ui_indices[i];
+   for (unsigned i = 0; i < count; i++) {
+      unsigned index = load_index(ptr, i, index_size);
+
+      if (!restart || index != restart_index) {
+         max = MAX2(max, index);
+         min = MIN2(min, index);
+      }
    }
 
-   *min_index = min_ui;
-   *max_index = max_ui;
+   /* Nothing but restart indices, return the same as an empty array. */
+   if (min > max)
+      min = ~0U;
+
+   *min_index = min;
+   *max_index = max;
+}
+
+void
+_mesa_uint_array_min_max(const unsigned *ui_indices, unsigned *min_index,
+                         unsigned *max_index, const unsigned count)
+{
+   array_min_max(ui_indices, 4, false, 0, min_index, max_index, count);
+}
+
+void
+_mesa_index_array_min_max(const void *indices, unsigned index_size,
+                          bool restart, unsigned restart_index,
+                          unsigned *min_index, unsigned *max_index,
+                          const unsigned count)
+{
+   /* A restart index that doesn't fit in the index type never matches an
+    * index, and must not be truncated to one that does.
+    */
+   if (index_size < 4 && restart_index >> (index_size * 8))
+      restart = false;
+
+   switch (index_size) {
+   case 4:
+      if (restart)
+         array_min_max(indices, 4, true, restart_index, min_index, max_index,
+                       count);
+      else
+         array_min_max(indices, 4, false, 0, min_index, max_index, count);
+      break;
+   case 2:
+      if (restart)
+         array_min_max(indices, 2, true, restart_index, min_index, max_index,
+                       count);
+      else
+         array_min_max(indices, 2, false, 0, min_index, max_index, count);
+      break;
+   case 1:
+      if (restart)
+         array_min_max(indices, 1, true, restart_index, min_index, max_index,
+                       count);
+      else
+         array_min_max(indices, 1, false, 0, min_index, max_index, count);
+      break;
+   default:
+      unreachable("bad index size");
+   }
 }
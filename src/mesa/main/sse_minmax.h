@@ -28,8 +28,29 @@
 #ifndef SSE_MINMAX_H
 #define SSE_MINMAX_H
 
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 void
 _mesa_uint_array_min_max(const unsigned *ui_indices, unsigned *min_index,
                          unsigned *max_index, const unsigned count);
 
+/**
+ * Computes the min and max of an array of 1, 2 or 4-byte indices, skipping
+ * restart_index if restart is set. Returns ~0 and 0 if there are no indices
+ * other than restart_index.
+ */
+void
+_mesa_index_array_min_max(const void *indices, unsigned index_size,
+                          bool restart, unsigned restart_index,
+                          unsigned *min_index, unsigned *max_index,
+                          const unsigned count);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* SSE_MINMAX_H */
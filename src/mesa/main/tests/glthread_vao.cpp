@@ -0,0 +1,417 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "main/mtypes.h"
+#include "main/glthread.h"
+#include "main/marshal.h"
+
+/**
+ * Tests the main thread side tracking of the element array buffer binding
+ * and of the vertex arrays, which decides whether glthread copies the indices
+ * and vertices of a draw call from client memory.  The tracking functions are
+ * called directly, the way the marshalling functions call them, without a
+ * worker thread.
+ */
+class glthread_vao_test : public ::testing::Test {
+protected:
+   void SetUp()
+   {
+      ctx = (struct gl_context *) calloc(1, sizeof(*ctx));
+      ctx->API = API_OPENGL_COMPAT;
+      ctx->GLThread = (struct glthread_state *) calloc(1, sizeof(*ctx->GLThread));
+      ASSERT_TRUE(_mesa_glthread_init_vaos(ctx->GLThread));
+   }
+
+   void TearDown()
+   {
+      _mesa_glthread_destroy_vaos(ctx->GLThread);
+      free(ctx->GLThread);
+      free(ctx);
+   }
+
+   /* Does what glGenVertexArrays() does once the call returned names. */
+   void gen_vertex_array(GLuint name)
+   {
+      _mesa_glthread_GenVertexArrays(ctx, 1, &name);
+   }
+
+   bool user_indices()
+   {
+      return _mesa_glthread_is_non_vbo_draw_elements(ctx);
+   }
+
+   /* Prepares a glDrawArraysInstancedBaseInstance() and copies the arrays
+    * into data, returning the size of the copies.
+    */
+   int draw_arrays(GLint first, GLsizei count, GLsizei num_instances = 1,
+                   GLuint baseinstance = 0)
+   {
+      struct glthread_user_arrays upload;
+      int size = _mesa_glthread_prepare_user_arrays(ctx, &upload, first, count,
+                                                    0, NULL, 0, num_instances,
+                                                    baseinstance);
+      if (size > 0)
+         _mesa_glthread_upload_user_arrays(&upload, data);
+      return size;
+   }
+
+   int draw_elements(const GLushort *indices, GLsizei count,
+                     GLint basevertex = 0)
+   {
+      struct glthread_user_arrays upload;
+      int size = _mesa_glthread_prepare_user_arrays(ctx, &upload, 0, count,
+                                                    GL_UNSIGNED_SHORT, indices,
+                                                    basevertex, 1, 0);
+      if (size > 0)
+         _mesa_glthread_upload_user_arrays(&upload, data);
+      return size;
+   }
+
+   /* Where the worker thread makes an array of the given stride read from,
+    * for an array the last draw copied.
+    */
+   const GLubyte *copied_array(unsigned attrib, GLsizei stride)
+   {
+      struct gl_vertex_array_object vao = {};
+      const GLubyte *saved[VERT_ATTRIB_MAX];
+
+      for (unsigned i = 0; i < VERT_ATTRIB_MAX; i++) {
+         vao.VertexAttrib[i].BufferBindingIndex = i;
+         vao.BufferBinding[i].Stride = stride;
+      }
+      vao.Enabled = VERT_BIT_ALL;
+
+      ctx->Array.VAO = &vao;
+      _mesa_glthread_bind_user_arrays(ctx, data, saved);
+      EXPECT_EQ(vao.NewArrays, *(GLbitfield *) data);
+      ctx->Array.VAO = NULL;
+      return vao.VertexAttrib[attrib].Ptr;
+   }
+
+   uint64_t data[MARSHAL_MAX_CMD_SIZE / 8];
+
+   struct gl_context *ctx;
+};
+
+TEST_F(glthread_vao_test, DefaultVAOUsesClientMemory)
+{
+   EXPECT_TRUE(user_indices());
+
+   _mesa_glthread_BindBuffer(ctx, GL_ELEMENT_ARRAY_BUFFER, 3);
+   EXPECT_FALSE(user_indices());
+
+   _mesa_glthread_BindBuffer(ctx, GL_ELEMENT_ARRAY_BUFFER, 0);
+   EXPECT_TRUE(user_indices());
+}
+
+TEST_F(glthread_vao_test, ElementBufferFollowsVAOBinding)
+{
+   const GLuint vao = 1, ebo = 2;
+
+   gen_vertex_array(vao);
+
+   _mesa_glthread_BindVertexArray(ctx, vao);
+   _mesa_glthread_BindBuffer(ctx, GL_ELEMENT_ARRAY_BUFFER, ebo);
+   _mesa_glthread_BindVertexArray(ctx, 0);
+   _mesa_glthread_BindBuffer(ctx, GL_ELEMENT_ARRAY_BUFFER, 0);
+   EXPECT_TRUE(user_indices());
+
+   /* The indices pointer of a draw is now an offset into ebo. */
+   _mesa_glthread_BindVertexArray(ctx, vao);
+   EXPECT_FALSE(user_indices());
+
+   _mesa_glthread_BindVertexArray(ctx, 0);
+   EXPECT_TRUE(user_indices());
+}
+
+TEST_F(glthread_vao_test, NewVAOHasNoElementBuffer)
+{
+   _mesa_glthread_BindBuffer(ctx, GL_ELEMENT_ARRAY_BUFFER, 2);
+
+   gen_vertex_array(1);
+   _mesa_glthread_BindVertexArray(ctx, 1);
+   EXPECT_TRUE(user_indices());
+}
+
+TEST_F(glthread_vao_test, VertexArrayElementBuffer)
+{
+   gen_vertex_array(1);
+   gen_vertex_array(2);
+
+   _mesa_glthread_BindVertexArray(ctx, 1);
+   _mesa_glthread_VertexArrayElementBuffer(ctx, 2, 5);
+   EXPECT_TRUE(user_indices());
+
+   _mesa_glthread_BindVertexArray(ctx, 2);
+   EXPECT_FALSE(user_indices());
+
+   /* Zero is the default vertex array object in compatibility contexts. */
+   _mesa_glthread_VertexArrayElementBuffer(ctx, 0, 6);
+   _mesa_glthread_BindVertexArray(ctx, 0);
+   EXPECT_FALSE(user_indices());
+}
+
+TEST_F(glthread_vao_test, DeleteBoundVAO)
+{
+   _mesa_glthread_BindBuffer(ctx, GL_ELEMENT_ARRAY_BUFFER, 3);
+
+   gen_vertex_array(1);
+   _mesa_glthread_BindVertexArray(ctx, 1);
+   EXPECT_TRUE(user_indices());
+
+   /* Deleting the bound vertex array object binds the default one. */
+   GLuint name = 1;
+   _mesa_glthread_DeleteVertexArrays(ctx, 1, &name);
+   EXPECT_FALSE(user_indices());
+
+   /* Binding the deleted name fails, the binding is then unknown. */
+   _mesa_glthread_BindVertexArray(ctx, 1);
+   EXPECT_EQ(ctx->GLThread->current_vao, (struct glthread_vao *) NULL);
+}
+
+TEST_F(glthread_vao_test, DeleteBoundElementBuffer)
+{
+   const GLuint buffers[] = { 4, 3 };
+
+   gen_vertex_array(1);
+   _mesa_glthread_BindVertexArray(ctx, 1);
+   _mesa_glthread_BindBuffer(ctx, GL_ELEMENT_ARRAY_BUFFER, 3);
+   _mesa_glthread_BindVertexArray(ctx, 0);
+   _mesa_glthread_BindBuffer(ctx, GL_ELEMENT_ARRAY_BUFFER, 3);
+
+   /* Only the binding of the bound vertex array object is reset. */
+   _mesa_glthread_DeleteBuffers(ctx, 2, buffers);
+   EXPECT_TRUE(user_indices());
+
+   _mesa_glthread_BindVertexArray(ctx, 1);
+   EXPECT_FALSE(user_indices());
+}
+
+TEST_F(glthread_vao_test, UnknownBindingIsReadBack)
+{
+   struct gl_buffer_object ebo = {};
+   struct gl_vertex_array_object vao = {};
+
+   ebo.Name = 7;
+   vao.Name = 42;
+   vao.IndexBufferObj = &ebo;
+   ctx->Array.VAO = &vao;
+
+   /* A vertex array object created before glthread was enabled. */
+   _mesa_glthread_BindVertexArray(ctx, 42);
+   EXPECT_EQ(ctx->GLThread->current_vao, (struct glthread_vao *) NULL);
+
+   _mesa_glthread_sync_vao(ctx);
+   EXPECT_FALSE(user_indices());
+
+   _mesa_glthread_BindVertexArray(ctx, 0);
+   EXPECT_TRUE(user_indices());
+   _mesa_glthread_BindVertexArray(ctx, 42);
+   EXPECT_FALSE(user_indices());
+
+   _mesa_glthread_PopClientAttrib(ctx);
+   EXPECT_EQ(ctx->GLThread->current_vao, (struct glthread_vao *) NULL);
+}
+
+TEST_F(glthread_vao_test, CoreNeverUsesClientMemory)
+{
+   ctx->API = API_OPENGL_CORE;
+   EXPECT_FALSE(user_indices());
+
+   /* Not even when the binding is unknown. */
+   _mesa_glthread_BindVertexArray(ctx, 9);
+   EXPECT_FALSE(user_indices());
+}
+
+TEST_F(glthread_vao_test, ClientArraysAreCopied)
+{
+   GLfloat positions[16][2];
+   GLubyte colors[16][4];
+
+   for (unsigned i = 0; i < 16; i++) {
+      positions[i][0] = i;
+      positions[i][1] = -(GLfloat) i;
+      memset(colors[i], i, 4);
+   }
+
+   _mesa_glthread_AttribPointer(ctx, VERT_ATTRIB_POS, 2, GL_FLOAT, 0,
+                                positions);
+   _mesa_glthread_AttribPointer(ctx, VERT_ATTRIB_COLOR0, GL_BGRA,
+                                GL_UNSIGNED_BYTE, 0, colors);
+
+   /* Only enabled arrays are read. */
+   EXPECT_EQ(draw_arrays(3, 5), 0);
+
+   _mesa_glthread_ClientState(ctx, GL_VERTEX_ARRAY, 0, true);
+   EXPECT_TRUE(_mesa_glthread_has_user_arrays(ctx));
+   EXPECT_EQ(draw_arrays(3, 5), 4 + 8 + 5 * sizeof(positions[0]));
+   EXPECT_EQ(memcmp(copied_array(VERT_ATTRIB_POS, sizeof(positions[0])) +
+                    3 * sizeof(positions[0]), positions[3],
+                    5 * sizeof(positions[0])), 0);
+
+   _mesa_glthread_ClientState(ctx, GL_COLOR_ARRAY, 0, true);
+   EXPECT_EQ(draw_arrays(3, 5),
+             4 + 2 * 8 + 5 * sizeof(positions[0]) + 5 * sizeof(colors[0]));
+   EXPECT_EQ(memcmp(copied_array(VERT_ATTRIB_COLOR0, sizeof(colors[0])) +
+                    3 * sizeof(colors[0]), colors[3],
+                    5 * sizeof(colors[0])), 0);
+
+   _mesa_glthread_ClientState(ctx, GL_VERTEX_ARRAY, 0, false);
+   _mesa_glthread_ClientState(ctx, GL_COLOR_ARRAY, 0, false);
+   EXPECT_FALSE(_mesa_glthread_has_user_arrays(ctx));
+}
+
+TEST_F(glthread_vao_test, BufferArraysAreNotCopied)
+{
+   _mesa_glthread_BindBuffer(ctx, GL_ARRAY_BUFFER, 4);
+   _mesa_glthread_VertexAttribPointer(ctx, 0, 4, GL_FLOAT, 0, NULL);
+   _mesa_glthread_VertexAttribArray(ctx, NULL, 0, true);
+   EXPECT_FALSE(_mesa_glthread_has_user_arrays(ctx));
+   EXPECT_EQ(draw_arrays(0, 3), 0);
+
+   /* Deleting the buffer makes it unknown what the array reads. */
+   GLuint name = 4;
+   _mesa_glthread_DeleteBuffers(ctx, 1, &name);
+   EXPECT_EQ(ctx->GLThread->current_vao, (struct glthread_vao *) NULL);
+   EXPECT_EQ(ctx->GLThread->array_buffer, 0u);
+}
+
+TEST_F(glthread_vao_test, InterleavedArraysShareACopy)
+{
+   struct {
+      GLfloat position[3];
+      GLfloat texcoord[2];
+   } vertices[8];
+
+   for (unsigned i = 0; i < 8; i++) {
+      vertices[i].position[0] = i;
+      vertices[i].texcoord[1] = i;
+   }
+
+   _mesa_glthread_ClientActiveTexture(ctx, GL_TEXTURE1);
+   _mesa_glthread_AttribPointer(ctx, VERT_ATTRIB_TEX1, 2, GL_FLOAT,
+                                sizeof(vertices[0]), vertices[0].texcoord);
+   _mesa_glthread_ClientState(ctx, GL_TEXTURE_COORD_ARRAY,
+                              ctx->GLThread->client_active_texture, true);
+   _mesa_glthread_AttribPointer(ctx, VERT_ATTRIB_POS, 3, GL_FLOAT,
+                                sizeof(vertices[0]), vertices[0].position);
+   _mesa_glthread_ClientState(ctx, GL_VERTEX_ARRAY, 0, true);
+
+   EXPECT_EQ(draw_arrays(2, 4), 4 + 2 * 8 + 4 * sizeof(vertices[0]));
+   const GLubyte *position = copied_array(VERT_ATTRIB_POS,
+                                          sizeof(vertices[0]));
+   const GLubyte *texcoord = copied_array(VERT_ATTRIB_TEX(1),
+                                          sizeof(vertices[0]));
+   EXPECT_EQ(texcoord - position, (ptrdiff_t) (3 * sizeof(GLfloat)));
+   EXPECT_EQ(((const GLfloat *) (texcoord + 5 * sizeof(vertices[0])))[1], 5);
+}
+
+TEST_F(glthread_vao_test, IndexedDrawCopiesTheIndexRange)
+{
+   GLint values[64];
+   const GLushort indices[] = { 7, 3, 9, 3 };
+
+   for (unsigned i = 0; i < 64; i++)
+      values[i] = i;
+
+   _mesa_glthread_VertexAttribPointer(ctx, 2, 1, GL_INT, 0, values);
+   _mesa_glthread_VertexAttribArray(ctx, NULL, 2, true);
+
+   EXPECT_EQ(draw_elements(indices, 4), 4 + 8 + 7 * sizeof(GLint));
+   EXPECT_EQ(((const GLint *) copied_array(VERT_ATTRIB_GENERIC(2),
+                                           sizeof(GLint)))[3], 3);
+
+   EXPECT_EQ(draw_elements(indices, 4, 20), 4 + 8 + 7 * sizeof(GLint));
+   EXPECT_EQ(((const GLint *) copied_array(VERT_ATTRIB_GENERIC(2),
+                                           sizeof(GLint)))[29], 29);
+
+   /* The range isn't known when the indices are in a buffer object. */
+   EXPECT_EQ(draw_elements(NULL, 4), -1);
+}
+
+TEST_F(glthread_vao_test, InstancedArraysCopyTheInstanceRange)
+{
+   GLfloat offsets[10];
+
+   for (unsigned i = 0; i < 10; i++)
+      offsets[i] = i;
+
+   _mesa_glthread_VertexAttribPointer(ctx, 1, 1, GL_FLOAT, 0, offsets);
+   _mesa_glthread_VertexAttribDivisor(ctx, 1, 2);
+   _mesa_glthread_VertexAttribArray(ctx, NULL, 1, true);
+
+   /* Instances 0-6 with base instance 2 read elements 2-5. */
+   EXPECT_EQ(draw_arrays(0, 1000, 7, 2), 4 + 8 + 4 * sizeof(GLfloat));
+   EXPECT_EQ(((const GLfloat *) copied_array(VERT_ATTRIB_GENERIC(1),
+                                             sizeof(GLfloat)))[5], 5);
+}
+
+TEST_F(glthread_vao_test, LargeArraysAreDrawnSynchronously)
+{
+   static GLfloat vertices[4096][4];
+
+   _mesa_glthread_AttribPointer(ctx, VERT_ATTRIB_POS, 4, GL_FLOAT, 0,
+                                vertices);
+   _mesa_glthread_ClientState(ctx, GL_VERTEX_ARRAY, 0, true);
+   EXPECT_EQ(draw_arrays(0, 4096), -1);
+   EXPECT_GT(draw_arrays(0, 16), 0);
+}
+
+TEST_F(glthread_vao_test, VertexBufferBindingOfClientMemoryIsReadBack)
+{
+   const GLuint buffer = 0;
+   const GLsizei stride = 16;
+
+   gen_vertex_array(1);
+   _mesa_glthread_BindVertexArray(ctx, 1);
+
+   /* Buffer objects are followed. */
+   const GLuint vbo = 3;
+   _mesa_glthread_VertexBuffers(ctx, NULL, 0, 1, &vbo, &stride);
+   _mesa_glthread_VertexAttribBinding(ctx, NULL, 0, 0);
+   EXPECT_NE(ctx->GLThread->current_vao, (struct glthread_vao *) NULL);
+
+   _mesa_glthread_VertexBuffers(ctx, NULL, 0, 1, &buffer, &stride);
+   EXPECT_EQ(ctx->GLThread->current_vao, (struct glthread_vao *) NULL);
+
+   /* It stays unknown until it's read back. */
+   _mesa_glthread_BindVertexArray(ctx, 0);
+   _mesa_glthread_BindVertexArray(ctx, 1);
+   EXPECT_EQ(ctx->GLThread->current_vao, (struct glthread_vao *) NULL);
+}
+
+TEST_F(glthread_vao_test, CoreNeverCopiesArrays)
+{
+   GLfloat vertices[4][4];
+
+   ctx->API = API_OPENGL_CORE;
+   _mesa_glthread_AttribPointer(ctx, VERT_ATTRIB_GENERIC0, 4, GL_FLOAT, 0,
+                                vertices);
+   _mesa_glthread_VertexAttribArray(ctx, NULL, 0, true);
+   EXPECT_FALSE(_mesa_glthread_has_user_arrays(ctx));
+   EXPECT_EQ(draw_arrays(0, 4), 0);
+}
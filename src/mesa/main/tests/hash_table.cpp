@@ -0,0 +1,218 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdint.h>
+#include <thread>
+
+#include "main/hash.h"
+
+/**
+ * Tests of the name -> object table, whose small keys are stored in a dense
+ * array and the other ones in a struct hash_table.  Entries move from the
+ * struct hash_table to the dense array when it grows over their keys.
+ */
+
+static void *
+value(GLuint key)
+{
+   return (void *) (uintptr_t) (key * 16 + 8);
+}
+
+static void
+count_entry(GLuint key, void *data, void *userData)
+{
+   EXPECT_EQ(data, value(key));
+   (*(unsigned *) userData)++;
+}
+
+static void
+delete_entry(GLuint key, void *data, void *userData)
+{
+   (*(unsigned *) userData)++;
+}
+
+class hash_table_test : public ::testing::Test {
+protected:
+   void SetUp()
+   {
+      table = _mesa_NewHashTable();
+      ASSERT_NE(table, (struct _mesa_HashTable *) NULL);
+   }
+
+   void TearDown()
+   {
+      unsigned deleted = 0;
+
+      _mesa_HashDeleteAll(table, delete_entry, &deleted);
+      EXPECT_EQ(_mesa_HashNumEntries(table), 0u);
+      _mesa_DeleteHashTable(table);
+   }
+
+   unsigned walk()
+   {
+      unsigned count = 0;
+
+      _mesa_HashWalk(table, count_entry, &count);
+      return count;
+   }
+
+   struct _mesa_HashTable *table;
+};
+
+TEST_F(hash_table_test, SequentialKeysGrow)
+{
+   for (GLuint key = 1; key <= 5000; key++)
+      _mesa_HashInsert(table, key, value(key));
+
+   for (GLuint key = 1; key <= 5000; key++)
+      EXPECT_EQ(_mesa_HashLookup(table, key), value(key)) << "key " << key;
+   EXPECT_EQ(_mesa_HashLookup(table, 5001), (void *) NULL);
+
+   EXPECT_EQ(_mesa_HashNumEntries(table), 5000u);
+   EXPECT_EQ(walk(), 5000u);
+   EXPECT_EQ(_mesa_HashFindFreeKeyBlock(table, 10), 5001u);
+}
+
+TEST_F(hash_table_test, SparseKeysMoveToDenseArray)
+{
+   /* Too far from the dense array to grow it, or past its maximum size. */
+   const GLuint sparse[] = { 200, 1000, 70000, 100000, 0x7fffffff };
+
+   for (unsigned i = 0; i < ARRAY_SIZE(sparse); i++)
+      _mesa_HashInsert(table, sparse[i], value(sparse[i]));
+
+   /* Growing the dense array one key at a time moves 200 and 1000 into it.
+    * Every key must be found at every step.
+    */
+   for (GLuint key = 2; key <= 1100; key++) {
+      if (key == 200 || key == 1000)
+         continue;
+
+      _mesa_HashInsert(table, key, value(key));
+
+      for (unsigned i = 0; i < ARRAY_SIZE(sparse); i++) {
+         EXPECT_EQ(_mesa_HashLookup(table, sparse[i]), value(sparse[i]))
+            << "key " << sparse[i] << " after inserting " << key;
+      }
+   }
+
+   for (GLuint key = 2; key <= 1100; key++)
+      EXPECT_EQ(_mesa_HashLookup(table, key), value(key)) << "key " << key;
+
+   EXPECT_EQ(_mesa_HashNumEntries(table), 1099u + 3);
+   EXPECT_EQ(walk(), 1099u + 3);
+}
+
+TEST_F(hash_table_test, LookupAcrossBoundary)
+{
+   _mesa_HashInsert(table, 1, value(1));
+
+   /* Keys around every power of two: the dense array ends on one of them. */
+   for (GLuint size = 64; size <= 256 * 1024; size *= 2) {
+      _mesa_HashInsert(table, size - 1, value(size - 1));
+      _mesa_HashInsert(table, size + 1, value(size + 1));
+   }
+
+   for (GLuint size = 64; size <= 256 * 1024; size *= 2) {
+      EXPECT_EQ(_mesa_HashLookup(table, size - 1), value(size - 1));
+      EXPECT_EQ(_mesa_HashLookup(table, size), (void *) NULL);
+      EXPECT_EQ(_mesa_HashLookup(table, size + 1), value(size + 1));
+
+      _mesa_HashLockMutex(table);
+      EXPECT_EQ(_mesa_HashLookupLocked(table, size - 1), value(size - 1));
+      EXPECT_EQ(_mesa_HashLookupLocked(table, size), (void *) NULL);
+      EXPECT_EQ(_mesa_HashLookupLocked(table, size + 1), value(size + 1));
+      _mesa_HashUnlockMutex(table);
+   }
+}
+
+TEST_F(hash_table_test, Delete)
+{
+   for (GLuint key = 1; key <= 300; key++)
+      _mesa_HashInsert(table, key, value(key));
+   _mesa_HashInsert(table, 100000, value(100000));
+
+   for (GLuint key = 1; key <= 300; key += 3)
+      _mesa_HashRemove(table, key);
+   _mesa_HashRemove(table, 100000);
+   /* Removing keys that aren't in the table does nothing. */
+   _mesa_HashRemove(table, 1000);
+   _mesa_HashRemove(table, 200000);
+
+   for (GLuint key = 1; key <= 300; key++) {
+      EXPECT_EQ(_mesa_HashLookup(table, key),
+                key % 3 == 1 ? NULL : value(key)) << "key " << key;
+   }
+   EXPECT_EQ(_mesa_HashLookup(table, 100000), (void *) NULL);
+   EXPECT_EQ(_mesa_HashNumEntries(table), 200u);
+   EXPECT_EQ(walk(), 200u);
+
+   /* Deleted keys can be reused. */
+   _mesa_HashInsert(table, 1, value(1));
+   _mesa_HashInsert(table, 100000, value(100000));
+   EXPECT_EQ(_mesa_HashLookup(table, 1), value(1));
+   EXPECT_EQ(_mesa_HashLookup(table, 100000), value(100000));
+   EXPECT_EQ(_mesa_HashNumEntries(table), 202u);
+
+   unsigned deleted = 0;
+   _mesa_HashDeleteAll(table, delete_entry, &deleted);
+   EXPECT_EQ(deleted, 202u);
+   EXPECT_EQ(_mesa_HashLookup(table, 2), (void *) NULL);
+   EXPECT_EQ(_mesa_HashLookup(table, 100000), (void *) NULL);
+}
+
+/**
+ * A key stored in the struct hash_table must be found while another thread
+ * grows the dense array over it.
+ */
+TEST_F(hash_table_test, LookupWhileGrowing)
+{
+   for (unsigned round = 0; round < 200; round++) {
+      struct _mesa_HashTable *t = _mesa_NewHashTable();
+      const GLuint key = 4000;
+      std::atomic<bool> done(false), missed(false);
+
+      _mesa_HashInsert(t, key, value(key));
+
+      std::thread reader([&] {
+         while (!done) {
+            if (_mesa_HashLookup(t, key) != value(key))
+               missed = true;
+         }
+      });
+      for (GLuint k = 1; k < 8000; k++) {
+         if (k != key)
+            _mesa_HashInsert(t, k, value(k));
+      }
+      done = true;
+      reader.join();
+
+      EXPECT_FALSE(missed) << "round " << round;
+
+      unsigned deleted = 0;
+      _mesa_HashDeleteAll(t, delete_entry, &deleted);
+      _mesa_DeleteHashTable(t);
+   }
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "main/sse_minmax.h"
+#include "util/macros.h"
+#include "util/u_cpu_detect.h"
+
+/**
+ * Compares _mesa_index_array_min_max() against a scalar loop, for every
+ * index size, with and without primitive restart, and for every alignment
+ * and length of a small array.
+ */
+static void
+check_min_max(unsigned index_size, bool restart, unsigned restart_index,
+              unsigned range)
+{
+   uint8_t buf[4 * 80 + 16] __attribute__ ((aligned (16)));
+
+   srand(index_size * 1000 + restart * 100 + range);
+
+   for (unsigned start = 0; start < 16; start += index_size) {
+      for (unsigned count = 0; count < 64; count++) {
+         unsigned expected_min = ~0u, expected_max = 0;
+
+         for (unsigned i = 0; i < count; i++) {
+            unsigned index = rand() % range;
+
+            if (rand() % 4 == 0)
+               index = restart_index;
+            memcpy(&buf[start + i * index_size], &index, index_size);
+
+            if (restart && index == restart_index)
+               continue;
+            expected_min = MIN2(expected_min, index);
+            expected_max = MAX2(expected_max, index);
+         }
+
+         unsigned min, max;
+         _mesa_index_array_min_max(&buf[start], index_size, restart,
+                                   restart_index, &min, &max, count);
+         EXPECT_EQ(min, expected_min) << "size " << index_size
+                                      << ", start " << start
+                                      << ", count " << count;
+         EXPECT_EQ(max, expected_max) << "size " << index_size
+                                      << ", start " << start
+                                      << ", count " << count;
+      }
+   }
+}
+
+TEST(IndexMinMax, AllSizes)
+{
+   util_cpu_detect();
+   if (!util_cpu_caps.has_sse4_1)
+      return;
+
+   for (unsigned restart = 0; restart < 2; restart++) {
+      check_min_max(1, restart, 0xff, 256);
+      check_min_max(1, restart, 7, 16);
+      check_min_max(2, restart, 0xffff, 65536);
+      check_min_max(2, restart, 7, 16);
+      check_min_max(4, restart, 0xffffffff, 1 << 30);
+      check_min_max(4, restart, 7, 16);
+   }
+}
+
+TEST(IndexMinMax, OnlyRestart)
+{
+   uint16_t indices[64] __attribute__ ((aligned (16)));
+   unsigned min, max;
+
+   util_cpu_detect();
+   if (!util_cpu_caps.has_sse4_1)
+      return;
+
+   for (unsigned i = 0; i < 64; i++)
+      indices[i] = 0xffff;
+
+   _mesa_index_array_min_max(indices, 2, true, 0xffff, &min, &max, 64);
+   EXPECT_EQ(min, ~0u);
+   EXPECT_EQ(max, 0u);
+
+   _mesa_index_array_min_max(indices, 2, false, 0xffff, &min, &max, 64);
+   EXPECT_EQ(min, 0xffffu);
+   EXPECT_EQ(max, 0xffffu);
+}
+
+TEST(IndexMinMax, WideRestartIndex)
+{
+   uint16_t indices[64] __attribute__ ((aligned (16)));
+   uint8_t ub_indices[64] __attribute__ ((aligned (16)));
+   unsigned min, max;
+
+   util_cpu_detect();
+   if (!util_cpu_caps.has_sse4_1)
+      return;
+
+   /* 0x10007 doesn't fit in 16 bits, so restart matches no index, and in
+    * particular not 7.
+    */
+   for (unsigned i = 0; i < 64; i++)
+      indices[i] = 7 + i % 8;
+
+   _mesa_index_array_min_max(indices, 2, true, 0x10007, &min, &max, 64);
+   EXPECT_EQ(min, 7u);
+   EXPECT_EQ(max, 14u);
+
+   for (unsigned i = 0; i < 64; i++)
+      ub_indices[i] = 7 + i % 8;
+
+   _mesa_index_array_min_max(ub_indices, 1, true, 0x107, &min, &max, 64);
+   EXPECT_EQ(min, 7u);
+   EXPECT_EQ(max, 14u);
+}
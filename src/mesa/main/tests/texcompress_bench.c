@@ -0,0 +1,266 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * Measures how fast the compressed format fallback unpacks images, both
+ * single-threaded and through _mesa_unpack_compressed_image(), after
+ * checking that both give the same texels.
+ *
+ * Usage: texcompress_bench [-n iterations] [file.astc ...]
+ *
+ * Without files, random ETC1, ETC2, S3TC and BPTC images are used (every
+ * bit pattern is a valid ETC or S3TC block, and invalid BPTC modes decode
+ * as black).  ASTC images are read from .astc files as written by
+ * the ARM ASTC encoder, since random data mostly decodes as error blocks.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "main/formats.h"
+#include "main/texcompress.h"
+#include "main/texcompress_astc.h"
+#include "main/texcompress_bptc.h"
+#include "main/texcompress_etc.h"
+#include "main/texcompress_s3tc.h"
+#include "util/macros.h"
+#include "util/os_time.h"
+
+struct image {
+   const char *name;
+   mesa_format format;
+   unsigned width, height;
+   uint8_t *data;
+   unsigned stride;     /* bytes between rows of blocks */
+};
+
+static void
+unpack_single_threaded(const struct image *img, uint8_t *dst,
+                       unsigned dst_stride)
+{
+   if (img->format == MESA_FORMAT_ETC1_RGB8) {
+      _mesa_etc1_unpack_rgba8888(dst, dst_stride, img->data, img->stride,
+                                 img->width, img->height);
+   } else if (_mesa_is_format_etc2(img->format)) {
+      _mesa_unpack_etc2_format(dst, dst_stride, img->data, img->stride,
+                               img->width, img->height, img->format, false);
+   } else if (_mesa_get_format_layout(img->format) ==
+              MESA_FORMAT_LAYOUT_S3TC) {
+      _mesa_unpack_s3tc_rgba8888(dst, dst_stride, img->data, img->stride,
+                                 img->width, img->height, img->format);
+   } else if (img->format == MESA_FORMAT_BPTC_RGBA_UNORM) {
+      _mesa_unpack_bptc_rgba_unorm(dst, dst_stride, img->data, img->stride,
+                                   img->width, img->height);
+   } else {
+      _mesa_unpack_astc_2d_ldr(dst, dst_stride, img->data, img->stride,
+                               img->width, img->height, img->format);
+   }
+}
+
+static void
+unpack_threaded(const struct image *img, uint8_t *dst, unsigned dst_stride)
+{
+   _mesa_unpack_compressed_image(dst, dst_stride, img->data, img->stride,
+                                 img->width, img->height, img->format, false);
+}
+
+/**
+ * Returns whether the threaded unpack gives the same texels as the
+ * single-threaded one.
+ */
+static bool
+check(const struct image *img)
+{
+   const unsigned dst_stride = img->width * 4;
+   const size_t size = (size_t) dst_stride * img->height;
+   uint8_t *expected = malloc(size);
+   uint8_t *actual = malloc(size);
+   bool ok = false;
+
+   if (expected && actual) {
+      /* Unpacking must write every texel, so start from different data. */
+      memset(expected, 0x00, size);
+      memset(actual, 0xff, size);
+      unpack_single_threaded(img, expected, dst_stride);
+      unpack_threaded(img, actual, dst_stride);
+      ok = memcmp(expected, actual, size) == 0;
+   }
+
+   free(expected);
+   free(actual);
+   return ok;
+}
+
+static double
+run(const struct image *img, unsigned iterations,
+    void (*unpack)(const struct image *, uint8_t *, unsigned))
+{
+   const unsigned dst_stride = img->width * 4;
+   uint8_t *dst = malloc((size_t) dst_stride * img->height);
+
+   /* Warm up the caches and the thread pool */
+   unpack(img, dst, dst_stride);
+
+   int64_t start = os_time_get_nano();
+   for (unsigned i = 0; i < iterations; i++)
+      unpack(img, dst, dst_stride);
+   int64_t end = os_time_get_nano();
+
+   free(dst);
+
+   return (double) img->width * img->height * iterations /
+          ((end - start) / 1000.0);
+}
+
+static bool
+make_random_image(struct image *img, const char *name, mesa_format format,
+                  unsigned width, unsigned height)
+{
+   unsigned bw, bh;
+
+   _mesa_get_format_block_size(format, &bw, &bh);
+
+   img->name = name;
+   img->format = format;
+   img->width = width;
+   img->height = height;
+   img->stride = DIV_ROUND_UP(width, bw) * _mesa_get_format_bytes(format);
+   img->data = malloc((size_t) img->stride * DIV_ROUND_UP(height, bh));
+   if (!img->data)
+      return false;
+
+   for (size_t i = 0; i < (size_t) img->stride * DIV_ROUND_UP(height, bh); i++)
+      img->data[i] = rand();
+
+   return true;
+}
+
+static bool
+load_astc_file(struct image *img, const char *path)
+{
+   uint8_t header[16];
+   bool ok = false;
+   FILE *f = fopen(path, "rb");
+
+   if (!f)
+      return false;
+
+   if (fread(header, 1, sizeof(header), f) != sizeof(header) ||
+       header[0] != 0x13 || header[1] != 0xab ||
+       header[2] != 0xa1 || header[3] != 0x5c || header[6] != 1)
+      goto out;
+
+   img->name = path;
+   img->format = MESA_FORMAT_NONE;
+   img->width = header[7] | header[8] << 8 | header[9] << 16;
+   img->height = header[10] | header[11] << 8 | header[12] << 16;
+
+   for (mesa_format fmt = MESA_FORMAT_RGBA_ASTC_4x4;
+        fmt <= MESA_FORMAT_RGBA_ASTC_12x12; fmt++) {
+      unsigned bw, bh;
+
+      _mesa_get_format_block_size(fmt, &bw, &bh);
+      if (bw == header[4] && bh == header[5])
+         img->format = fmt;
+   }
+
+   if (img->format == MESA_FORMAT_NONE || !img->width || !img->height)
+      goto out;
+
+   const unsigned rows = DIV_ROUND_UP(img->height, header[5]);
+
+   img->stride = DIV_ROUND_UP(img->width, header[4]) * 16;
+   img->data = malloc((size_t) img->stride * rows);
+   ok = img->data && fread(img->data, img->stride, rows, f) == rows;
+
+out:
+   fclose(f);
+   return ok;
+}
+
+int
+main(int argc, char **argv)
+{
+   struct image images[64];
+   unsigned num_images = 0;
+   unsigned iterations = 10;
+   int i;
+
+   for (i = 1; i < argc && num_images < ARRAY_SIZE(images); i++) {
+      if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+         iterations = atoi(argv[++i]);
+      } else if (load_astc_file(&images[num_images], argv[i])) {
+         num_images++;
+      } else {
+         fprintf(stderr, "%s: can't read %s as an .astc file\n",
+                 argv[0], argv[i]);
+         return EXIT_FAILURE;
+      }
+   }
+
+   if (num_images == 0) {
+      if (!make_random_image(&images[num_images++], "random ETC1",
+                             MESA_FORMAT_ETC1_RGB8, 2048, 2048) ||
+          !make_random_image(&images[num_images++], "random ETC2 RGBA8",
+                             MESA_FORMAT_ETC2_RGBA8_EAC, 2048, 2048) ||
+          !make_random_image(&images[num_images++], "random ETC2 RGB8 odd",
+                             MESA_FORMAT_ETC2_RGB8, 1021, 1019) ||
+          !make_random_image(&images[num_images++], "random DXT1",
+                             MESA_FORMAT_RGB_DXT1, 2048, 2048) ||
+          !make_random_image(&images[num_images++], "random DXT5 odd",
+                             MESA_FORMAT_RGBA_DXT5, 1021, 1019) ||
+          !make_random_image(&images[num_images++], "random BPTC",
+                             MESA_FORMAT_BPTC_RGBA_UNORM, 2048, 2048)) {
+         fprintf(stderr, "%s: out of memory\n", argv[0]);
+         return EXIT_FAILURE;
+      }
+   }
+
+   printf("%-32s %12s %10s %14s %14s\n", "image", "format", "size",
+          "1 thread MT/s", "threaded MT/s");
+
+   int status = EXIT_SUCCESS;
+
+   for (unsigned n = 0; n < num_images; n++) {
+      const struct image *img = &images[n];
+      char size[32];
+
+      if (!check(img)) {
+         fprintf(stderr, "%s: threaded unpack of %s differs from the "
+                 "single-threaded one\n", argv[0], img->name);
+         status = EXIT_FAILURE;
+         free(img->data);
+         continue;
+      }
+
+      snprintf(size, sizeof(size), "%ux%u", img->width, img->height);
+      printf("%-32s %12s %10s %14.1f %14.1f\n", img->name,
+             _mesa_get_format_name(img->format) + strlen("MESA_FORMAT_"),
+             size, run(img, iterations, unpack_single_threaded),
+             run(img, iterations, unpack_threaded));
+      free(img->data);
+   }
+
+   return status;
+}
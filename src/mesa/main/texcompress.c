@@ -42,6 +42,8 @@
 #include "texcompress_s3tc.h"
 #include "texcompress_etc.h"
 #include "texcompress_bptc.h"
+#include "texcompress_astc.h"
+#include "util/u_parallel_rows.h"
 
 
 /**
@@ -928,8 +930,42 @@ _mesa_get_compressed_fetch_func(mesa_format format)
 }
 
 
+/**
+ * Images are unpacked in bands of block rows on several threads, each band
+ * having at least this many texels.
+ */
+#define UNPACK_BAND_MIN_TEXELS (32 * 1024)
+
+struct decompress_job {
+   compressed_fetch_func fetch;
+   const GLubyte *src;
+   GLint stride;
+   GLuint width, height;
+   GLuint block_height;
+   GLfloat *dest;
+};
+
+static void
+decompress_band(void *data, unsigned start, unsigned end)
+{
+   const struct decompress_job *job = data;
+   const GLuint last = MIN2(end * job->block_height, job->height);
+   GLuint i, j;
+
+   for (j = start * job->block_height; j < last; j++) {
+      GLfloat *dest = job->dest + (size_t) j * job->width * 4;
+
+      for (i = 0; i < job->width; i++) {
+         job->fetch(job->src, job->stride, i, j, dest);
+         dest += 4;
+      }
+   }
+}
+
+
 /**
  * Decompress a compressed texture image, returning a GL_RGBA/GL_FLOAT image.
+ * Large images are split in bands of block rows decompressed in parallel.
  * \param srcRowStride  stride in bytes between rows of blocks in the
  *                      compressed source image.
  */
@@ -938,26 +974,116 @@ _mesa_decompress_image(mesa_format format, GLuint width, GLuint height,
                        const GLubyte *src, GLint srcRowStride,
                        GLfloat *dest)
 {
-   compressed_fetch_func fetch;
-   GLuint i, j;
+   struct decompress_job job;
    GLuint bytes, bw, bh;
-   GLint stride;
 
    bytes = _mesa_get_format_bytes(format);
    _mesa_get_format_block_size(format, &bw, &bh);
 
-   fetch = _mesa_get_compressed_fetch_func(format);
-   if (!fetch) {
+   job.fetch = _mesa_get_compressed_fetch_func(format);
+   if (!job.fetch) {
       _mesa_problem(NULL, "Unexpected format in _mesa_decompress_image()");
       return;
    }
 
-   stride = srcRowStride * bh / bytes;
+   job.src = src;
+   job.stride = srcRowStride * bh / bytes;
+   job.width = width;
+   job.height = height;
+   job.block_height = bh;
+   job.dest = dest;
+
+   util_parallel_rows(DIV_ROUND_UP(height, bh),
+                      DIV_ROUND_UP(UNPACK_BAND_MIN_TEXELS,
+                                   MAX2(width, 1) * bh),
+                      decompress_band, &job);
+}
 
-   for (j = 0; j < height; j++) {
-      for (i = 0; i < width; i++) {
-         fetch(src, stride, i, j, dest);
-         dest += 4;
-      }
+
+struct unpack_job {
+   uint8_t *dst_row;
+   unsigned dst_stride;
+   const uint8_t *src_row;
+   unsigned src_stride;
+   unsigned width, height;
+   unsigned block_height;
+   mesa_format format;
+   bool bgra;
+};
+
+static void
+unpack_band(void *data, unsigned start, unsigned end)
+{
+   const struct unpack_job *job = data;
+   uint8_t *dst_row = job->dst_row +
+                      (size_t) start * job->block_height * job->dst_stride;
+   const uint8_t *src_row = job->src_row + (size_t) start * job->src_stride;
+   const unsigned height = MIN2(end * job->block_height, job->height) -
+                           start * job->block_height;
+
+   if (job->format == MESA_FORMAT_ETC1_RGB8) {
+      _mesa_etc1_unpack_rgba8888(dst_row, job->dst_stride,
+                                 src_row, job->src_stride,
+                                 job->width, height);
+   } else if (_mesa_is_format_etc2(job->format)) {
+      _mesa_unpack_etc2_format(dst_row, job->dst_stride,
+                               src_row, job->src_stride,
+                               job->width, height,
+                               job->format, job->bgra);
+   } else if (_mesa_get_format_layout(job->format) ==
+              MESA_FORMAT_LAYOUT_S3TC) {
+      _mesa_unpack_s3tc_rgba8888(dst_row, job->dst_stride,
+                                 src_row, job->src_stride,
+                                 job->width, height,
+                                 job->format);
+   } else if (job->format == MESA_FORMAT_BPTC_RGBA_UNORM ||
+              job->format == MESA_FORMAT_BPTC_SRGB_ALPHA_UNORM) {
+      _mesa_unpack_bptc_rgba_unorm(dst_row, job->dst_stride,
+                                   src_row, job->src_stride,
+                                   job->width, height);
+   } else {
+      assert(_mesa_is_format_astc_2d(job->format));
+      _mesa_unpack_astc_2d_ldr(dst_row, job->dst_stride,
+                               src_row, job->src_stride,
+                               job->width, height,
+                               job->format);
    }
 }
+
+
+/**
+ * Unpack an ETC1, ETC2, 2D ASTC, S3TC or BPTC unorm image to 8-bit RGBA the
+ * same way as _mesa_etc1_unpack_rgba8888(), _mesa_unpack_etc2_format(),
+ * _mesa_unpack_astc_2d_ldr(), _mesa_unpack_s3tc_rgba8888() and
+ * _mesa_unpack_bptc_rgba_unorm(), for drivers that don't support these
+ * formats.
+ * Large images are split in bands of block rows unpacked in parallel.
+ * \param src_stride  stride in bytes between rows of blocks
+ * \param bgra  whether to unpack ETC2 sRGB formats to BGRA
+ */
+void
+_mesa_unpack_compressed_image(uint8_t *dst_row, unsigned dst_stride,
+                              const uint8_t *src_row, unsigned src_stride,
+                              unsigned width, unsigned height,
+                              mesa_format format, bool bgra)
+{
+   struct unpack_job job;
+   unsigned bw, bh;
+
+   _mesa_get_format_block_size(format, &bw, &bh);
+
+   const unsigned min_rows = DIV_ROUND_UP(UNPACK_BAND_MIN_TEXELS,
+                                          MAX2(width, 1) * bh);
+
+   job.dst_row = dst_row;
+   job.dst_stride = dst_stride;
+   job.src_row = src_row;
+   job.src_stride = src_stride;
+   job.width = width;
+   job.height = height;
+   job.block_height = bh;
+   job.format = format;
+   job.bgra = bgra;
+
+   util_parallel_rows(DIV_ROUND_UP(height, bh), min_rows, unpack_band, &job);
+}
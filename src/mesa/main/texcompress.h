@@ -63,4 +63,10 @@ _mesa_decompress_image(mesa_format format, GLuint width, GLuint height,
                        const GLubyte *src, GLint srcRowStride,
                        GLfloat *dest);
 
+extern void
+_mesa_unpack_compressed_image(uint8_t *dst_row, unsigned dst_stride,
+                              const uint8_t *src_row, unsigned src_stride,
+                              unsigned width, unsigned height,
+                              mesa_format format, bool bgra);
+
 #endif /* TEXCOMPRESS_H */
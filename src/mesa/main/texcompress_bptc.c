@@ -29,6 +29,7 @@
 #include <stdbool.h>
 #include "texcompress.h"
 #include "texcompress_bptc.h"
+#define BPTC_BLOCK_DECODE
 #include "texcompress_bptc_tmp.h"
 #include "texstore.h"
 #include "image.h"
@@ -122,6 +123,20 @@ _mesa_get_bptc_fetch_func(mesa_format format)
    }
 }
 
+/**
+ * Unpack a BPTC unorm image to RGBA8888, one block at a time.  sRGB images
+ * are not converted to linear.
+ * \param src_stride  stride in bytes between rows of blocks
+ */
+void
+_mesa_unpack_bptc_rgba_unorm(uint8_t *dst_row, unsigned dst_stride,
+                             const uint8_t *src_row, unsigned src_stride,
+                             unsigned width, unsigned height)
+{
+   decompress_rgba_unorm(width, height, src_row, src_stride,
+                         dst_row, dst_stride);
+}
+
 GLboolean
 _mesa_texstore_bptc_rgba_unorm(TEXSTORE_PARAMS)
 {
@@ -41,4 +41,9 @@ _mesa_texstore_bptc_rgb_unsigned_float(TEXSTORE_PARAMS);
 compressed_fetch_func
 _mesa_get_bptc_fetch_func(mesa_format format);
 
+void
+_mesa_unpack_bptc_rgba_unorm(uint8_t *dst_row, unsigned dst_stride,
+                             const uint8_t *src_row, unsigned src_stride,
+                             unsigned width, unsigned height);
+
 #endif
@@ -374,3 +374,52 @@ _mesa_get_dxt_fetch_func(mesa_format format)
       return NULL;
    }
 }
+
+
+/**
+ * Unpack an S3TC image to RGBA8888.  sRGB images are not converted to
+ * linear.
+ * \param src_stride  stride in bytes between rows of blocks
+ */
+void
+_mesa_unpack_s3tc_rgba8888(uint8_t *dst_row, unsigned dst_stride,
+                           const uint8_t *src_row, unsigned src_stride,
+                           unsigned width, unsigned height,
+                           mesa_format format)
+{
+   void (*fetch)(GLint srcRowStride, const GLubyte *pixdata,
+                 GLint i, GLint j, GLvoid *texel);
+   /* The fetch functions take the row stride in texels */
+   const GLint stride = src_stride / _mesa_get_format_bytes(format) * 4;
+   unsigned i, j;
+
+   switch (format) {
+   case MESA_FORMAT_RGB_DXT1:
+   case MESA_FORMAT_SRGB_DXT1:
+      fetch = fetch_2d_texel_rgb_dxt1;
+      break;
+   case MESA_FORMAT_RGBA_DXT1:
+   case MESA_FORMAT_SRGBA_DXT1:
+      fetch = fetch_2d_texel_rgba_dxt1;
+      break;
+   case MESA_FORMAT_RGBA_DXT3:
+   case MESA_FORMAT_SRGBA_DXT3:
+      fetch = fetch_2d_texel_rgba_dxt3;
+      break;
+   case MESA_FORMAT_RGBA_DXT5:
+   case MESA_FORMAT_SRGBA_DXT5:
+      fetch = fetch_2d_texel_rgba_dxt5;
+      break;
+   default:
+      unreachable("Unexpected format in _mesa_unpack_s3tc_rgba8888()");
+   }
+
+   for (j = 0; j < height; j++) {
+      uint8_t *dst = dst_row + j * dst_stride;
+
+      for (i = 0; i < width; i++) {
+         fetch(stride, src_row, i, j, dst);
+         dst += 4;
+      }
+   }
+}
@@ -47,5 +47,11 @@ _mesa_texstore_rgba_dxt5(TEXSTORE_PARAMS);
 extern compressed_fetch_func
 _mesa_get_dxt_fetch_func(mesa_format format);
 
+extern void
+_mesa_unpack_s3tc_rgba8888(uint8_t *dst_row, unsigned dst_stride,
+                           const uint8_t *src_row, unsigned src_stride,
+                           unsigned width, unsigned height,
+                           mesa_format format);
+
 
 #endif /* TEXCOMPRESS_S3TC_H */
@@ -48,6 +48,7 @@
 #include "texstore.h"
 #include "format_utils.h"
 #include "pixeltransfer.h"
+#include "util/streaming-load-memcpy.h"
 
 /**
  * Can the given type represent negative values?
@@ -661,12 +662,12 @@ get_tex_memcpy(struct gl_context *ctx,
 
       if (src) {
          if (bytesPerRow == dstRowStride && bytesPerRow == srcRowStride) {
-            memcpy(dst, src, bytesPerRow * height);
+            util_streaming_load_memcpy(dst, src, bytesPerRow * height);
          }
          else {
             GLuint row;
             for (row = 0; row < height; row++) {
-               memcpy(dst, src, bytesPerRow);
+               util_streaming_load_memcpy(dst, src, bytesPerRow);
                dst += dstRowStride;
                src += srcRowStride;
             }
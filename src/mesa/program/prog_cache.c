@@ -32,6 +32,7 @@
 #include "main/shaderobj.h"
 #include "program/prog_cache.h"
 #include "program/program.h"
+#include "util/hash_table.h"
 
 
 struct cache_item
@@ -58,21 +59,9 @@ struct gl_program_cache
 static GLuint
 hash_key(const void *key, GLuint key_size)
 {
-   const GLuint *ikey = (const GLuint *) key;
-   GLuint hash = 0, i;
-
    assert(key_size >= 4);
 
-   /* Make a slightly better attempt at a hash function:
-    */
-   for (i = 0; i < key_size / sizeof(*ikey); i++)
-   {
-      hash += ikey[i];
-      hash += (hash << 10);
-      hash ^= (hash >> 6);
-   }
-
-   return hash;
+   return _mesa_hash_data(key, key_size);
 }
 
 
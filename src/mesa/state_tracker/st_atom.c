@@ -34,6 +34,7 @@
 #include "pipe/p_defines.h"
 #include "st_context.h"
 #include "st_atom.h"
+#include "st_cb_readpixels.h"
 #include "st_program.h"
 #include "st_manager.h"
 #include "st_util.h"
@@ -194,6 +195,7 @@ void st_validate_state( struct st_context *st, enum st_pipeline pipeline )
       }
 
       st_manager_validate_framebuffers(st);
+      st_finish_readbacks_for_draw(st);
 
       pipeline_mask = ST_PIPELINE_RENDER_STATE_MASK;
       break;
@@ -230,6 +232,7 @@ void st_validate_state( struct st_context *st, enum st_pipeline pipeline )
       }
 
       st->compute_shader_may_be_dirty = false;
+      st_finish_readbacks_for_draw(st);
 
       /*
        * We add the ST_NEW_FB_STATE bit here as well, because glBindFramebuffer
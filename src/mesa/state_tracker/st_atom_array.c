@@ -364,6 +364,22 @@ static void init_velement_lowered(const struct st_vertex_program *vp,
    }
 }
 
+/**
+ * Whether a vertex buffer is still bound as it was.  The buffers in use are
+ * referenced by the driver, so they can't be replaced by another one at the
+ * same address.  User buffers are always rebound, as their contents may
+ * have changed.
+ */
+static inline bool
+vertex_buffer_unchanged(const struct pipe_vertex_buffer *vb,
+                        const struct pipe_vertex_buffer *last)
+{
+   return !vb->is_user_buffer && !last->is_user_buffer &&
+          vb->buffer.resource == last->buffer.resource &&
+          vb->buffer_offset == last->buffer_offset &&
+          vb->stride == last->stride;
+}
+
 static void
 set_vertex_attribs(struct st_context *st,
                    struct pipe_vertex_buffer *vbuffers,
@@ -372,15 +388,43 @@ set_vertex_attribs(struct st_context *st,
                    unsigned num_velements)
 {
    struct cso_context *cso = st->cso_context;
-
-   cso_set_vertex_buffers(cso, 0, num_vbuffers, vbuffers);
+   unsigned start = 0, end = MIN2(num_vbuffers, st->last_num_vbuffers);
+
+   /* Only bind the range of buffers that changed. Switching between VAOs
+    * with the same layout usually changes a few of them, and changing a
+    * buffer offset only one.
+    */
+   while (start < end &&
+          vertex_buffer_unchanged(&vbuffers[start], &st->last_vbuffers[start]))
+      start++;
+   end = num_vbuffers;
+   while (end > start && end <= st->last_num_vbuffers &&
+          vertex_buffer_unchanged(&vbuffers[end - 1],
+                                  &st->last_vbuffers[end - 1]))
+      end--;
+
+   if (start < end)
+      cso_set_vertex_buffers(cso, start, end - start, &vbuffers[start]);
    if (st->last_num_vbuffers > num_vbuffers) {
       /* Unbind remaining buffers, if any. */
       cso_set_vertex_buffers(cso, num_vbuffers,
                              st->last_num_vbuffers - num_vbuffers, NULL);
    }
+   memcpy(st->last_vbuffers, vbuffers, num_vbuffers * sizeof(vbuffers[0]));
    st->last_num_vbuffers = num_vbuffers;
-   cso_set_vertex_elements(cso, num_velements, velements);
+
+   /* Skip hashing the vertex elements for the CSO cache when they are the
+    * same as for the last draw, which they are as long as the vertex
+    * program and the attribute formats don't change.
+    */
+   if (num_velements != st->last_num_velements ||
+       memcmp(velements, st->last_velements,
+              num_velements * sizeof(velements[0])) != 0) {
+      cso_set_vertex_elements(cso, num_velements, velements);
+      memcpy(st->last_velements, velements,
+             num_velements * sizeof(velements[0]));
+      st->last_num_velements = num_velements;
+   }
 }
 
 void
@@ -42,6 +42,7 @@
 #include "st_context.h"
 #include "st_cb_bufferobjects.h"
 #include "st_cb_memoryobjects.h"
+#include "st_cb_readpixels.h"
 #include "st_debug.h"
 #include "st_util.h"
 
@@ -82,6 +83,7 @@ st_bufferobj_free(struct gl_context *ctx, struct gl_buffer_object *obj)
 
    assert(obj->RefCount == 0);
    _mesa_buffer_unmap_all_mappings(ctx, obj);
+   st_discard_readback(st_obj);
 
    if (st_obj->buffer)
       pipe_resource_reference(&st_obj->buffer, NULL);
@@ -126,6 +128,8 @@ st_bufferobj_subdata(struct gl_context *ctx,
       return;
    }
 
+   st_flush_readback(st_context(ctx), st_obj);
+
    /* Now that transfers are per-context, we don't have to figure out
     * flushing here.  Usually drivers won't need to flush in this case
     * even if the buffer is currently referenced by hardware - they
@@ -168,6 +172,8 @@ st_bufferobj_get_subdata(struct gl_context *ctx,
       return;
    }
 
+   st_flush_readback(st_context(ctx), st_obj);
+
    pipe_buffer_read(st_context(ctx)->pipe, st_obj->buffer,
                     offset, size, data);
 }
@@ -291,6 +297,9 @@ bufferobj_data(struct gl_context *ctx,
    struct st_memory_object *st_mem_obj = st_memory_object(memObj);
    bool is_mapped = _mesa_bufferobj_mapped(obj, MAP_USER);
 
+   /* The old contents are gone either way */
+   st_discard_readback(st_obj);
+
    if (target != GL_EXTERNAL_VIRTUAL_MEMORY_BUFFER_AMD &&
        size && st_obj->buffer &&
        st_obj->Base.Size == size &&
@@ -441,6 +450,7 @@ st_bufferobj_invalidate(struct gl_context *ctx,
    if (!st_obj->buffer || _mesa_bufferobj_mapped(obj, MAP_USER))
       return;
 
+   st_discard_readback(st_obj);
    pipe->invalidate_resource(pipe, st_obj->buffer);
 }
 
@@ -509,6 +519,8 @@ st_bufferobj_map_range(struct gl_context *ctx,
    assert(offset < obj->Size);
    assert(offset + length <= obj->Size);
 
+   st_flush_readback(st_context(ctx), st_obj);
+
    const enum pipe_transfer_usage transfer_flags =
       st_access_flags_to_transfer_flags(access,
                                         offset == 0 && length == obj->Size);
@@ -598,6 +610,9 @@ st_copy_buffer_subdata(struct gl_context *ctx,
    assert(!_mesa_check_disallowed_mapping(src));
    assert(!_mesa_check_disallowed_mapping(dst));
 
+   st_flush_readback(st_context(ctx), srcObj);
+   st_flush_readback(st_context(ctx), dstObj);
+
    u_box_1d(readOffset, size, &box);
 
    pipe->resource_copy_region(pipe, dstObj->buffer, 0, writeOffset, 0, 0,
@@ -618,6 +633,8 @@ st_clear_buffer_subdata(struct gl_context *ctx,
    struct st_buffer_object *buf = st_buffer_object(bufObj);
    static const char zeros[16] = {0};
 
+   st_flush_readback(st_context(ctx), buf);
+
    if (!pipe->clear_buffer) {
       _mesa_ClearBufferSubData_sw(ctx, offset, size,
                                   clearValue, clearValueSize, bufObj);
@@ -34,6 +34,7 @@ struct dd_function_table;
 struct pipe_resource;
 struct pipe_screen;
 struct st_context;
+struct st_pending_readback;
 
 /**
  * State_tracker vertex/pixel buffer object, derived from Mesa's
@@ -44,6 +45,9 @@ struct st_buffer_object
    struct gl_buffer_object Base;
    struct pipe_resource *buffer;     /* GPU storage */
    struct pipe_transfer *transfer[MAP_COUNT];
+
+   /** glReadPixels result not copied into the buffer yet */
+   struct st_pending_readback *pending_readback;
 };
 
 
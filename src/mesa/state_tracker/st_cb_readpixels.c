@@ -32,14 +32,18 @@
 #include "main/readpix.h"
 #include "main/enums.h"
 #include "main/framebuffer.h"
+#include "util/list.h"
+#include "util/simple_mtx.h"
 #include "util/u_inlines.h"
 #include "util/u_format.h"
+#include "util/streaming-load-memcpy.h"
 #include "cso_cache/cso_context.h"
 
 #include "st_cb_fbo.h"
 #include "st_atom.h"
 #include "st_context.h"
 #include "st_cb_bitmap.h"
+#include "st_cb_bufferobjects.h"
 #include "st_cb_readpixels.h"
 #include "st_debug.h"
 #include "state_tracker/st_cb_texture.h"
@@ -68,6 +72,296 @@
  */
 #define ALWAYS_READPIXELS_CACHE false
 
+/* glReadPixels into a buffer object doesn't wait for the blit to the staging
+ * texture: it flushes with a fence, and the copy from the staging texture
+ * into the buffer is only done when the buffer is used next, typically when
+ * the application maps it.  By then the GPU is usually done, and reading
+ * back a frame overlaps with rendering the next one.
+ *
+ * The buffer may be used by any context it is shared with, so pending
+ * readbacks are kept on a global list rather than in the st_context.  Only
+ * the contexts of the share group the readback was made in look at it.
+ */
+struct st_pending_readback
+{
+   struct list_head link;
+   struct pipe_screen *screen;
+   struct gl_shared_state *shared;
+   struct st_buffer_object *obj;
+   /** obj->buffer, kept alive while it's copied without readback_lock */
+   struct pipe_resource *buffer;
+   struct pipe_resource *staging;
+   struct pipe_fence_handle *fence;
+   unsigned x, y, width, height;
+   unsigned bytes_per_row;
+   intptr_t offset;     /**< of the first row in the buffer */
+   int stride;          /**< negative with GL_PACK_INVERT_MESA */
+};
+
+static struct list_head pending_readbacks = {
+   &pending_readbacks, &pending_readbacks
+};
+static simple_mtx_t readback_lock = _SIMPLE_MTX_INITIALIZER_NP;
+
+/* Usage bits of buffers that only glReadPixels writes to */
+#define READBACK_USAGE (USAGE_PIXEL_PACK_BUFFER | USAGE_DISABLE_MINMAX_CACHE)
+
+/**
+ * Take \p rb off the list, so that nothing else finds it and it can be
+ * waited for and copied without holding readback_lock.  rb->obj may be
+ * deleted from then on.  Called with readback_lock held.
+ */
+static void
+unlink_readback(struct st_pending_readback *rb)
+{
+   list_del(&rb->link);
+   rb->obj->pending_readback = NULL;
+}
+
+static void
+free_readback(struct st_pending_readback *rb)
+{
+   pipe_resource_reference(&rb->buffer, NULL);
+   pipe_resource_reference(&rb->staging, NULL);
+   rb->screen->fence_reference(rb->screen, &rb->fence, NULL);
+   free(rb);
+}
+
+/**
+ * Wait for the blit and copy the staging texture into the buffer.
+ */
+static void
+copy_readback(struct pipe_context *pipe, struct st_pending_readback *rb)
+{
+   const unsigned stride = abs(rb->stride);
+   const intptr_t start = rb->stride < 0 ?
+      rb->offset - (intptr_t) (rb->height - 1) * stride : rb->offset;
+   const unsigned size = (rb->height - 1) * stride + rb->bytes_per_row;
+   unsigned usage = PIPE_TRANSFER_WRITE;
+   struct pipe_transfer *src_xfer, *dst_xfer;
+   const ubyte *src;
+   ubyte *dst;
+
+   if (rb->fence)
+      rb->screen->fence_finish(rb->screen, NULL, rb->fence,
+                               PIPE_TIMEOUT_INFINITE);
+
+   /* Nothing in between the rows needs to be preserved */
+   if (stride == rb->bytes_per_row)
+      usage |= PIPE_TRANSFER_DISCARD_RANGE;
+
+   src = pipe_transfer_map(pipe, rb->staging, 0, 0, PIPE_TRANSFER_READ,
+                           rb->x, rb->y, rb->width, rb->height, &src_xfer);
+   if (!src)
+      return;
+
+   dst = pipe_buffer_map_range(pipe, rb->buffer, start, size, usage,
+                               &dst_xfer);
+   if (!dst) {
+      pipe_transfer_unmap(pipe, src_xfer);
+      return;
+   }
+
+   dst += rb->offset - start;
+   for (unsigned row = 0; row < rb->height; row++) {
+      util_streaming_load_memcpy(dst, src, rb->bytes_per_row);
+      src += src_xfer->stride;
+      dst += rb->stride;
+   }
+
+   pipe_buffer_unmap(pipe, dst_xfer);
+   pipe_transfer_unmap(pipe, src_xfer);
+}
+
+/**
+ * Copy the deferred glReadPixels result into \p obj, see
+ * st_flush_readback().
+ */
+void
+st_finish_readback(struct st_context *st, struct st_buffer_object *obj)
+{
+   struct st_pending_readback *rb;
+
+   simple_mtx_lock(&readback_lock);
+   rb = obj->pending_readback;
+   if (rb)
+      unlink_readback(rb);
+   simple_mtx_unlock(&readback_lock);
+
+   if (rb) {
+      copy_readback(st->pipe, rb);
+      free_readback(rb);
+   }
+}
+
+/**
+ * Forget the deferred glReadPixels result of \p obj, when its contents are
+ * replaced or it is deleted.
+ */
+void
+st_discard_readback(struct st_buffer_object *obj)
+{
+   struct st_pending_readback *rb;
+
+   if (likely(!obj->pending_readback))
+      return;
+
+   simple_mtx_lock(&readback_lock);
+   rb = obj->pending_readback;
+   if (rb)
+      unlink_readback(rb);
+   simple_mtx_unlock(&readback_lock);
+
+   if (rb)
+      free_readback(rb);
+}
+
+/**
+ * Finish the readbacks into buffers that the GPU may read with the current
+ * bindings.  Called before draws and compute dispatches.
+ */
+void
+st_finish_readbacks_for_draw(struct st_context *st)
+{
+   struct gl_context *ctx = st->ctx;
+   struct list_head ready;
+
+   if (likely(list_empty(&pending_readbacks)))
+      return;
+
+   list_inithead(&ready);
+
+   simple_mtx_lock(&readback_lock);
+   list_for_each_entry_safe(struct st_pending_readback, rb,
+                            &pending_readbacks, link) {
+      const struct gl_buffer_object *obj = &rb->obj->Base;
+
+      /* Buffers of other share groups can't be bound here */
+      if (rb->shared != ctx->Shared || rb->screen != st->pipe->screen)
+         continue;
+
+      /* Other kinds of bindings are recorded in the usage history */
+      if ((obj->UsageHistory & ~READBACK_USAGE) ||
+          obj == ctx->Array.VAO->IndexBufferObj ||
+          obj == ctx->DrawIndirectBuffer ||
+          obj == ctx->ParameterBuffer ||
+          obj == ctx->DispatchIndirectBuffer) {
+         unlink_readback(rb);
+         list_addtail(&rb->link, &ready);
+      }
+   }
+   simple_mtx_unlock(&readback_lock);
+
+   /* Waiting for the blits doesn't hold up the other contexts */
+   list_for_each_entry_safe(struct st_pending_readback, rb, &ready, link) {
+      copy_readback(st->pipe, rb);
+      free_readback(rb);
+   }
+}
+
+/**
+ * Record a readback from \p staging into the pack buffer, to be copied
+ * later.  Returns false if it has to be done now.
+ */
+static bool
+defer_readback(struct st_context *st, const struct gl_pixelstore_attrib *pack,
+               void *pixels, GLenum format, GLenum type,
+               struct pipe_resource *staging, unsigned x, unsigned y,
+               unsigned width, unsigned height)
+{
+   struct st_buffer_object *obj = st_buffer_object(pack->BufferObj);
+   struct pipe_context *pipe = st->pipe;
+   struct st_pending_readback *rb;
+
+   /* The application must not be able to look at the contents without
+    * going through a map or another buffer entry point.
+    */
+   if (!obj->buffer ||
+       (obj->Base.UsageHistory & ~READBACK_USAGE) ||
+       (obj->Base.StorageFlags & GL_MAP_PERSISTENT_BIT) ||
+       _mesa_bufferobj_mapped(&obj->Base, MAP_USER))
+      return false;
+
+   rb = CALLOC_STRUCT(st_pending_readback);
+   if (!rb)
+      return false;
+
+   /* Readbacks may overlap, so they are copied in order */
+   st_flush_readback(st, obj);
+
+   rb->screen = pipe->screen;
+   rb->shared = st->ctx->Shared;
+   rb->obj = obj;
+   pipe_resource_reference(&rb->buffer, obj->buffer);
+   pipe_resource_reference(&rb->staging, staging);
+   rb->x = x;
+   rb->y = y;
+   rb->width = width;
+   rb->height = height;
+   rb->bytes_per_row = width * util_format_get_blocksize(staging->format);
+   rb->offset = (intptr_t) _mesa_image_address2d(pack, pixels, width, height,
+                                                 format, type, 0, 0);
+   rb->stride = _mesa_image_row_stride(pack, width, format, type);
+
+   /* Submit the blit now, so that it's done by the time the buffer is used */
+   pipe->flush(pipe, &rb->fence, 0);
+
+   simple_mtx_lock(&readback_lock);
+   list_addtail(&rb->link, &pending_readbacks);
+   obj->pending_readback = rb;
+   simple_mtx_unlock(&readback_lock);
+
+   return true;
+}
+
+/**
+ * Return a staging texture matching \p templ, reusing one the pool holds
+ * the only reference to when possible.
+ */
+static struct pipe_resource *
+get_staging_texture(struct st_context *st, const struct pipe_resource *templ)
+{
+   struct pipe_screen *screen = st->pipe->screen;
+   struct pipe_resource *res = NULL;
+   int slot = -1;
+
+   for (unsigned i = 0; i < ARRAY_SIZE(st->readpix_staging); i++) {
+      struct pipe_resource *pooled = st->readpix_staging[i];
+
+      if (!pooled) {
+         slot = i;
+         continue;
+      }
+
+      /* Still used by a pending readback or the readpixels cache */
+      if (p_atomic_read(&pooled->reference.count) != 1)
+         continue;
+
+      if (pooled->format == templ->format &&
+          pooled->width0 == templ->width0 &&
+          pooled->height0 == templ->height0 &&
+          pooled->bind == templ->bind) {
+         pipe_resource_reference(&res, pooled);
+         return res;
+      }
+
+      slot = i;
+   }
+
+   res = screen->resource_create(screen, templ);
+   if (res && slot >= 0)
+      pipe_resource_reference(&st->readpix_staging[slot], res);
+
+   return res;
+}
+
+void
+st_destroy_readpixels(struct st_context *st)
+{
+   for (unsigned i = 0; i < ARRAY_SIZE(st->readpix_staging); i++)
+      pipe_resource_reference(&st->readpix_staging[i], NULL);
+}
+
 static boolean
 needs_integer_signed_unsigned_conversion(const struct gl_context *ctx,
                                          GLenum format, GLenum type)
@@ -255,7 +549,7 @@ fail:
 }
 
 /**
- * Create a staging texture and blit the requested region to it.
+ * Get a staging texture and blit the requested region to it.
  */
 static struct pipe_resource *
 blit_to_staging(struct st_context *st, struct st_renderbuffer *strb,
@@ -291,7 +585,7 @@ blit_to_staging(struct st_context *st, struct st_renderbuffer *strb,
                                    &dst_templ.width0, &dst_templ.height0,
                                    &dst_templ.depth0, &dst_templ.array_size);
 
-   dst = screen->resource_create(screen, &dst_templ);
+   dst = get_staging_texture(st, &dst_templ);
    if (!dst)
       return NULL;
 
@@ -512,6 +806,13 @@ st_ReadPixels(struct gl_context *ctx, GLint x, GLint y,
       dst_y = 0;
    }
 
+   if (_mesa_is_bufferobj(pack->BufferObj) &&
+       defer_readback(st, pack, pixels, format, type, dst, dst_x, dst_y,
+                      width, height)) {
+      pipe_resource_reference(&dst, NULL);
+      return;
+   }
+
    /* map resources */
    pixels = _mesa_map_pbo_dest(ctx, pack, pixels);
 
@@ -523,7 +824,9 @@ st_ReadPixels(struct gl_context *ctx, GLint x, GLint y,
       goto fallback;
    }
 
-   /* memcpy data into a user buffer */
+   /* memcpy data into a user buffer, with streaming loads since the
+    * mapping may be uncached
+    */
    {
       const uint bytesPerRow = width * util_format_get_blocksize(dst_format);
       const int destStride = _mesa_image_row_stride(pack, width, format, type);
@@ -532,12 +835,12 @@ st_ReadPixels(struct gl_context *ctx, GLint x, GLint y,
                                          type, 0, 0);
 
       if (tex_xfer->stride == bytesPerRow && destStride == bytesPerRow) {
-         memcpy(dest, map, bytesPerRow * height);
+         util_streaming_load_memcpy(dest, map, bytesPerRow * height);
       } else {
          GLuint row;
 
          for (row = 0; row < (unsigned) height; row++) {
-            memcpy(dest, map, bytesPerRow);
+            util_streaming_load_memcpy(dest, map, bytesPerRow);
             map += tex_xfer->stride;
             dest += destStride;
          }
@@ -30,11 +30,37 @@
 #define ST_CB_READPIXELS_H
 
 #include "main/glheader.h"
+#include "st_cb_bufferobjects.h"
 
 struct dd_function_table;
+struct st_context;
 
 extern void
 st_init_readpixels_functions(struct dd_function_table *functions);
 
+extern void
+st_destroy_readpixels(struct st_context *st);
+
+extern void
+st_finish_readback(struct st_context *st, struct st_buffer_object *obj);
+
+extern void
+st_discard_readback(struct st_buffer_object *obj);
+
+extern void
+st_finish_readbacks_for_draw(struct st_context *st);
+
+
+/**
+ * Copy the result of a glReadPixels into \p obj that was deferred, before
+ * the buffer is accessed in any other way.
+ */
+static inline void
+st_flush_readback(struct st_context *st, struct st_buffer_object *obj)
+{
+   if (unlikely(obj && obj->pending_readback))
+      st_finish_readback(st, obj);
+}
+
 
 #endif /* ST_CB_READPIXELS_H */
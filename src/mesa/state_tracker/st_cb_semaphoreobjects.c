@@ -32,6 +32,7 @@
 #include "st_util.h"
 #include "st_cb_bitmap.h"
 #include "st_cb_bufferobjects.h"
+#include "st_cb_readpixels.h"
 #include "st_cb_semaphoreobjects.h"
 
 #include "state_tracker/drm_driver.h"
@@ -141,6 +142,7 @@ st_server_signal_semaphore(struct gl_context *ctx,
          continue;
 
       bufObj = st_buffer_object(bufObjs[i]);
+      st_flush_readback(st, bufObj);
       pipe->flush_resource(pipe, bufObj->buffer);
    }
 
@@ -41,8 +41,6 @@
 #include "main/pbo.h"
 #include "main/pixeltransfer.h"
 #include "main/texcompress.h"
-#include "main/texcompress_astc.h"
-#include "main/texcompress_etc.h"
 #include "main/texgetimage.h"
 #include "main/teximage.h"
 #include "main/texobj.h"
@@ -56,6 +54,7 @@
 #include "state_tracker/st_cb_texture.h"
 #include "state_tracker/st_cb_bufferobjects.h"
 #include "state_tracker/st_cb_memoryobjects.h"
+#include "state_tracker/st_cb_readpixels.h"
 #include "state_tracker/st_format.h"
 #include "state_tracker/st_pbo.h"
 #include "state_tracker/st_texture.h"
@@ -346,29 +345,17 @@ st_UnmapTextureImage(struct gl_context *ctx,
       assert(z == transfer->box.z);
 
       if (transfer->usage & PIPE_TRANSFER_WRITE) {
-         if (texImage->TexFormat == MESA_FORMAT_ETC1_RGB8) {
-            _mesa_etc1_unpack_rgba8888(itransfer->map, transfer->stride,
+         bool bgra = stImage->pt->format == PIPE_FORMAT_B8G8R8A8_SRGB;
+
+         assert(texImage->TexFormat == MESA_FORMAT_ETC1_RGB8 ||
+                _mesa_is_format_etc2(texImage->TexFormat) ||
+                _mesa_is_format_astc_2d(texImage->TexFormat));
+         _mesa_unpack_compressed_image(itransfer->map, transfer->stride,
                                        itransfer->temp_data,
                                        itransfer->temp_stride,
                                        transfer->box.width,
-                                       transfer->box.height);
-         } else if (_mesa_is_format_etc2(texImage->TexFormat)) {
-            bool bgra = stImage->pt->format == PIPE_FORMAT_B8G8R8A8_SRGB;
-            _mesa_unpack_etc2_format(itransfer->map, transfer->stride,
-                                     itransfer->temp_data,
-                                     itransfer->temp_stride,
-                                     transfer->box.width, transfer->box.height,
-                                     texImage->TexFormat,
-                                     bgra);
-         } else if (_mesa_is_format_astc_2d(texImage->TexFormat)) {
-            _mesa_unpack_astc_2d_ldr(itransfer->map, transfer->stride,
-                                     itransfer->temp_data,
-                                     itransfer->temp_stride,
-                                     transfer->box.width, transfer->box.height,
-                                     texImage->TexFormat);
-         } else {
-            unreachable("unexpected format for a compressed format fallback");
-         }
+                                       transfer->box.height,
+                                       texImage->TexFormat, bgra);
       }
 
       itransfer->temp_data = NULL;
@@ -1819,6 +1806,8 @@ st_CompressedTexSubImage(struct gl_context *ctx, GLuint dims,
    addr.pixels_per_row = store.TotalBytesPerRow / addr.bytes_per_pixel;
    addr.image_height = store.TotalRowsPerSlice;
 
+   st_flush_readback(st, st_buffer_object(ctx->Unpack.BufferObj));
+
    if (!st_pbo_addresses_setup(st,
                                st_buffer_object(ctx->Unpack.BufferObj)->buffer,
                                buf_offset, &addr))
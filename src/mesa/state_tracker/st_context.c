@@ -454,6 +454,7 @@ st_destroy_context_priv(struct st_context *st, bool destroy_pipe)
 
    /* free glReadPixels cache data */
    st_invalidate_readpix_cache(st);
+   st_destroy_readpixels(st);
    util_throttle_deinit(st->pipe->screen, &st->throttle);
 
    cso_destroy_context(st->cso_context);
@@ -575,6 +576,9 @@ st_create_context_priv(struct gl_context *ctx, struct pipe_context *pipe,
       ctx->API == API_OPENGL_CORE ? U_VBUF_FLAG_NO_USER_VBOS : 0;
    st->cso_context = cso_create_context(pipe, vbuf_flags);
 
+   /* No vertex elements are bound yet, not even an empty set */
+   st->last_num_velements = ~0u;
+
    st_init_atoms(st);
    st_init_clear(st);
    st_init_pbo_helpers(st);
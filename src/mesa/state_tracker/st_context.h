@@ -272,6 +272,9 @@ struct st_context
       unsigned hits;
    } readpix_cache;
 
+   /** Staging textures for glReadPixels, reused once they are idle */
+   struct pipe_resource *readpix_staging[4];
+
    /** for glClear */
    struct {
       struct pipe_rasterizer_state raster;
@@ -309,8 +312,13 @@ struct st_context
 
    void *winsys_drawable_handle;
 
-   /* The number of vertex buffers from the last call of validate_arrays. */
+   /* The vertex buffers and elements from the last call of
+    * st_update_array(), to only bind what changed.
+    */
+   struct pipe_vertex_buffer last_vbuffers[PIPE_MAX_ATTRIBS];
    unsigned last_num_vbuffers;
+   struct pipe_vertex_element last_velements[PIPE_MAX_ATTRIBS];
+   unsigned last_num_velements;
 
    int32_t draw_stamp;
    int32_t read_stamp;
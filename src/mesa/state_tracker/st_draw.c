@@ -157,6 +157,57 @@ prepare_draw(struct st_context *st, struct gl_context *ctx)
    }
 }
 
+/**
+ * Whether \p p1 can be appended to \p p0 and both drawn with a single
+ * pipe draw call.  Only independent primitives of the same list type can be
+ * concatenated, and p1's vertices or indices must follow p0's.  Unlike
+ * vbo_can_merge_prims(), begin/end don't matter here: every prim that
+ * reaches the driver is complete.
+ */
+static bool
+can_merge_prims(const struct _mesa_prim *p0, const struct _mesa_prim *p1,
+                unsigned vertices_per_patch)
+{
+   if (p0->mode != p1->mode ||
+       p0->start + p0->count != p1->start ||
+       p0->basevertex != p1->basevertex ||
+       p0->num_instances != p1->num_instances ||
+       p0->base_instance != p1->base_instance)
+      return false;
+
+   switch (p0->mode) {
+   case GL_POINTS:
+      return true;
+   case GL_LINES:
+      return p0->count % 2 == 0;
+   case GL_TRIANGLES:
+      return p0->count % 3 == 0;
+   case GL_QUADS:
+      return p0->count % 4 == 0;
+   case GL_LINES_ADJACENCY:
+      return p0->count % 4 == 0;
+   case GL_TRIANGLES_ADJACENCY:
+      return p0->count % 6 == 0;
+   case GL_PATCHES:
+      return p0->count % vertices_per_patch == 0;
+   default:
+      return false;
+   }
+}
+
+/**
+ * Whether \p prog can tell prims apart by reading the primitive ID, which
+ * restarts from zero at each draw.
+ */
+static bool
+reads_primitive_id(const struct gl_program *prog)
+{
+   return prog &&
+      ((prog->info.inputs_read & VARYING_BIT_PRIMITIVE_ID) ||
+       (prog->info.system_values_read &
+        BITFIELD64_BIT(SYSTEM_VALUE_PRIMITIVE_ID)));
+}
+
 /**
  * This function gets plugged into the VBO module and is called when
  * we have something to render.
@@ -180,9 +231,24 @@ st_draw_vbo(struct gl_context *ctx,
    struct pipe_draw_info info;
    unsigned i;
    unsigned start = 0;
+   bool merge_prims;
 
    prepare_draw(st, ctx);
 
+   /* Consecutive prims can be sent down as one draw as long as nothing can
+    * tell them apart, which isn't the case if the vertex shader reads
+    * gl_DrawID, if a later stage reads the primitive ID, or if the vertex
+    * count comes from transform feedback.  Primitive restart is checked
+    * below.
+    */
+   merge_prims = nr_prims > 1 && !tfb_vertcount &&
+      !(st->vp->Base.info.system_values_read &
+        BITFIELD64_BIT(SYSTEM_VALUE_DRAW_ID)) &&
+      !(st->tcp && reads_primitive_id(&st->tcp->Base)) &&
+      !(st->tep && reads_primitive_id(&st->tep->Base)) &&
+      !(st->gp && reads_primitive_id(&st->gp->Base)) &&
+      !(st->fp && reads_primitive_id(&st->fp->Base));
+
    /* Initialize pipe_draw_info. */
    info.primitive_restart = false;
    info.vertices_per_patch = ctx->TessCtrlProgram.patch_vertices;
@@ -222,6 +288,12 @@ st_draw_vbo(struct gl_context *ctx,
       }
 
       setup_primitive_restart(ctx, &info);
+
+      /* A restart index drops the incomplete primitive before it, so the
+       * vertex counts of the prims no longer tell where their primitives end.
+       */
+      if (info.primitive_restart)
+         merge_prims = false;
    }
    else {
       info.index_size = 0;
@@ -239,18 +311,29 @@ st_draw_vbo(struct gl_context *ctx,
 
    /* do actual drawing */
    for (i = 0; i < nr_prims; i++) {
-      info.count = prims[i].count;
+      const struct _mesa_prim *prim = &prims[i];
+
+      info.count = prim->count;
+
+      if (merge_prims) {
+         while (i + 1 < nr_prims &&
+                can_merge_prims(&prims[i], &prims[i + 1],
+                                info.vertices_per_patch)) {
+            i++;
+            info.count += prims[i].count;
+         }
+      }
 
       /* Skip no-op draw calls. */
       if (!info.count && !tfb_vertcount)
          continue;
 
-      info.mode = translate_prim(ctx, prims[i].mode);
-      info.start = start + prims[i].start;
-      info.start_instance = prims[i].base_instance;
-      info.instance_count = prims[i].num_instances;
-      info.index_bias = prims[i].basevertex;
-      info.drawid = prims[i].draw_id;
+      info.mode = translate_prim(ctx, prim->mode);
+      info.start = start + prim->start;
+      info.start_instance = prim->base_instance;
+      info.instance_count = prim->num_instances;
+      info.index_bias = prim->basevertex;
+      info.drawid = prim->draw_id;
       if (!ib) {
          info.min_index = info.start;
          info.max_index = info.start + info.count - 1;
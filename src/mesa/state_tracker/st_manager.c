@@ -266,6 +266,12 @@ st_framebuffer_validate(struct st_framebuffer *stfb,
       pipe_resource_reference(&textures[i], NULL);
    }
 
+   if (stfb->Base.FlipY == stfb->iface->bottom_up) {
+      stfb->Base.FlipY = !stfb->iface->bottom_up;
+      st->ctx->NewState |= _NEW_BUFFERS;
+      changed = true;
+   }
+
    if (changed) {
       ++stfb->stamp;
       _mesa_resize_framebuffer(st->ctx, &stfb->Base, width, height);
@@ -491,6 +497,7 @@ st_framebuffer_create(struct st_context *st,
    }
 
    _mesa_initialize_window_framebuffer(&stfb->Base, &mode);
+   stfb->Base.FlipY = !stfbi->bottom_up;
 
    stfb->iface = stfbi;
    stfb->iface_ID = stfbi->ID;
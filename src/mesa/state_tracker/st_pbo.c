@@ -32,6 +32,7 @@
 #include "state_tracker/st_nir.h"
 #include "state_tracker/st_pbo.h"
 #include "state_tracker/st_cb_bufferobjects.h"
+#include "state_tracker/st_cb_readpixels.h"
 
 #include "pipe/p_context.h"
 #include "pipe/p_defines.h"
@@ -118,6 +119,8 @@ st_pbo_addresses_pixelstore(struct st_context *st,
    struct pipe_resource *buf = st_buffer_object(store->BufferObj)->buffer;
    intptr_t buf_offset = (intptr_t) pixels;
 
+   st_flush_readback(st, st_buffer_object(store->BufferObj));
+
    if (buf_offset % addr->bytes_per_pixel)
       return false;
 
@@ -71,8 +71,9 @@ st_invalidate_readpix_cache(struct st_context *st)
 static inline GLuint
 st_fb_orientation(const struct gl_framebuffer *fb)
 {
-   if (fb && _mesa_is_winsys_fbo(fb)) {
-      /* Drawing into a window (on-screen buffer).
+   if (fb && fb->FlipY) {
+      /* Drawing into a window (on-screen buffer), unless the window system
+       * stores its rows bottom to top (see st_framebuffer_iface::bottom_up).
        *
        * Negate Y scale to flip image vertically.
        * The NDC Y coords prior to viewport transformation are in the range
@@ -228,40 +228,17 @@ out:
 
 
 /**
- * Compute min and max elements by scanning the index buffer for
- * glDraw[Range]Elements() calls.
- * If primitive restart is enabled, we need to ignore restart
- * indexes when computing min/max.
+ * Scalar version of _mesa_index_array_min_max(), for CPUs without SSE4.1.
  */
 static void
-vbo_get_minmax_index(struct gl_context *ctx,
-                     const struct _mesa_prim *prim,
-                     const struct _mesa_index_buffer *ib,
-                     GLuint *min_index, GLuint *max_index,
-                     const GLuint count)
+vbo_get_minmax_index_scalar(const void *indices, unsigned index_size,
+                            GLboolean restart, GLuint restartIndex,
+                            GLuint *min_index, GLuint *max_index,
+                            const GLuint count)
 {
-   const GLboolean restart = ctx->Array._PrimitiveRestart;
-   const GLuint restartIndex =
-      _mesa_primitive_restart_index(ctx, ib->index_size);
-   const char *indices;
    GLuint i;
-   GLintptr offset = 0;
 
-   indices = (char *) ib->ptr + prim->start * ib->index_size;
-   if (_mesa_is_bufferobj(ib->obj)) {
-      GLsizeiptr size = MIN2(count * ib->index_size, ib->obj->Size);
-
-      if (vbo_get_minmax_cached(ib->obj, ib->index_size, (GLintptr) indices,
-                                count, min_index, max_index))
-         return;
-
-      offset = (GLintptr) indices;
-      indices = ctx->Driver.MapBufferRange(ctx, offset, size,
-                                           GL_MAP_READ_BIT, ib->obj,
-                                           MAP_INTERNAL);
-   }
-
-   switch (ib->index_size) {
+   switch (index_size) {
    case 4: {
       const GLuint *ui_indices = (const GLuint *)indices;
       GLuint max_ui = 0;
@@ -275,16 +252,10 @@ vbo_get_minmax_index(struct gl_context *ctx,
          }
       }
       else {
-#if defined(USE_SSE41)
-         if (cpu_has_sse4_1) {
-            _mesa_uint_array_min_max(ui_indices, &min_ui, &max_ui, count);
+         for (i = 0; i < count; i++) {
+            if (ui_indices[i] > max_ui) max_ui = ui_indices[i];
+            if (ui_indices[i] < min_ui) min_ui = ui_indices[i];
          }
-         else
-#endif
-            for (i = 0; i < count; i++) {
-               if (ui_indices[i] > max_ui) max_ui = ui_indices[i];
-               if (ui_indices[i] < min_ui) min_ui = ui_indices[i];
-            }
       }
       *min_index = min_ui;
       *max_index = max_ui;
@@ -337,6 +308,51 @@ vbo_get_minmax_index(struct gl_context *ctx,
    default:
       unreachable("not reached");
    }
+}
+
+
+/**
+ * Compute min and max elements by scanning the index buffer for
+ * glDraw[Range]Elements() calls.
+ * If primitive restart is enabled, we need to ignore restart
+ * indexes when computing min/max.
+ */
+static void
+vbo_get_minmax_index(struct gl_context *ctx,
+                     const struct _mesa_prim *prim,
+                     const struct _mesa_index_buffer *ib,
+                     GLuint *min_index, GLuint *max_index,
+                     const GLuint count)
+{
+   const GLboolean restart = ctx->Array._PrimitiveRestart;
+   const GLuint restartIndex =
+      _mesa_primitive_restart_index(ctx, ib->index_size);
+   const char *indices;
+   GLintptr offset = 0;
+
+   indices = (char *) ib->ptr + prim->start * ib->index_size;
+   if (_mesa_is_bufferobj(ib->obj)) {
+      GLsizeiptr size = MIN2(count * ib->index_size, ib->obj->Size);
+
+      if (vbo_get_minmax_cached(ib->obj, ib->index_size, (GLintptr) indices,
+                                count, min_index, max_index))
+         return;
+
+      offset = (GLintptr) indices;
+      indices = ctx->Driver.MapBufferRange(ctx, offset, size,
+                                           GL_MAP_READ_BIT, ib->obj,
+                                           MAP_INTERNAL);
+   }
+
+#if defined(USE_SSE41)
+   if (cpu_has_sse4_1) {
+      _mesa_index_array_min_max(indices, ib->index_size, restart,
+                                restartIndex, min_index, max_index, count);
+   }
+   else
+#endif
+      vbo_get_minmax_index_scalar(indices, ib->index_size, restart,
+                                  restartIndex, min_index, max_index, count);
 
    if (_mesa_is_bufferobj(ib->obj)) {
       vbo_minmax_cache_store(ctx, ib->obj, ib->index_size, offset,
@@ -75,6 +75,12 @@ struct vbo_save_vertex_list {
    GLuint prim_count;
 
    struct vbo_save_primitive_store *prim_store;
+
+   /* Prims owned by this node once merging vertex lists made them
+    * non-contiguous in prim_store, NULL otherwise.
+    */
+   struct _mesa_prim *merged_prims;
+   GLuint merged_prims_size;
 };
 
 
@@ -187,6 +193,15 @@ struct vbo_save_context {
 
    GLuint opcode_vertex_list;
 
+   /**
+    * The last vertex list compiled into the current display list, and the
+    * display list position right after it, to append the next vertex list
+    * to it when nothing else was compiled in between.
+    */
+   struct vbo_save_vertex_list *last_node;
+   const void *last_node_block;
+   GLuint last_node_pos;
+
    struct vbo_save_copied_vtx copied;
 
    fi_type *current[VBO_ATTRIB_MAX]; /* points into ctx->ListState */
@@ -97,6 +97,10 @@ USE OR OTHER DEALINGS IN THE SOFTWARE.
 #define DLIST_DANGLING_REFS     0x1
 
 
+static void
+vbo_destroy_vertex_list(struct gl_context *ctx, void *data);
+
+
 /* An interesting VBO number/name to help with debugging */
 #define VBO_BUF_ID  12345
 
@@ -524,6 +528,90 @@ update_vao(struct gl_context *ctx,
 }
 
 
+/**
+ * Try to append a just compiled vertex list to the previous one of the
+ * display list, to save a display list node and a draw call on each replay.
+ * That's possible when nothing was compiled in between, when both use the
+ * same VAOs, and so the same buffer and vertex format, and when no
+ * primitive is split across them.
+ * On success the references held by \p node are released.
+ */
+static bool
+merge_vertex_lists(struct gl_context *ctx, struct vbo_save_vertex_list *node)
+{
+   struct vbo_save_context *save = &vbo_context(ctx)->save;
+   struct vbo_save_vertex_list *last = save->last_node;
+
+   if (!last ||
+       save->last_node_block != ctx->ListState.CurrentBlock ||
+       save->last_node_pos != ctx->ListState.CurrentPos)
+      return false;
+
+   for (gl_vertex_processing_mode vpm = VP_MODE_FF; vpm < VP_MODE_MAX; ++vpm) {
+      if (last->VAO[vpm] != node->VAO[vpm])
+         return false;
+   }
+
+   if (node->wrap_count || !node->prims[0].begin ||
+       !last->prims[last->prim_count - 1].end)
+      return false;
+
+   /* Don't change whether current values get updated on replay */
+   if (!last->current_data != !node->current_data)
+      return false;
+
+   const GLuint prim_count = last->prim_count + node->prim_count;
+
+   if (!last->merged_prims && last->prim_store == node->prim_store) {
+      /* The prims of both lists are in the same store, with at most the
+       * slots freed by merge_prims in between.
+       */
+      memmove(last->prims + last->prim_count, node->prims,
+              node->prim_count * sizeof(*node->prims));
+   } else {
+      if (prim_count > last->merged_prims_size) {
+         const GLuint size = MAX2(2 * last->merged_prims_size, prim_count);
+         struct _mesa_prim *prims =
+            realloc(last->merged_prims, size * sizeof(*prims));
+
+         if (!prims)
+            return false;
+
+         if (!last->merged_prims)
+            memcpy(prims, last->prims, last->prim_count * sizeof(*prims));
+
+         last->merged_prims = prims;
+         last->merged_prims_size = size;
+         last->prims = prims;
+      }
+
+      memcpy(last->prims + last->prim_count, node->prims,
+             node->prim_count * sizeof(*node->prims));
+   }
+
+   /* Only the prims around the seam can be merged further */
+   GLuint tail_count = node->prim_count + 1;
+   merge_prims(last->prims + last->prim_count - 1, &tail_count);
+   last->prim_count += tail_count - 1;
+   assert(last->prim_count <= prim_count);
+
+   last->vertex_count += node->vertex_count;
+
+   if (node->current_data) {
+      free(last->current_data);
+      last->current_data = node->current_data;
+   }
+
+   for (gl_vertex_processing_mode vpm = VP_MODE_FF; vpm < VP_MODE_MAX; ++vpm)
+      _mesa_reference_vao(ctx, &node->VAO[vpm], NULL);
+
+   node->prim_store->refcount--;
+   assert(node->prim_store->refcount != 0);
+
+   return true;
+}
+
+
 /**
  * Insert the active immediate struct onto the display list currently
  * being built.
@@ -532,19 +620,8 @@ static void
 compile_vertex_list(struct gl_context *ctx)
 {
    struct vbo_save_context *save = &vbo_context(ctx)->save;
-   struct vbo_save_vertex_list *node;
-
-   /* Allocate space for this structure in the display list currently
-    * being compiled.
-    */
-   node = (struct vbo_save_vertex_list *)
-      _mesa_dlist_alloc_aligned(ctx, save->opcode_vertex_list, sizeof(*node));
-
-   if (!node)
-      return;
-
-   /* Make sure the pointer is aligned to the size of a pointer */
-   assert((GLintptr) node % sizeof(void *) == 0);
+   struct vbo_save_vertex_list list = { 0 };
+   struct vbo_save_vertex_list *node = &list;
 
    /* Duplicate our template, increment refcounts to the storage structs:
     */
@@ -666,6 +743,28 @@ compile_vertex_list(struct gl_context *ctx)
       _glapi_set_dispatch(dispatch);
    }
 
+   /* Append to the previous vertex list if possible, otherwise allocate
+    * space for this one in the display list currently being compiled.
+    */
+   if (!merge_vertex_lists(ctx, node)) {
+      struct vbo_save_vertex_list *dlist_node = (struct vbo_save_vertex_list *)
+         _mesa_dlist_alloc_aligned(ctx, save->opcode_vertex_list,
+                                   sizeof(*node));
+
+      if (dlist_node) {
+         /* Make sure the pointer is aligned to the size of a pointer */
+         assert((GLintptr) dlist_node % sizeof(void *) == 0);
+
+         *dlist_node = *node;
+         save->last_node = dlist_node;
+         save->last_node_block = ctx->ListState.CurrentBlock;
+         save->last_node_pos = ctx->ListState.CurrentPos;
+      } else {
+         vbo_destroy_vertex_list(ctx, node);
+         save->last_node = NULL;
+      }
+   }
+
    /* Decide whether the storage structs are full, or can be used for
     * the next vertex lists as well.
     */
@@ -1750,6 +1849,7 @@ vbo_save_SaveFlushVertices(struct gl_context *ctx)
    copy_to_current(ctx);
    reset_vertex(ctx);
    reset_counters(ctx);
+   save->last_node = NULL;
    ctx->Driver.SaveNeedFlush = GL_FALSE;
 }
 
@@ -1811,6 +1911,7 @@ vbo_save_EndList(struct gl_context *ctx)
    }
 
    vbo_save_unmap_vertex_store(ctx, save->vertex_store);
+   save->last_node = NULL;
 
    assert(save->vertex_size == 0);
 }
@@ -1856,6 +1957,9 @@ vbo_destroy_vertex_list(struct gl_context *ctx, void *data)
    if (--node->prim_store->refcount == 0)
       free(node->prim_store);
 
+   free(node->merged_prims);
+   node->merged_prims = NULL;
+
    free(node->current_data);
    node->current_data = NULL;
 }
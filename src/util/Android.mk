@@ -24,6 +24,32 @@ LOCAL_PATH := $(call my-dir)
 
 include $(LOCAL_PATH)/Makefile.sources
 
+# ---------------------------------------
+# Build libmesa_util_sse41
+# ---------------------------------------
+
+ifeq ($(ARCH_X86_HAVE_SSE4_1),true)
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := libmesa_util_sse41
+
+LOCAL_SRC_FILES := \
+	$(MESA_UTIL_SSE41_FILES)
+
+LOCAL_CFLAGS := \
+	-msse4.1 -mstackrealign
+
+LOCAL_C_INCLUDES := \
+	$(MESA_TOP)/src/mapi \
+	$(MESA_TOP)/src/gallium/include \
+	$(MESA_TOP)/src/gallium/auxiliary
+
+include $(MESA_COMMON_MK)
+include $(BUILD_STATIC_LIBRARY)
+
+endif
+
 # ---------------------------------------
 # Build libmesa_util
 # ---------------------------------------
@@ -52,6 +78,14 @@ endif
 
 LOCAL_SHARED_LIBRARIES += liblog
 
+# The SSE4.1 streaming loads are picked at runtime
+ifeq ($(ARCH_X86_HAVE_SSE4_1),true)
+LOCAL_WHOLE_STATIC_LIBRARIES := \
+	libmesa_util_sse41
+LOCAL_CFLAGS := \
+	-DUSE_SSE41
+endif
+
 LOCAL_MODULE := libmesa_util
 
 # Generated sources
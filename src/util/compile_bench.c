@@ -0,0 +1,248 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <errno.h>
+#include <ftw.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "compile_bench.h"
+#include "macros.h"
+#include "os_time.h"
+#include "u_cpu_detect.h"
+#include "u_dynarray.h"
+#include "u_queue.h"
+
+#define OPT_ITERATIONS  'n'
+#define OPT_THREADS     'j'
+#define OPT_HELP        'h'
+/* Options of the benchmark with an argument are OPT_BENCH + their index. */
+#define OPT_BENCH       256
+
+/* nftw() has no user data pointer. */
+static struct {
+   const struct compile_bench *bench;
+   struct util_dynarray paths;
+} collect;
+
+static int
+collect_path(const char *path, const struct stat *sb, int type,
+             struct FTW *ftw)
+{
+   if (type == FTW_F && collect.bench->is_shader(path)) {
+      char *copy = strdup(path);
+      util_dynarray_append(&collect.paths, char *, copy);
+   }
+
+   return 0;
+}
+
+static int
+compare_paths(const void *a, const void *b)
+{
+   return strcmp(*(char * const *) a, *(char * const *) b);
+}
+
+static void
+print_option(const char *name, const char *arg, const char *help)
+{
+   char buf[64];
+
+   snprintf(buf, sizeof(buf), "%s%s%s%s", name, arg ? " <" : "",
+            arg ? arg : "", arg ? ">" : "");
+   printf("    --%-20s %s\n", buf, help);
+}
+
+static void
+usage(const struct compile_bench *bench, const char *name)
+{
+   printf("usage: %s [options] <shader file or directory>...\n\n", name);
+   if (bench->description)
+      printf("%s\n\n", bench->description);
+
+   printf("Options:\n");
+   print_option("iterations", "n", "compile every shader n times (1)");
+   if (bench->threaded)
+      print_option("threads", "n", "compiler threads (number of CPUs)");
+   for (unsigned i = 0; bench->options && bench->options[i].name; i++) {
+      print_option(bench->options[i].name, bench->options[i].arg,
+                   bench->options[i].help);
+   }
+   print_option("csv", NULL, "print results as CSV");
+   print_option("verbose", NULL, "print per-shader results");
+
+   if (bench->print_help)
+      bench->print_help();
+}
+
+bool
+compile_bench_init(struct compile_bench *bench, int argc, char **argv,
+                   int *status)
+{
+   struct util_dynarray long_opts;
+   int c;
+
+   util_cpu_detect();
+   bench->iterations = 1;
+   bench->threads = bench->threaded ? util_cpu_caps.nr_cpus : 1;
+   bench->csv = 0;
+   bench->verbose = 0;
+   bench->paths = NULL;
+   bench->num_paths = 0;
+
+   util_dynarray_init(&long_opts, NULL);
+   struct option common_opts[] = {
+      { "iterations", required_argument, NULL, OPT_ITERATIONS },
+      { "threads", required_argument, NULL, OPT_THREADS },
+      { "csv", no_argument, &bench->csv, 1 },
+      { "verbose", no_argument, &bench->verbose, 1 },
+      { "help", no_argument, NULL, OPT_HELP },
+   };
+   for (unsigned i = 0; i < ARRAY_SIZE(common_opts); i++) {
+      if (common_opts[i].val != OPT_THREADS || bench->threaded)
+         util_dynarray_append(&long_opts, struct option, common_opts[i]);
+   }
+   for (unsigned i = 0; bench->options && bench->options[i].name; i++) {
+      const struct compile_bench_option *opt = &bench->options[i];
+      struct option o = {
+         .name = opt->name,
+         .has_arg = opt->arg ? required_argument : no_argument,
+         .flag = opt->arg ? NULL : opt->flag,
+         .val = opt->arg ? OPT_BENCH + i : 1,
+      };
+      util_dynarray_append(&long_opts, struct option, o);
+   }
+   struct option end = { NULL, 0, NULL, 0 };
+   util_dynarray_append(&long_opts, struct option, end);
+
+   *status = EXIT_FAILURE;
+   while ((c = getopt_long(argc, argv, "", long_opts.data, NULL)) != -1) {
+      switch (c) {
+      case OPT_ITERATIONS:
+         bench->iterations = MAX2(strtoul(optarg, NULL, 10), 1);
+         break;
+      case OPT_THREADS:
+         bench->threads = MAX2(strtoul(optarg, NULL, 10), 1);
+         break;
+      case 0:
+         break;
+      case OPT_HELP:
+         *status = EXIT_SUCCESS;
+         /* fallthrough */
+      default:
+         if (c >= OPT_BENCH) {
+            *bench->options[c - OPT_BENCH].value = optarg;
+            break;
+         }
+         usage(bench, argv[0]);
+         util_dynarray_fini(&long_opts);
+         return false;
+      }
+   }
+   util_dynarray_fini(&long_opts);
+
+   if (optind >= argc) {
+      usage(bench, argv[0]);
+      return false;
+   }
+
+   collect.bench = bench;
+   util_dynarray_init(&collect.paths, NULL);
+   for (int i = optind; i < argc; i++) {
+      if (nftw(argv[i], collect_path, 16, FTW_PHYS) == -1)
+         fprintf(stderr, "Failed to read %s: %s\n", argv[i], strerror(errno));
+   }
+
+   bench->paths = collect.paths.data;
+   bench->num_paths = util_dynarray_num_elements(&collect.paths, char *);
+   qsort(bench->paths, bench->num_paths, sizeof(char *), compare_paths);
+
+   return true;
+}
+
+void
+compile_bench_fini(struct compile_bench *bench)
+{
+   for (unsigned i = 0; i < bench->num_paths; i++)
+      free(bench->paths[i]);
+   free(bench->paths);
+   bench->paths = NULL;
+   bench->num_paths = 0;
+}
+
+struct run_job {
+   void *job;
+   void (*func)(void *job);
+   struct util_queue_fence fence;
+};
+
+static void
+run_job_execute(void *data, int thread_index)
+{
+   struct run_job *job = data;
+
+   job->func(job->job);
+}
+
+uint64_t
+compile_bench_run(const struct compile_bench *bench, void *jobs,
+                  unsigned count, size_t stride, void (*func)(void *job))
+{
+   struct util_queue queue;
+   uint64_t start = os_time_get_nano();
+
+   if (bench->threads <= 1 || count <= 1) {
+      for (unsigned i = 0; i < count; i++)
+         func((char *) jobs + i * stride);
+      return os_time_get_nano() - start;
+   }
+
+   struct run_job *run_jobs = calloc(count, sizeof(*run_jobs));
+   if (!run_jobs ||
+       !util_queue_init(&queue, "bench", count, bench->threads, 0)) {
+      fprintf(stderr, "Failed to create the compiler threads\n");
+      free(run_jobs);
+      exit(EXIT_FAILURE);
+   }
+
+   start = os_time_get_nano();
+   for (unsigned i = 0; i < count; i++) {
+      run_jobs[i].job = (char *) jobs + i * stride;
+      run_jobs[i].func = func;
+      util_queue_fence_init(&run_jobs[i].fence);
+      util_queue_add_job(&queue, &run_jobs[i], &run_jobs[i].fence,
+                         run_job_execute, NULL, 0);
+   }
+   util_queue_finish(&queue);
+   uint64_t wall_ns = os_time_get_nano() - start;
+
+   util_queue_destroy(&queue);
+   for (unsigned i = 0; i < count; i++)
+      util_queue_fence_destroy(&run_jobs[i].fence);
+   free(run_jobs);
+
+   return wall_ns;
+}
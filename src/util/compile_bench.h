@@ -0,0 +1,109 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file
+ * Command line handling shared by the offline compile-time benchmarks.
+ *
+ * A benchmark describes which files it compiles and its own options in a
+ * struct compile_bench, and compile_bench_init() parses the common options
+ * (--iterations, --threads, --csv, --verbose, --help), collects the shader
+ * files from the files and directories given on the command line and sorts
+ * them.  compile_bench_run() then runs a compile step over an array of jobs,
+ * on the requested number of threads.
+ */
+
+#ifndef COMPILE_BENCH_H
+#define COMPILE_BENCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct compile_bench_option {
+   /** Long option name, without the dashes. */
+   const char *name;
+   /** Argument name shown by --help, or NULL for a flag. */
+   const char *arg;
+   const char *help;
+   /** Set to 1 when the flag is given. */
+   int *flag;
+   /** Receives the argument of an option with one. */
+   const char **value;
+};
+
+struct compile_bench {
+   /* Filled in by the benchmark. */
+
+   /** Printed by --help after the usage line, may be NULL. */
+   const char *description;
+   /** Returns whether \p path is a shader the benchmark compiles. */
+   bool (*is_shader)(const char *path);
+   /** Benchmark specific options, terminated by a NULL name. May be NULL. */
+   const struct compile_bench_option *options;
+   /** Prints anything to add to --help after the options. May be NULL. */
+   void (*print_help)(void);
+   /** Whether compile_bench_run() may use several threads. */
+   bool threaded;
+
+   /* Filled in by compile_bench_init(). */
+
+   unsigned iterations;
+   unsigned threads;
+   int csv;
+   int verbose;
+   /** Sorted paths of the shaders to compile. */
+   char **paths;
+   unsigned num_paths;
+};
+
+/**
+ * Parses the command line and collects the shaders.  Returns false if the
+ * program should exit right away (after --help or on an error), with the
+ * status to exit with in \p status.
+ */
+bool
+compile_bench_init(struct compile_bench *bench, int argc, char **argv,
+                   int *status);
+
+void
+compile_bench_fini(struct compile_bench *bench);
+
+/**
+ * Calls \p func on each of the \p count jobs of \p stride bytes starting at
+ * \p jobs, on bench->threads threads if the benchmark is threaded and in
+ * order otherwise, and returns the wall time it took in nanoseconds.
+ */
+uint64_t
+compile_bench_run(const struct compile_bench *bench, void *jobs,
+                  unsigned count, size_t stride, void (*func)(void *job));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COMPILE_BENCH_H */
@@ -40,13 +40,19 @@
 #include <inttypes.h>
 #include "zlib.h"
 
+#ifdef HAVE_ZSTD
+#include "zstd.h"
+#endif
+
 #include "util/crc32.h"
 #include "util/debug.h"
+#include "util/hash_table.h"
 #include "util/rand_xor.h"
 #include "util/u_atomic.h"
 #include "util/u_queue.h"
 #include "util/mesa-sha1.h"
 #include "util/ralloc.h"
+#include "util/simple_mtx.h"
 #include "main/compiler.h"
 #include "main/errors.h"
 
@@ -75,6 +81,28 @@
  */
 #define CACHE_VERSION 1
 
+/* Codec used to compress cache entries. The codec id is part of the driver
+ * keys blob, so entries written with one codec are never looked up (and
+ * mis-decoded) by a cache configured for another.
+ */
+struct disk_cache_codec {
+   const char *name;
+   uint8_t id;
+   int default_level;
+   /* Highest level the codec accepts, the lowest one is 0 for both. */
+   int max_level;
+
+   /* Compresses \in_data and writes it to \dest, returns the number of bytes
+    * written or 0 on failure.
+    */
+   size_t (*compress)(const void *in_data, size_t in_data_size, int dest,
+                      int level);
+
+   /* Decompresses exactly \out_data_size bytes, returns true on success. */
+   bool (*decompress)(uint8_t *in_data, size_t in_data_size,
+                      uint8_t *out_data, size_t out_data_size);
+};
+
 struct disk_cache {
    /* The path to the cache directory. */
    char *path;
@@ -105,6 +133,17 @@ struct disk_cache {
 
    disk_cache_put_cb blob_put_cb;
    disk_cache_get_cb blob_get_cb;
+
+   /* Codec and level used for compressing new cache entries. */
+   const struct disk_cache_codec *codec;
+   int compression_level;
+
+   /* Entries requested through disk_cache_prefetch(), indexed by key and
+    * protected by prefetch_mtx. Each entry is a disk_cache_prefetch_job
+    * which is removed from the table when disk_cache_get() claims it.
+    */
+   struct hash_table *prefetch_jobs;
+   simple_mtx_t prefetch_mtx;
 };
 
 struct disk_cache_put_job {
@@ -123,6 +162,26 @@ struct disk_cache_put_job {
    struct cache_item_metadata cache_item_metadata;
 };
 
+struct disk_cache_prefetch_job {
+   struct util_queue_fence fence;
+
+   struct disk_cache *cache;
+
+   cache_key key;
+
+   /* Whether the job ran, as opposed to being dropped from the queue. */
+   bool loaded;
+
+   /* Decompressed cache data, or NULL if the entry could not be loaded. */
+   void *data;
+
+   /* Size of the decompressed data. */
+   size_t size;
+};
+
+static const struct disk_cache_codec *
+choose_codec(void);
+
 /* Create a directory named 'path' if it does not already exist.
  *
  * Returns: 0 if path already exists as a directory or if created.
@@ -189,6 +248,21 @@ do {                                       \
    _dst += _src_size;                      \
 } while (0);
 
+/* Cache keys are SHA-1 hashes, so any 32 bits of them make a good hash. */
+static uint32_t
+prefetch_key_hash(const void *key)
+{
+   uint32_t hash;
+   memcpy(&hash, key, sizeof(hash));
+   return hash;
+}
+
+static bool
+prefetch_key_equal(const void *a, const void *b)
+{
+   return memcmp(a, b, CACHE_KEY_SIZE) == 0;
+}
+
 struct disk_cache *
 disk_cache_create(const char *gpu_name, const char *driver_id,
                   uint64_t driver_flags)
@@ -369,6 +443,12 @@ disk_cache_create(const char *gpu_name, const char *driver_id,
 
    cache->max_size = max_size;
 
+   cache->prefetch_jobs =
+      _mesa_hash_table_create(cache, prefetch_key_hash, prefetch_key_equal);
+   if (cache->prefetch_jobs == NULL)
+      goto path_fail;
+   simple_mtx_init(&cache->prefetch_mtx, mtx_plain);
+
    /* 4 threads were chosen below because just about all modern CPUs currently
     * available that run Mesa have *at least* 4 cores. For these CPUs allowing
     * more threads can result in the queue being processed faster, thus
@@ -391,6 +471,15 @@ disk_cache_create(const char *gpu_name, const char *driver_id,
    if (fd != -1)
       close(fd);
 
+   cache->codec = choose_codec();
+   /* An out of range level would make every compression, and so every
+    * cache write, fail.
+    */
+   cache->compression_level =
+      MIN2(env_var_as_unsigned("MESA_GLSL_CACHE_COMPRESSION_LEVEL",
+                               cache->codec->default_level),
+           (unsigned) cache->codec->max_level);
+
    cache->driver_keys_blob_size = cv_size;
 
    /* Create driver id keys */
@@ -409,6 +498,9 @@ disk_cache_create(const char *gpu_name, const char *driver_id,
    size_t driver_flags_size = sizeof(driver_flags);
    cache->driver_keys_blob_size += driver_flags_size;
 
+   size_t codec_id_size = sizeof(cache->codec->id);
+   cache->driver_keys_blob_size += codec_id_size;
+
    cache->driver_keys_blob =
       ralloc_size(cache, cache->driver_keys_blob_size);
    if (!cache->driver_keys_blob)
@@ -420,6 +512,7 @@ disk_cache_create(const char *gpu_name, const char *driver_id,
    DRV_KEY_CPY(drv_key_blob, gpu_name, gpu_name_size)
    DRV_KEY_CPY(drv_key_blob, &ptr_size, ptr_size_size)
    DRV_KEY_CPY(drv_key_blob, &driver_flags, driver_flags_size)
+   DRV_KEY_CPY(drv_key_blob, &cache->codec->id, codec_id_size)
 
    /* Seed our rand function */
    s_rand_xorshift128plus(cache->seed_xorshift128plus, true);
@@ -442,6 +535,17 @@ disk_cache_destroy(struct disk_cache *cache)
    if (cache && !cache->path_init_failed) {
       util_queue_destroy(&cache->cache_queue);
       munmap(cache->index_mmap, cache->index_mmap_size);
+
+      /* The queue is idle now, so every prefetch job has completed. Drop the
+       * data nobody claimed.
+       */
+      hash_table_foreach(cache->prefetch_jobs, entry) {
+         struct disk_cache_prefetch_job *job = entry->data;
+         util_queue_fence_destroy(&job->fence);
+         free(job->data);
+         free(job);
+      }
+      simple_mtx_destroy(&cache->prefetch_mtx);
    }
 
    ralloc_free(cache);
@@ -735,7 +839,7 @@ write_all(int fd, const void *buf, size_t count)
  */
 static size_t
 deflate_and_write_to_disk(const void *in_data, size_t in_data_size, int dest,
-                          const char *filename)
+                          int level)
 {
    unsigned char *out;
 
@@ -747,7 +851,7 @@ deflate_and_write_to_disk(const void *in_data, size_t in_data_size, int dest,
    strm.next_in = (uint8_t *) in_data;
    strm.avail_in = in_data_size;
 
-   int ret = deflateInit(&strm, Z_BEST_COMPRESSION);
+   int ret = deflateInit(&strm, level);
    if (ret != Z_OK)
        return 0;
 
@@ -799,6 +903,119 @@ deflate_and_write_to_disk(const void *in_data, size_t in_data_size, int dest,
    return compressed_size;
 }
 
+/**
+ * Decompresses cache entry, returns true if successful.
+ */
+static bool
+inflate_cache_data(uint8_t *in_data, size_t in_data_size,
+                   uint8_t *out_data, size_t out_data_size)
+{
+   z_stream strm;
+
+   /* allocate inflate state */
+   strm.zalloc = Z_NULL;
+   strm.zfree = Z_NULL;
+   strm.opaque = Z_NULL;
+   strm.next_in = in_data;
+   strm.avail_in = in_data_size;
+   strm.next_out = out_data;
+   strm.avail_out = out_data_size;
+
+   int ret = inflateInit(&strm);
+   if (ret != Z_OK)
+      return false;
+
+   ret = inflate(&strm, Z_NO_FLUSH);
+   assert(ret != Z_STREAM_ERROR);  /* state not clobbered */
+
+   /* Unless there was an error we should have decompressed everything in one
+    * go as we know the uncompressed file size.
+    */
+   if (ret != Z_STREAM_END) {
+      (void)inflateEnd(&strm);
+      return false;
+   }
+   assert(strm.avail_out == 0);
+
+   /* clean up and return */
+   (void)inflateEnd(&strm);
+   return true;
+}
+
+#ifdef HAVE_ZSTD
+static size_t
+zstd_compress_and_write_to_disk(const void *in_data, size_t in_data_size,
+                                int dest, int level)
+{
+   size_t out_size = ZSTD_compressBound(in_data_size);
+   void *out = malloc(out_size);
+   if (out == NULL)
+      return 0;
+
+   size_t compressed_size = ZSTD_compress(out, out_size, in_data, in_data_size,
+                                          level);
+   if (ZSTD_isError(compressed_size) ||
+       write_all(dest, out, compressed_size) == -1) {
+      free(out);
+      return 0;
+   }
+
+   free(out);
+   return compressed_size;
+}
+
+static bool
+zstd_decompress_cache_data(uint8_t *in_data, size_t in_data_size,
+                           uint8_t *out_data, size_t out_data_size)
+{
+   size_t ret = ZSTD_decompress(out_data, out_data_size, in_data,
+                                in_data_size);
+   return !ZSTD_isError(ret) && ret == out_data_size;
+}
+#endif
+
+static const struct disk_cache_codec disk_cache_codecs[] = {
+#ifdef HAVE_ZSTD
+   /* zstd at its fastest levels compresses shader binaries about as well as
+    * zlib's best level at a fraction of the cost, so prefer it if available.
+    */
+   {
+      .name = "zstd",
+      .id = 1,
+      .default_level = 1,
+      .max_level = 22,
+      .compress = zstd_compress_and_write_to_disk,
+      .decompress = zstd_decompress_cache_data,
+   },
+#endif
+   {
+      .name = "zlib",
+      .id = 0,
+      .default_level = Z_BEST_COMPRESSION,
+      .max_level = Z_BEST_COMPRESSION,
+      .compress = deflate_and_write_to_disk,
+      .decompress = inflate_cache_data,
+   },
+};
+
+/* Picks the codec named by MESA_GLSL_CACHE_COMPRESSION, or the first
+ * (preferred) one if unset or unknown.
+ */
+static const struct disk_cache_codec *
+choose_codec(void)
+{
+   const char *name = getenv("MESA_GLSL_CACHE_COMPRESSION");
+
+   if (name) {
+      for (unsigned i = 0; i < ARRAY_SIZE(disk_cache_codecs); i++) {
+         if (strcmp(name, disk_cache_codecs[i].name) == 0)
+            return &disk_cache_codecs[i];
+      }
+   }
+
+   return &disk_cache_codecs[0];
+}
+
 static struct disk_cache_put_job *
 create_put_job(struct disk_cache *cache, const cache_key key,
                const void *data, size_t size,
@@ -985,8 +1202,9 @@ cache_put(void *job, int thread_index)
     * rename them atomically to the destination filename, and also
     * perform an atomic increment of the total cache size.
     */
-   size_t file_size = deflate_and_write_to_disk(dc_job->data, dc_job->size,
-                                                fd, filename_tmp);
+   size_t file_size =
+      dc_job->cache->codec->compress(dc_job->data, dc_job->size, fd,
+                                     dc_job->cache->compression_level);
    if (file_size == 0) {
       unlink(filename_tmp);
       goto done;
@@ -1042,46 +1260,12 @@ disk_cache_put(struct disk_cache *cache, const cache_key key,
 }
 
 /**
- * Decompresses cache entry, returns true if successful.
+ * Reads the cache file for \key, decompresses it and checks it for
+ * corruption. Returns the malloc'ed data or NULL. This may be called from
+ * the cache queue threads.
  */
-static bool
-inflate_cache_data(uint8_t *in_data, size_t in_data_size,
-                   uint8_t *out_data, size_t out_data_size)
-{
-   z_stream strm;
-
-   /* allocate inflate state */
-   strm.zalloc = Z_NULL;
-   strm.zfree = Z_NULL;
-   strm.opaque = Z_NULL;
-   strm.next_in = in_data;
-   strm.avail_in = in_data_size;
-   strm.next_out = out_data;
-   strm.avail_out = out_data_size;
-
-   int ret = inflateInit(&strm);
-   if (ret != Z_OK)
-      return false;
-
-   ret = inflate(&strm, Z_NO_FLUSH);
-   assert(ret != Z_STREAM_ERROR);  /* state not clobbered */
-
-   /* Unless there was an error we should have decompressed everything in one
-    * go as we know the uncompressed file size.
-    */
-   if (ret != Z_STREAM_END) {
-      (void)inflateEnd(&strm);
-      return false;
-   }
-   assert(strm.avail_out == 0);
-
-   /* clean up and return */
-   (void)inflateEnd(&strm);
-   return true;
-}
-
-void *
-disk_cache_get(struct disk_cache *cache, const cache_key key, size_t *size)
+static void *
+load_cache_item(struct disk_cache *cache, const cache_key key, size_t *size)
 {
    int fd = -1, ret;
    struct stat sb;
@@ -1090,31 +1274,6 @@ disk_cache_get(struct disk_cache *cache, const cache_key key, size_t *size)
    uint8_t *uncompressed_data = NULL;
    uint8_t *file_header = NULL;
 
-   if (size)
-      *size = 0;
-
-   if (cache->blob_get_cb) {
-      /* This is what Android EGL defines as the maxValueSize in egl_cache_t
-       * class implementation.
-       */
-      const signed long max_blob_size = 64 * 1024;
-      void *blob = malloc(max_blob_size);
-      if (!blob)
-         return NULL;
-
-      signed long bytes =
-         cache->blob_get_cb(key, CACHE_KEY_SIZE, blob, max_blob_size);
-
-      if (!bytes) {
-         free(blob);
-         return NULL;
-      }
-
-      if (size)
-         *size = bytes;
-      return blob;
-   }
-
    filename = get_cache_file(cache, key);
    if (filename == NULL)
       goto fail;
@@ -1189,8 +1348,9 @@ disk_cache_get(struct disk_cache *cache, const cache_key key, size_t *size)
 
    /* Uncompress the cache data */
    uncompressed_data = malloc(cf_data.uncompressed_size);
-   if (!inflate_cache_data(data, cache_data_size, uncompressed_data,
-                           cf_data.uncompressed_size))
+   if (!uncompressed_data ||
+       !cache->codec->decompress(data, cache_data_size, uncompressed_data,
+                                 cf_data.uncompressed_size))
       goto fail;
 
    /* Check the data for corruption */
@@ -1203,8 +1363,7 @@ disk_cache_get(struct disk_cache *cache, const cache_key key, size_t *size)
    free(file_header);
    close(fd);
 
-   if (size)
-      *size = cf_data.uncompressed_size;
+   *size = cf_data.uncompressed_size;
 
    return uncompressed_data;
 
@@ -1223,6 +1382,131 @@ disk_cache_get(struct disk_cache *cache, const cache_key key, size_t *size)
    return NULL;
 }
 
+/**
+ * Removes \key from the prefetch table and returns its data, waiting for the
+ * load if it is still in flight. \found is false if the key was never
+ * prefetched, or if its load had not started yet: the job is dropped then,
+ * and the caller loads the item itself.
+ */
+static void *
+claim_prefetched_item(struct disk_cache *cache, const cache_key key,
+                      size_t *size, bool *found)
+{
+   struct disk_cache_prefetch_job *job = NULL;
+
+   simple_mtx_lock(&cache->prefetch_mtx);
+   struct hash_entry *entry =
+      _mesa_hash_table_search(cache->prefetch_jobs, key);
+   if (entry) {
+      job = entry->data;
+      _mesa_hash_table_remove(cache->prefetch_jobs, entry);
+   }
+   simple_mtx_unlock(&cache->prefetch_mtx);
+
+   *found = false;
+   if (!job)
+      return NULL;
+
+   /* The job may still be behind other prefetches, which we shouldn't wait
+    * for, but reading the file a second time would only compete with a queue
+    * thread that is already loading it.
+    */
+   util_queue_drop_job(&cache->cache_queue, &job->fence);
+   util_queue_fence_destroy(&job->fence);
+
+   void *data = job->data;
+   *found = job->loaded;
+   *size = job->size;
+   free(job);
+
+   return data;
+}
+
+void *
+disk_cache_get(struct disk_cache *cache, const cache_key key, size_t *size)
+{
+   if (size)
+      *size = 0;
+
+   if (cache->blob_get_cb) {
+      /* This is what Android EGL defines as the maxValueSize in egl_cache_t
+       * class implementation.
+       */
+      const signed long max_blob_size = 64 * 1024;
+      void *blob = malloc(max_blob_size);
+      if (!blob)
+         return NULL;
+
+      signed long bytes =
+         cache->blob_get_cb(key, CACHE_KEY_SIZE, blob, max_blob_size);
+
+      if (!bytes) {
+         free(blob);
+         return NULL;
+      }
+
+      if (size)
+         *size = bytes;
+      return blob;
+   }
+
+   if (cache->path_init_failed)
+      return NULL;
+
+   bool prefetched;
+   size_t data_size = 0;
+   void *data = claim_prefetched_item(cache, key, &data_size, &prefetched);
+   if (!prefetched)
+      data = load_cache_item(cache, key, &data_size);
+
+   if (data && size)
+      *size = data_size;
+
+   return data;
+}
+
+static void
+cache_prefetch(void *job, int thread_index)
+{
+   struct disk_cache_prefetch_job *pf_job =
+      (struct disk_cache_prefetch_job *) job;
+
+   pf_job->data = load_cache_item(pf_job->cache, pf_job->key, &pf_job->size);
+   pf_job->loaded = true;
+}
+
+void
+disk_cache_prefetch(struct disk_cache *cache, const cache_key *keys,
+                    unsigned num_keys)
+{
+   if (cache->blob_get_cb || cache->path_init_failed)
+      return;
+
+   simple_mtx_lock(&cache->prefetch_mtx);
+   for (unsigned i = 0; i < num_keys; i++) {
+      if (_mesa_hash_table_search(cache->prefetch_jobs, keys[i]))
+         continue;
+
+      struct disk_cache_prefetch_job *job =
+         calloc(1, sizeof(struct disk_cache_prefetch_job));
+      if (!job)
+         break;
+
+      job->cache = cache;
+      memcpy(job->key, keys[i], sizeof(cache_key));
+      util_queue_fence_init(&job->fence);
+
+      _mesa_hash_table_insert(cache->prefetch_jobs, job->key, job);
+      /* Loads run ahead of the queued puts: a get waits for them, while
+       * nothing waits for the puts.
+       */
+      util_queue_add_job_ext(&cache->cache_queue, job, &job->fence,
+                             cache_prefetch, NULL, 0,
+                             UTIL_QUEUE_PRIORITY_HIGH, NULL);
+   }
+   simple_mtx_unlock(&cache->prefetch_mtx);
+}
+
 void
 disk_cache_put_key(struct disk_cache *cache, const cache_key key)
 {
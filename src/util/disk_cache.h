@@ -210,6 +210,19 @@ disk_cache_put(struct disk_cache *cache, const cache_key key,
 void *
 disk_cache_get(struct disk_cache *cache, const cache_key key, size_t *size);
 
+/**
+ * Start loading and decompressing the items stored under \keys on the
+ * cache's worker threads, ahead of the disk_cache_get() calls for them.
+ *
+ * A later disk_cache_get() for one of these keys returns the prefetched
+ * data, waiting for the load if it is in progress. A load that has not
+ * started yet is cancelled and done by disk_cache_get() itself. Prefetched
+ * items that are never requested are freed by disk_cache_destroy().
+ */
+void
+disk_cache_prefetch(struct disk_cache *cache, const cache_key *keys,
+                    unsigned num_keys);
+
 /**
  * Store the name \key within the cache, (without any associated data).
  *
@@ -280,6 +293,13 @@ disk_cache_get(struct disk_cache *cache, const cache_key key, size_t *size)
    return NULL;
 }
 
+static inline void
+disk_cache_prefetch(struct disk_cache *cache, const cache_key *keys,
+                    unsigned num_keys)
+{
+   return;
+}
+
 static inline void
 disk_cache_put_key(struct disk_cache *cache, const cache_key key)
 {
@@ -0,0 +1,182 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file
+ * SSE2 row converters for formats with four 8-bit unorm (or padding)
+ * channels, used by the generated pack/unpack functions of both Mesa and
+ * gallium.
+ *
+ * Pixels are handled four at a time, and each function returns how many
+ * pixels it converted, a multiple of four: the caller converts the rest
+ * with its per-pixel code.  The results are exactly the same as with the
+ * scalar conversions named below.
+ *
+ * Swizzles are given as four constants, one per destination byte or
+ * channel: 0 to 3 select a source byte or channel, 4 gives zero and 5 gives
+ * one (0xff).  That matches both PIPE_SWIZZLE_* and MESA_FORMAT_SWIZZLE_*.
+ * The functions are inline so that they get specialized for the constant
+ * swizzles of each format.
+ */
+
+#ifndef FORMAT_RGBA8_SSE2_H
+#define FORMAT_RGBA8_SSE2_H
+
+#ifdef __SSE2__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <emmintrin.h>
+
+#define UTIL_FORMAT_SWIZZLE_0 4
+#define UTIL_FORMAT_SWIZZLE_1 5
+
+/**
+ * Move byte \p swz of each 32-bit lane of \p v to byte \p c.
+ */
+static inline __m128i
+util_format_rgba8_swizzle_byte_sse2(__m128i v, unsigned swz, unsigned c)
+{
+   if (swz == UTIL_FORMAT_SWIZZLE_0)
+      return _mm_setzero_si128();
+   if (swz == UTIL_FORMAT_SWIZZLE_1)
+      return _mm_set1_epi32(0xff << (8 * c));
+
+   v = _mm_and_si128(v, _mm_set1_epi32(0xff << (8 * swz)));
+   if (swz > c)
+      return _mm_srli_epi32(v, 8 * (swz - c));
+   else
+      return _mm_slli_epi32(v, 8 * (c - swz));
+}
+
+static inline __m128i
+util_format_rgba8_swizzle_sse2(__m128i v, unsigned s0, unsigned s1,
+                               unsigned s2, unsigned s3)
+{
+   /* Nothing to do for the common RGBA -> RGBA case */
+   if (s0 == 0 && s1 == 1 && s2 == 2 && s3 == 3)
+      return v;
+
+   return _mm_or_si128(
+      _mm_or_si128(util_format_rgba8_swizzle_byte_sse2(v, s0, 0),
+                   util_format_rgba8_swizzle_byte_sse2(v, s1, 1)),
+      _mm_or_si128(util_format_rgba8_swizzle_byte_sse2(v, s2, 2),
+                   util_format_rgba8_swizzle_byte_sse2(v, s3, 3)));
+}
+
+/**
+ * Swizzle 8-bit channels, for unpacking to and packing from 8-bit RGBA.
+ */
+static inline unsigned
+util_format_rgba8_swizzle_row_sse2(uint8_t *dst, const uint8_t *src,
+                                   unsigned n, unsigned s0, unsigned s1,
+                                   unsigned s2, unsigned s3)
+{
+   unsigned i;
+
+   for (i = 0; i + 4 <= n; i += 4) {
+      const __m128i v = _mm_loadu_si128((const __m128i *) (src + i * 4));
+      _mm_storeu_si128((__m128i *) (dst + i * 4),
+                       util_format_rgba8_swizzle_sse2(v, s0, s1, s2, s3));
+   }
+
+   return i;
+}
+
+/**
+ * Unpack to float RGBA, like ubyte_to_float() and _mesa_unorm_to_float().
+ */
+static inline unsigned
+util_format_rgba8_to_float_row_sse2(float *dst, const uint8_t *src,
+                                    unsigned n, unsigned s0, unsigned s1,
+                                    unsigned s2, unsigned s3)
+{
+   const __m128i zero = _mm_setzero_si128();
+   const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+   unsigned i;
+
+   for (i = 0; i + 4 <= n; i += 4) {
+      __m128i v = _mm_loadu_si128((const __m128i *) (src + i * 4));
+      v = util_format_rgba8_swizzle_sse2(v, s0, s1, s2, s3);
+
+      const __m128i lo = _mm_unpacklo_epi8(v, zero);
+      const __m128i hi = _mm_unpackhi_epi8(v, zero);
+      const __m128i p[4] = {
+         _mm_unpacklo_epi16(lo, zero), _mm_unpackhi_epi16(lo, zero),
+         _mm_unpacklo_epi16(hi, zero), _mm_unpackhi_epi16(hi, zero),
+      };
+
+      for (unsigned j = 0; j < 4; j++) {
+         _mm_storeu_ps(dst + (i + j) * 4,
+                       _mm_mul_ps(_mm_cvtepi32_ps(p[j]), scale));
+      }
+   }
+
+   return i;
+}
+
+/**
+ * Pack from float RGBA, like float_to_ubyte() when \p round_even is false,
+ * or like _mesa_float_to_unorm() when it is true.  NaNs give 0 in both
+ * cases.
+ */
+static inline unsigned
+util_format_rgba8_from_float_row_sse2(uint8_t *dst, const float *src,
+                                      unsigned n, unsigned s0, unsigned s1,
+                                      unsigned s2, unsigned s3,
+                                      bool round_even)
+{
+   const __m128 zero = _mm_setzero_ps();
+   const __m128 one = _mm_set1_ps(1.0f);
+   unsigned i;
+
+   for (i = 0; i + 4 <= n; i += 4) {
+      __m128i p[4];
+
+      for (unsigned j = 0; j < 4; j++) {
+         /* max() returns its second operand for NaNs */
+         __m128 f = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + (i + j) * 4),
+                                          zero), one);
+
+         if (round_even) {
+            /* In the default rounding mode */
+            p[j] = _mm_cvtps_epi32(_mm_mul_ps(f, _mm_set1_ps(255.0f)));
+         } else {
+            f = _mm_add_ps(_mm_mul_ps(f, _mm_set1_ps(255.0f / 256.0f)),
+                           _mm_set1_ps(32768.0f));
+            p[j] = _mm_and_si128(_mm_castps_si128(f), _mm_set1_epi32(0xff));
+         }
+      }
+
+      const __m128i v = _mm_packus_epi16(_mm_packs_epi32(p[0], p[1]),
+                                         _mm_packs_epi32(p[2], p[3]));
+      _mm_storeu_si128((__m128i *) (dst + i * 4),
+                       util_format_rgba8_swizzle_sse2(v, s0, s1, s2, s3));
+   }
+
+   return i;
+}
+
+#endif /* __SSE2__ */
+
+#endif /* FORMAT_RGBA8_SSE2_H */
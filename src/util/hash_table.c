@@ -546,20 +546,99 @@ _mesa_hash_table_random_entry(struct hash_table *ht,
 }
 
 
+#define HASH_PRIME32_1 0x9e3779b1u
+#define HASH_PRIME32_2 0x85ebca77u
+#define HASH_PRIME32_3 0xc2b2ae3du
+#define HASH_PRIME32_4 0x27d4eb2fu
+#define HASH_PRIME32_5 0x165667b1u
+
+static inline uint32_t
+hash_rotl(uint32_t x, unsigned r)
+{
+   return (x << r) | (x >> (32 - r));
+}
+
+static inline uint32_t
+hash_read32(const uint8_t *p)
+{
+   uint32_t v;
+
+   memcpy(&v, p, sizeof(v));
+   return v;
+}
+
+static inline uint32_t
+hash_round(uint32_t acc, uint32_t input)
+{
+   acc += input * HASH_PRIME32_2;
+   return hash_rotl(acc, 13) * HASH_PRIME32_1;
+}
+
 /**
- * Quick FNV-1a hash implementation based on:
- * http://www.isthe.com/chongo/tech/comp/fnv/
+ * Word-at-a-time hash, following Yann Collet's xxHash32:
+ * https://github.com/Cyan4973/xxHash
+ *
+ * Keys are consumed 16 bytes per iteration by four independent lanes, so
+ * large keys like shader variant keys hash several times faster than with
+ * the byte-at-a-time FNV-1a, and the final avalanche gives well distributed
+ * low bits for the power-of-two sized tables.
  *
- * FNV-1a is not be the best hash out there -- Jenkins's lookup3 is supposed
- * to be quite good, and it probably beats FNV.  But FNV has the advantage
- * that it involves almost no code.  For an improvement on both, see Paul
- * Hsieh's http://www.azillionmonkeys.com/qed/hash.html
+ * Words are read in the host byte order, so the hashes are only meant to be
+ * used within a process: don't store them anywhere.
  */
+uint32_t
+_mesa_hash_data_with_seed(const void *data, size_t size, uint32_t seed)
+{
+   const uint8_t *p = data;
+   const uint8_t *const end = p + size;
+   uint32_t hash;
+
+   if (size >= 16) {
+      const uint8_t *const limit = end - 16;
+      uint32_t v1 = seed + HASH_PRIME32_1 + HASH_PRIME32_2;
+      uint32_t v2 = seed + HASH_PRIME32_2;
+      uint32_t v3 = seed;
+      uint32_t v4 = seed - HASH_PRIME32_1;
+
+      do {
+         v1 = hash_round(v1, hash_read32(p));
+         v2 = hash_round(v2, hash_read32(p + 4));
+         v3 = hash_round(v3, hash_read32(p + 8));
+         v4 = hash_round(v4, hash_read32(p + 12));
+         p += 16;
+      } while (p <= limit);
+
+      hash = hash_rotl(v1, 1) + hash_rotl(v2, 7) +
+             hash_rotl(v3, 12) + hash_rotl(v4, 18);
+   } else {
+      hash = seed + HASH_PRIME32_5;
+   }
+
+   hash += (uint32_t) size;
+
+   for (; p + 4 <= end; p += 4) {
+      hash += hash_read32(p) * HASH_PRIME32_3;
+      hash = hash_rotl(hash, 17) * HASH_PRIME32_4;
+   }
+
+   for (; p < end; p++) {
+      hash += *p * HASH_PRIME32_5;
+      hash = hash_rotl(hash, 11) * HASH_PRIME32_1;
+   }
+
+   hash ^= hash >> 15;
+   hash *= HASH_PRIME32_2;
+   hash ^= hash >> 13;
+   hash *= HASH_PRIME32_3;
+   hash ^= hash >> 16;
+
+   return hash;
+}
+
 uint32_t
 _mesa_hash_data(const void *data, size_t size)
 {
-   return _mesa_fnv32_1a_accumulate_block(_mesa_fnv32_1a_offset_bias,
-                                          data, size);
+   return _mesa_hash_data_with_seed(data, size, 0);
 }
 
 /** FNV-1a string hash implementation */
@@ -24,8 +24,55 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
+#include "c11/threads.h"
 #include "sha1/sha1.h"
 #include "mesa-sha1.h"
+#include "u_cpu_detect.h"
+
+typedef void (*sha1_transform_blocks_func)(uint32_t state[5],
+                                           const uint8_t *data,
+                                           size_t num_blocks);
+
+static sha1_transform_blocks_func sha1_transform_blocks;
+static once_flag sha1_transform_blocks_once = ONCE_FLAG_INIT;
+
+static void
+sha1_transform_blocks_c(uint32_t state[5], const uint8_t *data,
+                        size_t num_blocks)
+{
+   for (size_t i = 0; i < num_blocks; i++)
+      SHA1Transform(state, data + i * SHA1_BLOCK_LENGTH);
+}
+
+static void
+sha1_transform_blocks_init(void)
+{
+   util_cpu_detect();
+
+   sha1_transform_blocks = sha1_transform_blocks_c;
+#ifdef USE_SHA_NI
+   if (util_cpu_caps.has_sha1 && util_cpu_caps.has_sse4_1)
+      sha1_transform_blocks = _mesa_sha1_transform_blocks_sha_ni;
+#endif
+#ifdef USE_ARM_SHA1
+   if (util_cpu_caps.has_sha1)
+      sha1_transform_blocks = _mesa_sha1_transform_blocks_armv8;
+#endif
+}
+
+/**
+ * Hashes whole 64-byte blocks for SHA1Update(), with the SHA instructions
+ * of the CPU when it has them.
+ */
+void
+_mesa_sha1_transform_blocks(uint32_t state[5], const uint8_t *data,
+                            size_t num_blocks)
+{
+   call_once(&sha1_transform_blocks_once, sha1_transform_blocks_init);
+
+   if (num_blocks)
+      sha1_transform_blocks(state, data, num_blocks);
+}
 
 void
 _mesa_sha1_compute(const void *data, size_t size, unsigned char result[20])
@@ -57,6 +57,16 @@ _mesa_sha1_format(char *buf, const unsigned char *sha1);
 void
 _mesa_sha1_compute(const void *data, size_t size, unsigned char result[20]);
 
+/* The block functions for each instruction set, which expect the CPU to
+ * support it.
+ */
+void
+_mesa_sha1_transform_blocks_sha_ni(uint32_t state[5], const uint8_t *data,
+                                   size_t num_blocks);
+void
+_mesa_sha1_transform_blocks_armv8(uint32_t state[5], const uint8_t *data,
+                                  size_t num_blocks);
+
 #ifdef __cplusplus
 } /* extern C */
 #endif
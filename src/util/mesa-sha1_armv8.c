@@ -0,0 +1,92 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file
+ * SHA-1 block function using the ARMv8 cryptography extensions.
+ *
+ * Each SHA1C/SHA1P/SHA1M does four rounds, SHA1H gives the E of the next
+ * four, and SHA1SU0/SHA1SU1 expand the message four words at a time.
+ */
+
+#include <stdint.h>
+#include <arm_neon.h>
+
+#include "util/mesa-sha1.h"
+
+/* Four rounds, \p g being the index of the group of four */
+#define SHA1_ROUNDS4(g, op, k)                                               \
+   do {                                                                      \
+      if ((g) < 4) {                                                         \
+         w[(g)] = vreinterpretq_u32_u8(                                      \
+            vrev32q_u8(vld1q_u8(data + (g) * 16)));                          \
+      } else {                                                               \
+         w[(g) % 4] = vsha1su1q_u32(                                         \
+            vsha1su0q_u32(w[(g) % 4], w[((g) + 1) % 4], w[((g) + 2) % 4]),   \
+            w[((g) + 3) % 4]);                                               \
+      }                                                                      \
+      const uint32_t next_e = vsha1h_u32(vgetq_lane_u32(abcd, 0));           \
+      abcd = op(abcd, e, vaddq_u32(w[(g) % 4], vdupq_n_u32(k)));             \
+      e = next_e;                                                            \
+   } while (0)
+
+void
+_mesa_sha1_transform_blocks_armv8(uint32_t state[5], const uint8_t *data,
+                                  size_t num_blocks)
+{
+   uint32x4_t abcd = vld1q_u32(state);
+   uint32_t e0 = state[4];
+
+   for (; num_blocks; num_blocks--, data += SHA1_BLOCK_LENGTH) {
+      const uint32x4_t abcd_save = abcd;
+      uint32x4_t w[4];
+      uint32_t e = e0;
+
+      SHA1_ROUNDS4(0, vsha1cq_u32, 0x5a827999);
+      SHA1_ROUNDS4(1, vsha1cq_u32, 0x5a827999);
+      SHA1_ROUNDS4(2, vsha1cq_u32, 0x5a827999);
+      SHA1_ROUNDS4(3, vsha1cq_u32, 0x5a827999);
+      SHA1_ROUNDS4(4, vsha1cq_u32, 0x5a827999);
+      SHA1_ROUNDS4(5, vsha1pq_u32, 0x6ed9eba1);
+      SHA1_ROUNDS4(6, vsha1pq_u32, 0x6ed9eba1);
+      SHA1_ROUNDS4(7, vsha1pq_u32, 0x6ed9eba1);
+      SHA1_ROUNDS4(8, vsha1pq_u32, 0x6ed9eba1);
+      SHA1_ROUNDS4(9, vsha1pq_u32, 0x6ed9eba1);
+      SHA1_ROUNDS4(10, vsha1mq_u32, 0x8f1bbcdc);
+      SHA1_ROUNDS4(11, vsha1mq_u32, 0x8f1bbcdc);
+      SHA1_ROUNDS4(12, vsha1mq_u32, 0x8f1bbcdc);
+      SHA1_ROUNDS4(13, vsha1mq_u32, 0x8f1bbcdc);
+      SHA1_ROUNDS4(14, vsha1mq_u32, 0x8f1bbcdc);
+      SHA1_ROUNDS4(15, vsha1pq_u32, 0xca62c1d6);
+      SHA1_ROUNDS4(16, vsha1pq_u32, 0xca62c1d6);
+      SHA1_ROUNDS4(17, vsha1pq_u32, 0xca62c1d6);
+      SHA1_ROUNDS4(18, vsha1pq_u32, 0xca62c1d6);
+      SHA1_ROUNDS4(19, vsha1pq_u32, 0xca62c1d6);
+
+      e0 += e;
+      abcd = vaddq_u32(abcd, abcd_save);
+   }
+
+   vst1q_u32(state, abcd);
+   state[4] = e0;
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file
+ * SHA-1 block function using the x86 SHA extensions, after the sample code
+ * in Intel's "New Instructions Supporting the Secure Hash Algorithm on
+ * Intel Architecture Processors".
+ *
+ * Each SHA1RNDS4 does four rounds, with the message words and E added up by
+ * SHA1NEXTE, and SHA1MSG1/SHA1MSG2 expand the message four words at a time.
+ */
+
+#include <stdint.h>
+#include <immintrin.h>
+
+#include "util/mesa-sha1.h"
+
+/* Four rounds, \p g being the index of the group of four */
+#define SHA1_ROUNDS4(g, f)                                                   \
+   do {                                                                      \
+      if ((g) < 4) {                                                         \
+         w[(g)] = _mm_shuffle_epi8(                                          \
+            _mm_loadu_si128((const __m128i *) (data + (g) * 16)), bswap);    \
+      } else {                                                               \
+         w[(g) % 4] = _mm_sha1msg2_epu32(                                    \
+            _mm_xor_si128(_mm_sha1msg1_epu32(w[(g) % 4], w[((g) + 1) % 4]),  \
+                          w[((g) + 2) % 4]),                                 \
+            w[((g) + 3) % 4]);                                               \
+      }                                                                      \
+      e = (g) == 0 ? _mm_add_epi32(e, w[0])                                  \
+                   : _mm_sha1nexte_epu32(prev_abcd, w[(g) % 4]);             \
+      prev_abcd = abcd;                                                      \
+      abcd = _mm_sha1rnds4_epu32(abcd, e, (f));                              \
+   } while (0)
+
+void
+_mesa_sha1_transform_blocks_sha_ni(uint32_t state[5], const uint8_t *data,
+                                   size_t num_blocks)
+{
+   /* Message words are big-endian */
+   const __m128i bswap = _mm_set_epi64x(0x0001020304050607ull,
+                                        0x08090a0b0c0d0e0full);
+   __m128i abcd, e0;
+
+   /* A in the top lane, and E in the top lane of its own register */
+   abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *) state), 0x1b);
+   e0 = _mm_set_epi32(state[4], 0, 0, 0);
+
+   for (; num_blocks; num_blocks--, data += SHA1_BLOCK_LENGTH) {
+      const __m128i abcd_save = abcd;
+      __m128i w[4], e = e0, prev_abcd = abcd;
+
+      SHA1_ROUNDS4(0, 0);
+      SHA1_ROUNDS4(1, 0);
+      SHA1_ROUNDS4(2, 0);
+      SHA1_ROUNDS4(3, 0);
+      SHA1_ROUNDS4(4, 0);
+      SHA1_ROUNDS4(5, 1);
+      SHA1_ROUNDS4(6, 1);
+      SHA1_ROUNDS4(7, 1);
+      SHA1_ROUNDS4(8, 1);
+      SHA1_ROUNDS4(9, 1);
+      SHA1_ROUNDS4(10, 2);
+      SHA1_ROUNDS4(11, 2);
+      SHA1_ROUNDS4(12, 2);
+      SHA1_ROUNDS4(13, 2);
+      SHA1_ROUNDS4(14, 2);
+      SHA1_ROUNDS4(15, 3);
+      SHA1_ROUNDS4(16, 3);
+      SHA1_ROUNDS4(17, 3);
+      SHA1_ROUNDS4(18, 3);
+      SHA1_ROUNDS4(19, 3);
+
+      e0 = _mm_sha1nexte_epu32(prev_abcd, e0);
+      abcd = _mm_add_epi32(abcd, abcd_save);
+   }
+
+   _mm_storeu_si128((__m128i *) state, _mm_shuffle_epi32(abcd, 0x1b));
+   state[4] = _mm_extract_epi32(e0, 3);
+}
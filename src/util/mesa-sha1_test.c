@@ -23,13 +23,45 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "macros.h"
 #include "mesa-sha1.h"
+#include "u_cpu_detect.h"
 
 #define SHA1_LENGTH 40
 
+/* Checks a block function against SHA1Transform() */
+static bool
+test_transform_blocks(const char *name,
+                      void (*transform_blocks)(uint32_t state[5],
+                                               const uint8_t *data,
+                                               size_t num_blocks))
+{
+   uint8_t data[16 * SHA1_BLOCK_LENGTH];
+   bool failed = false;
+
+   for (unsigned i = 0; i < sizeof(data); i++)
+      data[i] = rand();
+
+   for (unsigned n = 0; n <= 16; n++) {
+      uint32_t expected[5] = { 1, 2, 3, 4, 5 };
+      uint32_t state[5] = { 1, 2, 3, 4, 5 };
+
+      for (unsigned i = 0; i < n; i++)
+         SHA1Transform(expected, data + i * SHA1_BLOCK_LENGTH);
+      transform_blocks(state, data, n);
+
+      if (memcmp(state, expected, sizeof(state)) != 0) {
+         printf("%s differs from SHA1Transform for %u blocks\n", name, n);
+         failed = true;
+      }
+   }
+
+   return failed;
+}
+
 int main(int argc, char *argv[])
 {
    static const struct {
@@ -39,6 +71,11 @@ int main(int argc, char *argv[])
       {"Mesa Rocks! 273", "7fb99737373d65a73f049cdabc01e73aa6bc60f3"},
       {"Mesa Rocks! 300", "b2180263e37d3bed6a4be0afe41b1a82ebbcf4c3"},
       {"Mesa Rocks! 583", "7fb9734108a62503e8a149c1051facd7fb112d05"},
+      {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+       "84983e441c3bd26ebaae4aa1f95129e5e54670f1"},
+      {"abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmn"
+       "hijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu",
+       "a49b2446a02c645bf419f995b67091253a04a259"},
    };
 
    bool failed = false;
@@ -61,5 +98,17 @@ int main(int argc, char *argv[])
       }
    }
 
+   util_cpu_detect();
+#ifdef USE_SHA_NI
+   if (util_cpu_caps.has_sha1 && util_cpu_caps.has_sse4_1)
+      failed |= test_transform_blocks("SHA-NI",
+                                      _mesa_sha1_transform_blocks_sha_ni);
+#endif
+#ifdef USE_ARM_SHA1
+   if (util_cpu_caps.has_sha1)
+      failed |= test_transform_blocks("ARMv8 SHA1",
+                                      _mesa_sha1_transform_blocks_armv8);
+#endif
+
    return failed;
 }
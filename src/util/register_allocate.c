@@ -76,6 +76,7 @@
 #include "main/imports.h"
 #include "main/macros.h"
 #include "util/bitset.h"
+#include "util/u_math.h"
 #include "register_allocate.h"
 
 #define NO_REG ~0U
@@ -126,7 +127,6 @@ struct ra_node {
     * List of which nodes this node interferes with.  This should be
     * symmetric with the other node.
     */
-   BITSET_WORD *adjacency;
    unsigned int *adjacency_list;
    unsigned int adjacency_list_size;
    unsigned int adjacency_count;
@@ -167,6 +167,15 @@ struct ra_graph {
     * the variables that need register allocation.
     */
    struct ra_node *nodes;
+
+   /**
+    * Interference matrix, used to avoid duplicate entries in the adjacency
+    * lists.  Interference is symmetric and no node interferes with itself,
+    * so only the lower triangle is stored; see ra_adjacency_bit().  Since
+    * the rows of new nodes go at the end, growing the graph doesn't move the
+    * existing bits.
+    */
+   BITSET_WORD *adjacency;
    unsigned int count; /**< count of nodes. */
 
    unsigned int alloc; /**< count of nodes allocated. */
@@ -198,6 +207,25 @@ struct ra_graph {
        */
       unsigned int *min_q_node;
 
+      /**
+       * Bit-set indicating, for each BITSET_WORD of pq_test, if it may have
+       * a node that passes the pq test and isn't in the stack yet.  This lets
+       * ra_simplify() skip the words with nothing to push.
+       */
+      BITSET_WORD *pq_words;
+
+      /**
+       * Tournament tree over the min_q_node of each BITSET_WORD, with
+       * min_q_leaves leaves.  The root is the node ra_simplify() pushes when
+       * it has to color optimistically, so that it doesn't have to visit
+       * every word to find it.
+       */
+      unsigned int *min_q_tree;
+      unsigned int min_q_leaves;
+
+      /** Bit-set indicating which leaves of min_q_tree are out of date */
+      BITSET_WORD *min_q_stale;
+
       /**
        * Tracks the start of the set of optimistically-colored registers in the
        * stack.
@@ -417,11 +445,29 @@ ra_set_finalize(struct ra_regs *regs, unsigned int **q_values)
    }
 }
 
+/**
+ * Returns the index of the bit for the interference between n1 and n2 in
+ * ra_graph::adjacency.
+ */
+static inline uint64_t
+ra_adjacency_bit(unsigned int n1, unsigned int n2)
+{
+   assert(n1 != n2);
+   uint64_t k1 = MAX2(n1, n2);
+   uint64_t k2 = MIN2(n1, n2);
+   return k1 * (k1 - 1) / 2 + k2;
+}
+
+/** Number of bits in ra_graph::adjacency for a graph of count nodes. */
+static inline uint64_t
+ra_adjacency_bits(unsigned int count)
+{
+   return (uint64_t)count * (count - 1) / 2;
+}
+
 static void
 ra_add_node_adjacency(struct ra_graph *g, unsigned int n1, unsigned int n2)
 {
-   BITSET_SET(g->nodes[n1].adjacency, n2);
-
    assert(n1 != n2);
 
    int n1_class = g->nodes[n1].class;
@@ -443,21 +489,20 @@ ra_add_node_adjacency(struct ra_graph *g, unsigned int n1, unsigned int n2)
 static void
 ra_node_remove_adjacency(struct ra_graph *g, unsigned int n1, unsigned int n2)
 {
-   BITSET_CLEAR(g->nodes[n1].adjacency, n2);
-
    assert(n1 != n2);
 
    int n1_class = g->nodes[n1].class;
    int n2_class = g->nodes[n2].class;
    g->nodes[n1].q_total -= g->regs->classes[n1_class]->q[n2_class];
 
+   /* Nothing depends on the order of the adjacency list, so the last entry
+    * can take the place of the removed one.
+    */
+   unsigned int *list = g->nodes[n1].adjacency_list;
    unsigned int i;
    for (i = 0; i < g->nodes[n1].adjacency_count; i++) {
-      if (g->nodes[n1].adjacency_list[i] == n2) {
-         memmove(&g->nodes[n1].adjacency_list[i],
-                 &g->nodes[n1].adjacency_list[i + 1],
-                 (g->nodes[n1].adjacency_count - i - 1) *
-                 sizeof(g->nodes[n1].adjacency_list[0]));
+      if (list[i] == n2) {
+         list[i] = list[g->nodes[n1].adjacency_count - 1];
          break;
       }
    }
@@ -479,19 +524,18 @@ ra_realloc_interference_graph(struct ra_graph *g, unsigned int alloc)
 
    g->nodes = reralloc(g, g->nodes, struct ra_node, alloc);
 
-   unsigned g_bitset_count = BITSET_WORDS(g->alloc);
+   /* The rows of the nodes already in the graph don't move, so growing the
+    * interference matrix only has to zero the rows of the new nodes.
+    */
+   g->adjacency = rerzalloc(g, g->adjacency, BITSET_WORD,
+                            BITSET_WORDS(ra_adjacency_bits(g->alloc)),
+                            BITSET_WORDS(ra_adjacency_bits(alloc)));
+
    unsigned bitset_count = BITSET_WORDS(alloc);
-   /* For nodes already in the graph, we just have to grow the adjacency set */
-   for (unsigned i = 0; i < g->alloc; i++) {
-      assert(g->nodes[i].adjacency != NULL);
-      g->nodes[i].adjacency = rerzalloc(g, g->nodes[i].adjacency, BITSET_WORD,
-                                        g_bitset_count, bitset_count);
-   }
 
    /* For new nodes, we have to fully initialize them */
    for (unsigned i = g->alloc; i < alloc; i++) {
       memset(&g->nodes[i], 0, sizeof(g->nodes[i]));
-      g->nodes[i].adjacency = rzalloc_array(g, BITSET_WORD, bitset_count);
       g->nodes[i].adjacency_list_size = 4;
       g->nodes[i].adjacency_list =
          ralloc_array(g, unsigned int, g->nodes[i].adjacency_list_size);
@@ -515,6 +559,13 @@ ra_realloc_interference_graph(struct ra_graph *g, unsigned int alloc)
                                  bitset_count);
    g->tmp.min_q_node = reralloc(g, g->tmp.min_q_node, unsigned int,
                                 bitset_count);
+   g->tmp.pq_words = reralloc(g, g->tmp.pq_words, BITSET_WORD,
+                              BITSET_WORDS(bitset_count));
+   g->tmp.min_q_stale = reralloc(g, g->tmp.min_q_stale, BITSET_WORD,
+                                 BITSET_WORDS(bitset_count));
+   g->tmp.min_q_leaves = util_next_power_of_two(bitset_count);
+   g->tmp.min_q_tree = reralloc(g, g->tmp.min_q_tree, unsigned int,
+                                2 * g->tmp.min_q_leaves);
 
    g->alloc = alloc;
 }
@@ -580,7 +631,12 @@ ra_add_node_interference(struct ra_graph *g,
                          unsigned int n1, unsigned int n2)
 {
    assert(n1 < g->count && n2 < g->count);
-   if (n1 != n2 && !BITSET_TEST(g->nodes[n1].adjacency, n2)) {
+   if (n1 == n2)
+      return;
+
+   uint64_t bit = ra_adjacency_bit(n1, n2);
+   if (!BITSET_TEST(g->adjacency, bit)) {
+      BITSET_SET(g->adjacency, bit);
       ra_add_node_adjacency(g, n1, n2);
       ra_add_node_adjacency(g, n2, n1);
    }
@@ -589,12 +645,15 @@ ra_add_node_interference(struct ra_graph *g,
 void
 ra_reset_node_interference(struct ra_graph *g, unsigned int n)
 {
-   for (unsigned int i = 0; i < g->nodes[n].adjacency_count; i++)
-      ra_node_remove_adjacency(g, g->nodes[n].adjacency_list[i], n);
+   for (unsigned int i = 0; i < g->nodes[n].adjacency_count; i++) {
+      unsigned int n2 = g->nodes[n].adjacency_list[i];
+
+      ra_node_remove_adjacency(g, n2, n);
+      BITSET_CLEAR(g->adjacency, ra_adjacency_bit(n, n2));
+   }
 
-   memset(g->nodes[n].adjacency, 0,
-          BITSET_WORDS(g->count) * sizeof(BITSET_WORD));
    g->nodes[n].adjacency_count = 0;
+   g->nodes[n].q_total = 0;
 }
 
 static void
@@ -604,6 +663,7 @@ update_pq_info(struct ra_graph *g, unsigned int n)
    int n_class = g->nodes[n].class;
    if (g->nodes[n].tmp.q_total < g->regs->classes[n_class]->p) {
       BITSET_SET(g->tmp.pq_test, n);
+      BITSET_SET(g->tmp.pq_words, i);
    } else if (g->tmp.min_q_total[i] != UINT_MAX) {
       /* Only update min_q_total and min_q_node if min_q_total != UINT_MAX so
        * that we don't update while we have stale data and accidentally mark
@@ -616,6 +676,7 @@ update_pq_info(struct ra_graph *g, unsigned int n)
            n > g->tmp.min_q_node[i])) {
          g->tmp.min_q_total[i] = g->nodes[n].tmp.q_total;
          g->tmp.min_q_node[i] = n;
+         BITSET_SET(g->tmp.min_q_stale, i);
       }
    }
 }
@@ -646,6 +707,105 @@ add_node_to_stack(struct ra_graph *g, unsigned int n)
 
    /* Flag the min_q_total for n's block as dirty so it gets recalculated */
    g->tmp.min_q_total[n / BITSET_WORDBITS] = UINT_MAX;
+   BITSET_SET(g->tmp.min_q_stale, n / BITSET_WORDBITS);
+}
+
+/** Returns the highest bit of BITSET_WORD i that is a node of the graph. */
+static unsigned int
+ra_word_high_bit(struct ra_graph *g, unsigned int i)
+{
+   if (i == BITSET_WORDS(g->count) - 1)
+      return (g->count - 1) % BITSET_WORDBITS;
+   else
+      return BITSET_WORDBITS - 1;
+}
+
+/**
+ * Returns the better node to push optimistically of n1 and n2, which may be
+ * UINT_MAX for none: the one with the lowest q total or, to stay consistent
+ * with the old naive implementation, the highest node index.
+ */
+static unsigned int
+ra_min_q_node(struct ra_graph *g, unsigned int n1, unsigned int n2)
+{
+   if (n1 == UINT_MAX)
+      return n2;
+   if (n2 == UINT_MAX)
+      return n1;
+
+   unsigned int q1 = g->nodes[n1].tmp.q_total;
+   unsigned int q2 = g->nodes[n2].tmp.q_total;
+   if (q1 != q2)
+      return q1 < q2 ? n1 : n2;
+   else
+      return MAX2(n1, n2);
+}
+
+/**
+ * Returns the node with the lowest q total that isn't in the stack or
+ * pre-assigned, or UINT_MAX if there is none.
+ *
+ * Only the words whose minimum changed since the last call are visited,
+ * along with their paths up min_q_tree.
+ */
+static unsigned int
+ra_find_min_q_node(struct ra_graph *g)
+{
+   unsigned int *tree = g->tmp.min_q_tree;
+   BITSET_WORD tmp;
+   int i;
+
+   if (g->count == 0)
+      return UINT_MAX;
+
+   BITSET_FOREACH_SET(i, tmp, g->tmp.min_q_stale, BITSET_WORDS(g->count)) {
+      if (g->tmp.min_q_total[i] == UINT_MAX) {
+         /* The min_q_total and min_q_node are dirty because we added one of
+          * these nodes to the stack.  It needs to be recalculated.
+          */
+         BITSET_WORD skip = g->tmp.in_stack[i] | g->tmp.reg_assigned[i];
+
+         g->tmp.min_q_node[i] = UINT_MAX;
+         for (int j = ra_word_high_bit(g, i); j >= 0; j--) {
+            if (skip & BITSET_BIT(j))
+               continue;
+
+            unsigned int n = i * BITSET_WORDBITS + j;
+            if (g->nodes[n].tmp.q_total < g->tmp.min_q_total[i]) {
+               g->tmp.min_q_total[i] = g->nodes[n].tmp.q_total;
+               g->tmp.min_q_node[i] = n;
+            }
+         }
+      }
+
+      unsigned int t = g->tmp.min_q_leaves + i;
+      tree[t] = g->tmp.min_q_node[i];
+      for (t /= 2; t > 0; t /= 2)
+         tree[t] = ra_min_q_node(g, tree[2 * t], tree[2 * t + 1]);
+   }
+   memset(g->tmp.min_q_stale, 0,
+          BITSET_WORDS(BITSET_WORDS(g->count)) * sizeof(BITSET_WORD));
+
+   return tree[1];
+}
+
+/**
+ * Returns the highest BITSET_WORD at or below i which may have nodes to
+ * push, or -1 if there is none.
+ */
+static int
+ra_prev_pq_word(struct ra_graph *g, int i)
+{
+   while (i >= 0) {
+      BITSET_WORD bits = g->tmp.pq_words[BITSET_BITWORD(i)] &
+                         (~(BITSET_WORD)0 >> (31 - i % BITSET_WORDBITS));
+      if (bits)
+         return BITSET_BITWORD(i) * BITSET_WORDBITS + util_last_bit(bits) - 1;
+
+      i = (int)(BITSET_BITWORD(i) * BITSET_WORDBITS) - 1;
+   }
+
+   return -1;
 }
 
 /**
@@ -668,10 +828,14 @@ ra_simplify(struct ra_graph *g)
     * over BITSET_WORDs.
     */
    const unsigned int top_word_high_bit = (g->count - 1) % BITSET_WORDBITS;
+   const unsigned int num_words = BITSET_WORDS(g->count);
 
    /* Do a quick pre-pass to set things up */
    g->tmp.stack_count = 0;
-   for (int i = BITSET_WORDS(g->count) - 1, high_bit = top_word_high_bit;
+   memset(g->tmp.pq_words, 0, BITSET_WORDS(num_words) * sizeof(BITSET_WORD));
+   for (unsigned int t = 0; t < 2 * g->tmp.min_q_leaves; t++)
+      g->tmp.min_q_tree[t] = UINT_MAX;
+   for (int i = num_words - 1, high_bit = top_word_high_bit;
         i >= 0; i--, high_bit = BITSET_WORDBITS - 1) {
       g->tmp.in_stack[i] = 0;
       g->tmp.reg_assigned[i] = 0;
@@ -687,67 +851,46 @@ ra_simplify(struct ra_graph *g)
          update_pq_info(g, n);
       }
    }
+   memset(g->tmp.min_q_stale, ~0, BITSET_WORDS(num_words) * sizeof(BITSET_WORD));
 
    while (progress) {
-      unsigned int min_q_total = UINT_MAX;
-      unsigned int min_q_node = UINT_MAX;
-
       progress = false;
 
-      for (int i = BITSET_WORDS(g->count) - 1, high_bit = top_word_high_bit;
-           i >= 0; i--, high_bit = BITSET_WORDBITS - 1) {
-         BITSET_WORD mask = ~(BITSET_WORD)0 >> (31 - high_bit);
-
+      /* Visit the words from the top down, pushing every node that passes
+       * the pq test.  Pushing a node may make nodes in words we've already
+       * visited pass the test; they get pushed in the next round.
+       */
+      for (int i = ra_prev_pq_word(g, num_words - 1); i >= 0;
+           i = ra_prev_pq_word(g, i - 1)) {
          BITSET_WORD skip = g->tmp.in_stack[i] | g->tmp.reg_assigned[i];
-         if (skip == mask)
-            continue;
-
          BITSET_WORD pq = g->tmp.pq_test[i] & ~skip;
-         if (pq) {
-            /* In this case, we have stuff we can immediately take off the
-             * stack.  This also means that we're guaranteed to make progress
-             * and we don't need to bother updating lowest_q_total because we
-             * know we're going to loop again before attempting to do anything
-             * optimistic.
-             */
-            for (int j = high_bit; j >= 0; j--) {
-               if (pq & BITSET_BIT(j)) {
-                  unsigned int n = i * BITSET_WORDBITS + j;
-                  assert(n < g->count);
-                  add_node_to_stack(g, n);
-                  /* add_node_to_stack() may update pq_test for this word so
-                   * we need to update our local copy.
-                   */
-                  pq = g->tmp.pq_test[i] & ~skip;
-                  progress = true;
-               }
-            }
-         } else if (!progress) {
-            if (g->tmp.min_q_total[i] == UINT_MAX) {
-               /* The min_q_total and min_q_node are dirty because we added
-                * one of these nodes to the stack.  It needs to be
-                * recalculated.
+
+         for (int j = ra_word_high_bit(g, i); j >= 0 && pq; j--) {
+            if (pq & BITSET_BIT(j)) {
+               unsigned int n = i * BITSET_WORDBITS + j;
+               assert(n < g->count);
+               add_node_to_stack(g, n);
+               /* add_node_to_stack() may update pq_test for this word so
+                * we need to update our local copy.
                 */
-               for (int j = high_bit; j >= 0; j--) {
-                  if (skip & BITSET_BIT(j))
-                     continue;
-
-                  unsigned int n = i * BITSET_WORDBITS + j;
-                  assert(n < g->count);
-                  if (g->nodes[n].tmp.q_total < g->tmp.min_q_total[i]) {
-                     g->tmp.min_q_total[i] = g->nodes[n].tmp.q_total;
-                     g->tmp.min_q_node[i] = n;
-                  }
-               }
-            }
-            if (g->tmp.min_q_total[i] < min_q_total) {
-               min_q_node = g->tmp.min_q_node[i];
-               min_q_total = g->tmp.min_q_total[i];
+               pq = g->tmp.pq_test[i] & ~skip;
+               progress = true;
             }
          }
+
+         skip = g->tmp.in_stack[i] | g->tmp.reg_assigned[i];
+         if (!(g->tmp.pq_test[i] & ~skip))
+            BITSET_CLEAR(g->tmp.pq_words, i);
       }
 
-      if (!progress && min_q_total != UINT_MAX) {
+      /* If nothing can be trivially colored, push the node that is most
+       * likely to be colored anyway and try again.
+       */
+      if (!progress) {
+         unsigned int min_q_node = ra_find_min_q_node(g);
+         if (min_q_node == UINT_MAX)
+            break;
+
          if (stack_optimistic_start == UINT_MAX)
             stack_optimistic_start = g->tmp.stack_count;
 
@@ -759,28 +902,12 @@ ra_simplify(struct ra_graph *g)
    g->tmp.stack_optimistic_start = stack_optimistic_start;
 }
 
-static bool
-ra_any_neighbors_conflict(struct ra_graph *g, unsigned int n, unsigned int r)
-{
-   unsigned int i;
-
-   for (i = 0; i < g->nodes[n].adjacency_count; i++) {
-      unsigned int n2 = g->nodes[n].adjacency_list[i];
-
-      if (!BITSET_TEST(g->tmp.in_stack, n2) &&
-          BITSET_TEST(g->regs->regs[r].conflicts, g->nodes[n2].reg)) {
-         return true;
-      }
-   }
-
-   return false;
-}
-
 /* Computes a bitfield of what regs are available for a given register
  * selection.
  *
  * This lets drivers implement a more complicated policy than our simple first
- * or round robin policies (which don't require knowing the whole bitset)
+ * or round robin policies.  It is also how those policies find a register:
+ * one pass over the neighbors, instead of one per candidate register.
  */
 static bool
 ra_compute_available_regs(struct ra_graph *g, unsigned int n, BITSET_WORD *regs)
@@ -811,6 +938,31 @@ ra_compute_available_regs(struct ra_graph *g, unsigned int n, BITSET_WORD *regs)
    return false;
 }
 
+/**
+ * Returns the first register set in regs, searching upwards from start and
+ * wrapping around, or NO_REG if regs is empty.
+ */
+static unsigned int
+ra_find_first_reg(const BITSET_WORD *regs, unsigned int count,
+                  unsigned int start)
+{
+   for (unsigned int i = start; i < count; ) {
+      BITSET_WORD bits = regs[BITSET_BITWORD(i)] >> (i % BITSET_WORDBITS);
+
+      if (bits)
+         return i + ffs(bits) - 1;
+
+      i = ALIGN(i + 1, BITSET_WORDBITS);
+   }
+
+   for (unsigned int i = 0; i < BITSET_WORDS(MIN2(start, count)); i++) {
+      if (regs[i])
+         return i * BITSET_WORDBITS + ffs(regs[i]) - 1;
+   }
+
+   return NO_REG;
+}
+
 /**
  * Pops nodes from the stack back into the graph, coloring them with
  * registers as they go.
@@ -822,44 +974,30 @@ static bool
 ra_select(struct ra_graph *g)
 {
    int start_search_reg = 0;
-   BITSET_WORD *select_regs = NULL;
-
-   if (g->select_reg_callback)
-      select_regs = malloc(BITSET_WORDS(g->regs->count) * sizeof(BITSET_WORD));
+   BITSET_WORD *select_regs =
+      malloc(BITSET_WORDS(g->regs->count) * sizeof(BITSET_WORD));
 
    while (g->tmp.stack_count != 0) {
-      unsigned int ri;
-      unsigned int r = -1;
+      unsigned int r;
       int n = g->tmp.stack[g->tmp.stack_count - 1];
-      struct ra_class *c = g->regs->classes[g->nodes[n].class];
 
       /* set this to false even if we return here so that
        * ra_get_best_spill_node() considers this node later.
        */
       BITSET_CLEAR(g->tmp.in_stack, n);
 
-      if (g->select_reg_callback) {
-         if (!ra_compute_available_regs(g, n, select_regs)) {
-            free(select_regs);
-            return false;
-         }
+      if (!ra_compute_available_regs(g, n, select_regs)) {
+         free(select_regs);
+         return false;
+      }
 
+      if (g->select_reg_callback) {
          r = g->select_reg_callback(g, select_regs, g->select_reg_callback_data);
       } else {
          /* Find the lowest-numbered reg which is not used by a member
           * of the graph adjacent to us.
           */
-         for (ri = 0; ri < g->regs->count; ri++) {
-            r = (start_search_reg + ri) % g->regs->count;
-            if (!reg_belongs_to_class(r, c))
-               continue;
-
-            if (!ra_any_neighbors_conflict(g, n, r))
-               break;
-         }
-
-         if (ri >= g->regs->count)
-            return false;
+         r = ra_find_first_reg(select_regs, g->regs->count, start_search_reg);
       }
 
       g->nodes[n].reg = r;
@@ -922,23 +1060,15 @@ ra_set_node_reg(struct ra_graph *g, unsigned int n, unsigned int reg)
 static float
 ra_get_spill_benefit(struct ra_graph *g, unsigned int n)
 {
-   unsigned int j;
-   float benefit = 0;
-   int n_class = g->nodes[n].class;
+   struct ra_class *n_class = g->regs->classes[g->nodes[n].class];
 
    /* Define the benefit of eliminating an interference between n, n2
     * through spilling as q(C, B) / p(C).  This is similar to the
     * "count number of edges" approach of traditional graph coloring,
-    * but takes classes into account.
+    * but takes classes into account.  Summed over all the neighbors, that is
+    * q_total / p(C).
     */
-   for (j = 0; j < g->nodes[n].adjacency_count; j++) {
-      unsigned int n2 = g->nodes[n].adjacency_list[j];
-      unsigned int n2_class = g->nodes[n2].class;
-      benefit += ((float)g->regs->classes[n_class]->q[n2_class] /
-                  g->regs->classes[n_class]->p);
-   }
-
-   return benefit;
+   return (float)g->nodes[n].q_total / n_class->p;
 }
 
 /**
@@ -0,0 +1,286 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "util/ralloc.h"
+#include "util/register_allocate.h"
+
+namespace {
+
+/* A register file of NUM_BASE_REGS registers, and a class of register pairs
+ * starting at every base register but the last one.
+ */
+#define NUM_BASE_REGS 16
+
+class ra_test : public ::testing::Test {
+protected:
+   ra_test();
+   ~ra_test();
+
+   unsigned pair_reg(unsigned base) const { return NUM_BASE_REGS + base; }
+   unsigned first_base_reg(unsigned reg) const;
+   unsigned num_base_regs(unsigned reg) const;
+   bool regs_conflict(unsigned r1, unsigned r2) const;
+
+   void build_random_graph(unsigned count, unsigned max_length,
+                           unsigned seed);
+   void check_allocation() const;
+
+   struct ra_regs *regs;
+   unsigned single_class;
+   unsigned pair_class;
+
+   struct ra_graph *g;
+   std::vector<std::pair<unsigned, unsigned> > edges;
+};
+
+ra_test::ra_test()
+   : g(NULL)
+{
+   regs = ra_alloc_reg_set(NULL, 2 * NUM_BASE_REGS - 1, true);
+   single_class = ra_alloc_reg_class(regs);
+   pair_class = ra_alloc_reg_class(regs);
+
+   for (unsigned i = 0; i < NUM_BASE_REGS; i++)
+      ra_class_add_reg(regs, single_class, i);
+
+   for (unsigned i = 0; i < NUM_BASE_REGS - 1; i++) {
+      ra_class_add_reg(regs, pair_class, pair_reg(i));
+      ra_add_transitive_reg_conflict(regs, i, pair_reg(i));
+      ra_add_transitive_reg_conflict(regs, i + 1, pair_reg(i));
+   }
+
+   ra_set_finalize(regs, NULL);
+}
+
+ra_test::~ra_test()
+{
+   ralloc_free(g);
+   ralloc_free(regs);
+}
+
+unsigned
+ra_test::first_base_reg(unsigned reg) const
+{
+   return reg < NUM_BASE_REGS ? reg : reg - NUM_BASE_REGS;
+}
+
+unsigned
+ra_test::num_base_regs(unsigned reg) const
+{
+   return reg < NUM_BASE_REGS ? 1 : 2;
+}
+
+bool
+ra_test::regs_conflict(unsigned r1, unsigned r2) const
+{
+   unsigned b1 = first_base_reg(r1), b2 = first_base_reg(r2);
+
+   return b1 < b2 + num_base_regs(r2) && b2 < b1 + num_base_regs(r1);
+}
+
+/**
+ * Builds a graph of nodes with random classes and live ranges of up to
+ * max_length, interfering when their live ranges overlap.
+ */
+void
+ra_test::build_random_graph(unsigned count, unsigned max_length,
+                            unsigned seed)
+{
+   std::vector<unsigned> start(count), end(count);
+
+   srand(seed);
+
+   g = ra_alloc_interference_graph(regs, count);
+   for (unsigned n = 0; n < count; n++) {
+      ra_set_node_class(g, n, rand() % 3 == 0 ? pair_class : single_class);
+      ra_set_node_spill_cost(g, n, 1 + rand() % 10);
+      start[n] = rand() % (2 * count);
+      end[n] = start[n] + 1 + rand() % max_length;
+   }
+
+   for (unsigned n1 = 0; n1 < count; n1++) {
+      for (unsigned n2 = 0; n2 < n1; n2++) {
+         if (start[n1] < end[n2] && start[n2] < end[n1]) {
+            ra_add_node_interference(g, n1, n2);
+            edges.push_back(std::make_pair(n1, n2));
+         }
+      }
+   }
+}
+
+void
+ra_test::check_allocation() const
+{
+   for (unsigned i = 0; i < edges.size(); i++) {
+      unsigned r1 = ra_get_node_reg(g, edges[i].first);
+      unsigned r2 = ra_get_node_reg(g, edges[i].second);
+
+      EXPECT_FALSE(regs_conflict(r1, r2))
+         << "nodes " << edges[i].first << " and " << edges[i].second
+         << " got conflicting registers " << r1 << " and " << r2;
+   }
+}
+
+} /* anonymous namespace */
+
+TEST_F(ra_test, clique)
+{
+   /* Every node interferes with every other, and there are exactly enough
+    * registers, so every node is trivially colorable until the end.
+    */
+   g = ra_alloc_interference_graph(regs, NUM_BASE_REGS);
+   for (unsigned n1 = 0; n1 < NUM_BASE_REGS; n1++) {
+      ra_set_node_class(g, n1, single_class);
+      for (unsigned n2 = 0; n2 < n1; n2++) {
+         ra_add_node_interference(g, n1, n2);
+         /* Adding an interference twice must not count it twice. */
+         ra_add_node_interference(g, n2, n1);
+         edges.push_back(std::make_pair(n1, n2));
+      }
+   }
+
+   ASSERT_TRUE(ra_allocate(g));
+   check_allocation();
+
+   /* The allocator prefers low registers. */
+   for (unsigned n = 0; n < NUM_BASE_REGS; n++)
+      EXPECT_LT(ra_get_node_reg(g, n), (unsigned)NUM_BASE_REGS);
+}
+
+TEST_F(ra_test, forced_reg)
+{
+   g = ra_alloc_interference_graph(regs, 3);
+   ra_set_node_class(g, 0, pair_class);
+   ra_set_node_class(g, 1, single_class);
+   ra_set_node_class(g, 2, single_class);
+   ra_set_node_reg(g, 1, 0);
+   ra_add_node_interference(g, 0, 1);
+   ra_add_node_interference(g, 1, 2);
+   edges.push_back(std::make_pair(0u, 1u));
+   edges.push_back(std::make_pair(1u, 2u));
+
+   ASSERT_TRUE(ra_allocate(g));
+   check_allocation();
+   EXPECT_EQ(ra_get_node_reg(g, 1), 0u);
+   EXPECT_EQ(ra_get_node_reg(g, 0), pair_reg(1));
+   EXPECT_EQ(ra_get_node_reg(g, 2), 1u);
+}
+
+TEST_F(ra_test, random_graphs)
+{
+   for (unsigned seed = 0; seed < 20; seed++) {
+      build_random_graph(200, 2 * NUM_BASE_REGS, seed);
+
+      if (ra_allocate(g))
+         check_allocation();
+
+      ralloc_free(g);
+      g = NULL;
+      edges.clear();
+   }
+}
+
+TEST_F(ra_test, round_robin)
+{
+   ra_set_allocate_round_robin(regs);
+   build_random_graph(100, NUM_BASE_REGS / 2, 1);
+
+   ASSERT_TRUE(ra_allocate(g));
+   check_allocation();
+}
+
+/**
+ * Spills like the i965 backend does: the spilled node loses its
+ * interference, and new short-lived nodes are added to the same graph.
+ */
+TEST_F(ra_test, spill_incrementally)
+{
+   build_random_graph(400, 2 * NUM_BASE_REGS, 42);
+
+   unsigned spills = 0;
+   while (!ra_allocate(g)) {
+      int n = ra_get_best_spill_node(g);
+      ASSERT_GE(n, 0);
+
+      ra_reset_node_interference(g, n);
+      ra_set_node_spill_cost(g, n, 0);
+
+      std::vector<std::pair<unsigned, unsigned> > kept;
+      for (unsigned i = 0; i < edges.size(); i++) {
+         if (edges[i].first != (unsigned)n && edges[i].second != (unsigned)n)
+            kept.push_back(edges[i]);
+      }
+      edges.swap(kept);
+
+      /* The fill of the spilled value interferes with one other node. */
+      unsigned fill = ra_add_node(g, single_class);
+      unsigned other = (n + 1) % 400;
+      ra_add_node_interference(g, fill, other);
+      edges.push_back(std::make_pair(fill, other));
+
+      ASSERT_LT(++spills, 400u);
+   }
+
+   EXPECT_GT(spills, 0u);
+   check_allocation();
+}
+
+static unsigned
+select_highest_reg(struct ra_graph *g, BITSET_WORD *regs, void *data)
+{
+   int *calls = (int *)data;
+   int highest = -1;
+
+   for (unsigned r = 0; r < 2 * NUM_BASE_REGS - 1; r++) {
+      if (BITSET_TEST(regs, r))
+         highest = r;
+   }
+
+   (*calls)++;
+   return highest;
+}
+
+TEST_F(ra_test, select_callback)
+{
+   int calls = 0;
+
+   g = ra_alloc_interference_graph(regs, 2);
+   ra_set_node_class(g, 0, single_class);
+   ra_set_node_class(g, 1, pair_class);
+   ra_add_node_interference(g, 0, 1);
+   edges.push_back(std::make_pair(0u, 1u));
+   ra_set_select_reg_callback(g, select_highest_reg, &calls);
+
+   ASSERT_TRUE(ra_allocate(g));
+   check_allocation();
+   EXPECT_EQ(calls, 2);
+
+   /* Node 0 is colored first, with the highest register, and node 1 gets
+    * the highest pair that doesn't overlap it.
+    */
+   EXPECT_EQ(ra_get_node_reg(g, 0), (unsigned)NUM_BASE_REGS - 1);
+   EXPECT_EQ(ra_get_node_reg(g, 1), pair_reg(NUM_BASE_REGS - 3));
+}
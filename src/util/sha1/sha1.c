@@ -124,15 +124,16 @@ SHA1Init(SHA1_CTX *context)
 void
 SHA1Update(SHA1_CTX *context, const uint8_t *data, size_t len)
 {
-	size_t i, j;
+	size_t i, j, n;
 
 	j = (size_t)((context->count >> 3) & 63);
 	context->count += (len << 3);
 	if ((j + len) > 63) {
 		(void)memcpy(&context->buffer[j], data, (i = 64-j));
-		SHA1Transform(context->state, context->buffer);
-		for ( ; i + 63 < len; i += 64)
-			SHA1Transform(context->state, (uint8_t *)&data[i]);
+		_mesa_sha1_transform_blocks(context->state, context->buffer, 1);
+		n = (len - i) / 64;
+		_mesa_sha1_transform_blocks(context->state, &data[i], n);
+		i += n * 64;
 		j = 0;
 	} else {
 		i = 0;
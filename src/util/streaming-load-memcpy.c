@@ -0,0 +1,110 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * @file
+ * Picks the streaming-load copy for the CPU, and splits large copies across
+ * a few threads: a single core can't saturate the bandwidth of uncached
+ * reads.
+ */
+
+#include <string.h>
+
+#include "c11/threads.h"
+#include "util/macros.h"
+#include "util/streaming-load-memcpy.h"
+#include "util/u_cpu_detect.h"
+#include "util/u_parallel_rows.h"
+
+/**
+ * Large copies are split across threads in bands of pages, each band having
+ * at least this many bytes, so copies of 4 MiB or more are split.  Bands
+ * starting on page boundaries keep dst and src as co-aligned as they were.
+ */
+#define STREAMING_COPY_PAGE_SIZE 4096
+#define STREAMING_COPY_BAND_MIN_BYTES (2 * 1024 * 1024)
+
+typedef void (*streaming_copy_func)(void *restrict dst,
+                                    const void *restrict src, size_t len);
+
+struct streaming_copy_job {
+   void *dst;
+   const void *src;
+   size_t len;
+};
+
+static streaming_copy_func streaming_copy;
+static once_flag streaming_copy_once = ONCE_FLAG_INIT;
+
+static void
+plain_memcpy(void *restrict dst, const void *restrict src, size_t len)
+{
+   memcpy(dst, src, len);
+}
+
+static void
+streaming_copy_init(void)
+{
+   util_cpu_detect();
+
+   streaming_copy = plain_memcpy;
+#ifdef USE_SSE41
+   if (util_cpu_caps.has_sse4_1)
+      streaming_copy = util_streaming_load_memcpy_sse41;
+#endif
+#ifdef USE_AVX2
+   if (util_cpu_caps.has_avx2)
+      streaming_copy = util_streaming_load_memcpy_avx2;
+#endif
+}
+
+static void
+streaming_copy_band(void *data, unsigned start, unsigned end)
+{
+   const struct streaming_copy_job *job = data;
+   const size_t offset = (size_t) start * STREAMING_COPY_PAGE_SIZE;
+   const size_t len = MIN2((size_t) end * STREAMING_COPY_PAGE_SIZE,
+                           job->len) - offset;
+
+   streaming_copy((char *) job->dst + offset,
+                  (const char *) job->src + offset, len);
+}
+
+void
+util_streaming_load_memcpy(void *restrict dst, const void *restrict src,
+                           size_t len)
+{
+   call_once(&streaming_copy_once, streaming_copy_init);
+
+   /* Only streaming loads gain from more threads */
+   if (streaming_copy == plain_memcpy) {
+      streaming_copy(dst, src, len);
+      return;
+   }
+
+   struct streaming_copy_job job = { dst, src, len };
+
+   util_parallel_rows(DIV_ROUND_UP(len, STREAMING_COPY_PAGE_SIZE),
+                      STREAMING_COPY_BAND_MIN_BYTES / STREAMING_COPY_PAGE_SIZE,
+                      streaming_copy_band, &job);
+}
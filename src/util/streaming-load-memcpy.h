@@ -26,14 +26,36 @@
  *
  */
 
-/* Copies memory from src to dst, using SSE 4.1's MOVNTDQA to get streaming
- * read performance from uncached memory.
+/* Copies memory from src to dst, using streaming loads (SSE 4.1's MOVNTDQA
+ * or its AVX2 version) to get streaming read performance from uncached or
+ * write-combined memory.  Large copies are split across several threads.
+ *
+ * Falls back to memcpy() when the CPU has no streaming loads or when dst and
+ * src are not co-aligned.
  */
 
 #ifndef STREAMING_LOAD_MEMCPY_H
 #define STREAMING_LOAD_MEMCPY_H
 
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void
+util_streaming_load_memcpy(void *dst, const void *src, size_t len);
+
+/* The single-threaded copies for each instruction set, which expect the CPU
+ * to support it.
+ */
 void
-_mesa_streaming_load_memcpy(void *restrict dst, void *restrict src, size_t len);
+util_streaming_load_memcpy_sse41(void *dst, const void *src, size_t len);
+void
+util_streaming_load_memcpy_avx2(void *dst, const void *src, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif /* STREAMING_LOAD_MEMCPY_H */
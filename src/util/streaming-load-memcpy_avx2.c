@@ -0,0 +1,91 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <immintrin.h>
+
+#include "util/macros.h"
+#include "util/streaming-load-memcpy.h"
+
+/* Copies memory from src to dst, using AVX2's 32-byte VMOVNTDQA to get
+ * streaming read performance from uncached memory.
+ */
+void
+util_streaming_load_memcpy_avx2(void *restrict dst, const void *restrict src,
+                                size_t len)
+{
+   char *restrict d = dst;
+   const char *restrict s = src;
+
+   /* The 16-byte loads still stream when dst and src are only co-aligned
+    * that much.
+    */
+   if (((uintptr_t)d & 31) != ((uintptr_t)s & 31)) {
+      util_streaming_load_memcpy_sse41(d, s, len);
+      return;
+   }
+
+   if ((uintptr_t)d & 31) {
+      const size_t header = MIN2(32 - ((uintptr_t)d & 31), len);
+
+      memcpy(d, s, header);
+      d += header;
+      s += header;
+      len -= header;
+   }
+
+   if (len >= 32)
+      _mm_mfence();
+
+   /* Two cachelines at a time, to keep more loads in flight */
+   while (len >= 128) {
+      __m256i *dst_cacheline = (__m256i *)d;
+      __m256i *src_cacheline = (__m256i *)s;
+
+      __m256i temp1 = _mm256_stream_load_si256(src_cacheline + 0);
+      __m256i temp2 = _mm256_stream_load_si256(src_cacheline + 1);
+      __m256i temp3 = _mm256_stream_load_si256(src_cacheline + 2);
+      __m256i temp4 = _mm256_stream_load_si256(src_cacheline + 3);
+
+      _mm256_store_si256(dst_cacheline + 0, temp1);
+      _mm256_store_si256(dst_cacheline + 1, temp2);
+      _mm256_store_si256(dst_cacheline + 2, temp3);
+      _mm256_store_si256(dst_cacheline + 3, temp4);
+
+      d += 128;
+      s += 128;
+      len -= 128;
+   }
+
+   while (len >= 32) {
+      _mm256_store_si256((__m256i *)d, _mm256_stream_load_si256((__m256i *)s));
+      d += 32;
+      s += 32;
+      len -= 32;
+   }
+
+   /* memcpy() the tail. */
+   if (len)
+      memcpy(d, s, len);
+}
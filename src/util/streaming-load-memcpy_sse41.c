@@ -26,18 +26,23 @@
  *
  */
 
-#include "main/macros.h"
-#include "main/streaming-load-memcpy.h"
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
 #include <smmintrin.h>
 
+#include "util/macros.h"
+#include "util/streaming-load-memcpy.h"
+
 /* Copies memory from src to dst, using SSE 4.1's MOVNTDQA to get streaming
  * read performance from uncached memory.
  */
 void
-_mesa_streaming_load_memcpy(void *restrict dst, void *restrict src, size_t len)
+util_streaming_load_memcpy_sse41(void *restrict dst, const void *restrict src,
+                                 size_t len)
 {
    char *restrict d = dst;
-   char *restrict s = src;
+   const char *restrict s = src;
 
    /* If dst and src are not co-aligned, fallback to memcpy(). */
    if (((uintptr_t)d & 15) != ((uintptr_t)s & 15)) {
@@ -54,8 +59,8 @@ _mesa_streaming_load_memcpy(void *restrict dst, void *restrict src, size_t len)
 
       memcpy(d, s, MIN2(bytes_before_alignment_boundary, len));
 
-      d = (char *)ALIGN((uintptr_t)d, 16);
-      s = (char *)ALIGN((uintptr_t)s, 16);
+      d = (char *)ALIGN_POT((uintptr_t)d, 16);
+      s = (const char *)ALIGN_POT((uintptr_t)s, 16);
       len -= MIN2(bytes_before_alignment_boundary, len);
    }
 
@@ -0,0 +1,207 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * Checks util_streaming_load_memcpy() and the variants for each instruction
+ * set against memcpy(), for all small alignments and lengths.
+ *
+ * With --bench, prints the copy throughput instead.  Note that it reads
+ * cached memory, while the streaming loads only pay off on uncached or
+ * write-combined mappings.
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "macros.h"
+#include "os_time.h"
+#include "streaming-load-memcpy.h"
+#include "u_cpu_detect.h"
+
+typedef void (*copy_func)(void *dst, const void *src, size_t len);
+
+static void
+copy_memcpy(void *dst, const void *src, size_t len)
+{
+   memcpy(dst, src, len);
+}
+
+static bool
+always(void)
+{
+   return true;
+}
+
+#ifdef USE_SSE41
+static bool
+has_sse41(void)
+{
+   return util_cpu_caps.has_sse4_1;
+}
+#endif
+
+#ifdef USE_AVX2
+static bool
+has_avx2(void)
+{
+   return util_cpu_caps.has_avx2;
+}
+#endif
+
+static const struct {
+   const char *name;
+   copy_func copy;
+   bool (*supported)(void);
+} copies[] = {
+   { "memcpy", copy_memcpy, always },
+   { "streaming", util_streaming_load_memcpy, always },
+#ifdef USE_SSE41
+   { "sse4.1", util_streaming_load_memcpy_sse41, has_sse41 },
+#endif
+#ifdef USE_AVX2
+   { "avx2", util_streaming_load_memcpy_avx2, has_avx2 },
+#endif
+};
+
+#define GUARD 64
+
+static bool
+check_copy(const char *name, copy_func copy, size_t len,
+           unsigned dst_offset, unsigned src_offset)
+{
+   uint8_t *src = malloc(len + 2 * GUARD);
+   uint8_t *dst = malloc(len + 2 * GUARD);
+   uint8_t *expected = malloc(len + 2 * GUARD);
+   bool ok;
+
+   for (size_t i = 0; i < len + 2 * GUARD; i++) {
+      src[i] = i * 7 + len;
+      dst[i] = expected[i] = ~i;
+   }
+
+   memcpy(expected + GUARD + dst_offset, src + GUARD + src_offset, len);
+   copy(dst + GUARD + dst_offset, src + GUARD + src_offset, len);
+
+   ok = memcmp(dst, expected, len + 2 * GUARD) == 0;
+   if (!ok) {
+      printf("%s: copy of %zu bytes from offset %u to %u is wrong\n",
+             name, len, src_offset, dst_offset);
+   }
+
+   free(src);
+   free(dst);
+   free(expected);
+   return ok;
+}
+
+static void
+bench(void)
+{
+   static const size_t sizes[] = { 4096, 256 * 1024, 4 * 1024 * 1024,
+                                   64 * 1024 * 1024 };
+   uint8_t *src = malloc(sizes[ARRAY_SIZE(sizes) - 1] + 64);
+   uint8_t *dst = malloc(sizes[ARRAY_SIZE(sizes) - 1] + 64);
+
+   if (!src || !dst)
+      goto out;
+
+   memset(src, 1, sizes[ARRAY_SIZE(sizes) - 1] + 64);
+   memset(dst, 2, sizes[ARRAY_SIZE(sizes) - 1] + 64);
+
+   printf("%-10s", "size");
+   for (unsigned c = 0; c < ARRAY_SIZE(copies); c++)
+      printf(" %12s", copies[c].name);
+   printf("   (GB/s)\n");
+
+   for (unsigned s = 0; s < ARRAY_SIZE(sizes); s++) {
+      /* Roughly 1 GB copied per measurement */
+      const unsigned iterations = MAX2(1, (1 << 30) / sizes[s]);
+
+      printf("%-10zu", sizes[s]);
+      for (unsigned c = 0; c < ARRAY_SIZE(copies); c++) {
+         if (!copies[c].supported()) {
+            printf(" %12s", "-");
+            continue;
+         }
+
+         /* Same alignment for dst and src, as the streaming loads need */
+         copies[c].copy(dst + 16, src + 16, sizes[s]);
+
+         int64_t start = os_time_get_nano();
+         for (unsigned i = 0; i < iterations; i++)
+            copies[c].copy(dst + 16, src + 16, sizes[s]);
+         int64_t end = os_time_get_nano();
+
+         printf(" %12.2f", (double) sizes[s] * iterations / (end - start));
+      }
+      printf("\n");
+   }
+
+out:
+   free(src);
+   free(dst);
+}
+
+int main(int argc, char *argv[])
+{
+   bool failed = false;
+
+   util_cpu_detect();
+
+   if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+      bench();
+      return 0;
+   }
+
+   for (unsigned c = 0; c < ARRAY_SIZE(copies); c++) {
+      if (!copies[c].supported())
+         continue;
+
+      for (size_t len = 0; len <= 200; len++) {
+         for (unsigned dst_offset = 0; dst_offset < 36; dst_offset++) {
+            for (unsigned src_offset = 0; src_offset < 40; src_offset += 8) {
+               failed |= !check_copy(copies[c].name, copies[c].copy, len,
+                                     dst_offset,
+                                     (dst_offset + src_offset) % 40);
+            }
+         }
+      }
+   }
+
+   /* Copies large enough to be split across threads, with and without
+    * co-aligned pointers.
+    */
+   if (util_cpu_caps.nr_cpus < 2)
+      util_cpu_caps.nr_cpus = 2;
+
+   failed |= !check_copy("streaming", util_streaming_load_memcpy,
+                         5 * 1024 * 1024 + 129, 16, 16);
+   failed |= !check_copy("streaming", util_streaming_load_memcpy,
+                         5 * 1024 * 1024 + 129, 3, 35);
+   failed |= !check_copy("streaming", util_streaming_load_memcpy,
+                         17 * 1024 * 1024 + 7, 5, 13);
+
+   return failed;
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#undef NDEBUG
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "hash_table.h"
+#include "u_endian.h"
+
+int
+main(int argc, char **argv)
+{
+   static const char spam[] = "Nobody inspects the spammish repetition";
+   uint8_t buf[64 + 16];
+   uint32_t hashes[65];
+   unsigned i, j;
+
+   (void) argc;
+   (void) argv;
+
+   /* xxHash32 reference values.  The words of the key are read in host
+    * order, so a non-empty key only hashes the same on little endian hosts.
+    */
+   assert(_mesa_hash_data("", 0) == 0x02cc5d05);
+#ifdef PIPE_ARCH_LITTLE_ENDIAN
+   assert(_mesa_hash_data(spam, strlen(spam)) == 0xe2293b2f);
+#else
+   (void) spam;
+#endif
+
+   for (i = 0; i < sizeof(buf); i++)
+      buf[i] = i * 7 + 3;
+
+   /* Every length goes through a different mix of the 16-byte loop and the
+    * word and byte tails, and gives a different hash.
+    */
+   for (i = 0; i <= 64; i++) {
+      hashes[i] = _mesa_hash_data(buf, i);
+      for (j = 0; j < i; j++)
+         assert(hashes[i] != hashes[j]);
+   }
+
+   /* The hash doesn't depend on the alignment of the key */
+   for (i = 1; i < 16; i++) {
+      memmove(buf + i, buf + i - 1, 64);
+      for (j = 0; j <= 64; j++)
+         assert(_mesa_hash_data(buf + i, j) == hashes[j]);
+   }
+
+   /* Every byte of the key counts */
+   for (i = 0; i < 64; i++) {
+      buf[15 + i] ^= 0x10;
+      assert(_mesa_hash_data(buf + 15, 64) != hashes[64]);
+      buf[15 + i] ^= 0x10;
+   }
+
+   assert(_mesa_hash_data_with_seed(buf + 15, 64, 1) != hashes[64]);
+
+   return 0;
+}
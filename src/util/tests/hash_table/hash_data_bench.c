@@ -0,0 +1,90 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * Compares _mesa_hash_data() with byte-at-a-time FNV-1a on keys of the
+ * sizes seen in shader variant and state caches.
+ *
+ * Usage: hash_data_bench [-n iterations]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash_table.h"
+#include "macros.h"
+#include "os_time.h"
+
+static uint32_t
+hash_fnv1a(const void *data, size_t size)
+{
+   return _mesa_fnv32_1a_accumulate_block(_mesa_fnv32_1a_offset_bias,
+                                          data, size);
+}
+
+static double
+run(uint32_t (*hash)(const void *, size_t), const uint8_t *key, size_t size,
+    unsigned iterations)
+{
+   uint32_t sum = 0;
+
+   int64_t start = os_time_get_nano();
+   for (unsigned i = 0; i < iterations; i++)
+      sum += hash(key, size);
+   int64_t end = os_time_get_nano();
+
+   /* Keep the loop from being optimized out */
+   if (sum == 0x12345678)
+      printf(" ");
+
+   return (double) size * iterations / (end - start);
+}
+
+int
+main(int argc, char **argv)
+{
+   static const size_t sizes[] = { 4, 8, 16, 32, 64, 128, 256, 1024, 4096 };
+   unsigned iterations = 1000000;
+   uint8_t key[4096];
+
+   if (argc == 3 && strcmp(argv[1], "-n") == 0)
+      iterations = atoi(argv[2]);
+
+   for (unsigned i = 0; i < sizeof(key); i++)
+      key[i] = rand();
+
+   printf("%8s %14s %14s\n", "size", "FNV-1a GB/s", "hash_data GB/s");
+
+   for (unsigned i = 0; i < ARRAY_SIZE(sizes); i++) {
+      /* Same amount of data for every size */
+      const unsigned n = MAX2(iterations / (sizes[i] / 4), 1000);
+
+      printf("%8zu %14.2f %14.2f\n", sizes[i],
+             run(hash_fnv1a, key, sizes[i], n),
+             run(_mesa_hash_data, key, sizes[i], n));
+   }
+
+   return EXIT_SUCCESS;
+}
@@ -74,6 +74,7 @@ struct util_cpu_caps {
    unsigned has_vsx:1;
    unsigned has_daz:1;
    unsigned has_neon:1;
+   unsigned has_sha1:1;
 
    unsigned has_avx512f:1;
    unsigned has_avx512dq:1;
@@ -0,0 +1,104 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "c11/threads.h"
+#include "util/macros.h"
+#include "util/u_cpu_detect.h"
+#include "util/u_parallel_rows.h"
+#include "util/u_queue.h"
+
+struct parallel_rows_job {
+   util_parallel_rows_func func;
+   void *data;
+   unsigned start, end;
+   struct util_queue_fence fence;
+};
+
+static struct util_queue rows_queue;
+static bool rows_queue_initialized;
+static once_flag rows_queue_once = ONCE_FLAG_INIT;
+
+static void
+rows_queue_init(void)
+{
+   util_cpu_detect();
+
+   const unsigned num_threads = MIN2(util_cpu_caps.nr_cpus,
+                                     UTIL_PARALLEL_ROWS_MAX_BANDS);
+
+   /* The calling thread does one band itself */
+   if (num_threads > 1) {
+      rows_queue_initialized =
+         util_queue_init(&rows_queue, "rows", UTIL_PARALLEL_ROWS_MAX_BANDS,
+                         num_threads - 1, UTIL_QUEUE_INIT_RESIZE_IF_FULL);
+   }
+}
+
+static void
+parallel_rows_execute(void *data, int thread_index)
+{
+   struct parallel_rows_job *job = data;
+
+   job->func(job->data, job->start, job->end);
+}
+
+void
+util_parallel_rows(unsigned rows, unsigned min_rows,
+                   util_parallel_rows_func func, void *data)
+{
+   const unsigned max_bands = rows / MAX2(min_rows, 1);
+
+   if (max_bands >= 2)
+      call_once(&rows_queue_once, rows_queue_init);
+
+   if (max_bands < 2 || !rows_queue_initialized) {
+      func(data, 0, rows);
+      return;
+   }
+
+   struct parallel_rows_job jobs[UTIL_PARALLEL_ROWS_MAX_BANDS];
+   const unsigned num_bands = MIN3(rows_queue.num_threads + 1, max_bands,
+                                   UTIL_PARALLEL_ROWS_MAX_BANDS);
+   const unsigned band = DIV_ROUND_UP(rows, num_bands);
+   unsigned i, n = 0;
+
+   for (i = 0; i < num_bands && i * band < rows; i++, n++) {
+      jobs[i].func = func;
+      jobs[i].data = data;
+      jobs[i].start = i * band;
+      jobs[i].end = MIN2(rows, (i + 1) * band);
+
+      if (i > 0) {
+         util_queue_fence_init(&jobs[i].fence);
+         util_queue_add_job(&rows_queue, &jobs[i], &jobs[i].fence,
+                            parallel_rows_execute, NULL, 0);
+      }
+   }
+
+   func(data, jobs[0].start, jobs[0].end);
+
+   for (i = 1; i < n; i++) {
+      util_queue_fence_wait(&jobs[i].fence);
+      util_queue_fence_destroy(&jobs[i].fence);
+   }
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file
+ * Splits work on the rows of an image (or any other range) in bands handled
+ * in parallel by a shared pool of threads, the calling thread doing the
+ * first band itself.
+ */
+
+#ifndef U_PARALLEL_ROWS_H
+#define U_PARALLEL_ROWS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** The maximum number of bands, and of threads doing them. */
+#define UTIL_PARALLEL_ROWS_MAX_BANDS 8
+
+/** Handles the rows from start (inclusive) to end (exclusive). */
+typedef void (*util_parallel_rows_func)(void *data, unsigned start,
+                                        unsigned end);
+
+/**
+ * Calls \p func on bands covering rows 0 to \p rows, all of which have
+ * returned when this returns.  Bands have at least \p min_rows rows, so
+ * that each one is worth handing to another thread, and \p func is simply
+ * called for all the rows when there aren't enough of them to make two
+ * bands, or when there is a single CPU.
+ */
+void
+util_parallel_rows(unsigned rows, unsigned min_rows,
+                   util_parallel_rows_func func, void *data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* U_PARALLEL_ROWS_H */
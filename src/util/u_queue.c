@@ -288,6 +288,12 @@ util_queue_thread_func(void *input)
       cnd_signal(&queue->has_space_cond);
       mtx_unlock(&queue->lock);
 
+      /* The job it depends on is either running in another thread or in
+       * another queue, since it was queued before this one.
+       */
+      if (job.job && job.depends_on)
+         util_queue_fence_wait(job.depends_on);
+
       if (job.job) {
          job.execute(job.job, thread_index);
          util_queue_fence_signal(job.fence);
@@ -520,8 +526,23 @@ util_queue_add_job(struct util_queue *queue,
                    util_queue_execute_func execute,
                    util_queue_execute_func cleanup,
                    const size_t job_size)
+{
+   util_queue_add_job_ext(queue, job, fence, execute, cleanup, job_size,
+                          UTIL_QUEUE_PRIORITY_NORMAL, NULL);
+}
+
+void
+util_queue_add_job_ext(struct util_queue *queue,
+                       void *job,
+                       struct util_queue_fence *fence,
+                       util_queue_execute_func execute,
+                       util_queue_execute_func cleanup,
+                       const size_t job_size,
+                       enum util_queue_priority priority,
+                       struct util_queue_fence *depends_on)
 {
    struct util_queue_job *ptr;
+   unsigned idx;
 
    mtx_lock(&queue->lock);
    if (queue->num_threads == 0) {
@@ -571,13 +592,31 @@ util_queue_add_job(struct util_queue *queue,
       }
    }
 
-   ptr = &queue->jobs[queue->write_idx];
-   assert(ptr->job == NULL);
+   /* Keep the jobs sorted by priority, but never put a job in front of the
+    * job it depends on. Jobs are usually added with the priority of the
+    * previous one, so this doesn't have to move anything.
+    */
+   idx = queue->write_idx;
+   assert(queue->jobs[idx].job == NULL);
+   while (idx != queue->read_idx) {
+      unsigned prev = (idx + queue->max_jobs - 1) % queue->max_jobs;
+
+      if (queue->jobs[prev].priority >= priority ||
+          (depends_on && queue->jobs[prev].fence == depends_on))
+         break;
+
+      queue->jobs[idx] = queue->jobs[prev];
+      idx = prev;
+   }
+
+   ptr = &queue->jobs[idx];
    ptr->job = job;
    ptr->fence = fence;
+   ptr->depends_on = depends_on;
    ptr->execute = execute;
    ptr->cleanup = cleanup;
    ptr->job_size = job_size;
+   ptr->priority = priority;
 
    queue->write_idx = (queue->write_idx + 1) % queue->max_jobs;
    queue->total_jobs_size += ptr->job_size;
@@ -650,10 +689,12 @@ util_queue_finish(struct util_queue *queue)
    fences = malloc(queue->num_threads * sizeof(*fences));
    util_barrier_init(&barrier, queue->num_threads);
 
+   /* The lowest priority puts the barrier behind every queued job. */
    for (unsigned i = 0; i < queue->num_threads; ++i) {
       util_queue_fence_init(&fences[i]);
-      util_queue_add_job(queue, &barrier, &fences[i],
-                         util_queue_finish_execute, NULL, 0);
+      util_queue_add_job_ext(queue, &barrier, &fences[i],
+                             util_queue_finish_execute, NULL, 0,
+                             UTIL_QUEUE_PRIORITY_LOW, NULL);
    }
 
    for (unsigned i = 0; i < queue->num_threads; ++i) {
@@ -191,12 +191,23 @@ util_queue_fence_wait_timeout(struct util_queue_fence *fence,
 
 typedef void (*util_queue_execute_func)(void *job, int thread_index);
 
+/* Jobs of higher priority are executed first. Jobs of the same priority
+ * are executed in the order they were added.
+ */
+enum util_queue_priority {
+   UTIL_QUEUE_PRIORITY_LOW,
+   UTIL_QUEUE_PRIORITY_NORMAL,
+   UTIL_QUEUE_PRIORITY_HIGH,
+};
+
 struct util_queue_job {
    void *job;
    size_t job_size;
    struct util_queue_fence *fence;
+   struct util_queue_fence *depends_on;
    util_queue_execute_func execute;
    util_queue_execute_func cleanup;
+   enum util_queue_priority priority;
 };
 
 /* Put this into your context. */
@@ -234,6 +245,20 @@ void util_queue_add_job(struct util_queue *queue,
                         util_queue_execute_func execute,
                         util_queue_execute_func cleanup,
                         const size_t job_size);
+
+/* Same as util_queue_add_job, with a priority, and optionally a fence that
+ * must be signalled before the job starts. That is usually the fence of
+ * another job, in this queue or in another one, which must have been added
+ * first.
+ */
+void util_queue_add_job_ext(struct util_queue *queue,
+                            void *job,
+                            struct util_queue_fence *fence,
+                            util_queue_execute_func execute,
+                            util_queue_execute_func cleanup,
+                            const size_t job_size,
+                            enum util_queue_priority priority,
+                            struct util_queue_fence *depends_on);
 void util_queue_drop_job(struct util_queue *queue,
                          struct util_queue_fence *fence);
 
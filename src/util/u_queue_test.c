@@ -0,0 +1,136 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * Checks the order in which util_queue executes jobs of different
+ * priorities and jobs that depend on other jobs.
+ */
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "u_queue.h"
+
+struct test_job {
+   struct util_queue_fence fence;
+   struct util_queue_fence *gate;
+   char name;
+};
+
+static char order[16];
+static unsigned num_executed;
+
+static void
+test_job_execute(void *data, int thread_index)
+{
+   struct test_job *job = data;
+
+   if (job->gate)
+      util_queue_fence_wait(job->gate);
+
+   order[p_atomic_inc_return(&num_executed) - 1] = job->name;
+}
+
+static void
+add_job(struct util_queue *queue, struct test_job *job, char name,
+        enum util_queue_priority priority, struct test_job *depends_on)
+{
+   job->name = name;
+   util_queue_fence_init(&job->fence);
+   util_queue_add_job_ext(queue, job, &job->fence, test_job_execute, NULL, 0,
+                          priority, depends_on ? &depends_on->fence : NULL);
+}
+
+static void
+check_order(const char *expected)
+{
+   order[num_executed] = 0;
+   if (strcmp(order, expected) != 0) {
+      fprintf(stderr, "jobs executed as %s, expected %s\n", order, expected);
+      exit(EXIT_FAILURE);
+   }
+   num_executed = 0;
+}
+
+int
+main(int argc, char **argv)
+{
+   struct util_queue queue, other_queue;
+   struct util_queue_fence gate;
+   struct test_job jobs[7] = {0};
+
+   (void) argc;
+   (void) argv;
+
+   util_queue_fence_init(&gate);
+
+   if (!util_queue_init(&queue, "test", 8, 1, 0) ||
+       !util_queue_init(&other_queue, "test_other", 8, 1, 0))
+      return EXIT_FAILURE;
+
+   /* Block the thread so that the other jobs wait in the queue. It may not
+    * have started yet, and nothing goes in front of a high priority job.
+    */
+   util_queue_fence_reset(&gate);
+   jobs[0].gate = &gate;
+   add_job(&queue, &jobs[0], '0', UTIL_QUEUE_PRIORITY_HIGH, NULL);
+
+   add_job(&queue, &jobs[1], 'a', UTIL_QUEUE_PRIORITY_LOW, NULL);
+   add_job(&queue, &jobs[2], 'b', UTIL_QUEUE_PRIORITY_NORMAL, NULL);
+   add_job(&queue, &jobs[3], 'c', UTIL_QUEUE_PRIORITY_HIGH, NULL);
+   add_job(&queue, &jobs[4], 'd', UTIL_QUEUE_PRIORITY_NORMAL, NULL);
+   /* Can't run before 'a' */
+   add_job(&queue, &jobs[5], 'e', UTIL_QUEUE_PRIORITY_HIGH, &jobs[1]);
+   add_job(&queue, &jobs[6], 'f', UTIL_QUEUE_PRIORITY_LOW, NULL);
+
+   util_queue_fence_signal(&gate);
+   util_queue_finish(&queue);
+   check_order("0cbdaef");
+
+   /* Dependency on a job of another queue */
+   util_queue_fence_destroy(&jobs[0].fence);
+   util_queue_fence_destroy(&jobs[1].fence);
+   util_queue_fence_reset(&gate);
+   jobs[0].gate = &gate;
+   add_job(&other_queue, &jobs[0], '0', UTIL_QUEUE_PRIORITY_NORMAL, NULL);
+   jobs[1].gate = NULL;
+   add_job(&queue, &jobs[1], 'a', UTIL_QUEUE_PRIORITY_NORMAL, &jobs[0]);
+
+   util_queue_fence_signal(&gate);
+   util_queue_fence_wait(&jobs[1].fence);
+   assert(util_queue_fence_is_signalled(&jobs[0].fence));
+   check_order("0a");
+
+   util_queue_destroy(&queue);
+   util_queue_destroy(&other_queue);
+
+   for (unsigned i = 0; i < ARRAY_SIZE(jobs); i++)
+      util_queue_fence_destroy(&jobs[i].fence);
+   util_queue_fence_destroy(&gate);
+
+   return EXIT_SUCCESS;
+}